@@ -5,9 +5,126 @@
 #include <valgrind/valgrind.h>
 #include <valgrind/memcheck.h>
 #endif /* MEMCHECK */
+#ifdef USE_THREADSAFE_MALLOC
+#include <pthread.h>
+#endif /* USE_THREADSAFE_MALLOC */
 
 /* const dl_uint8_t redZoneSize = 8; */
 
+#ifdef MEMCHECK
+#define DL_MEMORY_DEFINED(memory, size) VALGRIND_MAKE_MEM_DEFINED(memory, size)
+#define DL_MEMORY_UNDEFINED(memory, size) VALGRIND_MAKE_MEM_UNDEFINED(memory, size)
+#define DL_MEMORY_NOACCESS(memory, size) VALGRIND_MAKE_MEM_NOACCESS(memory, size)
+#else /* MEMCHECK */
+#define DL_MEMORY_DEFINED(memory, size)
+#define DL_MEMORY_UNDEFINED(memory, size)
+#define DL_MEMORY_NOACCESS(memory, size)
+#endif /* MEMCHECK */
+
+
+/* Segregated free lists
+
+   Every block starts with a header holding its size, which includes the header. Sizes are multiples of the alignment,
+   so the low bits are used as flags. Free blocks also hold links to their neighbors in their size class's list, and
+   they end with a copy of their size so that the block after them can find their start. Free blocks never sit next to
+   each other, because they are merged as soon as they are freed. A header-only block that is always allocated marks
+   the end of the heap.
+
+   Size classes are split like TLSF. Each power of two is split into `DL_MEMORY_SUBCLASSES` classes, and sizes smaller
+   than `DL_MEMORY_SMALL` get one class per alignment step. Each class has a bit in a bitmap that is set when its list
+   isn't empty, so the smallest class with a big enough block can be found with a couple of bit scans. */
+
+#define DL_MEMORY_ALLOCATED ((dl_size_t) 1)
+#define DL_MEMORY_PREVIOUS_ALLOCATED ((dl_size_t) 2)
+#define DL_MEMORY_FLAGS (DL_MEMORY_ALLOCATED | DL_MEMORY_PREVIOUS_ALLOCATED)
+#define DL_MEMORY_HEADER_SIZE sizeof(dl_size_t)
+
+#define DL_MEMORY_SUBCLASSES_LOG2 3
+#define DL_MEMORY_SUBCLASSES (1 << DL_MEMORY_SUBCLASSES_LOG2)
+/* `DL_ALIGNMENT` times the number of subclasses. */
+#define DL_MEMORY_SMALL_LOG2 (DL_MEMORY_SUBCLASSES_LOG2 + 3)
+#define DL_MEMORY_SMALL (1 << DL_MEMORY_SMALL_LOG2)
+#define DL_MEMORY_CLASSES (8 * sizeof(dl_size_t) - DL_MEMORY_SMALL_LOG2 + 1)
+
+typedef struct dl_memoryFreeBlock_s {
+	dl_size_t header;
+	struct dl_memoryFreeBlock_s *next;
+	struct dl_memoryFreeBlock_s *previous;
+} dl_memoryFreeBlock_t;
+
+/* Big enough for the links and the trailing size. */
+#define DL_MEMORY_MINIMUM_BLOCK \
+	((sizeof(dl_memoryFreeBlock_t) + sizeof(dl_size_t) + DL_ALIGNMENT - 1) & ~((dl_size_t) DL_ALIGNMENT - 1))
+
+typedef struct dl_memorySizeClasses_s {
+	dl_uint64_t classBitmap;
+	dl_uint8_t subclassBitmaps[DL_MEMORY_CLASSES];
+	dl_memoryFreeBlock_t *freeLists[DL_MEMORY_CLASSES][DL_MEMORY_SUBCLASSES];
+	/* The end marker. */
+	dl_size_t *end;
+#ifdef USE_THREADSAFE_MALLOC
+	/* Held by every malloc, free, and realloc on the allocation, and by thread caches when they go to it for blocks. */
+	pthread_mutex_t lock;
+#endif /* USE_THREADSAFE_MALLOC */
+} dl_memorySizeClasses_t;
+
+/* Index of the highest set bit. `bits` can't be zero. */
+static dl_size_t dl_memory_highestBit(dl_size_t bits) {
+#if defined(__GNUC__)
+	return 8 * sizeof(unsigned long long) - 1 - __builtin_clzll(bits);
+#else
+	dl_size_t index = 0;
+	while (bits >>= 1) index++;
+	return index;
+#endif
+}
+
+static void dl_memory_sizeClass(dl_size_t size, dl_size_t *sizeClass, dl_size_t *subclass) {
+	if (size < DL_MEMORY_SMALL) {
+		*sizeClass = 0;
+		*subclass = size / (DL_MEMORY_SMALL / DL_MEMORY_SUBCLASSES);
+	}
+	else {
+		dl_size_t log2 = dl_memory_highestBit(size);
+		*sizeClass = log2 - DL_MEMORY_SMALL_LOG2 + 1;
+		*subclass = (size >> (log2 - DL_MEMORY_SUBCLASSES_LOG2)) ^ DL_MEMORY_SUBCLASSES;
+	}
+}
+
+static dl_size_t dl_memory_blockSize(dl_memoryFreeBlock_t *block) {
+	return block->header & ~DL_MEMORY_FLAGS;
+}
+
+static dl_memoryFreeBlock_t *dl_memory_nextBlock(dl_memoryFreeBlock_t *block) {
+	return (dl_memoryFreeBlock_t *) ((dl_uint8_t *) block + dl_memory_blockSize(block));
+}
+
+static void dl_memory_insertFreeBlock(dl_memorySizeClasses_t *sizeClasses, dl_memoryFreeBlock_t *block) {
+	dl_size_t size = dl_memory_blockSize(block);
+	dl_size_t sizeClass;
+	dl_size_t subclass;
+	dl_memoryFreeBlock_t *next;
+	/**/ dl_memory_sizeClass(size, &sizeClass, &subclass);
+	next = sizeClasses->freeLists[sizeClass][subclass];
+
+	DL_MEMORY_DEFINED(block, sizeof(dl_memoryFreeBlock_t));
+	block->header &= ~DL_MEMORY_ALLOCATED;
+	block->next = next;
+	block->previous = dl_null;
+	if (next != dl_null) next->previous = block;
+	sizeClasses->freeLists[sizeClass][subclass] = block;
+	sizeClasses->subclassBitmaps[sizeClass] |= 1 << subclass;
+	sizeClasses->classBitmap |= (dl_uint64_t) 1 << sizeClass;
+
+	/* Leave the size at the end for the block after this one, and tell that block that this one is free. */
+	DL_MEMORY_DEFINED((dl_uint8_t *) block + size - sizeof(dl_size_t), sizeof(dl_size_t));
+	*(dl_size_t *) ((dl_uint8_t *) block + size - sizeof(dl_size_t)) = size;
+	dl_memory_nextBlock(block)->header &= ~DL_MEMORY_PREVIOUS_ALLOCATED;
+}
+
+static dl_error_t dl_memory_initSizeClasses(dl_memoryAllocation_t *memoryAllocation);
+static void dl_memory_initProfile(dl_memoryAllocation_t *memoryAllocation);
+
 
 dl_error_t dl_memory_init(dl_memoryAllocation_t *memoryAllocation, void *memory, dl_size_t size, dl_memoryFit_t fit) {
 	dl_error_t error;
@@ -21,11 +138,26 @@ dl_error_t dl_memory_init(dl_memoryAllocation_t *memoryAllocation, void *memory,
 	// Initialize.
 	memoryAllocation->memory = memory;
 	memoryAllocation->size = size;
+	memoryAllocation->fit = fit;
+	memoryAllocation->sizeClasses = dl_null;
+	memoryAllocation->threadCache = dl_null;
+	memoryAllocation->arena = dl_null;
+	/**/ dl_memory_initProfile(memoryAllocation);
 
 #ifdef MEMCHECK
     VALGRIND_MAKE_MEM_NOACCESS(memoryAllocation->memory, memoryAllocation->size);
 #endif /* MEMCHECK */
 
+	if (fit == dl_memoryFit_segregated) {
+		memoryAllocation->blockList = dl_null;
+		memoryAllocation->blockList_length = 0;
+		memoryAllocation->blockList_indexOfBlockList = -1;
+		memoryAllocation->firstBlock = -1;
+		memoryAllocation->mostRecentBlock = -1;
+		error = dl_memory_initSizeClasses(memoryAllocation);
+		goto cleanup;
+	}
+
 	memoryAllocation->blockList = memory;
 	/*
 	0   Block list
@@ -105,6 +237,278 @@ void dl_memory_quit(dl_memoryAllocation_t *memoryAllocation) {
 	// memoryAllocation->lastBlock = -1;
 	memoryAllocation->mostRecentBlock = -1;
 	// memoryAllocation->fit = 
+#ifdef USE_THREADSAFE_MALLOC
+	if (memoryAllocation->sizeClasses != dl_null) {
+		/**/ pthread_mutex_destroy(&memoryAllocation->sizeClasses->lock);
+	}
+#endif /* USE_THREADSAFE_MALLOC */
+	memoryAllocation->sizeClasses = dl_null;
+}
+
+static dl_error_t dl_memory_initSizeClasses(dl_memoryAllocation_t *memoryAllocation) {
+	dl_memorySizeClasses_t *sizeClasses = memoryAllocation->memory;
+	const dl_size_t alignmentMask = DL_ALIGNMENT - 1;
+	dl_size_t tableSize = (sizeof(dl_memorySizeClasses_t) + alignmentMask) & ~alignmentMask;
+	dl_size_t blockSize;
+	dl_memoryFreeBlock_t *block;
+
+	if (tableSize + DL_MEMORY_MINIMUM_BLOCK + DL_MEMORY_HEADER_SIZE > memoryAllocation->size) {
+		return dl_error_outOfMemory;
+	}
+	blockSize = (memoryAllocation->size - tableSize - DL_MEMORY_HEADER_SIZE) & ~alignmentMask;
+
+	DL_MEMORY_DEFINED(sizeClasses, tableSize);
+	/**/ dl_memclear(sizeClasses, sizeof(dl_memorySizeClasses_t));
+#ifdef USE_THREADSAFE_MALLOC
+	if (pthread_mutex_init(&sizeClasses->lock, dl_null)) return dl_error_shouldntHappen;
+#endif /* USE_THREADSAFE_MALLOC */
+	memoryAllocation->sizeClasses = sizeClasses;
+
+	/* One big free block, and then the end marker. Nothing comes before the first block, so it can't be merged
+	   backwards. */
+	block = (dl_memoryFreeBlock_t *) ((dl_uint8_t *) sizeClasses + tableSize);
+	sizeClasses->end = (dl_size_t *) ((dl_uint8_t *) block + blockSize);
+	DL_MEMORY_DEFINED(sizeClasses->end, DL_MEMORY_HEADER_SIZE);
+	*sizeClasses->end = DL_MEMORY_HEADER_SIZE | DL_MEMORY_ALLOCATED;
+	DL_MEMORY_DEFINED(block, DL_MEMORY_HEADER_SIZE);
+	block->header = blockSize | DL_MEMORY_PREVIOUS_ALLOCATED;
+	/**/ dl_memory_insertFreeBlock(sizeClasses, block);
+
+	memoryAllocation->used = tableSize + DL_MEMORY_HEADER_SIZE;
+	memoryAllocation->max_used = memoryAllocation->used;
+	return dl_error_ok;
+}
+
+/* Arenas
+
+   An arena hands out memory from big chunks by bumping a pointer, and gives all of it back at once when it's reset.
+   Freeing a block does nothing unless it's the most recent one, and only the most recent block can grow in place.
+   Chunks come from the parent allocation. Pointers that aren't in any of the arena's chunks are passed on to the
+   parent, so freeing something that was allocated before the arena was put in charge still works. */
+
+#define DL_MEMORY_ROUND(size) (((size) + DL_ALIGNMENT - 1) & ~((dl_size_t) DL_ALIGNMENT - 1))
+
+typedef struct dl_memoryArenaChunk_s {
+	struct dl_memoryArenaChunk_s *previous;
+	dl_uint8_t *end;
+} dl_memoryArenaChunk_t;
+
+#define DL_MEMORY_ARENA_CHUNK_HEADER_SIZE DL_MEMORY_ROUND(sizeof(dl_memoryArenaChunk_t))
+/* Each block starts with its size. */
+#define DL_MEMORY_ARENA_HEADER_SIZE DL_MEMORY_ROUND(sizeof(dl_size_t))
+
+typedef struct dl_memoryArena_s {
+	dl_memoryAllocation_t *parent;
+	/* The newest chunk. Older chunks are full. */
+	dl_memoryArenaChunk_t *chunk;
+	dl_uint8_t *top;
+	/* Header of the most recent block, or null if it was freed. */
+	dl_uint8_t *last;
+	dl_size_t chunkSize;
+} dl_memoryArena_t;
+
+static dl_bool_t dl_memory_arenaOwns(dl_memoryArena_t *arena, void *memory) {
+	dl_memoryArenaChunk_t *chunk = arena->chunk;
+	while (chunk != dl_null) {
+		if (((dl_uint8_t *) memory > (dl_uint8_t *) chunk) && ((dl_uint8_t *) memory < chunk->end)) return dl_true;
+		chunk = chunk->previous;
+	}
+	return dl_false;
+}
+
+static dl_error_t dl_memory_arenaMalloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_size_t size) {
+	dl_error_t e = dl_error_ok;
+	dl_memoryArena_t *arena = memoryAllocation->arena;
+	dl_uint8_t *block;
+	dl_size_t blockSize;
+
+	if (size > ((dl_size_t) -1) / 2) return dl_error_outOfMemory;
+	size = DL_MEMORY_ROUND(size);
+	blockSize = DL_MEMORY_ARENA_HEADER_SIZE + size;
+
+	if ((arena->chunk == dl_null) || ((dl_size_t) (arena->chunk->end - arena->top) < blockSize)) {
+		void *chunkMemory = dl_null;
+		dl_memoryArenaChunk_t *chunk;
+		dl_size_t chunkSize = dl_max(arena->chunkSize, DL_MEMORY_ARENA_CHUNK_HEADER_SIZE + blockSize);
+		e = dl_malloc(arena->parent, &chunkMemory, chunkSize);
+		if (e) return e;
+		chunk = chunkMemory;
+		chunk->previous = arena->chunk;
+		chunk->end = (dl_uint8_t *) chunk + chunkSize;
+		arena->chunk = chunk;
+		arena->top = (dl_uint8_t *) chunk + DL_MEMORY_ARENA_CHUNK_HEADER_SIZE;
+		DL_MEMORY_NOACCESS(arena->top, chunk->end - arena->top);
+	}
+
+	block = arena->top;
+	DL_MEMORY_DEFINED(block, DL_MEMORY_ARENA_HEADER_SIZE);
+	*(dl_size_t *) block = size;
+	arena->top += blockSize;
+	arena->last = block;
+	memoryAllocation->used += blockSize;
+	memoryAllocation->max_used = dl_max(memoryAllocation->max_used, memoryAllocation->used);
+
+	*memory = block + DL_MEMORY_ARENA_HEADER_SIZE;
+	DL_MEMORY_UNDEFINED(*memory, size);
+	return e;
+}
+
+static dl_error_t dl_memory_arenaFree(dl_memoryAllocation_t *memoryAllocation, void **memory) {
+	dl_memoryArena_t *arena = memoryAllocation->arena;
+	dl_uint8_t *block;
+	dl_size_t size;
+
+	if (!dl_memory_arenaOwns(arena, *memory)) return dl_free(arena->parent, memory);
+
+	block = (dl_uint8_t *) *memory - DL_MEMORY_ARENA_HEADER_SIZE;
+	size = *(dl_size_t *) block;
+	if (block == arena->last) {
+		/* Free lists are nice, but popping the top of the arena is nicer. */
+		arena->top = block;
+		arena->last = dl_null;
+		memoryAllocation->used -= DL_MEMORY_ARENA_HEADER_SIZE + size;
+		DL_MEMORY_NOACCESS(block, DL_MEMORY_ARENA_HEADER_SIZE + size);
+	}
+	else {
+		DL_MEMORY_NOACCESS(*memory, size);
+	}
+	*memory = dl_null;
+	return dl_error_ok;
+}
+
+static dl_error_t dl_memory_arenaRealloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_size_t size) {
+	dl_error_t e = dl_error_ok;
+	dl_memoryArena_t *arena = memoryAllocation->arena;
+	dl_uint8_t *block;
+	dl_size_t oldSize;
+	void *newMemory = dl_null;
+
+	if (*memory == dl_null) return dl_memory_arenaMalloc(memoryAllocation, memory, size);
+	if (!dl_memory_arenaOwns(arena, *memory)) return dl_realloc(arena->parent, memory, size);
+	if (size > ((dl_size_t) -1) / 2) return dl_error_outOfMemory;
+
+	block = (dl_uint8_t *) *memory - DL_MEMORY_ARENA_HEADER_SIZE;
+	oldSize = *(dl_size_t *) block;
+	size = DL_MEMORY_ROUND(size);
+
+	/* The most recent block can be resized in place if the chunk has room. */
+	if ((block == arena->last) && ((dl_size_t) (arena->chunk->end - (dl_uint8_t *) *memory) >= size)) {
+		*(dl_size_t *) block = size;
+		arena->top = (dl_uint8_t *) *memory + size;
+		memoryAllocation->used = memoryAllocation->used + size - oldSize;
+		memoryAllocation->max_used = dl_max(memoryAllocation->max_used, memoryAllocation->used);
+		if (size > oldSize) {
+			DL_MEMORY_UNDEFINED((dl_uint8_t *) *memory + oldSize, size - oldSize);
+		}
+		else {
+			DL_MEMORY_NOACCESS((dl_uint8_t *) *memory + size, oldSize - size);
+		}
+		return e;
+	}
+	/* Anything else just keeps its block when it shrinks. */
+	if (size <= oldSize) return e;
+
+	/* Arrays that grow one element at a time would copy themselves on every push, so leave room to grow into. */
+	e = dl_memory_arenaMalloc(memoryAllocation, &newMemory, dl_max(size, 2 * oldSize));
+	if (e) return e;
+	/**/ dl_memcopy_noOverlap(newMemory, *memory, oldSize);
+	e = dl_memory_arenaFree(memoryAllocation, memory);
+	*memory = newMemory;
+	return e;
+}
+
+static dl_error_t dl_memory_freeArenaChunks(dl_memoryArena_t *arena) {
+	dl_error_t e = dl_error_ok;
+	while (arena->chunk != dl_null) {
+		void *chunk = arena->chunk;
+		dl_error_t eError;
+		arena->chunk = arena->chunk->previous;
+		DL_MEMORY_UNDEFINED(chunk, ((dl_memoryArenaChunk_t *) chunk)->end - (dl_uint8_t *) chunk);
+		eError = dl_free(arena->parent, &chunk);
+		if (eError) e = eError;
+	}
+	arena->top = dl_null;
+	arena->last = dl_null;
+	return e;
+}
+
+#ifdef USE_MEMORY_PROFILING
+/* Zero for pointers that belong to the parent, so that only the parent counts them. */
+static dl_size_t dl_memory_arenaAllocatedSize(dl_memoryArena_t *arena, void *memory) {
+	if (!dl_memory_arenaOwns(arena, memory)) return 0;
+	return *(dl_size_t *) ((dl_uint8_t *) memory - DL_MEMORY_ARENA_HEADER_SIZE);
+}
+
+/* Nothing is reused until a reset, so the only free memory is what's left of the newest chunk. */
+static void dl_memory_arenaFreeMemory(dl_memoryArena_t *arena, dl_size_t *freeBytes, dl_size_t *largestFreeBlock) {
+	*freeBytes = (arena->chunk == dl_null) ? 0 : (dl_size_t) (arena->chunk->end - arena->top);
+	*largestFreeBlock = *freeBytes;
+}
+#endif /* USE_MEMORY_PROFILING */
+
+dl_error_t dl_memory_initArena(dl_memoryAllocation_t *arena, dl_memoryAllocation_t *parent, dl_size_t chunkSize) {
+	dl_error_t e = dl_error_ok;
+	void *memory = dl_null;
+
+	e = dl_malloc(parent, &memory, sizeof(dl_memoryArena_t));
+	if (e) return e;
+	/**/ dl_memclear(memory, sizeof(dl_memoryArena_t));
+
+	arena->memory = parent->memory;
+	arena->size = parent->size;
+	arena->fit = parent->fit;
+	arena->mostRecentBlock = -1;
+	arena->firstBlock = -1;
+	arena->blockList = dl_null;
+	arena->blockList_length = 0;
+	arena->blockList_indexOfBlockList = -1;
+	arena->used = 0;
+	arena->max_used = 0;
+	arena->sizeClasses = dl_null;
+	arena->threadCache = dl_null;
+	/**/ dl_memory_initProfile(arena);
+	arena->arena = memory;
+	arena->arena->parent = parent;
+	arena->arena->chunkSize = DL_MEMORY_ROUND(dl_max(chunkSize, DL_MEMORY_ARENA_CHUNK_HEADER_SIZE));
+	return e;
+}
+
+dl_error_t dl_memory_resetArena(dl_memoryAllocation_t *arena) {
+	dl_error_t e = dl_error_ok;
+	dl_memoryArena_t *state = arena->arena;
+
+	if (state->chunk == dl_null) return e;
+	if (state->chunk->previous == dl_null) {
+		state->top = (dl_uint8_t *) state->chunk + DL_MEMORY_ARENA_CHUNK_HEADER_SIZE;
+		state->last = dl_null;
+		DL_MEMORY_NOACCESS(state->top, state->chunk->end - state->top);
+	}
+	else {
+		/* Took more than one chunk. Make the next chunk big enough to hold all of it so that the next round doesn't. */
+		dl_size_t total = 0;
+		dl_memoryArenaChunk_t *chunk = state->chunk;
+		while (chunk != dl_null) {
+			total += chunk->end - (dl_uint8_t *) chunk;
+			chunk = chunk->previous;
+		}
+		state->chunkSize = dl_max(state->chunkSize, total);
+		e = dl_memory_freeArenaChunks(state);
+	}
+	arena->used = 0;
+#ifdef USE_MEMORY_PROFILING
+	arena->profile.bytes = 0;
+#endif /* USE_MEMORY_PROFILING */
+	return e;
+}
+
+void dl_memory_quitArena(dl_memoryAllocation_t *arena) {
+	void *state = arena->arena;
+	if (state == dl_null) return;
+	/**/ dl_memory_freeArenaChunks(arena->arena);
+	/**/ dl_free(arena->arena->parent, &state);
+	arena->arena = dl_null;
+	arena->memory = dl_null;
+	arena->size = 0;
 }
 
 /* void dl_memory_printMemoryAllocation(dl_memoryAllocation_t memoryAllocation) { */
@@ -346,23 +750,46 @@ void dl_memory_quit(dl_memoryAllocation_t *memoryAllocation) {
 /* 	return error; */
 /* } */
 
+/* Blocks handed out by the block list fits start with the index of their descriptor, so freeing doesn't have to search
+   the block list. Padded so that the memory after it stays aligned. */
+#define DL_MEMORY_BLOCK_HEADER_SIZE ((sizeof(dl_ptrdiff_t) + DL_ALIGNMENT - 1) & ~((dl_size_t) DL_ALIGNMENT - 1))
+
 dl_error_t dl_memory_pointerToBlock(dl_memoryAllocation_t memoryAllocation, dl_ptrdiff_t *block, void **memory) {
 	dl_error_t error = dl_error_ok;
-	
+	dl_uint8_t *pointer = *memory;
+	dl_uint8_t *start = memoryAllocation.memory;
+	dl_ptrdiff_t index;
+
 	*block = -1;
-	for (dl_ptrdiff_t i = 0; (dl_size_t) i < memoryAllocation.blockList_length; i++) {
-		if (!memoryAllocation.blockList[i].unlinked && (memoryAllocation.blockList[i].block == *memory)) {
-			*block = i;
-		}
+	/* Don't read a header that isn't in the heap. */
+	if ((pointer < start + DL_MEMORY_BLOCK_HEADER_SIZE)
+	    || (pointer >= start + memoryAllocation.size)
+	    || ((dl_size_t) (pointer - start) & (sizeof(dl_ptrdiff_t) - 1))) {
+		error = dl_error_danglingPointer;
+		goto l_cleanup;
 	}
-	if (*block == -1) {
+
+	/* The pointer may not be ours, in which case the header is probably somebody else's data or freed memory. Reading it
+	   is fine. It just can't be trusted until the descriptor it names points back at it. */
+#ifdef MEMCHECK
+	VALGRIND_DISABLE_ERROR_REPORTING;
+#endif /* MEMCHECK */
+	index = *(dl_ptrdiff_t *) (pointer - DL_MEMORY_BLOCK_HEADER_SIZE);
+#ifdef MEMCHECK
+	VALGRIND_ENABLE_ERROR_REPORTING;
+#endif /* MEMCHECK */
+	if ((index < 0)
+	    || ((dl_size_t) index >= memoryAllocation.blockList_length)
+	    || memoryAllocation.blockList[index].unlinked
+	    || ((dl_uint8_t *) memoryAllocation.blockList[index].block + DL_MEMORY_BLOCK_HEADER_SIZE != pointer)) {
 		error = dl_error_danglingPointer;
 		goto l_cleanup;
 	}
-	
+	*block = index;
+
 	error = dl_error_ok;
 	l_cleanup:
-	
+
 	return error;
 }
 
@@ -707,8 +1134,530 @@ dl_error_t dl_memory_splitBlock(dl_memoryAllocation_t *memoryAllocation, dl_ptrd
 	return error;
 }
 
+#ifdef USE_MEMORY_PROFILING
+/* `dl_malloc` and friends count the call and then pass it on to these. */
+#define DL_MEMORY_MALLOC dl_memory_unprofiledMalloc
+#define DL_MEMORY_FREE dl_memory_unprofiledFree
+#define DL_MEMORY_REALLOC dl_memory_unprofiledRealloc
+static dl_error_t dl_memory_unprofiledMalloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_size_t size);
+static dl_error_t dl_memory_unprofiledFree(dl_memoryAllocation_t *memoryAllocation, void **memory);
+static dl_error_t dl_memory_unprofiledRealloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_size_t size);
+#else /* USE_MEMORY_PROFILING */
+#define DL_MEMORY_MALLOC dl_malloc
+#define DL_MEMORY_FREE dl_free
+#define DL_MEMORY_REALLOC dl_realloc
+#endif /* USE_MEMORY_PROFILING */
+
 #ifdef USE_DUCKLIB_MALLOC
-dl_error_t dl_malloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_size_t size) {
+
+static void dl_memory_writeBlockHeader(dl_memoryAllocation_t *memoryAllocation, dl_ptrdiff_t block) {
+	dl_ptrdiff_t *header = memoryAllocation->blockList[block].block;
+	DL_MEMORY_UNDEFINED(header, sizeof(dl_ptrdiff_t));
+	*header = block;
+	/* Nobody else has any business touching it. */
+	DL_MEMORY_NOACCESS(header, sizeof(dl_ptrdiff_t));
+}
+
+/* Index of the lowest set bit. `bits` can't be zero. */
+static dl_size_t dl_memory_lowestBit(dl_uint64_t bits) {
+#if defined(__GNUC__)
+	return __builtin_ctzll(bits);
+#else
+	dl_size_t index = 0;
+	while (!(bits & 1)) {
+		bits >>= 1;
+		index++;
+	}
+	return index;
+#endif
+}
+
+static void dl_memory_removeFreeBlock(dl_memorySizeClasses_t *sizeClasses, dl_memoryFreeBlock_t *block) {
+	dl_size_t sizeClass;
+	dl_size_t subclass;
+	/**/ dl_memory_sizeClass(dl_memory_blockSize(block), &sizeClass, &subclass);
+
+	if (block->next != dl_null) block->next->previous = block->previous;
+	if (block->previous != dl_null) {
+		block->previous->next = block->next;
+	}
+	else {
+		sizeClasses->freeLists[sizeClass][subclass] = block->next;
+		if (block->next == dl_null) {
+			sizeClasses->subclassBitmaps[sizeClass] &= ~(1 << subclass);
+			if (sizeClasses->subclassBitmaps[sizeClass] == 0) {
+				sizeClasses->classBitmap &= ~((dl_uint64_t) 1 << sizeClass);
+			}
+		}
+	}
+	dl_memory_nextBlock(block)->header |= DL_MEMORY_PREVIOUS_ALLOCATED;
+}
+
+/* Find and unlink a free block of at least `size` bytes. Rounding the size up to the next class boundary means that any
+   block in the class that is found is big enough, so nothing has to be searched. */
+static dl_memoryFreeBlock_t *dl_memory_takeFreeBlock(dl_memorySizeClasses_t *sizeClasses, dl_size_t size) {
+	dl_size_t sizeClass;
+	dl_size_t subclass;
+	dl_size_t roundedSize = size;
+	dl_uint64_t subclasses = 0;
+	dl_uint64_t classes;
+	dl_memoryFreeBlock_t *block;
+
+	if (size >= DL_MEMORY_SMALL) {
+		roundedSize += ((dl_size_t) 1 << (dl_memory_highestBit(size) - DL_MEMORY_SUBCLASSES_LOG2)) - 1;
+	}
+	/**/ dl_memory_sizeClass(roundedSize, &sizeClass, &subclass);
+	if (sizeClass < DL_MEMORY_CLASSES) {
+		subclasses = sizeClasses->subclassBitmaps[sizeClass] & (~(dl_uint64_t) 0 << subclass);
+		if (subclasses == 0) {
+			classes = ((sizeClass + 1 < 64)
+			           ? sizeClasses->classBitmap & (~(dl_uint64_t) 0 << (sizeClass + 1))
+			           : 0);
+			if (classes != 0) {
+				sizeClass = dl_memory_lowestBit(classes);
+				subclasses = sizeClasses->subclassBitmaps[sizeClass];
+			}
+		}
+	}
+	if (subclasses != 0) {
+		subclass = dl_memory_lowestBit(subclasses);
+		block = sizeClasses->freeLists[sizeClass][subclass];
+	}
+	else {
+		/* Nothing bigger is free, but a block in the size's own class might still fit. This only happens when the heap
+		   is nearly full, so it's fine to search. */
+		/**/ dl_memory_sizeClass(size, &sizeClass, &subclass);
+		block = sizeClasses->freeLists[sizeClass][subclass];
+		while ((block != dl_null) && (dl_memory_blockSize(block) < size)) block = block->next;
+		if (block == dl_null) return dl_null;
+	}
+	/**/ dl_memory_removeFreeBlock(sizeClasses, block);
+	return block;
+}
+
+/* Cut an allocated block down to `size` bytes and free the rest if it's big enough to be a block. */
+static void dl_memory_trimBlock(dl_memoryAllocation_t *memoryAllocation, dl_memoryFreeBlock_t *block, dl_size_t size) {
+	dl_size_t blockSize = dl_memory_blockSize(block);
+	dl_memoryFreeBlock_t *rest;
+	if (blockSize - size < DL_MEMORY_MINIMUM_BLOCK) return;
+
+	block->header = size | (block->header & DL_MEMORY_FLAGS);
+	rest = dl_memory_nextBlock(block);
+	DL_MEMORY_NOACCESS(rest, blockSize - size);
+	DL_MEMORY_DEFINED(rest, DL_MEMORY_HEADER_SIZE);
+	rest->header = (blockSize - size) | DL_MEMORY_PREVIOUS_ALLOCATED;
+	memoryAllocation->used -= blockSize - size;
+	/* The block after might be free too. */
+	if (!(dl_memory_nextBlock(rest)->header & DL_MEMORY_ALLOCATED)) {
+		dl_memoryFreeBlock_t *next = dl_memory_nextBlock(rest);
+		/**/ dl_memory_removeFreeBlock(memoryAllocation->sizeClasses, next);
+		rest->header += dl_memory_blockSize(next);
+	}
+	/**/ dl_memory_insertFreeBlock(memoryAllocation->sizeClasses, rest);
+}
+
+/* Convert a request into a block size: a header, plus the payload rounded up to the alignment. */
+static dl_size_t dl_memory_segregatedBlockSize(dl_size_t size) {
+	size = (size + DL_MEMORY_HEADER_SIZE + DL_ALIGNMENT - 1) & ~((dl_size_t) DL_ALIGNMENT - 1);
+	return dl_max(size, DL_MEMORY_MINIMUM_BLOCK);
+}
+
+static dl_error_t dl_memory_segregatedMalloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_size_t size) {
+	dl_memoryFreeBlock_t *block;
+	if (size > memoryAllocation->size) return dl_error_outOfMemory;
+	size = dl_memory_segregatedBlockSize(size);
+
+	block = dl_memory_takeFreeBlock(memoryAllocation->sizeClasses, size);
+	if (block == dl_null) return dl_error_outOfMemory;
+	block->header |= DL_MEMORY_ALLOCATED;
+	memoryAllocation->used += dl_memory_blockSize(block);
+	/**/ dl_memory_trimBlock(memoryAllocation, block, size);
+	memoryAllocation->max_used = dl_max(memoryAllocation->max_used, memoryAllocation->used);
+
+	*memory = (dl_uint8_t *) block + DL_MEMORY_HEADER_SIZE;
+	DL_MEMORY_UNDEFINED(*memory, dl_memory_blockSize(block) - DL_MEMORY_HEADER_SIZE);
+	return dl_error_ok;
+}
+
+/* Returns null if the pointer wasn't returned by the allocator or was already freed. Only catches some of those. */
+static dl_memoryFreeBlock_t *dl_memory_segregatedPointerToBlock(dl_memoryAllocation_t *memoryAllocation, void *memory) {
+	dl_memoryFreeBlock_t *block = (dl_memoryFreeBlock_t *) ((dl_uint8_t *) memory - DL_MEMORY_HEADER_SIZE);
+	if (((dl_uint8_t *) block < (dl_uint8_t *) (memoryAllocation->sizeClasses + 1))
+	    || ((dl_size_t *) block >= memoryAllocation->sizeClasses->end)
+	    || ((dl_size_t) memory & (DL_ALIGNMENT - 1))
+	    || !(block->header & DL_MEMORY_ALLOCATED)) {
+		return dl_null;
+	}
+	return block;
+}
+
+static dl_error_t dl_memory_segregatedFree(dl_memoryAllocation_t *memoryAllocation, void **memory) {
+	dl_memorySizeClasses_t *sizeClasses = memoryAllocation->sizeClasses;
+	dl_memoryFreeBlock_t *block = dl_memory_segregatedPointerToBlock(memoryAllocation, *memory);
+	dl_memoryFreeBlock_t *next;
+
+	if (block == dl_null) return dl_error_danglingPointer;
+	memoryAllocation->used -= dl_memory_blockSize(block);
+	DL_MEMORY_NOACCESS(*memory, dl_memory_blockSize(block) - DL_MEMORY_HEADER_SIZE);
+
+	/* Merge with the neighbors. */
+	next = dl_memory_nextBlock(block);
+	if (!(next->header & DL_MEMORY_ALLOCATED)) {
+		/**/ dl_memory_removeFreeBlock(sizeClasses, next);
+		block->header += dl_memory_blockSize(next);
+	}
+	if (!(block->header & DL_MEMORY_PREVIOUS_ALLOCATED)) {
+		dl_size_t previousSize = *((dl_size_t *) block - 1);
+		dl_memoryFreeBlock_t *previous = (dl_memoryFreeBlock_t *) ((dl_uint8_t *) block - previousSize);
+		/**/ dl_memory_removeFreeBlock(sizeClasses, previous);
+		previous->header += dl_memory_blockSize(block);
+		block = previous;
+	}
+	/**/ dl_memory_insertFreeBlock(sizeClasses, block);
+	return dl_error_ok;
+}
+
+static dl_error_t dl_memory_segregatedRealloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_size_t size) {
+	dl_error_t e = dl_error_ok;
+	dl_memoryFreeBlock_t *block = dl_memory_segregatedPointerToBlock(memoryAllocation, *memory);
+	dl_memoryFreeBlock_t *next;
+	dl_size_t oldSize;
+	void *newMemory = dl_null;
+
+	if (block == dl_null) return dl_error_danglingPointer;
+	if (size > memoryAllocation->size) return dl_error_outOfMemory;
+	oldSize = dl_memory_blockSize(block);
+	size = dl_memory_segregatedBlockSize(size);
+
+	/* Grow into the next block if it's free and big enough. */
+	next = dl_memory_nextBlock(block);
+	if ((size > oldSize)
+	    && !(next->header & DL_MEMORY_ALLOCATED)
+	    && (oldSize + dl_memory_blockSize(next) >= size)) {
+		/**/ dl_memory_removeFreeBlock(memoryAllocation->sizeClasses, next);
+		block->header += dl_memory_blockSize(next);
+		memoryAllocation->used += dl_memory_blockSize(next);
+	}
+	if (dl_memory_blockSize(block) >= size) {
+		/**/ dl_memory_trimBlock(memoryAllocation, block, size);
+		memoryAllocation->max_used = dl_max(memoryAllocation->max_used, memoryAllocation->used);
+		if (dl_memory_blockSize(block) > oldSize) {
+			DL_MEMORY_UNDEFINED((dl_uint8_t *) block + oldSize, dl_memory_blockSize(block) - oldSize);
+		}
+		return e;
+	}
+
+	e = dl_memory_segregatedMalloc(memoryAllocation, &newMemory, size - DL_MEMORY_HEADER_SIZE);
+	if (e) return e;
+	/**/ dl_memcopy_noOverlap(newMemory, *memory, oldSize - DL_MEMORY_HEADER_SIZE);
+	e = dl_memory_segregatedFree(memoryAllocation, memory);
+	*memory = newMemory;
+	return e;
+}
+
+#ifdef USE_THREADSAFE_MALLOC
+#define DL_MEMORY_LOCK(memoryAllocation) /**/ pthread_mutex_lock(&(memoryAllocation)->sizeClasses->lock)
+#define DL_MEMORY_UNLOCK(memoryAllocation) /**/ pthread_mutex_unlock(&(memoryAllocation)->sizeClasses->lock)
+#else /* USE_THREADSAFE_MALLOC */
+#define DL_MEMORY_LOCK(memoryAllocation)
+#define DL_MEMORY_UNLOCK(memoryAllocation)
+#endif /* USE_THREADSAFE_MALLOC */
+
+#ifdef USE_THREADSAFE_MALLOC
+
+/* Thread caches
+
+   Each thread keeps lists of free small blocks, one list per size class. Mallocs and frees from the owning thread only
+   touch those lists. The shared allocation is only locked to grab a batch of blocks when a list runs dry, to give a
+   batch back when a list gets too long, and for blocks too big to cache.
+
+   A block freed by some other thread is pushed onto its owner's remote list with a compare-and-swap. The owner takes
+   the whole list at once when it runs out of blocks, so nobody ever pops a single block from it and there's no ABA
+   problem.
+
+   The cache counts its blocks that are out, plus one for its owner. Whoever drops that count to zero, the owner on
+   quit or the thread that frees the last block, gives the cache back to the shared allocation. */
+
+#define DL_MEMORY_CACHE_STEP 16
+#define DL_MEMORY_CACHE_CLASSES 32
+/* Longest a list gets before a batch goes back to the shared allocation. */
+#define DL_MEMORY_CACHE_CAPACITY 64
+#define DL_MEMORY_CACHE_BATCH 32
+
+typedef struct dl_memoryCachedBlock_s {
+	/* Null for big blocks, which come straight from the shared allocation. */
+	struct dl_memoryThreadCache_s *owner;
+	dl_size_t sizeClass;
+	/* Only used while the block is free. This is where the caller's memory starts. */
+	struct dl_memoryCachedBlock_s *next;
+} dl_memoryCachedBlock_t;
+
+#define DL_MEMORY_CACHE_PREFIX_SIZE (sizeof(dl_memoryCachedBlock_t) - sizeof(dl_memoryCachedBlock_t *))
+/* Set in `sizeClass` while the block sits in a list, so double frees can be caught. */
+#define DL_MEMORY_CACHE_FREED ((dl_size_t) 1 << (8 * sizeof(dl_size_t) - 1))
+
+typedef struct dl_memoryThreadCache_s {
+	dl_memoryAllocation_t *shared;
+	dl_memoryCachedBlock_t *lists[DL_MEMORY_CACHE_CLASSES];
+	dl_size_t lists_lengths[DL_MEMORY_CACHE_CLASSES];
+	dl_memoryCachedBlock_t *remoteFrees;
+	dl_size_t references;
+} dl_memoryThreadCache_t;
+
+static void *dl_memory_cachedBlockMemory(dl_memoryCachedBlock_t *block) {
+	return (dl_uint8_t *) block + DL_MEMORY_CACHE_PREFIX_SIZE;
+}
+
+static dl_size_t dl_memory_cacheClassSize(dl_size_t sizeClass) {
+	return (sizeClass + 1) * DL_MEMORY_CACHE_STEP;
+}
+
+static void dl_memory_pushCachedBlock(dl_memoryThreadCache_t *cache, dl_memoryCachedBlock_t *block) {
+	dl_size_t sizeClass = block->sizeClass & ~DL_MEMORY_CACHE_FREED;
+	block->next = cache->lists[sizeClass];
+	cache->lists[sizeClass] = block;
+	cache->lists_lengths[sizeClass]++;
+}
+
+/* Move everything other threads freed into the lists. Only the owner may call this. */
+static void dl_memory_takeRemoteFrees(dl_memoryThreadCache_t *cache) {
+	dl_memoryCachedBlock_t *block = __atomic_exchange_n(&cache->remoteFrees, dl_null, __ATOMIC_ACQUIRE);
+	while (block != dl_null) {
+		dl_memoryCachedBlock_t *next = block->next;
+		/**/ dl_memory_pushCachedBlock(cache, block);
+		block = next;
+	}
+}
+
+/* Give up to `count` blocks from a list back to the shared allocation. The caller holds the lock. */
+static void dl_memory_flushCachedBlocks(dl_memoryThreadCache_t *cache, dl_size_t sizeClass, dl_size_t count) {
+	while ((count > 0) && (cache->lists[sizeClass] != dl_null)) {
+		void *block = cache->lists[sizeClass];
+		cache->lists[sizeClass] = cache->lists[sizeClass]->next;
+		--cache->lists_lengths[sizeClass];
+		--count;
+		/**/ dl_memory_segregatedFree(cache->shared, &block);
+	}
+}
+
+/* Nobody can use the cache anymore, so give all of it back. */
+static void dl_memory_releaseThreadCache(dl_memoryThreadCache_t *cache) {
+	dl_memoryAllocation_t *shared = cache->shared;
+	void *memory = cache;
+	/**/ dl_memory_takeRemoteFrees(cache);
+	DL_MEMORY_LOCK(shared);
+	DL_DOTIMES(i, DL_MEMORY_CACHE_CLASSES) {
+		/**/ dl_memory_flushCachedBlocks(cache, i, cache->lists_lengths[i]);
+	}
+	/**/ dl_memory_segregatedFree(shared, &memory);
+	DL_MEMORY_UNLOCK(shared);
+}
+
+static void dl_memory_dropThreadCacheReference(dl_memoryThreadCache_t *cache) {
+	if (__atomic_sub_fetch(&cache->references, 1, __ATOMIC_ACQ_REL) == 0) {
+		/**/ dl_memory_releaseThreadCache(cache);
+	}
+}
+
+/* Fill an empty list, first with blocks other threads freed, and then with a batch from the shared allocation. */
+static dl_error_t dl_memory_refillThreadCache(dl_memoryThreadCache_t *cache, dl_size_t sizeClass) {
+	dl_error_t e = dl_error_ok;
+	dl_memoryAllocation_t *shared = cache->shared;
+
+	/**/ dl_memory_takeRemoteFrees(cache);
+	if (cache->lists[sizeClass] != dl_null) return e;
+
+	DL_MEMORY_LOCK(shared);
+	DL_DOTIMES(i, DL_MEMORY_CACHE_BATCH) {
+		void *memory = dl_null;
+		dl_memoryCachedBlock_t *block;
+		e = dl_memory_segregatedMalloc(shared, &memory, DL_MEMORY_CACHE_PREFIX_SIZE + dl_memory_cacheClassSize(sizeClass));
+		if (e) {
+			/* A partial batch is still a batch. */
+			if (i > 0) e = dl_error_ok;
+			break;
+		}
+		block = memory;
+		block->owner = cache;
+		block->sizeClass = sizeClass | DL_MEMORY_CACHE_FREED;
+		/**/ dl_memory_pushCachedBlock(cache, block);
+	}
+	DL_MEMORY_UNLOCK(shared);
+	return e;
+}
+
+static dl_error_t dl_memory_cacheMalloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_size_t size) {
+	dl_error_t e = dl_error_ok;
+	dl_memoryThreadCache_t *cache = memoryAllocation->threadCache;
+	dl_memoryCachedBlock_t *block;
+	dl_size_t sizeClass;
+
+	if (size > dl_memory_cacheClassSize(DL_MEMORY_CACHE_CLASSES - 1)) {
+		void *bigMemory = dl_null;
+		if (size > cache->shared->size) return dl_error_outOfMemory;
+		DL_MEMORY_LOCK(cache->shared);
+		e = dl_memory_segregatedMalloc(cache->shared, &bigMemory, DL_MEMORY_CACHE_PREFIX_SIZE + size);
+		DL_MEMORY_UNLOCK(cache->shared);
+		if (e) return e;
+		block = bigMemory;
+		block->owner = dl_null;
+		block->sizeClass = 0;
+		*memory = dl_memory_cachedBlockMemory(block);
+		return e;
+	}
+
+	sizeClass = (size - 1) / DL_MEMORY_CACHE_STEP;
+	if (cache->lists[sizeClass] == dl_null) {
+		e = dl_memory_refillThreadCache(cache, sizeClass);
+		if (e) return e;
+	}
+	block = cache->lists[sizeClass];
+	cache->lists[sizeClass] = block->next;
+	--cache->lists_lengths[sizeClass];
+	block->sizeClass = sizeClass;
+	/**/ __atomic_add_fetch(&cache->references, 1, __ATOMIC_RELAXED);
+
+	*memory = dl_memory_cachedBlockMemory(block);
+	DL_MEMORY_UNDEFINED(*memory, dl_memory_cacheClassSize(sizeClass));
+	return e;
+}
+
+/* Returns null if the pointer can't have come from a cache of this shared allocation. Only catches some of those. */
+static dl_memoryCachedBlock_t *dl_memory_cachePointerToBlock(dl_memoryAllocation_t *memoryAllocation, void *memory) {
+	dl_memoryAllocation_t *shared = memoryAllocation->threadCache->shared;
+	dl_memoryCachedBlock_t *block = (dl_memoryCachedBlock_t *) ((dl_uint8_t *) memory - DL_MEMORY_CACHE_PREFIX_SIZE);
+	if (((dl_uint8_t *) block < (dl_uint8_t *) (shared->sizeClasses + 1))
+	    || ((dl_size_t *) block >= shared->sizeClasses->end)
+	    || ((dl_size_t) memory & (DL_ALIGNMENT - 1))
+	    || (block->sizeClass & DL_MEMORY_CACHE_FREED)) {
+		return dl_null;
+	}
+	return block;
+}
+
+static dl_error_t dl_memory_cacheFree(dl_memoryAllocation_t *memoryAllocation, void **memory) {
+	dl_error_t e = dl_error_ok;
+	dl_memoryThreadCache_t *cache = memoryAllocation->threadCache;
+	dl_memoryCachedBlock_t *block = dl_memory_cachePointerToBlock(memoryAllocation, *memory);
+	dl_memoryThreadCache_t *owner;
+
+	if (block == dl_null) return dl_error_danglingPointer;
+	owner = block->owner;
+
+	if (owner == dl_null) {
+		void *bigMemory = block;
+		DL_MEMORY_LOCK(cache->shared);
+		e = dl_memory_segregatedFree(cache->shared, &bigMemory);
+		DL_MEMORY_UNLOCK(cache->shared);
+		return e;
+	}
+
+	DL_MEMORY_NOACCESS((dl_uint8_t *) *memory + sizeof(dl_memoryCachedBlock_t *),
+	                   dl_memory_cacheClassSize(block->sizeClass) - sizeof(dl_memoryCachedBlock_t *));
+	block->sizeClass |= DL_MEMORY_CACHE_FREED;
+	if (owner == cache) {
+		dl_size_t sizeClass = block->sizeClass & ~DL_MEMORY_CACHE_FREED;
+		/**/ dl_memory_pushCachedBlock(cache, block);
+		if (cache->lists_lengths[sizeClass] > DL_MEMORY_CACHE_CAPACITY) {
+			DL_MEMORY_LOCK(cache->shared);
+			/**/ dl_memory_flushCachedBlocks(cache, sizeClass, DL_MEMORY_CACHE_BATCH);
+			DL_MEMORY_UNLOCK(cache->shared);
+		}
+	}
+	else {
+		block->next = __atomic_load_n(&owner->remoteFrees, __ATOMIC_RELAXED);
+		while (!__atomic_compare_exchange_n(&owner->remoteFrees,
+		                                    &block->next,
+		                                    block,
+		                                    dl_true,
+		                                    __ATOMIC_RELEASE,
+		                                    __ATOMIC_RELAXED));
+	}
+	/**/ dl_memory_dropThreadCacheReference(owner);
+	return e;
+}
+
+static dl_error_t dl_memory_cacheRealloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_size_t size) {
+	dl_error_t e = dl_error_ok;
+	dl_memoryThreadCache_t *cache = memoryAllocation->threadCache;
+	dl_memoryCachedBlock_t *block = dl_memory_cachePointerToBlock(memoryAllocation, *memory);
+	void *newMemory = dl_null;
+
+	if (block == dl_null) return dl_error_danglingPointer;
+
+	if (block->owner == dl_null) {
+		/* Big blocks may be able to grow in place, so let the shared allocation handle them. */
+		void *bigMemory = block;
+		if (size > cache->shared->size) return dl_error_outOfMemory;
+		DL_MEMORY_LOCK(cache->shared);
+		e = dl_memory_segregatedRealloc(cache->shared, &bigMemory, DL_MEMORY_CACHE_PREFIX_SIZE + size);
+		DL_MEMORY_UNLOCK(cache->shared);
+		if (e) return e;
+		*memory = dl_memory_cachedBlockMemory(bigMemory);
+		return e;
+	}
+
+	if (size <= dl_memory_cacheClassSize(block->sizeClass)) return e;
+	e = dl_memory_cacheMalloc(memoryAllocation, &newMemory, size);
+	if (e) return e;
+	/**/ dl_memcopy_noOverlap(newMemory, *memory, dl_memory_cacheClassSize(block->sizeClass));
+	e = dl_memory_cacheFree(memoryAllocation, memory);
+	*memory = newMemory;
+	return e;
+}
+
+#endif /* USE_THREADSAFE_MALLOC */
+
+dl_error_t dl_memory_initThreadCache(dl_memoryAllocation_t *cache, dl_memoryAllocation_t *shared) {
+#ifdef USE_THREADSAFE_MALLOC
+	dl_error_t e = dl_error_ok;
+	void *memory = dl_null;
+
+	if ((shared->fit != dl_memoryFit_segregated) || (shared->threadCache != dl_null)) return dl_error_invalidValue;
+
+	DL_MEMORY_LOCK(shared);
+	e = dl_memory_segregatedMalloc(shared, &memory, sizeof(dl_memoryThreadCache_t));
+	DL_MEMORY_UNLOCK(shared);
+	if (e) return e;
+	/**/ dl_memclear(memory, sizeof(dl_memoryThreadCache_t));
+
+	cache->memory = shared->memory;
+	cache->size = shared->size;
+	cache->fit = shared->fit;
+	cache->mostRecentBlock = -1;
+	cache->firstBlock = -1;
+	cache->blockList = dl_null;
+	cache->blockList_length = 0;
+	cache->blockList_indexOfBlockList = -1;
+	cache->used = 0;
+	cache->max_used = 0;
+	cache->sizeClasses = shared->sizeClasses;
+	cache->arena = dl_null;
+	/**/ dl_memory_initProfile(cache);
+	cache->threadCache = memory;
+	cache->threadCache->shared = shared;
+	cache->threadCache->references = 1;
+	return e;
+#else /* USE_THREADSAFE_MALLOC */
+	(void) cache;
+	(void) shared;
+	return dl_error_invalidValue;
+#endif /* USE_THREADSAFE_MALLOC */
+}
+
+void dl_memory_quitThreadCache(dl_memoryAllocation_t *cache) {
+#ifdef USE_THREADSAFE_MALLOC
+	if (cache->threadCache != dl_null) {
+		/**/ dl_memory_dropThreadCacheReference(cache->threadCache);
+	}
+#endif /* USE_THREADSAFE_MALLOC */
+	cache->threadCache = dl_null;
+	cache->sizeClasses = dl_null;
+	cache->memory = dl_null;
+	cache->size = 0;
+}
+
+dl_error_t DL_MEMORY_MALLOC(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_size_t size) {
 	dl_error_t error = dl_error_ok;
 
 	dl_ptrdiff_t block = -1;
@@ -718,7 +1667,27 @@ dl_error_t dl_malloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_
 		goto cleanup;
 	}
 
+	if (memoryAllocation->arena != dl_null) {
+		error = dl_memory_arenaMalloc(memoryAllocation, memory, size);
+		goto cleanup;
+	}
+
+#ifdef USE_THREADSAFE_MALLOC
+	if (memoryAllocation->threadCache != dl_null) {
+		error = dl_memory_cacheMalloc(memoryAllocation, memory, size);
+		goto cleanup;
+	}
+#endif /* USE_THREADSAFE_MALLOC */
+
+	if (memoryAllocation->fit == dl_memoryFit_segregated) {
+		DL_MEMORY_LOCK(memoryAllocation);
+		error = dl_memory_segregatedMalloc(memoryAllocation, memory, size);
+		DL_MEMORY_UNLOCK(memoryAllocation);
+		goto cleanup;
+	}
+
 	size += DL_ALIGNMENT - (size & (DL_ALIGNMENT - 1));
+	size += DL_MEMORY_BLOCK_HEADER_SIZE;
 
 	error = dl_memory_reserveTableEntries(memoryAllocation, 1);
 	if (error) goto cleanup;
@@ -737,12 +1706,13 @@ dl_error_t dl_malloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_
 	memoryAllocation->blockList[block].allocated = dl_true;
 
 	// Pass the memory.
-	*memory = memoryAllocation->blockList[block].block;
+	/**/ dl_memory_writeBlockHeader(memoryAllocation, block);
+	*memory = (char *) memoryAllocation->blockList[block].block + DL_MEMORY_BLOCK_HEADER_SIZE;
 	memoryAllocation->used = dl_max(memoryAllocation->used, (dl_size_t) (memoryAllocation->blockList[block].block_size + (char *) memoryAllocation->blockList[block].block - (char *) memoryAllocation->memory));
 	memoryAllocation->max_used = dl_max(memoryAllocation->max_used, memoryAllocation->used);
 
 #ifdef MEMCHECK
-	VALGRIND_MAKE_MEM_UNDEFINED(*memory, size);
+	VALGRIND_MAKE_MEM_UNDEFINED(*memory, size - DL_MEMORY_BLOCK_HEADER_SIZE);
 #endif /* MEMCHECK */
 
 	error = dl_error_ok;
@@ -756,7 +1726,7 @@ dl_error_t dl_malloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_
 
 
 // Sets the given pointer to zero after freeing the memory.
-dl_error_t dl_free(dl_memoryAllocation_t *memoryAllocation, void **memory) {
+dl_error_t DL_MEMORY_FREE(dl_memoryAllocation_t *memoryAllocation, void **memory) {
 	dl_error_t error = dl_error_ok;
 
 	dl_ptrdiff_t block = -1;
@@ -766,6 +1736,25 @@ dl_error_t dl_free(dl_memoryAllocation_t *memoryAllocation, void **memory) {
 		goto l_cleanup;
 	}
 
+	if (memoryAllocation->arena != dl_null) {
+		/* Not `goto l_cleanup`, since the pointer may be passed on to the parent, which needs to know it's not null. */
+		return dl_memory_arenaFree(memoryAllocation, memory);
+	}
+
+#ifdef USE_THREADSAFE_MALLOC
+	if (memoryAllocation->threadCache != dl_null) {
+		error = dl_memory_cacheFree(memoryAllocation, memory);
+		goto l_cleanup;
+	}
+#endif /* USE_THREADSAFE_MALLOC */
+
+	if (memoryAllocation->fit == dl_memoryFit_segregated) {
+		DL_MEMORY_LOCK(memoryAllocation);
+		error = dl_memory_segregatedFree(memoryAllocation, memory);
+		DL_MEMORY_UNLOCK(memoryAllocation);
+		goto l_cleanup;
+	}
+
 	error = dl_memory_pointerToBlock(*memoryAllocation, &block, memory);
 	if (error || (memoryAllocation->blockList[block].allocated == dl_false)) {
 		error = dl_error_danglingPointer;
@@ -773,7 +1762,7 @@ dl_error_t dl_free(dl_memoryAllocation_t *memoryAllocation, void **memory) {
 	}
 
 #ifdef MEMCHECK
-	VALGRIND_MAKE_MEM_NOACCESS(*memory, memoryAllocation->blockList[block].block_size);
+	VALGRIND_MAKE_MEM_NOACCESS(memoryAllocation->blockList[block].block, memoryAllocation->blockList[block].block_size);
 #endif /* MEMCHECK */
 		
 	memoryAllocation->blockList[block].allocated = dl_false;
@@ -792,19 +1781,17 @@ dl_error_t dl_free(dl_memoryAllocation_t *memoryAllocation, void **memory) {
 	return error;
 }
 
-dl_error_t dl_realloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_size_t size) {
+dl_error_t DL_MEMORY_REALLOC(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_size_t size) {
 	dl_error_t error = dl_error_ok;
 	
 	dl_ptrdiff_t currentBlock = -1;
 	dl_ptrdiff_t newBlock = -1;
 
 	dl_bool_t blockFits = dl_false;
-#ifdef MEMCHECK
 	dl_size_t oldSize;
-#endif
 	
 	if (*memory == dl_null) {
-		error = dl_malloc(memoryAllocation, memory, size);
+		error = DL_MEMORY_MALLOC(memoryAllocation, memory, size);
 		goto l_cleanup;
 	}
 
@@ -812,8 +1799,28 @@ dl_error_t dl_realloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl
 		error = dl_error_invalidValue;
 		goto l_cleanup;
 	}
+
+	if (memoryAllocation->arena != dl_null) {
+		error = dl_memory_arenaRealloc(memoryAllocation, memory, size);
+		goto l_cleanup;
+	}
+
+#ifdef USE_THREADSAFE_MALLOC
+	if (memoryAllocation->threadCache != dl_null) {
+		error = dl_memory_cacheRealloc(memoryAllocation, memory, size);
+		goto l_cleanup;
+	}
+#endif /* USE_THREADSAFE_MALLOC */
+
+	if (memoryAllocation->fit == dl_memoryFit_segregated) {
+		DL_MEMORY_LOCK(memoryAllocation);
+		error = dl_memory_segregatedRealloc(memoryAllocation, memory, size);
+		DL_MEMORY_UNLOCK(memoryAllocation);
+		goto l_cleanup;
+	}
 	
 	size += DL_ALIGNMENT - (size & (DL_ALIGNMENT - 1));
+	size += DL_MEMORY_BLOCK_HEADER_SIZE;
 	
 	error = dl_memory_pointerToBlock(*memoryAllocation, &currentBlock, memory);
 	if (error || (memoryAllocation->blockList[currentBlock].allocated == dl_false)) {
@@ -821,9 +1828,7 @@ dl_error_t dl_realloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl
 		goto l_cleanup;
 	}
 
-#ifdef MEMCHECK
 	oldSize = memoryAllocation->blockList[currentBlock].block_size;
-#endif
 	
 	// Mark deleted just in case we find that we can expand our block.
 	memoryAllocation->blockList[currentBlock].allocated = dl_false;
@@ -864,42 +1869,29 @@ dl_error_t dl_realloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl
 	}
 
 	if (!blockFits) {
-		// Copy.
+		// Copy. The new block may overlap the old one if the block before it was free.
 #ifdef MEMCHECK
-		VALGRIND_MAKE_MEM_UNDEFINED(memoryAllocation->blockList[newBlock].block, size);
-		VALGRIND_MAKE_MEM_DEFINED(*memory, memoryAllocation->blockList[currentBlock].block_size);
+		VALGRIND_MAKE_MEM_DEFINED(*memory, oldSize - DL_MEMORY_BLOCK_HEADER_SIZE);
 #endif /* MEMCHECK */
-		dl_memcopy(memoryAllocation->blockList[newBlock].block,
+		dl_memcopy((char *) memoryAllocation->blockList[newBlock].block + DL_MEMORY_BLOCK_HEADER_SIZE,
 		           *memory,
-		           dl_min(size, memoryAllocation->blockList[currentBlock].block_size));
-		if (error) {
-			goto l_cleanup;
-		}
-#ifdef MEMCHECK
-		VALGRIND_MAKE_MEM_NOACCESS(*memory, oldSize);
-		VALGRIND_MAKE_MEM_UNDEFINED(memoryAllocation->blockList[newBlock].block + oldSize, size - oldSize);
-		VALGRIND_MAKE_MEM_DEFINED(memoryAllocation->blockList[newBlock].block, oldSize);
-#endif /* MEMCHECK */
+		           dl_min(size, oldSize) - DL_MEMORY_BLOCK_HEADER_SIZE);
 	}
 #ifdef MEMCHECK
-	else {
-		if (size > oldSize) {
-			VALGRIND_MAKE_MEM_NOACCESS(*memory, oldSize);
-			VALGRIND_MAKE_MEM_UNDEFINED(memoryAllocation->blockList[newBlock].block + oldSize, size - oldSize);
-			VALGRIND_MAKE_MEM_DEFINED(memoryAllocation->blockList[newBlock].block, oldSize);
-		}
-		else {
-			VALGRIND_MAKE_MEM_NOACCESS(*memory, oldSize);
-			VALGRIND_MAKE_MEM_DEFINED(memoryAllocation->blockList[newBlock].block, size);
-		}
+	VALGRIND_MAKE_MEM_NOACCESS((char *) *memory - DL_MEMORY_BLOCK_HEADER_SIZE, oldSize);
+	if (size > oldSize) {
+		VALGRIND_MAKE_MEM_UNDEFINED((char *) memoryAllocation->blockList[newBlock].block + oldSize, size - oldSize);
 	}
+	VALGRIND_MAKE_MEM_DEFINED((char *) memoryAllocation->blockList[newBlock].block + DL_MEMORY_BLOCK_HEADER_SIZE,
+	                          dl_min(size, oldSize) - DL_MEMORY_BLOCK_HEADER_SIZE);
 #endif /* MEMCHECK */
 	
 	// Mark allocated.
 	memoryAllocation->blockList[newBlock].allocated = dl_true;
     
-	// Pass the memory.
-	*memory = memoryAllocation->blockList[newBlock].block;
+	// Pass the memory. The header goes in last so that it can't clobber anything that still needed copying.
+	/**/ dl_memory_writeBlockHeader(memoryAllocation, newBlock);
+	*memory = (char *) memoryAllocation->blockList[newBlock].block + DL_MEMORY_BLOCK_HEADER_SIZE;
 	memoryAllocation->used = dl_max(memoryAllocation->used, (dl_size_t) (memoryAllocation->blockList[newBlock].block_size + (char *) memoryAllocation->blockList[newBlock].block - (char *) memoryAllocation->memory));
 	memoryAllocation->max_used = dl_max(memoryAllocation->max_used, memoryAllocation->used);
 
@@ -917,6 +1909,25 @@ void dl_memory_usage(dl_size_t *bytes, const dl_memoryAllocation_t memoryAllocat
 	const dl_memoryBlock_t *blockList = memoryAllocation.blockList;
 	const dl_size_t blockList_length = memoryAllocation.blockList_length;
 	dl_size_t sum = 0;
+	if (memoryAllocation.arena != dl_null) {
+		*bytes = memoryAllocation.used;
+		return;
+	}
+#ifdef USE_THREADSAFE_MALLOC
+	/* Caches share their budget, so report the whole thing. */
+	if (memoryAllocation.threadCache != dl_null) {
+		dl_memoryAllocation_t *shared = memoryAllocation.threadCache->shared;
+		DL_MEMORY_LOCK(shared);
+		*bytes = shared->used;
+		DL_MEMORY_UNLOCK(shared);
+		return;
+	}
+#endif /* USE_THREADSAFE_MALLOC */
+	/* Already counted, and there's no block list to walk. */
+	if (memoryAllocation.fit == dl_memoryFit_segregated) {
+		*bytes = memoryAllocation.used;
+		return;
+	}
 	for (dl_ptrdiff_t i = 0; (dl_size_t) i < blockList_length; i++) {
 		if (blockList[i].allocated) {
 			sum += blockList[i].block_size;
@@ -925,35 +1936,285 @@ void dl_memory_usage(dl_size_t *bytes, const dl_memoryAllocation_t memoryAllocat
 	*bytes = sum;
 }
 
+#ifdef USE_MEMORY_PROFILING
+
+/* Usable size of a block that was handed out, or zero if the pointer isn't one of ours. */
+static dl_size_t dl_memory_allocatedSize(dl_memoryAllocation_t *memoryAllocation, void *memory) {
+	dl_ptrdiff_t block = -1;
+	if (memoryAllocation->arena != dl_null) return dl_memory_arenaAllocatedSize(memoryAllocation->arena, memory);
+#ifdef USE_THREADSAFE_MALLOC
+	if (memoryAllocation->threadCache != dl_null) {
+		dl_memoryCachedBlock_t *cachedBlock = dl_memory_cachePointerToBlock(memoryAllocation, memory);
+		dl_memoryFreeBlock_t *bigBlock;
+		if (cachedBlock == dl_null) return 0;
+		if (cachedBlock->owner != dl_null) return dl_memory_cacheClassSize(cachedBlock->sizeClass);
+		bigBlock = dl_memory_segregatedPointerToBlock(memoryAllocation->threadCache->shared, cachedBlock);
+		if (bigBlock == dl_null) return 0;
+		return dl_memory_blockSize(bigBlock) - DL_MEMORY_HEADER_SIZE - DL_MEMORY_CACHE_PREFIX_SIZE;
+	}
+#endif /* USE_THREADSAFE_MALLOC */
+	if (memoryAllocation->fit == dl_memoryFit_segregated) {
+		dl_memoryFreeBlock_t *segregatedBlock = dl_memory_segregatedPointerToBlock(memoryAllocation, memory);
+		if (segregatedBlock == dl_null) return 0;
+		return dl_memory_blockSize(segregatedBlock) - DL_MEMORY_HEADER_SIZE;
+	}
+	if (dl_memory_pointerToBlock(*memoryAllocation, &block, &memory)) return 0;
+	return memoryAllocation->blockList[block].block_size - DL_MEMORY_BLOCK_HEADER_SIZE;
+}
+
+static void dl_memory_freeMemory(dl_memoryAllocation_t *memoryAllocation,
+                                 dl_size_t *freeBytes,
+                                 dl_size_t *largestFreeBlock) {
+	*freeBytes = 0;
+	*largestFreeBlock = 0;
+	if (memoryAllocation->arena != dl_null) {
+		/**/ dl_memory_arenaFreeMemory(memoryAllocation->arena, freeBytes, largestFreeBlock);
+		return;
+	}
+#ifdef USE_THREADSAFE_MALLOC
+	/* Blocks sitting in caches look allocated from here. */
+	if (memoryAllocation->threadCache != dl_null) memoryAllocation = memoryAllocation->threadCache->shared;
+#endif /* USE_THREADSAFE_MALLOC */
+	if (memoryAllocation->fit == dl_memoryFit_segregated) {
+		DL_MEMORY_LOCK(memoryAllocation);
+		DL_DOTIMES(i, DL_MEMORY_CLASSES) {
+			DL_DOTIMES(j, DL_MEMORY_SUBCLASSES) {
+				dl_memoryFreeBlock_t *block = memoryAllocation->sizeClasses->freeLists[i][j];
+				while (block != dl_null) {
+					*freeBytes += dl_memory_blockSize(block);
+					*largestFreeBlock = dl_max(*largestFreeBlock, dl_memory_blockSize(block));
+					block = block->next;
+				}
+			}
+		}
+		DL_MEMORY_UNLOCK(memoryAllocation);
+		return;
+	}
+	for (dl_ptrdiff_t block = memoryAllocation->firstBlock;
+	     block != -1;
+	     block = memoryAllocation->blockList[block].nextBlock) {
+		if (!memoryAllocation->blockList[block].allocated) {
+			*freeBytes += memoryAllocation->blockList[block].block_size;
+			*largestFreeBlock = dl_max(*largestFreeBlock, memoryAllocation->blockList[block].block_size);
+		}
+	}
+}
+
+#endif /* USE_MEMORY_PROFILING */
+
 #else /* USE_DUCKLIB_MALLOC */
 
-dl_error_t dl_malloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_size_t size) {
-	(void) memoryAllocation;
-	*(dl_uint8_t **) memory = malloc(size);
-	if (*(dl_uint8_t **) memory == NULL) return dl_error_outOfMemory;
+#ifdef USE_MEMORY_PROFILING
+/* The C library won't say how big a block is, so profiling puts the size in front of each one. */
+#define DL_MEMORY_STDLIB_HEADER_SIZE DL_MEMORY_ROUND(sizeof(dl_size_t))
+#else /* USE_MEMORY_PROFILING */
+#define DL_MEMORY_STDLIB_HEADER_SIZE 0
+#endif /* USE_MEMORY_PROFILING */
+
+dl_error_t DL_MEMORY_MALLOC(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_size_t size) {
+	dl_uint8_t *block;
+	if (memoryAllocation->arena != dl_null) return dl_memory_arenaMalloc(memoryAllocation, memory, size);
+	block = malloc(DL_MEMORY_STDLIB_HEADER_SIZE + size);
+	if (block == NULL) {
+		*(dl_uint8_t **) memory = NULL;
+		return dl_error_outOfMemory;
+	}
+#ifdef USE_MEMORY_PROFILING
+	*(dl_size_t *) block = size;
+#endif /* USE_MEMORY_PROFILING */
+	*(dl_uint8_t **) memory = block + DL_MEMORY_STDLIB_HEADER_SIZE;
 	return dl_error_ok;
 }
 
 // Sets the given pointer to zero after freeing the memory.
-dl_error_t dl_free(dl_memoryAllocation_t *memoryAllocation, void **memory) {
-	(void) memoryAllocation;
-	free(*(dl_uint8_t **) memory);
+dl_error_t DL_MEMORY_FREE(dl_memoryAllocation_t *memoryAllocation, void **memory) {
+	if (memoryAllocation->arena != dl_null) return dl_memory_arenaFree(memoryAllocation, memory);
+	if (*(dl_uint8_t **) memory != NULL) free(*(dl_uint8_t **) memory - DL_MEMORY_STDLIB_HEADER_SIZE);
 	*(dl_uint8_t **) memory = NULL;
 	return dl_error_ok;
 }
 
-dl_error_t dl_realloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_size_t size) {
-	(void) memoryAllocation;
-	*(dl_uint8_t **) memory = realloc(*(dl_uint8_t **) memory, size);
-	if (*(dl_uint8_t **) memory == NULL) {
+dl_error_t DL_MEMORY_REALLOC(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_size_t size) {
+	dl_uint8_t *block;
+	if (memoryAllocation->arena != dl_null) return dl_memory_arenaRealloc(memoryAllocation, memory, size);
+	if (*(dl_uint8_t **) memory == NULL) return DL_MEMORY_MALLOC(memoryAllocation, memory, size);
+	block = realloc(*(dl_uint8_t **) memory - DL_MEMORY_STDLIB_HEADER_SIZE, DL_MEMORY_STDLIB_HEADER_SIZE + size);
+	if (block == NULL) {
+		*(dl_uint8_t **) memory = NULL;
 		return dl_error_outOfMemory;
 	}
+#ifdef USE_MEMORY_PROFILING
+	*(dl_size_t *) block = size;
+#endif /* USE_MEMORY_PROFILING */
+	*(dl_uint8_t **) memory = block + DL_MEMORY_STDLIB_HEADER_SIZE;
 	return dl_error_ok;
 }
 
 void dl_memory_usage(dl_size_t *bytes, const dl_memoryAllocation_t memoryAllocation) {
-	(void) memoryAllocation;
-	*bytes = 0;
+	*bytes = (memoryAllocation.arena != dl_null) ? memoryAllocation.used : 0;
+}
+
+/* The C library's allocator is already thread-safe. */
+dl_error_t dl_memory_initThreadCache(dl_memoryAllocation_t *cache, dl_memoryAllocation_t *shared) {
+	*cache = *shared;
+	/**/ dl_memory_initProfile(cache);
+	return dl_error_ok;
+}
+
+void dl_memory_quitThreadCache(dl_memoryAllocation_t *cache) {
+	(void) cache;
+}
+
+#ifdef USE_MEMORY_PROFILING
+
+static dl_size_t dl_memory_allocatedSize(dl_memoryAllocation_t *memoryAllocation, void *memory) {
+	if (memoryAllocation->arena != dl_null) return dl_memory_arenaAllocatedSize(memoryAllocation->arena, memory);
+	return *(dl_size_t *) ((dl_uint8_t *) memory - DL_MEMORY_STDLIB_HEADER_SIZE);
+}
+
+static void dl_memory_freeMemory(dl_memoryAllocation_t *memoryAllocation,
+                                 dl_size_t *freeBytes,
+                                 dl_size_t *largestFreeBlock) {
+	*freeBytes = 0;
+	*largestFreeBlock = 0;
+	if (memoryAllocation->arena != dl_null) {
+		/**/ dl_memory_arenaFreeMemory(memoryAllocation->arena, freeBytes, largestFreeBlock);
+	}
 }
 
+#endif /* USE_MEMORY_PROFILING */
+
 #endif /* USE_DUCKLIB_MALLOC */
+
+/* Profiling
+
+   With `USE_MEMORY_PROFILING`, `dl_malloc`, `dl_free`, and `dl_realloc` are thin wrappers that count the call, ask the
+   allocator how big the block is, and then call the hook. Each allocation keeps its own counters, so an arena or a
+   thread cache can be watched separately from the allocation it takes memory from. A shared allocation's counters are
+   guarded by its lock. */
+
+static void dl_memory_initProfile(dl_memoryAllocation_t *memoryAllocation) {
+#ifdef USE_MEMORY_PROFILING
+	/**/ dl_memclear(&memoryAllocation->profile, sizeof(dl_memoryProfile_t));
+	memoryAllocation->profileHook = dl_null;
+#else /* USE_MEMORY_PROFILING */
+	(void) memoryAllocation;
+#endif /* USE_MEMORY_PROFILING */
+}
+
+#ifdef USE_MEMORY_PROFILING
+
+static void dl_memory_lockProfile(dl_memoryAllocation_t *memoryAllocation) {
+#if defined(USE_DUCKLIB_MALLOC) && defined(USE_THREADSAFE_MALLOC)
+	/* Caches and arenas have no lock of their own, and only one thread uses each of them anyway. */
+	if ((memoryAllocation->sizeClasses != dl_null) && (memoryAllocation->threadCache == dl_null)) {
+		DL_MEMORY_LOCK(memoryAllocation);
+	}
+#else
+	(void) memoryAllocation;
+#endif
+}
+
+static void dl_memory_unlockProfile(dl_memoryAllocation_t *memoryAllocation) {
+#if defined(USE_DUCKLIB_MALLOC) && defined(USE_THREADSAFE_MALLOC)
+	if ((memoryAllocation->sizeClasses != dl_null) && (memoryAllocation->threadCache == dl_null)) {
+		DL_MEMORY_UNLOCK(memoryAllocation);
+	}
+#else
+	(void) memoryAllocation;
+#endif
+}
+
+static void dl_memory_countSize(dl_memoryProfile_t *profile, dl_size_t size) {
+	dl_size_t slot = 0;
+	if (size > 16) slot = dl_min(dl_memory_highestBit(size - 1) - 3, (dl_size_t) DL_MEMORY_PROFILE_SIZES - 1);
+	profile->sizes[slot]++;
+}
+
+static void dl_memory_countBytes(dl_memoryProfile_t *profile, dl_ptrdiff_t bytes) {
+	profile->bytes += bytes;
+	profile->peakBytes = dl_max(profile->peakBytes, profile->bytes);
+}
+
+dl_error_t dl_malloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_size_t size) {
+	dl_error_t e = dl_memory_unprofiledMalloc(memoryAllocation, memory, size);
+	dl_size_t allocatedSize = e ? 0 : dl_memory_allocatedSize(memoryAllocation, *memory);
+
+	/**/ dl_memory_lockProfile(memoryAllocation);
+	memoryAllocation->profile.mallocs++;
+	/**/ dl_memory_countSize(&memoryAllocation->profile, size);
+	if (e) memoryAllocation->profile.failures++;
+	else dl_memory_countBytes(&memoryAllocation->profile, allocatedSize);
+	/**/ dl_memory_unlockProfile(memoryAllocation);
+
+	if (!e && (memoryAllocation->profileHook != dl_null)) {
+		/**/ memoryAllocation->profileHook(memoryAllocation, dl_memoryProfileEvent_malloc, *memory, allocatedSize);
+	}
+	return e;
+}
+
+// Sets the given pointer to zero after freeing the memory.
+dl_error_t dl_free(dl_memoryAllocation_t *memoryAllocation, void **memory) {
+	void *oldMemory = *memory;
+	dl_size_t allocatedSize = (oldMemory == dl_null) ? 0 : dl_memory_allocatedSize(memoryAllocation, oldMemory);
+	dl_error_t e = dl_memory_unprofiledFree(memoryAllocation, memory);
+
+	/**/ dl_memory_lockProfile(memoryAllocation);
+	memoryAllocation->profile.frees++;
+	if (e) memoryAllocation->profile.failures++;
+	else dl_memory_countBytes(&memoryAllocation->profile, -(dl_ptrdiff_t) allocatedSize);
+	/**/ dl_memory_unlockProfile(memoryAllocation);
+
+	if (!e && (oldMemory != dl_null) && (memoryAllocation->profileHook != dl_null)) {
+		/**/ memoryAllocation->profileHook(memoryAllocation, dl_memoryProfileEvent_free, oldMemory, allocatedSize);
+	}
+	return e;
+}
+
+dl_error_t dl_realloc(dl_memoryAllocation_t *memoryAllocation, void **memory, dl_size_t size) {
+	dl_size_t oldSize = (*memory == dl_null) ? 0 : dl_memory_allocatedSize(memoryAllocation, *memory);
+	dl_error_t e = dl_memory_unprofiledRealloc(memoryAllocation, memory, size);
+	dl_size_t allocatedSize = e ? 0 : dl_memory_allocatedSize(memoryAllocation, *memory);
+
+	/**/ dl_memory_lockProfile(memoryAllocation);
+	memoryAllocation->profile.reallocs++;
+	/**/ dl_memory_countSize(&memoryAllocation->profile, size);
+	if (e) memoryAllocation->profile.failures++;
+	else dl_memory_countBytes(&memoryAllocation->profile, (dl_ptrdiff_t) allocatedSize - (dl_ptrdiff_t) oldSize);
+	/**/ dl_memory_unlockProfile(memoryAllocation);
+
+	if (!e && (memoryAllocation->profileHook != dl_null)) {
+		/**/ memoryAllocation->profileHook(memoryAllocation, dl_memoryProfileEvent_realloc, *memory, allocatedSize);
+	}
+	return e;
+}
+
+#endif /* USE_MEMORY_PROFILING */
+
+dl_error_t dl_memory_getProfile(dl_memoryProfile_t *profile, dl_memoryAllocation_t *memoryAllocation) {
+#ifdef USE_MEMORY_PROFILING
+	/**/ dl_memory_lockProfile(memoryAllocation);
+	*profile = memoryAllocation->profile;
+	/**/ dl_memory_unlockProfile(memoryAllocation);
+	/**/ dl_memory_freeMemory(memoryAllocation, &profile->freeBytes, &profile->largestFreeBlock);
+	return dl_error_ok;
+#else /* USE_MEMORY_PROFILING */
+	/**/ dl_memclear(profile, sizeof(dl_memoryProfile_t));
+	(void) memoryAllocation;
+	return dl_error_invalidValue;
+#endif /* USE_MEMORY_PROFILING */
+}
+
+void dl_memory_resetProfile(dl_memoryAllocation_t *memoryAllocation) {
+#ifdef USE_MEMORY_PROFILING
+	dl_ptrdiff_t bytes;
+	/**/ dl_memory_lockProfile(memoryAllocation);
+	bytes = memoryAllocation->profile.bytes;
+	/**/ dl_memclear(&memoryAllocation->profile, sizeof(dl_memoryProfile_t));
+	memoryAllocation->profile.bytes = bytes;
+	memoryAllocation->profile.peakBytes = bytes;
+	/**/ dl_memory_unlockProfile(memoryAllocation);
+#else /* USE_MEMORY_PROFILING */
+	(void) memoryAllocation;
+#endif /* USE_MEMORY_PROFILING */
+}
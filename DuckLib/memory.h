@@ -22,9 +22,47 @@ typedef enum {
 	dl_memoryFit_first,
 	dl_memoryFit_next,
 	dl_memoryFit_best,
-	dl_memoryFit_worst
+	dl_memoryFit_worst,
+	/* Not a fit. Free blocks are kept in lists by size class, so finding a block takes constant time no matter how
+	   fragmented the heap is. The block list isn't used. */
+	dl_memoryFit_segregated
 } dl_memoryFit_t;
 
+#define DL_MEMORY_PROFILE_SIZES 16
+
+/* Counters kept by `dl_malloc`, `dl_free`, and `dl_realloc` when DuckLib is built with `USE_MEMORY_PROFILING`. */
+typedef struct {
+	dl_size_t mallocs;
+	dl_size_t frees;
+	dl_size_t reallocs;
+	/* Calls that returned an error. */
+	dl_size_t failures;
+	/* Sizes asked for by mallocs and reallocs. Slot 0 counts sizes up to 16 bytes, and each slot after that counts sizes
+	   up to twice what the slot before it does. The last slot counts everything bigger. */
+	dl_size_t sizes[DL_MEMORY_PROFILE_SIZES];
+	/* Usable bytes in blocks that are out. Signed, since a thread cache counts the blocks it frees even when another
+	   cache allocated them. */
+	dl_ptrdiff_t bytes;
+	dl_ptrdiff_t peakBytes;
+	/* Only filled in by `dl_memory_getProfile`. Both are zero when the C library's allocator is used, since it won't
+	   say. */
+	dl_size_t freeBytes;
+	dl_size_t largestFreeBlock;
+} dl_memoryProfile_t;
+
+typedef enum {
+	dl_memoryProfileEvent_malloc,
+	dl_memoryProfileEvent_free,
+	dl_memoryProfileEvent_realloc
+} dl_memoryProfileEvent_t;
+
+/* Free lists for `dl_memoryFit_segregated`. They live at the start of the allocator's memory. */
+struct dl_memorySizeClasses_s;
+/* Per-thread cache in front of a shared allocation. Allocated from the shared allocation's memory. */
+struct dl_memoryThreadCache_s;
+/* Bump allocator state. Allocated from the parent allocation. */
+struct dl_memoryArena_s;
+
 typedef struct dl_memoryAllocation_s {
 	void *memory;
 	dl_size_t size;
@@ -42,10 +80,49 @@ typedef struct dl_memoryAllocation_s {
 	dl_ptrdiff_t blockList_indexOfBlockList;
 	dl_size_t max_used;
 	dl_size_t used;
+
+	/* Only used by `dl_memoryFit_segregated`. */
+	struct dl_memorySizeClasses_s *sizeClasses;
+	/* Only set by `dl_memory_initThreadCache`. */
+	struct dl_memoryThreadCache_s *threadCache;
+	/* Only set by `dl_memory_initArena`. */
+	struct dl_memoryArena_s *arena;
+#ifdef USE_MEMORY_PROFILING
+	dl_memoryProfile_t profile;
+	/* Called after every malloc, free, and realloc that succeeds, if it isn't null. `size` is the usable size of the
+	   block. Freed blocks are already gone by the time it's called. */
+	void (*profileHook)(struct dl_memoryAllocation_s *memoryAllocation,
+	                    dl_memoryProfileEvent_t event,
+	                    void *memory,
+	                    dl_size_t size);
+#endif /* USE_MEMORY_PROFILING */
 } dl_memoryAllocation_t;
 
 dl_error_t DECLSPEC dl_memory_init(dl_memoryAllocation_t *memoryAllocation, void *memory, dl_size_t size, dl_memoryFit_t fit);
 void DECLSPEC dl_memory_quit(dl_memoryAllocation_t *memoryAllocation);
+/* Make `cache` allocate from `shared` through a cache that belongs to the calling thread. Each thread should have its
+   own cache. Memory from any cache may be freed by any other cache of the same shared allocation. `shared` must use
+   `dl_memoryFit_segregated`, and DuckLib must be built with `USE_THREADSAFE_MALLOC`. When DuckLib's allocator isn't
+   used at all, `cache` just becomes a copy of `shared`. */
+dl_error_t DECLSPEC dl_memory_initThreadCache(dl_memoryAllocation_t *cache, dl_memoryAllocation_t *shared);
+/* Only call this from the thread that owns the cache. Blocks that are still in use stay valid. Everything goes back to
+   the shared allocation once they are freed. */
+void DECLSPEC dl_memory_quitThreadCache(dl_memoryAllocation_t *cache);
+/* Make `arena` allocate by bumping a pointer through chunks of at least `chunkSize` bytes taken from `parent`. Freeing
+   only gives memory back if it was the most recent allocation. Everything else waits for `dl_memory_resetArena`.
+   Pointers passed to `dl_free` or `dl_realloc` that didn't come from the arena are passed on to `parent`. This works
+   whether or not DuckLib's allocator is used. */
+dl_error_t DECLSPEC dl_memory_initArena(dl_memoryAllocation_t *arena, dl_memoryAllocation_t *parent, dl_size_t chunkSize);
+/* Free everything allocated from the arena at once. One chunk is kept, and it grows to fit the most the arena has ever
+   held between resets. */
+dl_error_t DECLSPEC dl_memory_resetArena(dl_memoryAllocation_t *arena);
+void DECLSPEC dl_memory_quitArena(dl_memoryAllocation_t *arena);
+/* Copy the allocation's counters into `profile`, and measure how much of its memory is free and how big the largest
+   free block is. A thread cache reports its own counters, and the free memory of its shared allocation. Returns
+   `dl_error_invalidValue` unless DuckLib is built with `USE_MEMORY_PROFILING`. */
+dl_error_t DECLSPEC dl_memory_getProfile(dl_memoryProfile_t *profile, dl_memoryAllocation_t *memoryAllocation);
+/* Zero the counters. `bytes` is left alone since those blocks are still out, and the peak starts over from there. */
+void DECLSPEC dl_memory_resetProfile(dl_memoryAllocation_t *memoryAllocation);
 /* void DECLSPEC dl_memory_printMemoryAllocation(dl_memoryAllocation_t memoryAllocation); */
 /* dl_error_t DECLSPEC dl_memory_checkHealth(dl_memoryAllocation_t memoryAllocation); */
 
@@ -220,7 +220,7 @@ int jumpLink_less(const void *l, const void *r, const void *context) {
 
 
 /* This function has three major parts.
-   1. Remove redundant instructions.
+   1. Remove redundant instructions, fuse compare-and-branch sequences, and mark tail calls.
    2. Create a mapping of jumps and branches to target labels.
    3. Assemble to a preliminary bytecode. Jumps and branches do not have an address at this point. Jumps are a single
       byte long at this point. The opcode used by jumps is "jump32".
@@ -436,6 +436,189 @@ dl_error_t duckLisp_assemble(duckLisp_t *duckLisp,
 	}
 #endif /* NO_OPTIMIZE_PUSHPOPS */
 
+#ifndef NO_OPTIMIZE_SUPERINSTRUCTIONS
+	/* Compare-and-branch fusion */
+	/* A comparison followed by `brnz` is the test of nearly every loop and conditional. Replace the pair with a single
+	   instruction so that the VM doesn't push a boolean only to test it and pop it right away. Like the push-pop
+	   optimization, this can't fuse across a branch target since there would be a label between the two
+	   instructions. */
+	DL_DOTIMES(i, assembly->elements_length) {
+		duckLisp_instructionObject_t *instruction = &DL_ARRAY_GETADDRESS(*assembly, duckLisp_instructionObject_t, i);
+		duckLisp_instructionObject_t *nextInstruction = dl_null;
+		duckLisp_instructionArgClass_t *args = dl_null;
+		duckLisp_instructionArgClass_t *nextArgs = dl_null;
+		duckLisp_instructionClass_t fusedClass;
+		dl_size_t indices_length = 2;
+		dl_bool_t fits = dl_true;
+
+		if ((dl_size_t) i >= assembly->elements_length - 1) break;
+
+		switch (instruction->instructionClass) {
+			/* The fused instructions aren't specialized, but they still beat pushing and testing a boolean. */
+		case duckLisp_instructionClass_lessInt:
+			/* Fall through */
+		case duckLisp_instructionClass_lessFloat:
+			/* Fall through */
+		case duckLisp_instructionClass_less:
+			fusedClass = duckLisp_instructionClass_brLess;
+			break;
+		case duckLisp_instructionClass_greaterInt:
+			/* Fall through */
+		case duckLisp_instructionClass_greaterFloat:
+			/* Fall through */
+		case duckLisp_instructionClass_greater:
+			fusedClass = duckLisp_instructionClass_brGreater;
+			break;
+		case duckLisp_instructionClass_equal:
+			fusedClass = duckLisp_instructionClass_brEqual;
+			break;
+		case duckLisp_instructionClass_nullp:
+			fusedClass = duckLisp_instructionClass_brNullp;
+			indices_length = 1;
+			break;
+		default:
+			continue;
+		}
+
+		nextInstruction = &DL_ARRAY_GETADDRESS(*assembly, duckLisp_instructionObject_t, i + 1);
+		if (nextInstruction->instructionClass != duckLisp_instructionClass_brnz) continue;
+		args = &DL_ARRAY_GETADDRESS(instruction->args, duckLisp_instructionArgClass_t, 0);
+		nextArgs = &DL_ARRAY_GETADDRESS(nextInstruction->args, duckLisp_instructionArgClass_t, 0);
+
+		/* The branch has to be the thing that pops the boolean, and the fused instructions only have room for
+		   single-byte stack indices. */
+		if (nextArgs[1].value.integer < 1) continue;
+		DL_DOTIMES(j, indices_length) {
+			if ((args[j].type != duckLisp_instructionArgClass_type_index)
+			    || ((unsigned long) args[j].value.index >= 0x100UL)) {
+				fits = dl_false;
+			}
+		}
+		if (!fits) continue;
+
+		/* The boolean is never pushed, so there is one less thing to pop. */
+		--nextArgs[1].value.integer;
+		DL_DOTIMES(j, indices_length) {
+			e = dl_array_pushElement(&nextInstruction->args, &args[j]);
+			if (e) goto cleanup;
+		}
+		nextInstruction->instructionClass = fusedClass;
+
+		e = duckLisp_instructionObject_quit(duckLisp, instruction);
+		if (e) goto cleanup;
+		instruction->instructionClass = duckLisp_instructionClass_internalNop;
+	}
+#endif /* NO_OPTIMIZE_SUPERINSTRUCTIONS */
+
+#ifndef NO_OPTIMIZE_TAILCALLS
+	/* Tail calls */
+	/* A `funcall` whose return value is only moved down the stack and then returned is a tail call. Follow the
+	   instructions after each call through any jumps, keeping track of how many objects are popped from under the return
+	   value. If a `return` is reached, the call can reuse the current frame. The instructions after the call are left
+	   as-is since the VM runs them when it can't reuse the frame, like when the callee is a C function. */
+	{
+		dl_array_t labelPositions;  /* dl_ptrdiff_t, indexed by label */
+		dl_ptrdiff_t undefinedPosition = -1;
+		/**/ dl_array_init(&labelPositions,
+		                   duckLisp->memoryAllocation,
+		                   sizeof(dl_ptrdiff_t),
+		                   dl_array_strategy_fit);
+		DL_DOTIMES(i, compileState->currentCompileState->label_number) {
+			e = dl_array_pushElement(&labelPositions, &undefinedPosition);
+			if (e) break;
+		}
+		DL_DOTIMES(i, assembly->elements_length) {
+			duckLisp_instructionObject_t *instruction = &DL_ARRAY_GETADDRESS(*assembly,
+			                                                                 duckLisp_instructionObject_t,
+			                                                                 i);
+			if (e) break;
+			if (instruction->instructionClass == duckLisp_instructionClass_pseudo_label) {
+				DL_ARRAY_GETADDRESS(labelPositions,
+				                    dl_ptrdiff_t,
+				                    DL_ARRAY_GETADDRESS(instruction->args,
+				                                        duckLisp_instructionArgClass_t,
+				                                        0).value.integer) = i;
+			}
+		}
+
+		DL_DOTIMES(i, assembly->elements_length) {
+			duckLisp_instructionObject_t *instruction = &DL_ARRAY_GETADDRESS(*assembly,
+			                                                                 duckLisp_instructionObject_t,
+			                                                                 i);
+			duckLisp_instructionArgClass_t argument = {0};
+			dl_ptrdiff_t j = i + 1;
+			/* Position of the return value counting down from the top of the stack. */
+			dl_ptrdiff_t depth = 1;
+			dl_ptrdiff_t pops = 0;
+			dl_bool_t tail = dl_false;
+			dl_bool_t searching = dl_true;
+			/* Give up eventually in case of a jump loop. */
+			dl_size_t steps = 64;
+
+			if (e) break;
+			if (instruction->instructionClass != duckLisp_instructionClass_funcall) continue;
+
+			while (searching && (j >= 0) && ((dl_size_t) j < assembly->elements_length) && (steps-- > 0)) {
+				duckLisp_instructionObject_t *next = &DL_ARRAY_GETADDRESS(*assembly, duckLisp_instructionObject_t, j);
+				duckLisp_instructionArgClass_t *nextArgs = dl_null;
+				if (next->args.elements_length != 0) {
+					nextArgs = &DL_ARRAY_GETADDRESS(next->args, duckLisp_instructionArgClass_t, 0);
+				}
+				switch (next->instructionClass) {
+				case duckLisp_instructionClass_internalNop:
+					/* Fall through */
+				case duckLisp_instructionClass_pseudo_label:
+					/* Fall through */
+				case duckLisp_instructionClass_releaseUpvalues:
+					/* Doesn't touch the stack. The VM refuses the tail call if there are upvalues to release. */
+					j++;
+					break;
+				case duckLisp_instructionClass_jump:
+					j = DL_ARRAY_GETADDRESS(labelPositions, dl_ptrdiff_t, nextArgs[0].value.integer);
+					break;
+				case duckLisp_instructionClass_move:
+					if ((depth != 1) || (nextArgs[0].value.index != 1)) {
+						searching = dl_false;
+						break;
+					}
+					depth = nextArgs[1].value.index;
+					j++;
+					break;
+				case duckLisp_instructionClass_pop:
+					if (nextArgs[0].value.integer >= depth) {
+						searching = dl_false;
+						break;
+					}
+					depth -= nextArgs[0].value.integer;
+					pops += nextArgs[0].value.integer;
+					j++;
+					break;
+				case duckLisp_instructionClass_return:
+					if (depth == 1) {
+						pops += nextArgs[0].value.integer;
+						tail = dl_true;
+					}
+					searching = dl_false;
+					break;
+				default:
+					searching = dl_false;
+				}
+			}
+			if (!tail) continue;
+
+			argument.type = duckLisp_instructionArgClass_type_integer;
+			argument.value.integer = pops;
+			e = dl_array_pushElement(&instruction->args, &argument);
+			if (e) break;
+			instruction->instructionClass = duckLisp_instructionClass_tailcall;
+		}
+
+		eError = dl_array_quit(&labelPositions);
+		if (eError) e = eError;
+		if (e) goto cleanup;
+	}
+#endif /* NO_OPTIMIZE_TAILCALLS */
+
 	/* Create label links. */
 	/* The links have one pointer to the target instruction, which is always a label instruction.
 	   The links have a bunch of other pointers to the branch instructions for that label. These are always jump or
@@ -2193,6 +2376,10 @@ dl_error_t duckLisp_assemble(duckLisp_t *duckLisp,
 					                                                    >> 8*(byte_length - n - 1))
 					                                                   & 0xFFU);
 				}
+				// Arity
+				e = dl_array_pushElement(&currentArgs, dl_null);
+				if (e) goto cleanup;
+				DL_ARRAY_GETADDRESS(currentArgs, dl_uint8_t, byte_length) = args[1].value.integer & 0xFFU;
 				break;
 			default:
 				eError = duckLisp_error_pushRuntime(duckLisp, DL_STR("Invalid argument class. Aborting."));
@@ -2250,6 +2437,118 @@ dl_error_t duckLisp_assemble(duckLisp_t *duckLisp,
 			}
 			break;
 		}
+		case duckLisp_instructionClass_tailcall: {
+			if (args[0].type == duckLisp_instructionArgClass_type_index) {
+				dl_ptrdiff_t index = 0;
+
+				/* The function index and pop count share a size. */
+				if (((unsigned long) args[0].value.index < 0x100UL)
+				    && ((unsigned long) args[2].value.integer < 0x100UL)) {
+					currentInstruction.byte = duckLisp_instruction_tailcall8;
+					byte_length = 1;
+				}
+				else if (((unsigned long) args[0].value.index < 0x10000UL)
+				         && ((unsigned long) args[2].value.integer < 0x10000UL)) {
+					currentInstruction.byte = duckLisp_instruction_tailcall16;
+					byte_length = 2;
+				}
+				else {
+					currentInstruction.byte = duckLisp_instruction_tailcall32;
+					byte_length = 4;
+				}
+				e = dl_array_pushElements(&currentArgs, dl_null, 2 * byte_length + 1);
+				if (e) goto cleanup;
+
+				// Function index
+				DL_DOTIMES (l, byte_length) {
+					DL_ARRAY_GETADDRESS(currentArgs, dl_uint8_t, index + l) = ((args[0].value.index
+					                                                            >> 8*(byte_length - l - 1))
+					                                                           & 0xFFU);
+				}
+				index += byte_length;
+
+				// Arity
+				DL_ARRAY_GETADDRESS(currentArgs, dl_uint8_t, index) = args[1].value.integer & 0xFFU;
+				index++;
+
+				// Pop count
+				DL_DOTIMES (l, byte_length) {
+					DL_ARRAY_GETADDRESS(currentArgs, dl_uint8_t, index + l) = ((args[2].value.integer
+					                                                            >> 8*(byte_length - l - 1))
+					                                                           & 0xFFU);
+				}
+				index += byte_length;
+				break;
+			}
+			else {
+				eError = duckLisp_error_pushRuntime(duckLisp, DL_STR("Invalid argument class. Aborting."));
+				if (eError) {
+					e = eError;
+				}
+				goto cleanup;
+			}
+			break;
+		}
+		case duckLisp_instructionClass_addInt:
+			/* Fall through */
+		case duckLisp_instructionClass_addFloat:
+			/* Fall through */
+		case duckLisp_instructionClass_subInt:
+			/* Fall through */
+		case duckLisp_instructionClass_subFloat:
+			/* Fall through */
+		case duckLisp_instructionClass_mulInt:
+			/* Fall through */
+		case duckLisp_instructionClass_mulFloat:
+			/* Fall through */
+		case duckLisp_instructionClass_lessInt:
+			/* Fall through */
+		case duckLisp_instructionClass_lessFloat:
+			/* Fall through */
+		case duckLisp_instructionClass_greaterInt:
+			/* Fall through */
+		case duckLisp_instructionClass_greaterFloat: {
+			if ((args[0].type == duckLisp_instructionArgClass_type_index)
+			    && (args[1].type == duckLisp_instructionArgClass_type_index)) {
+				/* Each class has an 8, 16, and 32 bit opcode, in that order. */
+				dl_uint8_t opcode = (duckLisp_instruction_addInt8
+				                     + 3 * (instruction.instructionClass - duckLisp_instructionClass_addInt));
+				if (((unsigned long) args[0].value.index < 0x100UL)
+				    && ((unsigned long) args[1].value.index < 0x100UL)) {
+					currentInstruction.byte = opcode;
+					byte_length = 1;
+				}
+				else if (((unsigned long) args[0].value.index < 0x10000UL)
+				         && ((unsigned long) args[1].value.index < 0x10000UL)) {
+					currentInstruction.byte = opcode + 1;
+					byte_length = 2;
+				}
+				else {
+					currentInstruction.byte = opcode + 2;
+					byte_length = 4;
+				}
+				e = dl_array_pushElements(&currentArgs, dl_null, 2 * byte_length);
+				if (e) goto cleanup;
+				DL_DOTIMES(l, byte_length) {
+					DL_ARRAY_GETADDRESS(currentArgs, dl_uint8_t, l) = ((args[0].value.index >> 8*(byte_length - l - 1))
+					                                                   & 0xFFU);
+				}
+				DL_DOTIMES(l, byte_length) {
+					DL_ARRAY_GETADDRESS(currentArgs, dl_uint8_t, byte_length + l) = ((args[1].value.index
+					                                                                  >> 8*(byte_length - l - 1))
+					                                                                 & 0xFFU);
+				}
+				break;
+			}
+			else {
+				eError = duckLisp_error_pushRuntime(duckLisp, DL_STR("Invalid argument class. Aborting."));
+				if (eError) {
+					e = eError;
+				}
+				goto cleanup;
+			}
+			break;
+		}
 		case duckLisp_instructionClass_apply: {
 			if (args[0].type == duckLisp_instructionArgClass_type_index) {
 				dl_ptrdiff_t index = 0;
@@ -2340,7 +2639,11 @@ dl_error_t duckLisp_assemble(duckLisp_t *duckLisp,
 			/* Branches */
 		case duckLisp_instructionClass_call:
 		case duckLisp_instructionClass_jump:
-		case duckLisp_instructionClass_brnz: {
+		case duckLisp_instructionClass_brnz:
+		case duckLisp_instructionClass_brLess:
+		case duckLisp_instructionClass_brGreater:
+		case duckLisp_instructionClass_brEqual:
+		case duckLisp_instructionClass_brNullp: {
 			dl_ptrdiff_t index = 0;
 			dl_ptrdiff_t label_index = -1;
 			duckLisp_label_t label;
@@ -2394,6 +2697,18 @@ dl_error_t duckLisp_assemble(duckLisp_t *duckLisp,
 			case duckLisp_instructionClass_brnz:
 				currentInstruction.byte = duckLisp_instruction_brnz8;
 				break;
+			case duckLisp_instructionClass_brLess:
+				currentInstruction.byte = duckLisp_instruction_brLess8;
+				break;
+			case duckLisp_instructionClass_brGreater:
+				currentInstruction.byte = duckLisp_instruction_brGreater8;
+				break;
+			case duckLisp_instructionClass_brEqual:
+				currentInstruction.byte = duckLisp_instruction_brEqual8;
+				break;
+			case duckLisp_instructionClass_brNullp:
+				currentInstruction.byte = duckLisp_instruction_brNullp8;
+				break;
 			default:
 				e = dl_error_invalidValue;
 				goto cleanup;
@@ -2415,6 +2730,18 @@ dl_error_t duckLisp_assemble(duckLisp_t *duckLisp,
 			case duckLisp_instructionClass_brnz:
 				currentInstruction.byte = duckLisp_instruction_brnz32;
 				break;
+			case duckLisp_instructionClass_brLess:
+				currentInstruction.byte = duckLisp_instruction_brLess32;
+				break;
+			case duckLisp_instructionClass_brGreater:
+				currentInstruction.byte = duckLisp_instruction_brGreater32;
+				break;
+			case duckLisp_instructionClass_brEqual:
+				currentInstruction.byte = duckLisp_instruction_brEqual32;
+				break;
+			case duckLisp_instructionClass_brNullp:
+				currentInstruction.byte = duckLisp_instruction_brNullp32;
+				break;
 			default:
 				e = dl_error_invalidValue;
 				goto cleanup;
@@ -2427,6 +2754,10 @@ dl_error_t duckLisp_assemble(duckLisp_t *duckLisp,
 #endif
 
 			if ((instruction.instructionClass == duckLisp_instructionClass_brnz)
+			    || (instruction.instructionClass == duckLisp_instructionClass_brLess)
+			    || (instruction.instructionClass == duckLisp_instructionClass_brGreater)
+			    || (instruction.instructionClass == duckLisp_instructionClass_brEqual)
+			    || (instruction.instructionClass == duckLisp_instructionClass_brNullp)
 			    || (instruction.instructionClass == duckLisp_instructionClass_call)) {
 				/* br?? also have a pop argument. Insert that. */
 				byte_length = 1;
@@ -2436,6 +2767,15 @@ dl_error_t duckLisp_assemble(duckLisp_t *duckLisp,
 					DL_ARRAY_GETADDRESS(currentArgs, dl_uint8_t, index + n) = args[1].value.integer & 0xFFU;
 				}
 				index += byte_length;
+
+				/* Fused compare-and-branch instructions end with the stack indices of their operands. The fusion pass
+				   guarantees they fit in a byte. */
+				for (dl_ptrdiff_t l = 2; (dl_size_t) l < instruction.args.elements_length; l++) {
+					e = dl_array_pushElement(&currentArgs, dl_null);
+					if (e) goto cleanup;
+					DL_ARRAY_GETADDRESS(currentArgs, dl_uint8_t, index) = args[l].value.index & 0xFFU;
+					index++;
+				}
 			}
 			else if ((instruction.instructionClass == duckLisp_instructionClass_pushClosure)
 			         || (instruction.instructionClass == duckLisp_instructionClass_pushVaClosure)) {
@@ -2914,9 +3254,9 @@ dl_error_t duckLisp_disassemble(dl_array_t *string,
 		{duckLisp_instruction_apply8, DL_STR("apply.8 1 1")},
 		{duckLisp_instruction_apply16, DL_STR("apply.16 2 1")},
 		{duckLisp_instruction_apply32, DL_STR("apply.32 4 1")},
-		{duckLisp_instruction_ccall8, DL_STR("c-call.8 1")},
-		{duckLisp_instruction_ccall16, DL_STR("c-call.16 2")},
-		{duckLisp_instruction_ccall32, DL_STR("c-call.32 4")},
+		{duckLisp_instruction_ccall8, DL_STR("c-call.8 1 1")},
+		{duckLisp_instruction_ccall16, DL_STR("c-call.16 2 1")},
+		{duckLisp_instruction_ccall32, DL_STR("c-call.32 4 1")},
 		{duckLisp_instruction_jump8, DL_STR("jump.8 1")},
 		{duckLisp_instruction_jump16, DL_STR("jump.16 2")},
 		{duckLisp_instruction_jump32, DL_STR("jump.32 4")},
@@ -3029,6 +3369,51 @@ dl_error_t duckLisp_disassemble(dl_array_t *string,
 		{duckLisp_instruction_return32, DL_STR("return.32 4")},
 		{duckLisp_instruction_halt, DL_STR("halt")},
 		{duckLisp_instruction_nil, DL_STR("nil")},
+		{duckLisp_instruction_brLess8, DL_STR("br-less.8 1 1 1 1")},
+		{duckLisp_instruction_brLess16, DL_STR("br-less.16 2 1 1 1")},
+		{duckLisp_instruction_brLess32, DL_STR("br-less.32 4 1 1 1")},
+		{duckLisp_instruction_brGreater8, DL_STR("br-greater.8 1 1 1 1")},
+		{duckLisp_instruction_brGreater16, DL_STR("br-greater.16 2 1 1 1")},
+		{duckLisp_instruction_brGreater32, DL_STR("br-greater.32 4 1 1 1")},
+		{duckLisp_instruction_brEqual8, DL_STR("br-equal.8 1 1 1 1")},
+		{duckLisp_instruction_brEqual16, DL_STR("br-equal.16 2 1 1 1")},
+		{duckLisp_instruction_brEqual32, DL_STR("br-equal.32 4 1 1 1")},
+		{duckLisp_instruction_brNullp8, DL_STR("br-null?.8 1 1 1")},
+		{duckLisp_instruction_brNullp16, DL_STR("br-null?.16 2 1 1")},
+		{duckLisp_instruction_brNullp32, DL_STR("br-null?.32 4 1 1")},
+		{duckLisp_instruction_tailcall8, DL_STR("tail-call.8 1 1 1")},
+		{duckLisp_instruction_tailcall16, DL_STR("tail-call.16 2 1 2")},
+		{duckLisp_instruction_tailcall32, DL_STR("tail-call.32 4 1 4")},
+		{duckLisp_instruction_addInt8, DL_STR("add-int.8 1 1")},
+		{duckLisp_instruction_addInt16, DL_STR("add-int.16 2 2")},
+		{duckLisp_instruction_addInt32, DL_STR("add-int.32 4 4")},
+		{duckLisp_instruction_addFloat8, DL_STR("add-float.8 1 1")},
+		{duckLisp_instruction_addFloat16, DL_STR("add-float.16 2 2")},
+		{duckLisp_instruction_addFloat32, DL_STR("add-float.32 4 4")},
+		{duckLisp_instruction_subInt8, DL_STR("sub-int.8 1 1")},
+		{duckLisp_instruction_subInt16, DL_STR("sub-int.16 2 2")},
+		{duckLisp_instruction_subInt32, DL_STR("sub-int.32 4 4")},
+		{duckLisp_instruction_subFloat8, DL_STR("sub-float.8 1 1")},
+		{duckLisp_instruction_subFloat16, DL_STR("sub-float.16 2 2")},
+		{duckLisp_instruction_subFloat32, DL_STR("sub-float.32 4 4")},
+		{duckLisp_instruction_mulInt8, DL_STR("mul-int.8 1 1")},
+		{duckLisp_instruction_mulInt16, DL_STR("mul-int.16 2 2")},
+		{duckLisp_instruction_mulInt32, DL_STR("mul-int.32 4 4")},
+		{duckLisp_instruction_mulFloat8, DL_STR("mul-float.8 1 1")},
+		{duckLisp_instruction_mulFloat16, DL_STR("mul-float.16 2 2")},
+		{duckLisp_instruction_mulFloat32, DL_STR("mul-float.32 4 4")},
+		{duckLisp_instruction_lessInt8, DL_STR("less-int.8 1 1")},
+		{duckLisp_instruction_lessInt16, DL_STR("less-int.16 2 2")},
+		{duckLisp_instruction_lessInt32, DL_STR("less-int.32 4 4")},
+		{duckLisp_instruction_lessFloat8, DL_STR("less-float.8 1 1")},
+		{duckLisp_instruction_lessFloat16, DL_STR("less-float.16 2 2")},
+		{duckLisp_instruction_lessFloat32, DL_STR("less-float.32 4 4")},
+		{duckLisp_instruction_greaterInt8, DL_STR("greater-int.8 1 1")},
+		{duckLisp_instruction_greaterInt16, DL_STR("greater-int.16 2 2")},
+		{duckLisp_instruction_greaterInt32, DL_STR("greater-int.32 4 4")},
+		{duckLisp_instruction_greaterFloat8, DL_STR("greater-float.8 1 1")},
+		{duckLisp_instruction_greaterFloat16, DL_STR("greater-float.16 2 2")},
+		{duckLisp_instruction_greaterFloat32, DL_STR("greater-float.32 4 4")},
 	};
 	dl_ptrdiff_t *template_array = dl_null;
 	e = DL_MALLOC(memoryAllocation, &template_array, maxElements, dl_ptrdiff_t);
@@ -209,7 +209,7 @@ dl_error_t duckLisp_symbol_create(duckLisp_t *duckLisp, const dl_uint8_t *name,
 		                   duckLisp->symbols_array.elements_length);
 		if (e) goto l_cleanup;
 		tempIdentifier.value_length = name_length;
-		e = dl_malloc(duckLisp->memoryAllocation, (void **) &tempIdentifier.value, name_length);
+		e = dl_malloc(duckLisp->persistentMemoryAllocation, (void **) &tempIdentifier.value, name_length);
 		if (e) goto l_cleanup;
 		/**/ dl_memcopy_noOverlap(tempIdentifier.value, name, name_length);
 		e = dl_array_pushElement(&duckLisp->symbols_array, (void *) &tempIdentifier);
@@ -230,6 +230,7 @@ dl_error_t duckLisp_symbol_create(duckLisp_t *duckLisp, const dl_uint8_t *name,
 static void scope_init(duckLisp_t *duckLisp, duckLisp_scope_t *scope, dl_bool_t is_function) {
 	/**/ dl_trie_init(&scope->locals_trie, duckLisp->memoryAllocation, -1);
 	/**/ dl_trie_init(&scope->functionLocals_trie, duckLisp->memoryAllocation, -1);
+	/**/ dl_trie_init(&scope->localTypes_trie, duckLisp->memoryAllocation, -1);
 	/**/ dl_trie_init(&scope->functions_trie, duckLisp->memoryAllocation, -1);
 	scope->functions_length = 0;
 	/**/ dl_trie_init(&scope->labels_trie, duckLisp->memoryAllocation, -1);
@@ -245,6 +246,7 @@ static dl_error_t scope_quit(duckLisp_t *duckLisp, duckLisp_scope_t *scope) {
 	(void) duckLisp;
 	/**/ dl_trie_quit(&scope->locals_trie);
 	/**/ dl_trie_quit(&scope->functionLocals_trie);
+	/**/ dl_trie_quit(&scope->localTypes_trie);
 	/**/ dl_trie_quit(&scope->functions_trie);
 	scope->functions_length = 0;
 	/**/ dl_trie_quit(&scope->labels_trie);
@@ -427,6 +429,45 @@ dl_error_t duckLisp_scope_getLocalIndexFromName(duckLisp_subCompileState_t *subC
 	return e;
 }
 
+/* Variables that aren't found, including free variables, are of unknown type. */
+duckLisp_valueType_t duckLisp_scope_getLocalType(duckLisp_subCompileState_t *subCompileState,
+                                                 const dl_uint8_t *name,
+                                                 const dl_size_t name_length) {
+	dl_ptrdiff_t scope_index = subCompileState->scope_stack.elements_length;
+
+	while (scope_index > 0) {
+		duckLisp_scope_t *scope = &DL_ARRAY_GETADDRESS(subCompileState->scope_stack, duckLisp_scope_t, --scope_index);
+		dl_ptrdiff_t local_index = -1;
+		(void) dl_trie_find(scope->locals_trie, &local_index, name, name_length);
+		if (local_index != -1) {
+			dl_ptrdiff_t type = -1;
+			(void) dl_trie_find(scope->localTypes_trie, &type, name, name_length);
+			return (type == -1) ? duckLisp_valueType_unknown : (duckLisp_valueType_t) type;
+		}
+		if (scope->function_scope) break;
+	}
+	return duckLisp_valueType_unknown;
+}
+
+/* Set the type of the nearest variable named `name`. Unlike `duckLisp_scope_getLocalType`, this looks through
+   enclosing functions too, so that a closure assigning to a captured variable can forget that variable's type. */
+dl_error_t duckLisp_scope_setLocalType(duckLisp_subCompileState_t *subCompileState,
+                                       const dl_uint8_t *name,
+                                       const dl_size_t name_length,
+                                       const duckLisp_valueType_t type) {
+	dl_ptrdiff_t scope_index = subCompileState->scope_stack.elements_length;
+
+	while (scope_index > 0) {
+		duckLisp_scope_t *scope = &DL_ARRAY_GETADDRESS(subCompileState->scope_stack, duckLisp_scope_t, --scope_index);
+		dl_ptrdiff_t local_index = -1;
+		(void) dl_trie_find(scope->locals_trie, &local_index, name, name_length);
+		if (local_index != -1) {
+			return dl_trie_insert(&scope->localTypes_trie, name, name_length, type);
+		}
+	}
+	return dl_error_ok;
+}
+
 dl_error_t duckLisp_scope_getFreeLocalIndexFromName_helper(duckLisp_t *duckLisp,
                                                            duckLisp_subCompileState_t *subCompileState,
                                                            dl_bool_t *found,
@@ -832,7 +873,13 @@ dl_error_t duckLisp_astToObject(duckLisp_t *duckLisp,
 	case duckLisp_ast_type_expression:
 		/* Fall through */
 	case duckLisp_ast_type_literalExpression: {
+		/* Any allocation can start a collection, so the list is kept on the stack while it's built back to front. The
+		   slot above it holds the element being added, and then the element's box until the cons that holds it is
+		   made. */
 		duckVM_object_t *tailPointer = dl_null;
+		dl_size_t stackLength = duckVM_stackLength(duckVM);
+		e = duckVM_pushNil(duckVM);
+		if (e) break;
 		DL_DOTIMES(j, ast.value.expression.compoundExpressions_length) {
 			duckVM_object_t head;
 			e = duckLisp_astToObject(duckLisp,
@@ -843,13 +890,22 @@ dl_error_t duckLisp_astToObject(duckLisp_t *duckLisp,
 			                           - 1
 			                           - j]));
 			if (e) break;
+			e = duckVM_object_push(duckVM, &head);
+			if (e) break;
 			duckVM_object_t *headPointer;
 			e = duckVM_allocateHeapObject(duckVM, &headPointer, head);
 			if (e) break;
+			DL_ARRAY_GETTOPADDRESS(duckVM->stack, duckVM_object_t) = duckVM_object_makeList(headPointer);
 			duckVM_object_t tail = duckVM_object_makeCons(headPointer, tailPointer);
 			e = duckVM_allocateHeapObject(duckVM, &tailPointer, tail);
 			if (e) break;
+			e = duckVM_pop(duckVM);
+			if (e) break;
+			DL_ARRAY_GETTOPADDRESS(duckVM->stack, duckVM_object_t).value.list = tailPointer;
 		}
+		eError = duckVM_popSeveral(duckVM, duckVM_stackLength(duckVM) - stackLength);
+		if (eError) e = eError;
+		if (e) break;
 		object->type = duckVM_object_type_list;
 		object->value.list = tailPointer;
 		break;
@@ -1477,7 +1533,9 @@ dl_error_t duckLisp_callback_read(duckVM_t *duckVM) {
 	dl_error_t eError = dl_error_ok;
 
 	duckLisp_t *duckLisp = duckVM->duckLisp;
-	dl_memoryAllocation_t *memoryAllocation = duckVM->memoryAllocation;
+	/* `duckLisp_read` allocates the AST from the compiler, which is using its arena if this is running at compile
+	   time. */
+	dl_memoryAllocation_t *memoryAllocation = duckLisp->memoryAllocation;
 
 	duckVM_object_type_t booleanObject_type;
 	dl_bool_t boolean;
@@ -1556,6 +1614,9 @@ dl_error_t duckLisp_callback_read(duckVM_t *duckVM) {
 				e = duckLisp_astToObject(duckLisp, duckVM, &astObject, ast);
 				if (e) goto cleanupAst;
 			}
+			/* Nothing else refers to the object yet, so it has to be on the stack before the cons is allocated. */
+			e = duckVM_object_push(duckVM, &astObject);
+			if (e) goto cleanupAst;
 
 		cleanupAst:
 			eError = duckLisp_ast_compoundExpression_quit(memoryAllocation, &ast);
@@ -1563,27 +1624,34 @@ dl_error_t duckLisp_callback_read(duckVM_t *duckVM) {
 			if (e) goto cleanupString;
 		}
 
+		/* stack: ast */
 		e = duckVM_pushCons(duckVM);
 		if (e) goto cleanupString;
-		/* stack: (()) */
+		/* stack: ast (()) */
 		e = duckVM_pushInteger(duckVM);
 		if (e) goto cleanupString;
-		/* stack: (()) 0 */
+		/* stack: ast (()) 0 */
 		e = duckVM_setInteger(duckVM, status);
 		if (e) goto cleanupString;
-		/* stack: (()) status */
+		/* stack: ast (()) status */
 		e = duckVM_setRest(duckVM, -2);
 		if (e) goto cleanupString;
-		/* stack: (() . status) status */
+		/* stack: ast (() . status) status */
 		e = duckVM_pop(duckVM);
 		if (e) goto cleanupString;
-		/* stack: (() . status) */
-		e = duckVM_object_push(duckVM, &astObject);
+		/* stack: ast (() . status) */
+		e = duckVM_push(duckVM, -2);
 		if (e) goto cleanupString;
-		/* stack: (() . status) ast */
+		/* stack: ast (() . status) ast */
 		e = duckVM_setFirst(duckVM, -2);
 		if (e) goto cleanupString;
-		/* stack: (ast . status) ast */
+		/* stack: ast (ast . status) ast */
+		e = duckVM_pop(duckVM);
+		if (e) goto cleanupString;
+		/* stack: ast (ast . status) */
+		e = duckVM_copyFromTop(duckVM, -2);
+		if (e) goto cleanupString;
+		/* stack: (ast . status) (ast . status) */
 		e = duckVM_pop(duckVM);
 		if (e) goto cleanupString;
 		/* stack: (ast . status) */
@@ -1920,6 +1988,9 @@ dl_error_t duckLisp_init(duckLisp_t *duckLisp,
 	};
 
 	duckLisp->memoryAllocation = memoryAllocation;
+	duckLisp->persistentMemoryAllocation = memoryAllocation;
+	error = dl_memory_initArena(&duckLisp->compileArena, memoryAllocation, DUCKLISP_COMPILE_ARENA_CHUNK_SIZE);
+	if (error) goto cleanup;
 
 #ifdef USE_PARENTHESIS_INFERENCE
 	duckLisp->maxInferenceVmObjects = maxInferenceVmObjects;
@@ -2046,7 +2117,7 @@ dl_error_t duckLisp_init(duckLisp_t *duckLisp,
 void duckLisp_quit(duckLisp_t *duckLisp) {
 	dl_error_t e;
 
-	dl_memoryAllocation_t *memoryAllocation = duckLisp->memoryAllocation;
+	dl_memoryAllocation_t *memoryAllocation = duckLisp->persistentMemoryAllocation;
 	/**/ duckVM_quit(&duckLisp->vm);
 	duckLisp->gensym_number = 0;
 	e = dl_array_quit(&duckLisp->generators_stack);
@@ -2087,6 +2158,8 @@ void duckLisp_quit(duckLisp_t *duckLisp) {
 	duckLisp->stripSymbolNames = dl_false;
 	e = dl_array_quit(&duckLisp->disassemblies);
 
+	/**/ dl_memory_quitArena(&duckLisp->compileArena);
+
 	(void) e;
 }
 
@@ -2151,6 +2224,11 @@ dl_error_t duckLisp_loadString(duckLisp_t *duckLisp,
 	duckLisp_ast_compoundExpression_t ast;
 	dl_array_t bytecodeArray;
 	dl_bool_t result = dl_false;
+	/* The AST, the compile state, and the assembly are all gone by the time this returns, so they come from the arena
+	   and get freed in one reset instead of one node at a time. A load started from inside another load shares its
+	   arena and leaves the reset to the outer one. */
+	dl_bool_t nested = (duckLisp->memoryAllocation == &duckLisp->compileArena);
+	duckLisp->memoryAllocation = &duckLisp->compileArena;
 
 	/**/ duckLisp_ast_compoundExpression_init(&ast);
 
@@ -2184,15 +2262,16 @@ dl_error_t duckLisp_loadString(duckLisp_t *duckLisp,
 	duckLisp_compileState_init(duckLisp, &compileState);
 	e = duckLisp_compileAST(duckLisp, &compileState, &bytecodeArray, ast, duckLisp->stripSymbolNames);
 	if (e) goto cleanup;
-	e = duckLisp_compileState_quit(duckLisp, &compileState);
-	if (e) goto cleanup;
 
 	/* Save disassembly. */
 	if (duckLisp->disassemble) {
 		dl_array_t string;
-		(void) dl_array_init(&string, duckLisp->memoryAllocation, sizeof(dl_uint8_t), dl_array_strategy_double);
+		(void) dl_array_init(&string,
+		                     duckLisp->persistentMemoryAllocation,
+		                     sizeof(dl_uint8_t),
+		                     dl_array_strategy_double);
 		e = duckLisp_disassemble(&string,
-		                         duckLisp->memoryAllocation,
+		                         duckLisp->persistentMemoryAllocation,
 		                         bytecodeArray.elements,
 		                         bytecodeArray.elements_length);
 		if (e) goto cleanup;
@@ -2200,7 +2279,15 @@ dl_error_t duckLisp_loadString(duckLisp_t *duckLisp,
 		if (e) goto cleanup;
 	}
 
-	*bytecode = ((unsigned char*) bytecodeArray.elements);
+	/* The bytecode is the only thing that survives, so move it out of the arena. */
+	if (bytecodeArray.elements_length > 0) {
+		e = DL_MALLOC(duckLisp->persistentMemoryAllocation, bytecode, bytecodeArray.elements_length, dl_uint8_t);
+		if (e) goto cleanup;
+		/**/ dl_memcopy_noOverlap(*bytecode, bytecodeArray.elements, bytecodeArray.elements_length);
+	}
+	else {
+		*bytecode = dl_null;
+	}
 	*bytecode_length = bytecodeArray.elements_length;
 
  cleanup:
@@ -2208,8 +2295,11 @@ dl_error_t duckLisp_loadString(duckLisp_t *duckLisp,
 		*bytecode_length = 0;
 	}
 
-	eError = duckLisp_ast_compoundExpression_quit(duckLisp->memoryAllocation, &ast);
-	if (eError) e = eError;
+	if (!nested) {
+		duckLisp->memoryAllocation = duckLisp->persistentMemoryAllocation;
+		eError = dl_memory_resetArena(&duckLisp->compileArena);
+		if (eError) e = eError;
+	}
 
 	return e;
 }
@@ -2228,6 +2318,9 @@ dl_error_t duckLisp_scope_addObject(duckLisp_t *duckLisp,
 
 	e = dl_trie_insert(&scope.locals_trie, name, name_length, duckLisp_localsLength_get(compileState));
 	if (e) goto cleanup;
+	/* Forget the type of any variable that used to have this name. */
+	e = dl_trie_insert(&scope.localTypes_trie, name, name_length, duckLisp_valueType_unknown);
+	if (e) goto cleanup;
 
 	e = scope_setTop(compileState->currentCompileState, &scope);
 	if (e) goto cleanup;
@@ -2366,17 +2459,17 @@ dl_error_t duckLisp_addGenerator(duckLisp_t *duckLisp,
 #ifdef USE_PARENTHESIS_INFERENCE
 	if (typeString_length > 0) {
 		duckLisp_parenthesisInferrer_declarationPrototype_t prototype;
-		e = DL_MALLOC(duckLisp->memoryAllocation, &prototype.name, name_length, dl_uint8_t);
+		e = DL_MALLOC(duckLisp->persistentMemoryAllocation, &prototype.name, name_length, dl_uint8_t);
 		if (e) goto cleanup;
 		(void) dl_memcopy_noOverlap(prototype.name, name, name_length);
 		prototype.name_length = name_length;
-		e = DL_MALLOC(duckLisp->memoryAllocation, &prototype.type, typeString_length, dl_uint8_t);
+		e = DL_MALLOC(duckLisp->persistentMemoryAllocation, &prototype.type, typeString_length, dl_uint8_t);
 		if (e) goto cleanup;
 		(void) dl_memcopy_noOverlap(prototype.type, typeString, typeString_length);
 		prototype.type_length = typeString_length;
 		/* Functions can't declare variables, except globals, which I'm ignoring for now. */
 		if (declarationScript_length > 0) {
-			e = DL_MALLOC(duckLisp->memoryAllocation, &prototype.script, declarationScript_length, dl_uint8_t);
+			e = DL_MALLOC(duckLisp->persistentMemoryAllocation, &prototype.script, declarationScript_length, dl_uint8_t);
 			if (e) goto cleanup;
 			(void) dl_memcopy_noOverlap(prototype.script, declarationScript, declarationScript_length);
 		}
@@ -2415,12 +2508,12 @@ dl_error_t duckLisp_linkCFunction(duckLisp_t *duckLisp,
 
 #ifdef USE_PARENTHESIS_INFERENCE
 	duckLisp_parenthesisInferrer_declarationPrototype_t prototype;
-	e = DL_MALLOC(duckLisp->memoryAllocation, &prototype.name, name_length, dl_uint8_t);
+	e = DL_MALLOC(duckLisp->persistentMemoryAllocation, &prototype.name, name_length, dl_uint8_t);
 	if (e) goto cleanup;
 	(void) dl_memcopy_noOverlap(prototype.name, name, name_length);
 	prototype.name_length = name_length;
 	if (typeString_length > 0) {
-		e = DL_MALLOC(duckLisp->memoryAllocation, &prototype.type, typeString_length, dl_uint8_t);
+		e = DL_MALLOC(duckLisp->persistentMemoryAllocation, &prototype.type, typeString_length, dl_uint8_t);
 		if (e) goto cleanup;
 		(void) dl_memcopy_noOverlap(prototype.type, typeString, typeString_length);
 	}
@@ -2667,6 +2760,14 @@ dl_error_t duckLisp_scope_prettyPrint(dl_array_t *string_array, duckLisp_scope_t
 	e = dl_array_pushElements(string_array, DL_STR(", "));
 	if (e) goto cleanup;
 
+	e = dl_array_pushElements(string_array, DL_STR("localTypes_trie = "));
+	if (e) goto cleanup;
+	e = dl_trie_prettyPrint(string_array, scope.localTypes_trie);
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR(", "));
+	if (e) goto cleanup;
+
 	e = dl_array_pushElements(string_array, DL_STR("functions_trie = "));
 	if (e) goto cleanup;
 	e = dl_trie_prettyPrint(string_array, scope.functions_trie);
@@ -3275,6 +3376,36 @@ dl_error_t duckLisp_instructionClass_prettyPrint(dl_array_t *string_array,
 		return dl_array_pushElements(string_array, DL_STR("duckLisp_instructionClass_halt"));
 	case duckLisp_instructionClass_nil:
 		return dl_array_pushElements(string_array, DL_STR("duckLisp_instructionClass_nil"));
+	case duckLisp_instructionClass_brLess:
+		return dl_array_pushElements(string_array, DL_STR("duckLisp_instructionClass_brLess"));
+	case duckLisp_instructionClass_brGreater:
+		return dl_array_pushElements(string_array, DL_STR("duckLisp_instructionClass_brGreater"));
+	case duckLisp_instructionClass_brEqual:
+		return dl_array_pushElements(string_array, DL_STR("duckLisp_instructionClass_brEqual"));
+	case duckLisp_instructionClass_brNullp:
+		return dl_array_pushElements(string_array, DL_STR("duckLisp_instructionClass_brNullp"));
+	case duckLisp_instructionClass_tailcall:
+		return dl_array_pushElements(string_array, DL_STR("duckLisp_instructionClass_tailcall"));
+	case duckLisp_instructionClass_addInt:
+		return dl_array_pushElements(string_array, DL_STR("duckLisp_instructionClass_addInt"));
+	case duckLisp_instructionClass_addFloat:
+		return dl_array_pushElements(string_array, DL_STR("duckLisp_instructionClass_addFloat"));
+	case duckLisp_instructionClass_subInt:
+		return dl_array_pushElements(string_array, DL_STR("duckLisp_instructionClass_subInt"));
+	case duckLisp_instructionClass_subFloat:
+		return dl_array_pushElements(string_array, DL_STR("duckLisp_instructionClass_subFloat"));
+	case duckLisp_instructionClass_mulInt:
+		return dl_array_pushElements(string_array, DL_STR("duckLisp_instructionClass_mulInt"));
+	case duckLisp_instructionClass_mulFloat:
+		return dl_array_pushElements(string_array, DL_STR("duckLisp_instructionClass_mulFloat"));
+	case duckLisp_instructionClass_lessInt:
+		return dl_array_pushElements(string_array, DL_STR("duckLisp_instructionClass_lessInt"));
+	case duckLisp_instructionClass_lessFloat:
+		return dl_array_pushElements(string_array, DL_STR("duckLisp_instructionClass_lessFloat"));
+	case duckLisp_instructionClass_greaterInt:
+		return dl_array_pushElements(string_array, DL_STR("duckLisp_instructionClass_greaterInt"));
+	case duckLisp_instructionClass_greaterFloat:
+		return dl_array_pushElements(string_array, DL_STR("duckLisp_instructionClass_greaterFloat"));
 	case duckLisp_instructionClass_pseudo_label:
 		return dl_array_pushElements(string_array, DL_STR("duckLisp_instructionClass_pseudo_label"));
 	case duckLisp_instructionClass_internalNop:
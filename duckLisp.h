@@ -104,10 +104,19 @@ typedef enum {
 	duckLisp_functionType_macro
 } duckLisp_functionType_t;
 
+/* What the compiler knows about the type of a value. This is only a guess. It's used to pick type-specialized
+   arithmetic instructions, which fall back to the generic instruction if the guess was wrong. */
+typedef enum {
+	duckLisp_valueType_unknown = 0,
+	duckLisp_valueType_integer,
+	duckLisp_valueType_float,
+} duckLisp_valueType_t;
+
 typedef struct {
 	/* All variable names in the current scope are stored here. */
 	dl_trie_t locals_trie;   /* Points to stack objects. */
 	dl_trie_t functionLocals_trie;   /* Points to stack objects. */
+	dl_trie_t localTypes_trie;   /* dl_trie_t:duckLisp_valueType_t */
 
 	/* This trie records all the function types in this scope. */
 	dl_trie_t functions_trie;  /* dl_trie_t:duckLisp_functionType_t */
@@ -152,9 +161,17 @@ typedef struct {
 } duckLisp_datalog_t;
 #endif /* USE_DATALOGGING */
 
+/* Size of the first chunk of the compile arena. The arena grows to fit the biggest compile it has seen. */
+#define DUCKLISP_COMPILE_ARENA_CHUNK_SIZE 16384
+
 /* This remains until the compiler is destroyed. */
 typedef struct {
+	/* While `duckLisp_loadString` is compiling, this points at `compileArena`. Anything that has to outlive the compile
+	   must come from `persistentMemoryAllocation` instead. */
 	dl_memoryAllocation_t *memoryAllocation;
+	dl_memoryAllocation_t *persistentMemoryAllocation;
+	/* Everything that only lives as long as a single compile is bump allocated from here and thrown away in one go. */
+	dl_memoryAllocation_t compileArena;
 
 	dl_array_t generators_stack; /* dl_array_t:dl_error_t(*)(duckLisp_t*, const duckLisp_ast_expression_t) */
 	dl_trie_t generators_trie;  /* Points to generator stack callbacks. */
@@ -268,6 +285,24 @@ typedef enum {
 	duckLisp_instructionClass_return,
 	duckLisp_instructionClass_halt,
 	duckLisp_instructionClass_nil,
+	/* Superinstructions. These are never emitted by the generators. The assembler fuses them from simpler
+	   instructions. */
+	duckLisp_instructionClass_brLess,
+	duckLisp_instructionClass_brGreater,
+	duckLisp_instructionClass_brEqual,
+	duckLisp_instructionClass_brNullp,
+	duckLisp_instructionClass_tailcall,
+	/* Type-specialized arithmetic. Emitted when the types of both operands are known. */
+	duckLisp_instructionClass_addInt,
+	duckLisp_instructionClass_addFloat,
+	duckLisp_instructionClass_subInt,
+	duckLisp_instructionClass_subFloat,
+	duckLisp_instructionClass_mulInt,
+	duckLisp_instructionClass_mulFloat,
+	duckLisp_instructionClass_lessInt,
+	duckLisp_instructionClass_lessFloat,
+	duckLisp_instructionClass_greaterInt,
+	duckLisp_instructionClass_greaterFloat,
 	duckLisp_instructionClass_pseudo_label,
 	duckLisp_instructionClass_internalNop,
 } duckLisp_instructionClass_t;
@@ -502,6 +537,71 @@ typedef enum {
 	duckLisp_instruction_halt,
 
 	duckLisp_instruction_nil,
+
+	/* Compare and branch. Operands are the branch offset, the pop count, and one-byte stack indices. */
+	duckLisp_instruction_brLess8,
+	duckLisp_instruction_brLess16,
+	duckLisp_instruction_brLess32,
+
+	duckLisp_instruction_brGreater8,
+	duckLisp_instruction_brGreater16,
+	duckLisp_instruction_brGreater32,
+
+	duckLisp_instruction_brEqual8,
+	duckLisp_instruction_brEqual16,
+	duckLisp_instruction_brEqual32,
+
+	duckLisp_instruction_brNullp8,
+	duckLisp_instruction_brNullp16,
+	duckLisp_instruction_brNullp32,
+
+	/* A `funcall` that is immediately followed by a return. Operands are the function index, the arity, and the number
+	   of objects the caller's frame would have popped from under the return value. */
+	duckLisp_instruction_tailcall8,
+	duckLisp_instruction_tailcall16,
+	duckLisp_instruction_tailcall32,
+
+	/* Type-specialized arithmetic. Operands are the same as the generic instructions. If the operands turn out not to
+	   be the expected type, the generic instruction is run instead. */
+	duckLisp_instruction_addInt8,
+	duckLisp_instruction_addInt16,
+	duckLisp_instruction_addInt32,
+
+	duckLisp_instruction_addFloat8,
+	duckLisp_instruction_addFloat16,
+	duckLisp_instruction_addFloat32,
+
+	duckLisp_instruction_subInt8,
+	duckLisp_instruction_subInt16,
+	duckLisp_instruction_subInt32,
+
+	duckLisp_instruction_subFloat8,
+	duckLisp_instruction_subFloat16,
+	duckLisp_instruction_subFloat32,
+
+	duckLisp_instruction_mulInt8,
+	duckLisp_instruction_mulInt16,
+	duckLisp_instruction_mulInt32,
+
+	duckLisp_instruction_mulFloat8,
+	duckLisp_instruction_mulFloat16,
+	duckLisp_instruction_mulFloat32,
+
+	duckLisp_instruction_lessInt8,
+	duckLisp_instruction_lessInt16,
+	duckLisp_instruction_lessInt32,
+
+	duckLisp_instruction_lessFloat8,
+	duckLisp_instruction_lessFloat16,
+	duckLisp_instruction_lessFloat32,
+
+	duckLisp_instruction_greaterInt8,
+	duckLisp_instruction_greaterInt16,
+	duckLisp_instruction_greaterInt32,
+
+	duckLisp_instruction_greaterFloat8,
+	duckLisp_instruction_greaterFloat16,
+	duckLisp_instruction_greaterFloat32,
 } duckLisp_instruction_t;
 
 typedef enum {
@@ -581,6 +681,14 @@ dl_error_t duckLisp_scope_getLocalIndexFromName(duckLisp_subCompileState_t *subC
                                                 const dl_uint8_t *name,
                                                 const dl_size_t name_length,
                                                 const dl_bool_t functionsOnly);
+/* The compiler's guess at the type of a local variable. */
+duckLisp_valueType_t duckLisp_scope_getLocalType(duckLisp_subCompileState_t *subCompileState,
+                                                 const dl_uint8_t *name,
+                                                 const dl_size_t name_length);
+dl_error_t duckLisp_scope_setLocalType(duckLisp_subCompileState_t *subCompileState,
+                                       const dl_uint8_t *name,
+                                       const dl_size_t name_length,
+                                       const duckLisp_valueType_t type);
 dl_error_t duckLisp_scope_getFreeLocalIndexFromName(duckLisp_t *duckLisp,
                                                     duckLisp_subCompileState_t *subCompileState,
                                                     dl_bool_t *found,
@@ -620,7 +728,8 @@ dl_error_t duckLisp_register_label(duckLisp_t *duckLisp,
                                    dl_uint8_t *name,
                                    const dl_size_t name_length);
 
-/* Convert an AST into a data structure made out of duckVM objects. */
+/* Convert an AST into a data structure made out of duckVM objects. Nothing on the stack refers to the result, so push
+   it before allocating anything else in the VM. */
 dl_error_t duckLisp_astToObject(duckLisp_t *duckLisp,
                                 duckVM_t *duckVM,
                                 duckVM_object_t *object,
@@ -28,6 +28,10 @@ SOFTWARE.
 #include "DuckLib/memory.h"
 #include "DuckLib/string.h"
 #include "duckLisp.h"
+#ifdef USE_PARALLEL_MARKING
+#include <pthread.h>
+#include <sched.h>
+#endif /* USE_PARALLEL_MARKING */
 
 
 duckVM_object_t duckVM_object_makeUpvalueArray(duckVM_object_t **upvalues, dl_size_t length);
@@ -45,40 +49,202 @@ dl_error_t duckVM_error_pushRuntime(duckVM_t *duckVM, const dl_uint8_t *message,
  cleanup: return e;
 }
 
-dl_error_t duckVM_gclist_init(duckVM_gclist_t *gclist,
-                              dl_memoryAllocation_t *memoryAllocation,
-                              duckVM_t *duckVM,
-                              const dl_size_t maxObjects) {
+/* Size of the first chunk, and the smallest chunk the heap grows by. */
+#define DUCKVM_GCLIST_CHUNK_LENGTH 256
+#define DUCKVM_GCLIST_TARGET_LIVE_PERCENT 50
+#define DUCKVM_GCLIST_FULL_COLLECTION_TRIGGER 50
+
+/* The mark and remembered flags are packed 64 to a word. */
+#define DUCKVM_GCLIST_BITMAP_LENGTH(length) (((length) + 63) / 64)
+#define DUCKVM_GCLIST_GETBIT(bitmap, index) (((bitmap)[(dl_size_t) (index) / 64] >> ((dl_size_t) (index) % 64)) & 1)
+#define DUCKVM_GCLIST_SETBIT(bitmap, index) \
+	((bitmap)[(dl_size_t) (index) / 64] |= (dl_uint64_t) 1 << ((dl_size_t) (index) % 64))
+#define DUCKVM_GCLIST_CLEARBIT(bitmap, index) \
+	((bitmap)[(dl_size_t) (index) / 64] &= ~((dl_uint64_t) 1 << ((dl_size_t) (index) % 64)))
+
+/* Payload slabs are this big, and the blocks in them are at least this big. */
+#define DUCKVM_GCLIST_SLAB_SIZE 4096
+#define DUCKVM_GCLIST_PAYLOAD_SMALLEST 16
+
+/* Every payload block starts with one of these. The size class tells `duckVM_gclist_freePayload` where the block came
+   from, since the object's length can change after it's allocated. Blocks from the general allocator hold their size
+   instead, which is always bigger than the number of size classes. */
+typedef union {
+	dl_size_t sizeClass;
+	void *next;  /* Next free block in the same size class. */
+	double alignment;
+} duckVM_gclist_payloadHeader_t;
+
+/* Add a chunk of `length` objects to the heap and put them all on the free list. */
+static dl_error_t duckVM_gclist_addChunk(duckVM_gclist_t *gclist, dl_size_t length) {
 	dl_error_t e = dl_error_ok;
+	dl_error_t eError = dl_error_ok;
 
-	gclist->memoryAllocation = memoryAllocation;
-	gclist->duckVM = duckVM;
-
+	duckVM_gclist_chunk_t chunk;
+	chunk.objects = dl_null;
+	chunk.marks = dl_null;
+	chunk.remembered = dl_null;
+	chunk.pinned = dl_null;
+	chunk.objects_length = length;
+	/* Nothing to sweep. */
+	chunk.swept = length;
 
-	e = dl_malloc(gclist->memoryAllocation,
-				  (void **) &gclist->objects,
-				  maxObjects * sizeof(duckVM_object_t));
+	e = DL_MALLOC(gclist->memoryAllocation, &chunk.objects, length, duckVM_object_t);
 	if (e) goto cleanup;
-	gclist->objects_length = maxObjects;
-
-	e = dl_malloc(gclist->memoryAllocation,
-				  (void **) &gclist->freeObjects,
-				  maxObjects * sizeof(duckVM_object_t *));
+	e = DL_MALLOC(gclist->memoryAllocation, &chunk.marks, DUCKVM_GCLIST_BITMAP_LENGTH(length), dl_uint64_t);
+	if (e) goto cleanup;
+	e = DL_MALLOC(gclist->memoryAllocation, &chunk.remembered, DUCKVM_GCLIST_BITMAP_LENGTH(length), dl_uint64_t);
 	if (e) goto cleanup;
-	gclist->freeObjects_length = maxObjects;
+	e = DL_MALLOC(gclist->memoryAllocation, &chunk.pinned, DUCKVM_GCLIST_BITMAP_LENGTH(length), dl_uint64_t);
+	if (e) goto cleanup;
+	/* Zero is `duckVM_object_type_none`, which is how free objects are told apart from garbage. */
+	/**/ dl_memclear(chunk.objects, length * sizeof(duckVM_object_t));
+	/**/ dl_memclear(chunk.marks, DUCKVM_GCLIST_BITMAP_LENGTH(length) * sizeof(dl_uint64_t));
+	/**/ dl_memclear(chunk.remembered, DUCKVM_GCLIST_BITMAP_LENGTH(length) * sizeof(dl_uint64_t));
+	/**/ dl_memclear(chunk.pinned, DUCKVM_GCLIST_BITMAP_LENGTH(length) * sizeof(dl_uint64_t));
+
+	/* The free list has to be able to hold every object at once. The arrays are reallocated through temporaries so
+	   that they stay intact if an allocation fails. */
+	{
+		duckVM_object_t **freeObjects = gclist->freeObjects;
+		e = DL_REALLOC(gclist->memoryAllocation, &freeObjects, gclist->objects_length + length, duckVM_object_t *);
+		if (e) goto cleanup;
+		gclist->freeObjects = freeObjects;
+	}
+	{
+		duckVM_object_t **youngObjects = gclist->youngObjects;
+		e = DL_REALLOC(gclist->memoryAllocation, &youngObjects, gclist->objects_length + length, duckVM_object_t *);
+		if (e) goto cleanup;
+		gclist->youngObjects = youngObjects;
+	}
+	{
+		duckVM_gclist_chunk_t *chunks = gclist->chunks;
+		e = DL_REALLOC(gclist->memoryAllocation, &chunks, gclist->chunks_length + 1, duckVM_gclist_chunk_t);
+		if (e) goto cleanup;
+		gclist->chunks = chunks;
+	}
 
+	{
+		dl_size_t index = gclist->chunks_length;
+		while ((index > 0) && (chunk.objects < gclist->chunks[index - 1].objects)) {
+			gclist->chunks[index] = gclist->chunks[index - 1];
+			--index;
+		}
+		gclist->chunks[index] = chunk;
+		gclist->chunks_length++;
+	}
+	gclist->objects_length += length;
+	DL_DOTIMES(i, length) {
+		gclist->freeObjects[gclist->freeObjects_length++] = &chunk.objects[length - 1 - i];
+	}
 
-	e = dl_malloc(gclist->memoryAllocation,
-				  (void **) &gclist->objectInUse,
-				  maxObjects * sizeof(dl_bool_t));
-	if (e) goto cleanup;
+ cleanup:
+	if (e) {
+		if (chunk.pinned != dl_null) {
+			eError = DL_FREE(gclist->memoryAllocation, &chunk.pinned);
+			if (eError) e = eError;
+		}
+		if (chunk.remembered != dl_null) {
+			eError = DL_FREE(gclist->memoryAllocation, &chunk.remembered);
+			if (eError) e = eError;
+		}
+		if (chunk.marks != dl_null) {
+			eError = DL_FREE(gclist->memoryAllocation, &chunk.marks);
+			if (eError) e = eError;
+		}
+		if (chunk.objects != dl_null) {
+			eError = DL_FREE(gclist->memoryAllocation, &chunk.objects);
+			if (eError) e = eError;
+		}
+	}
+	return e;
+}
+
+/* Find the chunk that holds the object. Returns null if the object isn't on the heap. */
+static duckVM_gclist_chunk_t *duckVM_gclist_findChunk(duckVM_gclist_t *gclist, duckVM_object_t *object) {
+	dl_size_t low = 0;
+	dl_size_t high = gclist->chunks_length;
+	while (low < high) {
+		dl_size_t middle = low + (high - low) / 2;
+		duckVM_gclist_chunk_t *chunk = &gclist->chunks[middle];
+		if (object < chunk->objects) {
+			high = middle;
+		}
+		else if (object >= chunk->objects + chunk->objects_length) {
+			low = middle + 1;
+		}
+		else {
+			return chunk;
+		}
+	}
+	return dl_null;
+}
 
+dl_error_t duckVM_gclist_init(duckVM_gclist_t *gclist,
+                              dl_memoryAllocation_t *memoryAllocation,
+                              duckVM_t *duckVM,
+                              const dl_size_t maxObjects) {
+	dl_error_t e = dl_error_ok;
 
-	/**/ dl_memclear(gclist->objects, gclist->objects_length * sizeof(duckVM_object_t));
+	gclist->memoryAllocation = memoryAllocation;
+	gclist->duckVM = duckVM;
+	gclist->chunks = dl_null;
+	gclist->chunks_length = 0;
+	gclist->freeObjects = dl_null;
+	gclist->objects_length = 0;
+	gclist->freeObjects_length = 0;
+	gclist->maxObjects = maxObjects;
+	gclist->targetLivePercent = DUCKVM_GCLIST_TARGET_LIVE_PERCENT;
+	gclist->minimumGrowth = DUCKVM_GCLIST_CHUNK_LENGTH;
+	gclist->fullCollectionTrigger = DUCKVM_GCLIST_FULL_COLLECTION_TRIGGER;
+	gclist->youngObjects = dl_null;
+	gclist->youngObjects_length = 0;
+	gclist->sweepChunk = 0;
+	gclist->markedObjects = 0;
+	/**/ dl_array_init(&gclist->rememberedSet,
+	                   gclist->memoryAllocation,
+	                   sizeof(duckVM_object_t *),
+	                   dl_array_strategy_double);
+	/**/ dl_array_init(&gclist->grayStack,
+	                   gclist->memoryAllocation,
+	                   sizeof(duckVM_object_t *),
+	                   dl_array_strategy_double);
+	/**/ dl_array_init(&gclist->pinnedObjects,
+	                   gclist->memoryAllocation,
+	                   sizeof(duckVM_object_t *),
+	                   dl_array_strategy_double);
+	gclist->marking = dl_false;
+	gclist->sliceBudget = 0;
+	gclist->markThreads = 1;
+	gclist->pauseWork = 0;
+	gclist->worstPause = 0;
+	gclist->pauses = 0;
+	gclist->totalPause = 0;
+	gclist->minorCollections = 0;
+	gclist->fullCollections = 0;
+	gclist->compactions = 0;
+	gclist->objectsAllocated = 0;
+	gclist->objectsFreed = 0;
+	gclist->payloadBytes = 0;
+	gclist->decodedBytes = 0;
+
+	DL_DOTIMES(i, DUCKVM_GCLIST_PAYLOAD_CLASSES) {
+		gclist->payloadFreeLists[i] = dl_null;
+	}
+	/**/ dl_array_init(&gclist->payloadSlabs,
+	                   gclist->memoryAllocation,
+	                   sizeof(dl_uint8_t *),
+	                   dl_array_strategy_double);
 
+	/* The gray stack keeps its memory between collections, so give it a decent size up front. */
+	e = dl_array_pushElements(&gclist->grayStack, dl_null, DUCKVM_GCLIST_CHUNK_LENGTH);
+	if (e) goto cleanup;
+	gclist->grayStack.elements_length = 0;
 
-	for (dl_ptrdiff_t i = 0; (dl_size_t) i < maxObjects; i++) {
-		gclist->freeObjects[i] = &gclist->objects[i];
+	/* Start small. The rest is allocated when it's needed. */
+	if (maxObjects > 0) {
+		e = duckVM_gclist_addChunk(gclist, dl_min(maxObjects, DUCKVM_GCLIST_CHUNK_LENGTH));
+		if (e) goto cleanup;
 	}
 
  cleanup:
@@ -90,2550 +256,5015 @@ static dl_error_t duckVM_gclist_quit(duckVM_gclist_t *gclist) {
 	dl_error_t e = dl_error_ok;
 	dl_error_t eError = dl_error_ok;
 
-	e = dl_free(gclist->memoryAllocation, (void **) &gclist->freeObjects);
+	if (gclist->freeObjects != dl_null) {
+		e = DL_FREE(gclist->memoryAllocation, &gclist->freeObjects);
+	}
 	gclist->freeObjects_length = 0;
 
-
-	eError = dl_free(gclist->memoryAllocation, (void **) &gclist->objects);
+	DL_DOTIMES(i, gclist->chunks_length) {
+		eError = DL_FREE(gclist->memoryAllocation, &gclist->chunks[i].objects);
+		e = eError ? eError : e;
+		eError = DL_FREE(gclist->memoryAllocation, &gclist->chunks[i].marks);
+		e = eError ? eError : e;
+		eError = DL_FREE(gclist->memoryAllocation, &gclist->chunks[i].remembered);
+		e = eError ? eError : e;
+		eError = DL_FREE(gclist->memoryAllocation, &gclist->chunks[i].pinned);
+		e = eError ? eError : e;
+	}
+	if (gclist->youngObjects != dl_null) {
+		eError = DL_FREE(gclist->memoryAllocation, &gclist->youngObjects);
+		e = eError ? eError : e;
+	}
+	gclist->youngObjects_length = 0;
+	eError = dl_array_quit(&gclist->rememberedSet);
+	e = eError ? eError : e;
+	eError = dl_array_quit(&gclist->grayStack);
+	e = eError ? eError : e;
+	eError = dl_array_quit(&gclist->pinnedObjects);
+	e = eError ? eError : e;
+	DL_DOTIMES(i, gclist->payloadSlabs.elements_length) {
+		eError = DL_FREE(gclist->memoryAllocation, &DL_ARRAY_GETADDRESS(gclist->payloadSlabs, dl_uint8_t *, i));
+		e = eError ? eError : e;
+	}
+	eError = dl_array_quit(&gclist->payloadSlabs);
 	e = eError ? eError : e;
+	DL_DOTIMES(i, DUCKVM_GCLIST_PAYLOAD_CLASSES) {
+		gclist->payloadFreeLists[i] = dl_null;
+	}
+	gclist->marking = dl_false;
+	if (gclist->chunks != dl_null) {
+		eError = DL_FREE(gclist->memoryAllocation, &gclist->chunks);
+		e = eError ? eError : e;
+	}
+	gclist->chunks_length = 0;
 	gclist->objects_length = 0;
+	gclist->sweepChunk = 0;
+	gclist->markedObjects = 0;
 
+	return e;
+}
 
-	eError = dl_free(gclist->memoryAllocation, (void **) &gclist->objectInUse);
-	e = eError ? eError : e;
+/* Carve a new slab into blocks and put them on the size class's free list. */
+static dl_error_t duckVM_gclist_addSlab(duckVM_gclist_t *gclist, dl_size_t sizeClass) {
+	dl_error_t e = dl_error_ok;
+	dl_error_t eError = dl_error_ok;
+	dl_uint8_t *slab = dl_null;
+	dl_size_t blockSize = (dl_size_t) DUCKVM_GCLIST_PAYLOAD_SMALLEST << sizeClass;
 
+	e = DL_MALLOC(gclist->memoryAllocation, &slab, DUCKVM_GCLIST_SLAB_SIZE, dl_uint8_t);
+	if (e) goto cleanup;
+	e = dl_array_pushElement(&gclist->payloadSlabs, &slab);
+	if (e) {
+		eError = DL_FREE(gclist->memoryAllocation, &slab);
+		if (eError) e = eError;
+		goto cleanup;
+	}
+	/* Back to front so that the blocks are handed out in address order. */
+	for (dl_size_t offset = DUCKVM_GCLIST_SLAB_SIZE; offset >= blockSize; offset -= blockSize) {
+		duckVM_gclist_payloadHeader_t *header = (duckVM_gclist_payloadHeader_t *) &slab[offset - blockSize];
+		header->next = gclist->payloadFreeLists[sizeClass];
+		gclist->payloadFreeLists[sizeClass] = header;
+	}
+
+ cleanup:
 	return e;
 }
 
-static dl_error_t duckVM_gclist_markObject(duckVM_gclist_t *gclist, duckVM_object_t *object, dl_bool_t stack) {
-	dl_error_t e = dl_error_ok;
+static dl_size_t duckVM_gclist_payloadSize(void *payload) {
+	duckVM_gclist_payloadHeader_t *header;
+	if (payload == dl_null) return 0;
+	header = (duckVM_gclist_payloadHeader_t *) payload - 1;
+	if (header->sizeClass >= DUCKVM_GCLIST_PAYLOAD_CLASSES) return header->sizeClass;
+	return (dl_size_t) DUCKVM_GCLIST_PAYLOAD_SMALLEST << header->sizeClass;
+}
 
-	/* Array of pointers that need to be traced. */
-	dl_array_t dispatchStack;
-	(void) dl_array_init(&dispatchStack, gclist->memoryAllocation, sizeof(duckVM_object_t *), dl_array_strategy_double);
+/* Allocate an object's payload. Payloads that fit in a size class come from a slab, and the rest come from the general
+   allocator. Either way, free it with `duckVM_gclist_freePayload`. */
+static dl_error_t duckVM_gclist_allocPayload(duckVM_gclist_t *gclist, void **payload, dl_size_t size) {
+	dl_error_t e = dl_error_ok;
+	dl_size_t blockSize = size + sizeof(duckVM_gclist_payloadHeader_t);
+	dl_size_t sizeClass = 0;
+	duckVM_gclist_payloadHeader_t *header = dl_null;
 
-	while (dl_true) {
-		// Bug: It is possible for object - gclist->objects to be negative during an OOM condition.
-		if (object && (stack
-		               || !gclist->objectInUse[(dl_ptrdiff_t) (object - gclist->objects)])) {
-			if (!stack) {
-				gclist->objectInUse[(dl_ptrdiff_t) (object - gclist->objects)] = dl_true;
-			}
-			if (object->type == duckVM_object_type_list) {
-				e = dl_array_pushElement(&dispatchStack, &object->value.list);
-				if (e) goto cleanup;
-			}
-			else if (object->type == duckVM_object_type_cons) {
-				e = dl_array_pushElement(&dispatchStack, &object->value.cons.car);
-				if (e) goto cleanup;
-				e = dl_array_pushElement(&dispatchStack, &object->value.cons.cdr);
-				if (e) goto cleanup;
-			}
-			else if (object->type == duckVM_object_type_closure) {
-				e = dl_array_pushElement(&dispatchStack, &object->value.closure.upvalue_array);
-				if (e) goto cleanup;
-				e = dl_array_pushElement(&dispatchStack, &object->value.closure.bytecode);
-				if (e) goto cleanup;
-			}
-			else if (object->type == duckVM_object_type_upvalue) {
-				if (object->value.upvalue.type == duckVM_upvalue_type_heap_object) {
-					e = dl_array_pushElement(&dispatchStack, &object->value.upvalue.value.heap_object);
-					if (e) goto cleanup;
-				}
-				else if (object->value.upvalue.type == duckVM_upvalue_type_heap_upvalue) {
-					e = dl_array_pushElement(&dispatchStack, &object->value.upvalue.value.heap_upvalue);
-					if (e) goto cleanup;
-				}
-			}
-			else if (object->type == duckVM_object_type_upvalueArray) {
-				DL_DOTIMES(k, object->value.upvalue_array.length) {
-					e = dl_array_pushElement(&dispatchStack, &object->value.upvalue_array.upvalues[k]);
-					if (e) goto cleanup;
-				}
-			}
-			else if (object->type == duckVM_object_type_vector) {
-				e = dl_array_pushElement(&dispatchStack, &object->value.vector.internal_vector);
-				if (e) goto cleanup;
-			}
-			else if (object->type == duckVM_object_type_internalVector) {
-				if (object->value.internal_vector.initialized) {
-					DL_DOTIMES(k, object->value.internal_vector.length) {
-						e = dl_array_pushElement(&dispatchStack, &object->value.internal_vector.values[k]);
-						if (e) goto cleanup;
-					}
-				}
-			}
-			else if (object->type == duckVM_object_type_string) {
-				if (object->value.string.internalString) {
-					e = dl_array_pushElement(&dispatchStack, &object->value.string.internalString);
-					if (e) goto cleanup;
-				}
-			}
-			else if (object->type == duckVM_object_type_symbol) {
-				if (object->value.symbol.internalString) {
-					e = dl_array_pushElement(&dispatchStack, &object->value.symbol.internalString);
-					if (e) goto cleanup;
-				}
-			}
-			else if (object->type == duckVM_object_type_composite) {
-				e = dl_array_pushElement(&dispatchStack, &object->value.composite);
-				if (e) goto cleanup;
-			}
-			else if (object->type == duckVM_object_type_internalComposite) {
-				e = dl_array_pushElement(&dispatchStack, &object->value.internalComposite.value);
-				if (e) goto cleanup;
-				e = dl_array_pushElement(&dispatchStack, &object->value.internalComposite.function);
-				if (e) goto cleanup;
-			}
-			else if (object->type == duckVM_object_type_user) {
-				if (object->value.user.marker) {
-					/* User-provided marking function */
-					e = object->value.user.marker(gclist, &dispatchStack, object);
-					if (e) goto cleanup;
-				}
-			}
-			/* else ignore, since the stack is the root of GC. Would cause a cycle (infinite loop) if we handled it. */
+	while ((sizeClass < DUCKVM_GCLIST_PAYLOAD_CLASSES)
+	       && (blockSize > ((dl_size_t) DUCKVM_GCLIST_PAYLOAD_SMALLEST << sizeClass))) {
+		sizeClass++;
+	}
+	if (sizeClass == DUCKVM_GCLIST_PAYLOAD_CLASSES) {
+		e = DL_MALLOC(gclist->memoryAllocation, &header, blockSize, dl_uint8_t);
+		if (e) goto cleanup;
+		header->sizeClass = blockSize;
+	}
+	else {
+		if (gclist->payloadFreeLists[sizeClass] == dl_null) {
+			e = duckVM_gclist_addSlab(gclist, sizeClass);
+			if (e) goto cleanup;
 		}
+		header = gclist->payloadFreeLists[sizeClass];
+		gclist->payloadFreeLists[sizeClass] = header->next;
+		header->sizeClass = sizeClass;
+		blockSize = (dl_size_t) DUCKVM_GCLIST_PAYLOAD_SMALLEST << sizeClass;
+	}
+	gclist->payloadBytes += blockSize;
+	*payload = header + 1;
 
-		e = dl_array_popElement(&dispatchStack, &object);
-		if (e == dl_error_bufferUnderflow) {
-			e = dl_error_ok;
-			break;
+ cleanup:
+	return e;
+}
+
+/* Free a payload and set the pointer to null. */
+static dl_error_t duckVM_gclist_freePayload(duckVM_gclist_t *gclist, void **payload) {
+	duckVM_gclist_payloadHeader_t *header = (duckVM_gclist_payloadHeader_t *) *payload - 1;
+	dl_size_t sizeClass = header->sizeClass;
+	*payload = dl_null;
+	if (sizeClass >= DUCKVM_GCLIST_PAYLOAD_CLASSES) {
+		gclist->payloadBytes -= sizeClass;
+		return DL_FREE(gclist->memoryAllocation, &header);
+	}
+	gclist->payloadBytes -= (dl_size_t) DUCKVM_GCLIST_PAYLOAD_SMALLEST << sizeClass;
+	header->next = gclist->payloadFreeLists[sizeClass];
+	gclist->payloadFreeLists[sizeClass] = header;
+	return dl_error_ok;
+}
+
+/* Resize a payload, keeping as much of the old contents as fits. A null payload is allocated, and a size of zero frees
+   the payload. */
+static dl_error_t duckVM_gclist_reallocPayload(duckVM_gclist_t *gclist,
+                                               void **payload,
+                                               dl_size_t oldSize,
+                                               dl_size_t size) {
+	dl_error_t e = dl_error_ok;
+	void *newPayload = dl_null;
+
+	if (size > 0) {
+		e = duckVM_gclist_allocPayload(gclist, &newPayload, size);
+		if (e) goto cleanup;
+		if (*payload != dl_null) {
+			(void) dl_memcopy_noOverlap(newPayload, *payload, dl_min(oldSize, size));
 		}
+	}
+	if (*payload != dl_null) {
+		e = duckVM_gclist_freePayload(gclist, payload);
 		if (e) goto cleanup;
-
-		stack = dl_false;
 	}
+	*payload = newPayload;
 
  cleanup:
-	e = dl_array_quit(&dispatchStack);
 	return e;
 }
 
-static dl_error_t duckVM_gclist_garbageCollect(duckVM_t *duckVM) {
-	dl_error_t e = dl_error_ok;
+/* Record the work done in the pause that just ended. */
+static void duckVM_gclist_endPause(duckVM_gclist_t *gclist) {
+	gclist->worstPause = dl_max(gclist->worstPause, gclist->pauseWork);
+	gclist->totalPause += gclist->pauseWork;
+	gclist->pauses++;
+}
 
-	/* Clear the in use flags. */
-	duckVM_gclist_t *gclistPointer = &duckVM->gclist;
-	duckVM_gclist_t gclistCopy = duckVM->gclist;
+/* Grow the heap after a collection if too much of it is still in use. */
+static dl_error_t duckVM_gclist_grow(duckVM_gclist_t *gclist, dl_size_t live) {
+	dl_size_t target = (live * 100) / gclist->targetLivePercent + 1;
+	dl_size_t length;
+	if (target <= gclist->objects_length) return dl_error_ok;
+	if (gclist->objects_length >= gclist->maxObjects) return dl_error_ok;
+	length = dl_max(target - gclist->objects_length, gclist->minimumGrowth);
+	length = dl_min(length, gclist->maxObjects - gclist->objects_length);
+	return duckVM_gclist_addChunk(gclist, length);
+}
+
+/* Mark the object and queue it so that its contents get traced. Returns false if there is nothing to trace because the
+   object was already marked. Objects that aren't on the heap, like the shim bytecode in `duckVM_call`, can't be marked,
+   so they are traced every time they're reached. */
+static dl_bool_t duckVM_gclist_whiteToGray(duckVM_gclist_t *gclist, duckVM_object_t *object) {
+	duckVM_gclist_chunk_t *chunk = duckVM_gclist_findChunk(gclist, object);
+	if (chunk != dl_null) {
+		dl_ptrdiff_t index = object - chunk->objects;
+		if (DUCKVM_GCLIST_GETBIT(chunk->marks, index)) return dl_false;
+		DUCKVM_GCLIST_SETBIT(chunk->marks, index);
+		gclist->markedObjects++;
+	}
+	return dl_true;
+}
 
-	for (dl_ptrdiff_t i = 0; (dl_size_t) i < gclistCopy.objects_length; i++) {
-		gclistCopy.objectInUse[i] = dl_false;
+/* Queue a marked object. Every object that gets marked goes through here, so skip `dl_array_pushElement` when there is
+   room. */
+static dl_error_t duckVM_gclist_pushGray(duckVM_gclist_t *gclist, duckVM_object_t *object) {
+	dl_array_t *grayStack = &gclist->grayStack;
+	if ((grayStack->elements_length + 1) * sizeof(duckVM_object_t *) > grayStack->elements_memorySize) {
+		return dl_array_pushElement(grayStack, &object);
 	}
+	DL_ARRAY_GETADDRESS(*grayStack, duckVM_object_t *, grayStack->elements_length++) = object;
+	return dl_error_ok;
+}
 
-	/* Mark the cells in use. */
+static dl_error_t duckVM_gclist_shade(duckVM_gclist_t *gclist, duckVM_object_t *object) {
+	if ((object == dl_null) || !duckVM_gclist_whiteToGray(gclist, object)) return dl_error_ok;
+	return duckVM_gclist_pushGray(gclist, object);
+}
 
-	/* Stack */
-	DL_DOTIMES(i, duckVM->stack.elements_length) {
-		e = duckVM_gclist_markObject(gclistPointer,
-		                             &DL_ARRAY_GETADDRESS(duckVM->stack, duckVM_object_t, i),
-		                             dl_true);
+/* Shade everything the object points to. */
+static dl_error_t duckVM_gclist_scanObject(duckVM_gclist_t *gclist, duckVM_object_t *object) {
+	dl_error_t e = dl_error_ok;
+
+	if (object->type == duckVM_object_type_list) {
+		e = duckVM_gclist_shade(gclist, object->value.list);
 		if (e) goto cleanup;
 	}
-
-	/* Upvalue stack */
-	DL_DOTIMES(i, duckVM->upvalue_stack.elements_length) {
-		duckVM_object_t *object = DL_ARRAY_GETADDRESS(duckVM->upvalue_stack, duckVM_object_t *, i);
-		if (object != dl_null) {
-			e = duckVM_gclist_markObject(gclistPointer, object, dl_false);
+	else if (object->type == duckVM_object_type_cons) {
+		e = duckVM_gclist_shade(gclist, object->value.cons.car);
+		if (e) goto cleanup;
+		e = duckVM_gclist_shade(gclist, object->value.cons.cdr);
+		if (e) goto cleanup;
+	}
+	else if (object->type == duckVM_object_type_closure) {
+		e = duckVM_gclist_shade(gclist, object->value.closure.upvalue_array);
+		if (e) goto cleanup;
+		e = duckVM_gclist_shade(gclist, object->value.closure.bytecode);
+		if (e) goto cleanup;
+	}
+	else if (object->type == duckVM_object_type_upvalue) {
+		if (object->value.upvalue.type == duckVM_upvalue_type_heap_object) {
+			e = duckVM_gclist_shade(gclist, object->value.upvalue.value.heap_object);
 			if (e) goto cleanup;
 		}
-	}
-
-	/* Globals */
-	DL_DOTIMES(i, duckVM->globals.elements_length) {
-		duckVM_object_t *object = DL_ARRAY_GETADDRESS(duckVM->globals, duckVM_object_t *, i);
-		if (object != dl_null) {
-			e = duckVM_gclist_markObject(gclistPointer, object, dl_false);
+		else if (object->value.upvalue.type == duckVM_upvalue_type_heap_upvalue) {
+			e = duckVM_gclist_shade(gclist, object->value.upvalue.value.heap_upvalue);
 			if (e) goto cleanup;
 		}
 	}
-
-	/* Call stack */
-	DL_DOTIMES(i, duckVM->call_stack.elements_length) {
-		duckVM_object_t *object = (DL_ARRAY_GETADDRESS(duckVM->call_stack, duckVM_callFrame_t, i)
-		                             .bytecode);
-		if (object != dl_null) {
-			e = duckVM_gclist_markObject(gclistPointer, object, dl_false);
+	else if (object->type == duckVM_object_type_upvalueArray) {
+		DL_DOTIMES(k, object->value.upvalue_array.length) {
+			e = duckVM_gclist_shade(gclist, object->value.upvalue_array.upvalues[k]);
 			if (e) goto cleanup;
 		}
 	}
-
-	/* Current bytecode */
-	if (duckVM->currentBytecode != dl_null) {
-		e = duckVM_gclist_markObject(gclistPointer, duckVM->currentBytecode, dl_false);
-			if (e) goto cleanup;
+	else if (object->type == duckVM_object_type_vector) {
+		e = duckVM_gclist_shade(gclist, object->value.vector.internal_vector);
+		if (e) goto cleanup;
 	}
-
-	/* Free cells if not marked. */
-	gclistPointer->freeObjects_length = 0;  /* This feels horribly inefficient. (That's 'cause it is.) */
-	for (dl_ptrdiff_t i = 0; (dl_size_t) i < gclistCopy.objects_length; i++) {
-		if (!gclistCopy.objectInUse[i]) {
-			duckVM_object_t *objectPointer = &gclistCopy.objects[i];
-			gclistCopy.freeObjects[gclistPointer->freeObjects_length++] = objectPointer;
-			duckVM_object_t object = *objectPointer;
-			duckVM_object_type_t type = object.type;
-			if ((type == duckVM_object_type_upvalueArray)
-			    /* Prevent multiple frees. */
-			    && (object.value.upvalue_array.upvalues != dl_null)) {
-				e = DL_FREE(duckVM->memoryAllocation, &objectPointer->value.upvalue_array.upvalues);
-				if (e) goto cleanup;
-			}
-			else if ((type == duckVM_object_type_internalVector)
-			         && object.value.internal_vector.initialized
-			         /* Prevent multiple frees. */
-			         && (object.value.internal_vector.values != dl_null)) {
-				e = DL_FREE(duckVM->memoryAllocation, &objectPointer->value.internal_vector.values);
-				if (e) goto cleanup;
-			}
-			else if ((type == duckVM_object_type_bytecode)
-			         /* Prevent multiple frees. */
-			         && (object.value.bytecode.bytecode != dl_null)) {
-				e = DL_FREE(duckVM->memoryAllocation, &objectPointer->value.bytecode.bytecode);
-				if (e) goto cleanup;
-			}
-			else if ((type == duckVM_object_type_internalString)
-			         /* Prevent multiple frees. */
-			         && (object.value.internalString.value != dl_null)) {
-				e = DL_FREE(duckVM->memoryAllocation, &objectPointer->value.internalString.value);
+	else if (object->type == duckVM_object_type_internalVector) {
+		if (object->value.internal_vector.initialized) {
+			DL_DOTIMES(k, object->value.internal_vector.length) {
+				e = duckVM_gclist_shade(gclist, object->value.internal_vector.values[k]);
 				if (e) goto cleanup;
 			}
-			else if ((type == duckVM_object_type_user)
-			         && (object.value.user.destructor != dl_null)) {
-				e = object.value.user.destructor(gclistPointer, objectPointer);
-				if (e) goto cleanup;
-				objectPointer->value.user.destructor = dl_null;
+		}
+	}
+	else if (object->type == duckVM_object_type_string) {
+		e = duckVM_gclist_shade(gclist, object->value.string.internalString);
+		if (e) goto cleanup;
+	}
+	else if (object->type == duckVM_object_type_symbol) {
+		e = duckVM_gclist_shade(gclist, object->value.symbol.internalString);
+		if (e) goto cleanup;
+	}
+	else if (object->type == duckVM_object_type_composite) {
+		e = duckVM_gclist_shade(gclist, object->value.composite);
+		if (e) goto cleanup;
+	}
+	else if (object->type == duckVM_object_type_internalComposite) {
+		e = duckVM_gclist_shade(gclist, object->value.internalComposite.value);
+		if (e) goto cleanup;
+		e = duckVM_gclist_shade(gclist, object->value.internalComposite.function);
+		if (e) goto cleanup;
+	}
+	else if (object->type == duckVM_object_type_user) {
+		if (object->value.user.marker) {
+			/* User-provided marking function. It pushes the children without marking them, so mark them here and
+			   drop the ones that were already marked. */
+			dl_size_t first = gclist->grayStack.elements_length;
+			dl_size_t kept = first;
+			e = object->value.user.marker(gclist, &gclist->grayStack, object);
+			if (e) goto cleanup;
+			for (dl_size_t i = first; i < gclist->grayStack.elements_length; i++) {
+				duckVM_object_t *child = DL_ARRAY_GETADDRESS(gclist->grayStack, duckVM_object_t *, i);
+				if ((child != dl_null) && duckVM_gclist_whiteToGray(gclist, child)) {
+					DL_ARRAY_GETADDRESS(gclist->grayStack, duckVM_object_t *, kept++) = child;
+				}
 			}
+			gclist->grayStack.elements_length = kept;
 		}
 	}
+	/* else ignore, since the stack is the root of GC. Would cause a cycle (infinite loop) if we handled it. */
 
  cleanup:
 	return e;
 }
 
-static dl_error_t duckVM_gclist_pushObject(duckVM_t *duckVM, duckVM_object_t **objectOut, duckVM_object_t objectIn) {
+/* Trace gray objects until there are none left, or until `budget` objects have been traced. A budget of zero means
+   there is no limit. */
+static dl_error_t duckVM_gclist_drain(duckVM_gclist_t *gclist, dl_size_t budget) {
 	dl_error_t e = dl_error_ok;
-	dl_error_t eError = dl_error_ok;
+	dl_size_t traced = 0;
+	while ((gclist->grayStack.elements_length > 0) && ((budget == 0) || (traced < budget))) {
+		duckVM_object_t *object = DL_ARRAY_GETADDRESS(gclist->grayStack,
+		                                              duckVM_object_t *,
+		                                              --gclist->grayStack.elements_length);
+		e = duckVM_gclist_scanObject(gclist, object);
+		if (e) break;
+		traced++;
+	}
+	gclist->pauseWork += traced;
+	return e;
+}
 
-	duckVM_gclist_t *gclist = &duckVM->gclist;
+#ifdef USE_PARALLEL_MARKING
+
+/* Parallel marking */
+
+/* Gray objects each thread keeps to itself. Other threads can only steal what has been spilled to the shared stack. */
+#define DUCKVM_GCLIST_MARK_LOCAL 128
+/* Smaller heaps are marked on one thread, since starting the threads would take longer than the marking. */
+#define DUCKVM_GCLIST_PARALLEL_MINIMUM 16384
+
+typedef struct {
+	duckVM_object_t **objects;
+	dl_size_t objects_length;
+	dl_size_t objects_size;
+} duckVM_gclist_markBuffer_t;
+
+typedef struct {
+	struct duckVM_gclist_parallelMark_s *mark;
+	duckVM_object_t *local[DUCKVM_GCLIST_MARK_LOCAL];
+	dl_size_t local_length;
+	/* The owner pushes and pops at the top, and thieves take from `bottom`. `available` is a copy of the number of
+	   objects that can be stolen, so idle threads can look for work without taking the lock. */
+	pthread_mutex_t lock;
+	duckVM_gclist_markBuffer_t shared;
+	dl_size_t bottom;
+	dl_size_t available;
+	/* User-defined objects with markers. Markers expect to be called by one thread at a time, so these are traced after
+	   the other threads are done. */
+	duckVM_gclist_markBuffer_t deferred;
+	dl_size_t marked;
+	dl_size_t traced;
+	dl_error_t e;
+} duckVM_gclist_markThread_t;
+
+typedef struct duckVM_gclist_parallelMark_s {
+	duckVM_gclist_t *gclist;
+	duckVM_gclist_markThread_t *threads;
+	dl_size_t threads_length;
+	/* Threads that are running, and how many of them are out of work. Marking is done when they are all out. */
+	dl_size_t started;
+	dl_size_t idle;
+	dl_bool_t failed;
+	/* The VM's allocator isn't thread safe. */
+	pthread_mutex_t allocationLock;
+} duckVM_gclist_parallelMark_t;
+
+static dl_error_t duckVM_gclist_markBuffer_reserve(duckVM_gclist_parallelMark_t *mark,
+                                                   duckVM_gclist_markBuffer_t *buffer,
+                                                   dl_size_t length) {
+	dl_error_t e = dl_error_ok;
+	duckVM_object_t **objects = buffer->objects;
+	dl_size_t size;
+	if (length <= buffer->objects_size) return e;
+	size = dl_max(dl_max(length, 2 * buffer->objects_size), DUCKVM_GCLIST_MARK_LOCAL);
+	/**/ pthread_mutex_lock(&mark->allocationLock);
+	e = DL_REALLOC(mark->gclist->memoryAllocation, &objects, size, duckVM_object_t *);
+	/**/ pthread_mutex_unlock(&mark->allocationLock);
+	if (e) return e;
+	buffer->objects = objects;
+	buffer->objects_size = size;
+	return e;
+}
 
-	// Try once
-	if (gclist->freeObjects_length == 0) {
-		// STOP THE WORLD
-		e = duckVM_gclist_garbageCollect(duckVM);
-		if (e) {
-			eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_gclist_pushObject: Garbage collection failed."));
-			if (!e) e = eError;
-			goto cleanup;
-		}
+/* Move the older half of the local stack to the shared stack. */
+static dl_error_t duckVM_gclist_markThread_spill(duckVM_gclist_markThread_t *self) {
+	dl_error_t e = dl_error_ok;
+	dl_size_t count = self->local_length / 2;
+	duckVM_gclist_markBuffer_t *shared = &self->shared;
+
+	/**/ pthread_mutex_lock(&self->lock);
+	if ((shared->objects_length + count > shared->objects_size) && (self->bottom > 0)) {
+		/**/ dl_memcopy(shared->objects,
+		                shared->objects + self->bottom,
+		                (shared->objects_length - self->bottom) * sizeof(duckVM_object_t *));
+		shared->objects_length -= self->bottom;
+		self->bottom = 0;
+	}
+	e = duckVM_gclist_markBuffer_reserve(self->mark, shared, shared->objects_length + count);
+	if (!e) {
+		/**/ dl_memcopy_noOverlap(shared->objects + shared->objects_length,
+		                          self->local,
+		                          count * sizeof(duckVM_object_t *));
+		shared->objects_length += count;
+		__atomic_store_n(&self->available, shared->objects_length - self->bottom, __ATOMIC_RELAXED);
+	}
+	/**/ pthread_mutex_unlock(&self->lock);
+	if (e) return e;
 
-		// Try twice
-		if (gclist->freeObjects_length == 0) {
-			e = dl_error_outOfMemory;
-			eError = duckVM_error_pushRuntime(duckVM,
-			                                  DL_STR("duckVM_gclist_pushObject: Garbage collection failed. Out of memory."));
-			if (!e) e = eError;
-			goto cleanup;
+	self->local_length -= count;
+	/**/ dl_memcopy(self->local, self->local + count, self->local_length * sizeof(duckVM_object_t *));
+	return e;
+}
+
+/* Refill the local stack from a thread's shared stack. The owner takes the newest objects. Thieves take the oldest
+   half, which tend to lead to the most work. */
+static dl_bool_t duckVM_gclist_markThread_take(duckVM_gclist_markThread_t *self, duckVM_gclist_markThread_t *victim) {
+	duckVM_gclist_markBuffer_t *shared = &victim->shared;
+	dl_size_t count;
+
+	/**/ pthread_mutex_lock(&victim->lock);
+	count = shared->objects_length - victim->bottom;
+	if (victim != self) count = (count + 1) / 2;
+	count = dl_min(count, DUCKVM_GCLIST_MARK_LOCAL / 2);
+	if (victim == self) {
+		shared->objects_length -= count;
+		/**/ dl_memcopy_noOverlap(self->local, shared->objects + shared->objects_length, count * sizeof(duckVM_object_t *));
+	}
+	else {
+		/**/ dl_memcopy_noOverlap(self->local, shared->objects + victim->bottom, count * sizeof(duckVM_object_t *));
+		victim->bottom += count;
+	}
+	if (victim->bottom == shared->objects_length) {
+		victim->bottom = 0;
+		shared->objects_length = 0;
+	}
+	__atomic_store_n(&victim->available, shared->objects_length - victim->bottom, __ATOMIC_RELAXED);
+	/**/ pthread_mutex_unlock(&victim->lock);
+
+	self->local_length = count;
+	return count > 0;
+}
+
+static dl_bool_t duckVM_gclist_markThread_steal(duckVM_gclist_markThread_t *self) {
+	duckVM_gclist_parallelMark_t *mark = self->mark;
+	dl_size_t start = self - mark->threads;
+	DL_DOTIMES(i, mark->threads_length) {
+		duckVM_gclist_markThread_t *victim = &mark->threads[(start + 1 + i) % mark->threads_length];
+		if ((victim != self)
+		    && (__atomic_load_n(&victim->available, __ATOMIC_RELAXED) > 0)
+		    && duckVM_gclist_markThread_take(self, victim)) {
+			return dl_true;
 		}
 	}
+	return dl_false;
+}
 
-	duckVM_object_t *heapObject = gclist->freeObjects[--gclist->freeObjects_length];
-	*heapObject = objectIn;
-	if (objectIn.type == duckVM_object_type_upvalueArray) {
-		if (objectIn.value.upvalue_array.length > 0) {
-			e = DL_MALLOC(duckVM->memoryAllocation,
-			              (void **) &heapObject->value.upvalue_array.upvalues,
-			              objectIn.value.upvalue_array.length,
-			              duckVM_object_t **);
-			if (e) {
-				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_gclist_pushObject: Upvalue array allocation failed."));
-				if (!e) e = eError;
-				goto cleanup;
+/* Wait for work to show up. Returns false once every thread is out of work, or if marking failed. */
+static dl_bool_t duckVM_gclist_markThread_idle(duckVM_gclist_markThread_t *self) {
+	duckVM_gclist_parallelMark_t *mark = self->mark;
+	/**/ __atomic_add_fetch(&mark->idle, 1, __ATOMIC_SEQ_CST);
+	for (;;) {
+		dl_bool_t found = dl_false;
+		if (__atomic_load_n(&mark->failed, __ATOMIC_RELAXED)) return dl_false;
+		DL_DOTIMES(i, mark->threads_length) {
+			if (__atomic_load_n(&mark->threads[i].available, __ATOMIC_RELAXED) > 0) {
+				found = dl_true;
+				break;
 			}
-			/* Don't copy the source array. */
 		}
-		else {
-			heapObject->value.upvalue_array.upvalues = dl_null;
+		if (found) {
+			/* Idle threads never hold work, so stop being idle before stealing. */
+			/**/ __atomic_sub_fetch(&mark->idle, 1, __ATOMIC_SEQ_CST);
+			if (duckVM_gclist_markThread_steal(self)) return dl_true;
+			/**/ __atomic_add_fetch(&mark->idle, 1, __ATOMIC_SEQ_CST);
+		}
+		else if (__atomic_load_n(&mark->idle, __ATOMIC_SEQ_CST) == __atomic_load_n(&mark->started, __ATOMIC_SEQ_CST)) {
+			return dl_false;
 		}
+		/**/ sched_yield();
+	}
+}
+
+/* Mark an object with an atomic OR, since other threads may be marking objects in the same word. */
+static dl_error_t duckVM_gclist_markThread_shade(duckVM_gclist_markThread_t *self, duckVM_object_t *object) {
+	dl_error_t e = dl_error_ok;
+	duckVM_gclist_chunk_t *chunk;
+	if (object == dl_null) return e;
+	chunk = duckVM_gclist_findChunk(self->mark->gclist, object);
+	if (chunk != dl_null) {
+		dl_size_t index = object - chunk->objects;
+		dl_uint64_t bit = (dl_uint64_t) 1 << (index % 64);
+		if (__atomic_fetch_or(&chunk->marks[index / 64], bit, __ATOMIC_RELAXED) & bit) return e;
+		self->marked++;
+	}
+	if (object->type == duckVM_object_type_user) {
+		if (object->value.user.marker == dl_null) return e;
+		e = duckVM_gclist_markBuffer_reserve(self->mark, &self->deferred, self->deferred.objects_length + 1);
+		if (e) return e;
+		self->deferred.objects[self->deferred.objects_length++] = object;
+		return e;
+	}
+	if (self->local_length == DUCKVM_GCLIST_MARK_LOCAL) {
+		e = duckVM_gclist_markThread_spill(self);
+		if (e) return e;
+	}
+	self->local[self->local_length++] = object;
+	return e;
+}
+
+/* Shade everything the object points to. Mirrors `duckVM_gclist_scanObject`. User-defined objects never get here. */
+static dl_error_t duckVM_gclist_markThread_scan(duckVM_gclist_markThread_t *self, duckVM_object_t *object) {
+	dl_error_t e = dl_error_ok;
+
+	if (object->type == duckVM_object_type_list) {
+		e = duckVM_gclist_markThread_shade(self, object->value.list);
+	}
+	else if (object->type == duckVM_object_type_cons) {
+		e = duckVM_gclist_markThread_shade(self, object->value.cons.car);
 		if (e) goto cleanup;
+		e = duckVM_gclist_markThread_shade(self, object->value.cons.cdr);
 	}
-	else if (objectIn.type == duckVM_object_type_internalVector) {
-		if (objectIn.value.internal_vector.length > 0) {
-			e = DL_MALLOC(duckVM->memoryAllocation,
-			              (void **) &heapObject->value.internal_vector.values,
-			              objectIn.value.internal_vector.length,
-			              duckVM_object_t **);
-			if (e) {
-				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_gclist_pushObject: Vector allocation failed."));
-				if (!e) e = eError;
-				goto cleanup;
-			}
-			if (objectIn.value.internal_vector.initialized) {
-				(void) dl_memcopy_noOverlap(heapObject->value.internal_vector.values,
-				                            objectIn.value.internal_vector.values,
-				                            objectIn.value.internal_vector.length * sizeof(duckVM_object_t *));
-			}
-		}
-		else {
-			heapObject->value.internal_vector.values = dl_null;
-		}
+	else if (object->type == duckVM_object_type_closure) {
+		e = duckVM_gclist_markThread_shade(self, object->value.closure.upvalue_array);
 		if (e) goto cleanup;
+		e = duckVM_gclist_markThread_shade(self, object->value.closure.bytecode);
 	}
-	else if (objectIn.type == duckVM_object_type_bytecode) {
-		if (objectIn.value.bytecode.bytecode_length > 0) {
-			e = DL_MALLOC(duckVM->memoryAllocation,
-			              &heapObject->value.bytecode.bytecode,
-			              objectIn.value.bytecode.bytecode_length,
-			              dl_uint8_t);
-			if (e) {
-				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_gclist_pushObject: Bytecode allocation failed."));
-				if (!e) e = eError;
-				goto cleanup;
-			}
-			/**/ dl_memcopy_noOverlap(heapObject->value.bytecode.bytecode,
-			                          objectIn.value.bytecode.bytecode,
-			                          objectIn.value.bytecode.bytecode_length);
+	else if (object->type == duckVM_object_type_upvalue) {
+		if (object->value.upvalue.type == duckVM_upvalue_type_heap_object) {
+			e = duckVM_gclist_markThread_shade(self, object->value.upvalue.value.heap_object);
 		}
-		else {
-			heapObject->value.bytecode.bytecode = dl_null;
-			heapObject->value.bytecode.bytecode_length = 0;
+		else if (object->value.upvalue.type == duckVM_upvalue_type_heap_upvalue) {
+			e = duckVM_gclist_markThread_shade(self, object->value.upvalue.value.heap_upvalue);
 		}
-		if (e) goto cleanup;
 	}
-	else if (objectIn.type == duckVM_object_type_internalString) {
-		if (objectIn.value.internalString.value_length > 0) {
-			e = DL_MALLOC(duckVM->memoryAllocation,
-			              &heapObject->value.internalString.value,
-			              objectIn.value.internalString.value_length,
-			              dl_uint8_t);
-			if (e) {
-				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_gclist_pushObject: String allocation failed."));
-				if (!e) e = eError;
-				goto cleanup;
-			}
-			/**/ dl_memcopy_noOverlap(heapObject->value.internalString.value,
-			                          objectIn.value.internalString.value,
-			                          objectIn.value.internalString.value_length);
+	else if (object->type == duckVM_object_type_upvalueArray) {
+		DL_DOTIMES(k, object->value.upvalue_array.length) {
+			e = duckVM_gclist_markThread_shade(self, object->value.upvalue_array.upvalues[k]);
+			if (e) goto cleanup;
 		}
-		else {
-			heapObject->value.internalString.value = dl_null;
-			heapObject->value.internalString.value_length = 0;
+	}
+	else if (object->type == duckVM_object_type_vector) {
+		e = duckVM_gclist_markThread_shade(self, object->value.vector.internal_vector);
+	}
+	else if (object->type == duckVM_object_type_internalVector) {
+		if (object->value.internal_vector.initialized) {
+			DL_DOTIMES(k, object->value.internal_vector.length) {
+				e = duckVM_gclist_markThread_shade(self, object->value.internal_vector.values[k]);
+				if (e) goto cleanup;
+			}
 		}
+	}
+	else if (object->type == duckVM_object_type_string) {
+		e = duckVM_gclist_markThread_shade(self, object->value.string.internalString);
+	}
+	else if (object->type == duckVM_object_type_symbol) {
+		e = duckVM_gclist_markThread_shade(self, object->value.symbol.internalString);
+	}
+	else if (object->type == duckVM_object_type_composite) {
+		e = duckVM_gclist_markThread_shade(self, object->value.composite);
+	}
+	else if (object->type == duckVM_object_type_internalComposite) {
+		e = duckVM_gclist_markThread_shade(self, object->value.internalComposite.value);
 		if (e) goto cleanup;
+		e = duckVM_gclist_markThread_shade(self, object->value.internalComposite.function);
 	}
-	*objectOut = heapObject;
 
  cleanup:
-
 	return e;
 }
 
+static void *duckVM_gclist_markThread_run(void *argument) {
+	duckVM_gclist_markThread_t *self = argument;
+	duckVM_gclist_parallelMark_t *mark = self->mark;
 
-dl_error_t duckVM_init(duckVM_t *duckVM, dl_memoryAllocation_t *memoryAllocation, dl_size_t maxObjects) {
+	for (;;) {
+		if ((self->local_length == 0)
+		    && !duckVM_gclist_markThread_take(self, self)
+		    && !duckVM_gclist_markThread_steal(self)
+		    && !duckVM_gclist_markThread_idle(self)) {
+			break;
+		}
+		self->e = duckVM_gclist_markThread_scan(self, self->local[--self->local_length]);
+		self->traced++;
+		/* Give some work away if another thread is waiting for it. */
+		if (!self->e && (self->local_length > 1) && (__atomic_load_n(&mark->idle, __ATOMIC_RELAXED) > 0)) {
+			self->e = duckVM_gclist_markThread_spill(self);
+		}
+		if (self->e) {
+			__atomic_store_n(&mark->failed, dl_true, __ATOMIC_RELAXED);
+			break;
+		}
+		if (__atomic_load_n(&mark->failed, __ATOMIC_RELAXED)) break;
+	}
+	return dl_null;
+}
+
+/* Trace the gray stack on several threads. The gray objects are dealt out to the threads, and each one marks what it
+   can reach. Threads that run out of work steal it from the others. User-defined objects are left for the calling
+   thread, which traces them one at a time after the other threads have stopped. */
+static dl_error_t duckVM_gclist_drainParallel(duckVM_gclist_t *gclist) {
 	dl_error_t e = dl_error_ok;
+	dl_error_t eError = dl_error_ok;
+	duckVM_gclist_parallelMark_t mark;
+	pthread_t *handles = dl_null;
+	dl_size_t handles_length = 0;
+	dl_size_t grays = gclist->grayStack.elements_length;
+
+	mark.gclist = gclist;
+	mark.threads = dl_null;
+	mark.threads_length = gclist->markThreads;
+	mark.started = 1;
+	mark.idle = 0;
+	mark.failed = dl_false;
+	/**/ pthread_mutex_init(&mark.allocationLock, dl_null);
+
+	e = DL_MALLOC(gclist->memoryAllocation, &mark.threads, mark.threads_length, duckVM_gclist_markThread_t);
+	if (e) goto cleanup;
+	DL_DOTIMES(i, mark.threads_length) {
+		duckVM_gclist_markThread_t *thread = &mark.threads[i];
+		thread->mark = &mark;
+		thread->local_length = 0;
+		/**/ pthread_mutex_init(&thread->lock, dl_null);
+		thread->shared.objects = dl_null;
+		thread->shared.objects_length = 0;
+		thread->shared.objects_size = 0;
+		thread->bottom = 0;
+		thread->available = 0;
+		thread->deferred.objects = dl_null;
+		thread->deferred.objects_length = 0;
+		thread->deferred.objects_size = 0;
+		thread->marked = 0;
+		thread->traced = 0;
+		thread->e = dl_error_ok;
+	}
+	e = DL_MALLOC(gclist->memoryAllocation, &handles, mark.threads_length, pthread_t);
+	if (e) goto cleanup;
 
-	duckVM->memoryAllocation = memoryAllocation;
-	duckVM->currentBytecode = dl_null;
-	duckVM->nextUserType = duckVM_object_type_last;
-	/**/ dl_array_init(&duckVM->errors, duckVM->memoryAllocation, sizeof(dl_uint8_t), dl_array_strategy_double);
-	/**/ dl_array_init(&duckVM->stack, duckVM->memoryAllocation, sizeof(duckVM_object_t), dl_array_strategy_double);
-	/**/ dl_array_init(&duckVM->call_stack,
-	                   duckVM->memoryAllocation,
-	                   sizeof(duckVM_callFrame_t),
-	                   dl_array_strategy_double);
-	/**/ dl_array_init(&duckVM->upvalue_stack,
-	                   duckVM->memoryAllocation,
-	                   sizeof(duckVM_object_t *),
-	                   dl_array_strategy_double);
-	/**/ dl_array_init(&duckVM->upvalue_array_call_stack,
-	                   duckVM->memoryAllocation,
-	                   sizeof(duckVM_upvalueArray_t),
-	                   dl_array_strategy_double);
-	e = dl_array_pushElement(&duckVM->upvalue_array_call_stack, dl_null);
+	/* Deal out the gray stack. */
+	DL_DOTIMES(i, mark.threads_length) {
+		duckVM_gclist_markThread_t *thread = &mark.threads[i];
+		e = duckVM_gclist_markBuffer_reserve(&mark, &thread->shared, grays / mark.threads_length + 1);
+		if (e) goto cleanup;
+	}
+	DL_DOTIMES(i, grays) {
+		duckVM_gclist_markThread_t *thread = &mark.threads[i % mark.threads_length];
+		thread->shared.objects[thread->shared.objects_length++] = DL_ARRAY_GETADDRESS(gclist->grayStack,
+		                                                                              duckVM_object_t *,
+		                                                                              i);
+		thread->available = thread->shared.objects_length;
+	}
+	gclist->grayStack.elements_length = 0;
+
+	/* This thread is thread 0. If a thread fails to start, the others will steal its share. */
+	for (dl_size_t i = 1; i < mark.threads_length; i++) {
+		/**/ __atomic_add_fetch(&mark.started, 1, __ATOMIC_SEQ_CST);
+		if (pthread_create(&handles[handles_length], dl_null, duckVM_gclist_markThread_run, &mark.threads[i])) {
+			/**/ __atomic_sub_fetch(&mark.started, 1, __ATOMIC_SEQ_CST);
+			continue;
+		}
+		handles_length++;
+	}
+	/**/ duckVM_gclist_markThread_run(&mark.threads[0]);
+	DL_DOTIMES(i, handles_length) {
+		/**/ pthread_join(handles[i], dl_null);
+	}
+	handles_length = 0;
+
+	DL_DOTIMES(i, mark.threads_length) {
+		duckVM_gclist_markThread_t *thread = &mark.threads[i];
+		if (thread->e) e = thread->e;
+		gclist->markedObjects += thread->marked;
+		gclist->pauseWork += thread->traced;
+	}
 	if (e) goto cleanup;
-	/**/ dl_array_init(&duckVM->globals,
-	                   duckVM->memoryAllocation,
-	                   sizeof(duckVM_object_t *),
-	                   dl_array_strategy_double);
-	/**/ dl_array_init(&duckVM->globals_map,
-	                   duckVM->memoryAllocation,
-	                   sizeof(dl_ptrdiff_t),
-	                   dl_array_strategy_double);
-	e = duckVM_gclist_init(&duckVM->gclist, duckVM->memoryAllocation, duckVM, maxObjects);
+
+	/* Back to one thread for user-defined objects. They're already marked, so just trace them. */
+	DL_DOTIMES(i, mark.threads_length) {
+		duckVM_gclist_markBuffer_t *deferred = &mark.threads[i].deferred;
+		DL_DOTIMES(j, deferred->objects_length) {
+			e = duckVM_gclist_scanObject(gclist, deferred->objects[j]);
+			if (e) goto cleanup;
+		}
+	}
+	e = duckVM_gclist_drain(gclist, 0);
 	if (e) goto cleanup;
-	duckVM->duckLisp = dl_null;
-	duckVM->userData = dl_null;
 
  cleanup:
+	if (mark.threads != dl_null) {
+		DL_DOTIMES(i, mark.threads_length) {
+			duckVM_gclist_markThread_t *thread = &mark.threads[i];
+			/**/ pthread_mutex_destroy(&thread->lock);
+			if (thread->shared.objects != dl_null) {
+				eError = DL_FREE(gclist->memoryAllocation, &thread->shared.objects);
+				if (eError) e = eError;
+			}
+			if (thread->deferred.objects != dl_null) {
+				eError = DL_FREE(gclist->memoryAllocation, &thread->deferred.objects);
+				if (eError) e = eError;
+			}
+		}
+		eError = DL_FREE(gclist->memoryAllocation, &mark.threads);
+		if (eError) e = eError;
+	}
+	if (handles != dl_null) {
+		eError = DL_FREE(gclist->memoryAllocation, &handles);
+		if (eError) e = eError;
+	}
+	/**/ pthread_mutex_destroy(&mark.allocationLock);
 	return e;
 }
 
-void duckVM_quit(duckVM_t *duckVM) {
-	dl_error_t e;
-	e = dl_array_quit(&duckVM->stack);
-	e = dl_array_quit(&duckVM->upvalue_stack);
-	e = dl_array_quit(&duckVM->globals);
-	e = dl_array_quit(&duckVM->globals_map);
-	e = dl_array_quit(&duckVM->call_stack);
-	duckVM->currentBytecode = dl_null;
-	e = duckVM_gclist_garbageCollect(duckVM);
-	e = dl_array_quit(&duckVM->upvalue_array_call_stack);
-	/**/ duckVM_gclist_quit(&duckVM->gclist);
-	e = dl_array_quit(&duckVM->errors);
-	duckVM->duckLisp = dl_null;
-	duckVM->userData = dl_null;
-	(void) e;
+#endif /* USE_PARALLEL_MARKING */
+
+/* Trace every gray object. Big heaps are traced on several threads if parallel marking is on. */
+static dl_error_t duckVM_gclist_drainAll(duckVM_gclist_t *gclist) {
+#ifdef USE_PARALLEL_MARKING
+	if ((gclist->markThreads > 1) && (gclist->objects_length >= DUCKVM_GCLIST_PARALLEL_MINIMUM)) {
+		return duckVM_gclist_drainParallel(gclist);
+	}
+#endif /* USE_PARALLEL_MARKING */
+	return duckVM_gclist_drain(gclist, 0);
 }
 
-static dl_error_t stack_push(duckVM_t *duckVM, duckVM_object_t *object) {
+/* Shade everything the VM's roots point to. */
+static dl_error_t duckVM_gclist_markRoots(duckVM_t *duckVM, dl_bool_t globals) {
 	dl_error_t e = dl_error_ok;
-	e = dl_array_pushElement(&duckVM->stack, object);
+	duckVM_gclist_t *gclist = &duckVM->gclist;
+
+	/* Stack. These objects aren't on the heap, so their contents are traced directly. */
+	DL_DOTIMES(i, duckVM->stack.elements_length) {
+		e = duckVM_gclist_scanObject(gclist, &DL_ARRAY_GETADDRESS(duckVM->stack, duckVM_object_t, i));
+		if (e) goto cleanup;
+	}
+	gclist->pauseWork += duckVM->stack.elements_length;
+
+	/* Upvalue stack */
+	DL_DOTIMES(i, duckVM->upvalue_stack.elements_length) {
+		e = duckVM_gclist_shade(gclist, DL_ARRAY_GETADDRESS(duckVM->upvalue_stack, duckVM_object_t *, i));
+		if (e) goto cleanup;
+	}
+
+	/* Globals. Minor collections get young globals from the remembered set instead. */
+	if (globals) {
+		DL_DOTIMES(i, duckVM->globals.elements_length) {
+			e = duckVM_gclist_shade(gclist, DL_ARRAY_GETADDRESS(duckVM->globals, duckVM_object_t *, i));
+			if (e) goto cleanup;
+		}
+	}
+
+	/* Call stack */
+	DL_DOTIMES(i, duckVM->call_stack.elements_length) {
+		duckVM_callFrame_t *frame = &DL_ARRAY_GETADDRESS(duckVM->call_stack, duckVM_callFrame_t, i);
+		e = duckVM_gclist_shade(gclist, frame->bytecode);
+		if (e) goto cleanup;
+		e = duckVM_gclist_shade(gclist, frame->tailcallBytecode);
+		if (e) goto cleanup;
+		e = duckVM_gclist_shade(gclist, frame->tailcallUpvalueArray);
+		if (e) goto cleanup;
+	}
+
+	/* Current bytecode */
+	e = duckVM_gclist_shade(gclist, duckVM->currentBytecode);
 	if (e) goto cleanup;
-	e = dl_array_pushElement(&duckVM->upvalue_stack, dl_null);
- cleanup:
-	if (e) {
-		dl_error_t eError = duckVM_error_pushRuntime(duckVM, DL_STR("stack_push: Failed."));
-		if (!e) e = eError;
+	e = duckVM_gclist_shade(gclist, duckVM->suspendedBytecode);
+	if (e) goto cleanup;
+
+	/* Objects pinned by C code */
+	DL_DOTIMES(i, gclist->pinnedObjects.elements_length) {
+		e = duckVM_gclist_shade(gclist, DL_ARRAY_GETADDRESS(gclist->pinnedObjects, duckVM_object_t *, i));
+		if (e) goto cleanup;
 	}
+
+ cleanup:
 	return e;
 }
 
-/* This is only used by the FFI. */
-static dl_error_t stack_pop(duckVM_t *duckVM, duckVM_object_t *object) {
+/* Release the resources held by an unmarked object. */
+static dl_error_t duckVM_gclist_freeObject(duckVM_t *duckVM, duckVM_object_t *objectPointer) {
 	dl_error_t e = dl_error_ok;
-	e = dl_array_popElement(&duckVM->stack, object);
-	if (e) goto cleanup;
-	e = dl_array_popElement(&duckVM->upvalue_stack, dl_null);
- cleanup:
-	if (e) {
-		dl_error_t eError = duckVM_error_pushRuntime(duckVM, DL_STR("stack_pop: Failed."));
-		if (!e) e = eError;
+
+	duckVM_object_t object = *objectPointer;
+	duckVM_object_type_t type = object.type;
+	if ((type == duckVM_object_type_upvalueArray)
+	    /* Prevent multiple frees. */
+	    && (object.value.upvalue_array.upvalues != dl_null)) {
+		e = duckVM_gclist_freePayload(&duckVM->gclist, (void **) &objectPointer->value.upvalue_array.upvalues);
+		if (e) goto cleanup;
+	}
+	else if ((type == duckVM_object_type_internalVector)
+	         && object.value.internal_vector.initialized
+	         /* Prevent multiple frees. */
+	         && (object.value.internal_vector.values != dl_null)) {
+		e = duckVM_gclist_freePayload(&duckVM->gclist, (void **) &objectPointer->value.internal_vector.values);
+		if (e) goto cleanup;
+	}
+	else if ((type == duckVM_object_type_bytecode)
+	         /* Prevent multiple frees. */
+	         && (object.value.bytecode.bytecode != dl_null)) {
+		e = duckVM_gclist_freePayload(&duckVM->gclist, (void **) &objectPointer->value.bytecode.bytecode);
+		if (e) goto cleanup;
+		if (object.value.bytecode.decoded != dl_null) {
+			duckVM->gclist.decodedBytes -= duckVM_gclist_payloadSize(object.value.bytecode.decoded);
+			e = duckVM_gclist_freePayload(&duckVM->gclist, (void **) &objectPointer->value.bytecode.decoded);
+			if (e) goto cleanup;
+		}
+	}
+	else if ((type == duckVM_object_type_internalString)
+	         /* Prevent multiple frees. */
+	         && (object.value.internalString.value != dl_null)) {
+		e = duckVM_gclist_freePayload(&duckVM->gclist, (void **) &objectPointer->value.internalString.value);
+		if (e) goto cleanup;
+	}
+	else if ((type == duckVM_object_type_user)
+	         && (object.value.user.destructor != dl_null)) {
+		e = object.value.user.destructor(&duckVM->gclist, objectPointer);
+		if (e) goto cleanup;
+		objectPointer->value.user.destructor = dl_null;
 	}
+	objectPointer->type = duckVM_object_type_none;
+	duckVM->gclist.objectsFreed++;
+
+ cleanup:
 	return e;
 }
 
-static dl_error_t stack_pop_multiple(duckVM_t *duckVM, dl_size_t pops) {
+/* Add an object to the remembered set if it isn't there already. */
+static dl_error_t duckVM_gclist_remember(duckVM_gclist_t *gclist,
+                                         duckVM_gclist_chunk_t *chunk,
+                                         duckVM_object_t *object) {
 	dl_error_t e = dl_error_ok;
-	e = dl_array_popElements(&duckVM->upvalue_stack, dl_null, pops);
+	dl_ptrdiff_t index = object - chunk->objects;
+	if (DUCKVM_GCLIST_GETBIT(chunk->remembered, index)) goto cleanup;
+	e = dl_array_pushElement(&gclist->rememberedSet, &object);
 	if (e) goto cleanup;
-	e = dl_array_popElements(&duckVM->stack, dl_null, pops);
+	DUCKVM_GCLIST_SETBIT(chunk->remembered, index);
  cleanup:
-	if (e) {
-		dl_error_t eError = duckVM_error_pushRuntime(duckVM, DL_STR("stack_pop_multiple: Failed."));
-		if (!e) e = eError;
-	}
 	return e;
 }
 
-static dl_error_t stack_getTop(duckVM_t *duckVM, duckVM_object_t *element) {
-	return dl_array_getTop(&duckVM->stack, element);
+/* Run after storing a pointer in a heap object. If the object is old, it might now point to a young object that a minor
+   collection wouldn't otherwise find. */
+static dl_error_t duckVM_gclist_writeBarrier(duckVM_gclist_t *gclist, duckVM_object_t *object) {
+	duckVM_gclist_chunk_t *chunk = duckVM_gclist_findChunk(gclist, object);
+	if ((chunk == dl_null) || !DUCKVM_GCLIST_GETBIT(chunk->marks, object - chunk->objects)) return dl_error_ok;
+	return duckVM_gclist_remember(gclist, chunk, object);
 }
 
-static dl_error_t stack_get(duckVM_t *duckVM, duckVM_object_t *element, dl_ptrdiff_t index) {
-	if (index < 0) {
-		index = duckVM->stack.elements_length + index;
-	}
-	return dl_array_get(&duckVM->stack, element, index);
+/* Run after storing an object in a global. Minor collections don't scan the globals, so young objects are remembered. */
+static dl_error_t duckVM_gclist_globalBarrier(duckVM_gclist_t *gclist, duckVM_object_t *object) {
+	duckVM_gclist_chunk_t *chunk = duckVM_gclist_findChunk(gclist, object);
+	if ((chunk == dl_null) || DUCKVM_GCLIST_GETBIT(chunk->marks, object - chunk->objects)) return dl_error_ok;
+	return duckVM_gclist_remember(gclist, chunk, object);
 }
 
-static dl_error_t stack_set(duckVM_t *duckVM, duckVM_object_t *element, dl_ptrdiff_t index) {
-	if (index < 0) {
-		index = duckVM->stack.elements_length + index;
+/* Empty the remembered set. User-defined objects stay in it if they're old, since their contents can be changed by C
+   code that doesn't know about the write barrier. */
+static dl_error_t duckVM_gclist_resetRememberedSet(duckVM_gclist_t *gclist) {
+	dl_size_t kept = 0;
+	DL_DOTIMES(i, gclist->rememberedSet.elements_length) {
+		duckVM_object_t *object = DL_ARRAY_GETADDRESS(gclist->rememberedSet, duckVM_object_t *, i);
+		duckVM_gclist_chunk_t *chunk = duckVM_gclist_findChunk(gclist, object);
+		dl_ptrdiff_t index = (dl_ptrdiff_t) (object - chunk->objects);
+		if (DUCKVM_GCLIST_GETBIT(chunk->marks, index)
+		    && (object->type == duckVM_object_type_user)
+		    && (object->value.user.marker != dl_null)) {
+			DL_ARRAY_GETADDRESS(gclist->rememberedSet, duckVM_object_t *, kept++) = object;
+		}
+		else {
+			DUCKVM_GCLIST_CLEARBIT(chunk->remembered, index);
+		}
 	}
-	return dl_array_set(&duckVM->stack, element, index);
+	gclist->rememberedSet.elements_length = kept;
+	return dl_error_ok;
 }
 
-static dl_error_t call_stack_push(duckVM_t *duckVM,
-                                  dl_uint8_t *ip,
-                                  duckVM_object_t *bytecode,
-                                  duckVM_upvalueArray_t *upvalueArray) {
+/* Queue the remembered objects to be traced. Marked objects have had something stored in them since they were traced,
+   so they are traced again. Unmarked objects are young globals, which are roots for minor collections. */
+static dl_error_t duckVM_gclist_markRemembered(duckVM_gclist_t *gclist, dl_bool_t minor) {
 	dl_error_t e = dl_error_ok;
-	duckVM_callFrame_t frame;
-	frame.ip = ip;
-	frame.bytecode = bytecode;
-	e = dl_array_pushElement(&duckVM->call_stack, &frame);
-	if (e) goto cleanup;
-	e = dl_array_pushElement(&duckVM->upvalue_array_call_stack, upvalueArray);
-	if (e) goto cleanup;
- cleanup:
-	if (e) {
-		dl_error_t eError = duckVM_error_pushRuntime(duckVM, DL_STR("call_stack_push: Failed."));
-		if (!e) e = eError;
+	DL_DOTIMES(i, gclist->rememberedSet.elements_length) {
+		duckVM_object_t *object = DL_ARRAY_GETADDRESS(gclist->rememberedSet, duckVM_object_t *, i);
+		duckVM_gclist_chunk_t *chunk = duckVM_gclist_findChunk(gclist, object);
+		dl_ptrdiff_t index = object - chunk->objects;
+		dl_bool_t marked = DUCKVM_GCLIST_GETBIT(chunk->marks, index);
+		if (marked || minor) {
+			if (!marked) {
+				DUCKVM_GCLIST_SETBIT(chunk->marks, index);
+				gclist->markedObjects++;
+			}
+			e = duckVM_gclist_pushGray(gclist, object);
+			if (e) goto cleanup;
+		}
 	}
+ cleanup:
 	return e;
 }
 
-static dl_error_t call_stack_pop(duckVM_t *duckVM, dl_uint8_t **ip, duckVM_object_t **bytecode) {
+/* Minor collection. Old objects are assumed to be alive. Young objects are marked from the roots and from the remembered
+   set, and the survivors become old. */
+static dl_error_t duckVM_gclist_collectYoung(duckVM_t *duckVM) {
 	dl_error_t e = dl_error_ok;
-	duckVM_callFrame_t frame;
-	e = dl_array_popElement(&duckVM->call_stack, &frame);
+	duckVM_gclist_t *gclist = &duckVM->gclist;
+
+	e = duckVM_gclist_markRoots(duckVM, dl_false);
 	if (e) goto cleanup;
-	*ip = frame.ip;
-	*bytecode = frame.bytecode;
-	e = dl_array_popElement(&duckVM->upvalue_array_call_stack, dl_null);
+	e = duckVM_gclist_markRemembered(gclist, dl_true);
+	if (e) goto cleanup;
+	e = duckVM_gclist_drain(gclist, 0);
+	if (e) goto cleanup;
+
+	e = duckVM_gclist_resetRememberedSet(gclist);
+	if (e) goto cleanup;
+
+	DL_DOTIMES(i, gclist->youngObjects_length) {
+		duckVM_object_t *object = gclist->youngObjects[i];
+		duckVM_gclist_chunk_t *chunk = duckVM_gclist_findChunk(gclist, object);
+		if (DUCKVM_GCLIST_GETBIT(chunk->marks, object - chunk->objects)) {
+			if ((object->type == duckVM_object_type_user) && (object->value.user.marker != dl_null)) {
+				e = duckVM_gclist_remember(gclist, chunk, object);
+				if (e) goto cleanup;
+			}
+		}
+		else {
+			gclist->freeObjects[gclist->freeObjects_length++] = object;
+			e = duckVM_gclist_freeObject(duckVM, object);
+			if (e) goto cleanup;
+		}
+	}
+	gclist->pauseWork += gclist->youngObjects_length;
+	gclist->youngObjects_length = 0;
+	gclist->minorCollections++;
+
  cleanup:
-	if (e && (e != dl_error_bufferUnderflow)) {
-		dl_error_t eError = duckVM_error_pushRuntime(duckVM, DL_STR("call_stack_pop: Failed."));
-		if (!e) e = eError;
+	return e;
+}
+
+/* Start sweeping after a full collection. Nothing is freed here. Unmarked objects are freed and put on the free list
+   a few at a time as objects are allocated, so the free list starts out empty. */
+static dl_error_t duckVM_gclist_startSweeping(duckVM_t *duckVM) {
+	dl_error_t e = dl_error_ok;
+	duckVM_gclist_t *gclist = &duckVM->gclist;
+
+	e = duckVM_gclist_resetRememberedSet(gclist);
+	if (e) goto cleanup;
+	/* Everything that survived is old now. Old user-defined objects have to be remembered. */
+	DL_DOTIMES(i, gclist->youngObjects_length) {
+		duckVM_object_t *object = gclist->youngObjects[i];
+		duckVM_gclist_chunk_t *chunk = duckVM_gclist_findChunk(gclist, object);
+		if ((object->type == duckVM_object_type_user)
+		    && (object->value.user.marker != dl_null)
+		    && DUCKVM_GCLIST_GETBIT(chunk->marks, object - chunk->objects)) {
+			e = duckVM_gclist_remember(gclist, chunk, object);
+			if (e) goto cleanup;
+		}
+	}
+	gclist->pauseWork += gclist->youngObjects_length;
+	gclist->youngObjects_length = 0;
+
+	gclist->freeObjects_length = 0;
+	DL_DOTIMES(i, gclist->chunks_length) {
+		gclist->chunks[i].swept = 0;
 	}
+	gclist->sweepChunk = 0;
+
+ cleanup:
 	return e;
 }
 
-dl_error_t duckVM_global_get(const duckVM_t *duckVM, duckVM_object_t **global, const dl_ptrdiff_t key) {
-	DL_DOTIMES(index, duckVM->globals_map.elements_length) {
-		dl_ptrdiff_t currentKey = DL_ARRAY_GETADDRESS(duckVM->globals_map, dl_ptrdiff_t, index);
-		if (key == currentKey) {
-			*global = DL_ARRAY_GETADDRESS(duckVM->globals, duckVM_object_t *, index);
-			return dl_error_ok;
+/* Sweep 64 objects, or fewer at the end of a chunk. Objects that were already free are put back on the free list too
+   since it was emptied when sweeping started. */
+static dl_error_t duckVM_gclist_sweepWord(duckVM_t *duckVM, duckVM_gclist_chunk_t *chunk) {
+	dl_error_t e = dl_error_ok;
+	duckVM_gclist_t *gclist = &duckVM->gclist;
+	dl_size_t start = chunk->swept;
+	dl_size_t length = dl_min(chunk->objects_length - start, 64);
+	dl_uint64_t dead = ~chunk->marks[start / 64];
+
+	if (length < 64) dead &= ((dl_uint64_t) 1 << length) - 1;
+	while (dead) {
+		dl_size_t index = start;
+		/* Find the lowest set bit. */
+		while (!(dead & 1)) {
+			dead >>= 1;
+			index++;
+		}
+		dead >>= 1;
+		start = index + 1;
+		if (chunk->objects[index].type != duckVM_object_type_none) {
+			e = duckVM_gclist_freeObject(duckVM, &chunk->objects[index]);
+			if (e) goto cleanup;
 		}
+		gclist->freeObjects[gclist->freeObjects_length++] = &chunk->objects[index];
 	}
-	return dl_error_invalidValue;
+	chunk->swept += length;
+	gclist->pauseWork += length;
+
+ cleanup:
+	return e;
 }
 
-dl_error_t duckVM_global_set(duckVM_t *duckVM, duckVM_object_t *value, dl_ptrdiff_t key) {
+/* Sweep until there is something on the free list. Returns with an empty free list if the sweep is done. */
+static dl_error_t duckVM_gclist_sweepSome(duckVM_t *duckVM) {
 	dl_error_t e = dl_error_ok;
+	duckVM_gclist_t *gclist = &duckVM->gclist;
 
-	dl_array_t *globals = &duckVM->globals;
-	dl_array_t *globals_map = &duckVM->globals_map;
-	DL_DOTIMES(index, globals_map->elements_length) {
-		dl_ptrdiff_t currentKey = DL_ARRAY_GETADDRESS(*globals_map, dl_ptrdiff_t, index);
-		if (key == currentKey) {
-			DL_ARRAY_GETADDRESS(*globals, duckVM_object_t *, index) = value;
-			goto cleanup;
+	while ((gclist->freeObjects_length == 0) && (gclist->sweepChunk < gclist->chunks_length)) {
+		duckVM_gclist_chunk_t *chunk = &gclist->chunks[gclist->sweepChunk];
+		if (chunk->swept >= chunk->objects_length) {
+			gclist->sweepChunk++;
+			continue;
+		}
+		e = duckVM_gclist_sweepWord(duckVM, chunk);
+		if (e) goto cleanup;
+	}
+
+ cleanup:
+	return e;
+}
+
+/* Sweep the rest of the heap now. */
+static dl_error_t duckVM_gclist_finishSweeping(duckVM_t *duckVM) {
+	dl_error_t e = dl_error_ok;
+	duckVM_gclist_t *gclist = &duckVM->gclist;
+
+	for (; gclist->sweepChunk < gclist->chunks_length; gclist->sweepChunk++) {
+		duckVM_gclist_chunk_t *chunk = &gclist->chunks[gclist->sweepChunk];
+		while (chunk->swept < chunk->objects_length) {
+			e = duckVM_gclist_sweepWord(duckVM, chunk);
+			if (e) goto cleanup;
 		}
 	}
-	e = dl_array_pushElement(globals, &value);
+
+ cleanup:
+	return e;
+}
+
+/* Clear the mark bits. */
+static void duckVM_gclist_clearMarks(duckVM_gclist_t *gclist) {
+	DL_DOTIMES(i, gclist->chunks_length) {
+		duckVM_gclist_chunk_t *chunk = &gclist->chunks[i];
+		/**/ dl_memclear(chunk->marks, DUCKVM_GCLIST_BITMAP_LENGTH(chunk->objects_length) * sizeof(dl_uint64_t));
+	}
+	gclist->markedObjects = 0;
+	gclist->grayStack.elements_length = 0;
+}
+
+/* Full collection. Abandons an incremental collection if one is marking. Garbage left over from an unfinished sweep is
+   unmarked again, so it gets swept with the rest. */
+static dl_error_t duckVM_gclist_garbageCollect(duckVM_t *duckVM) {
+	dl_error_t e = dl_error_ok;
+
+	/**/ duckVM_gclist_clearMarks(&duckVM->gclist);
+	duckVM->gclist.marking = dl_false;
+
+	/* Mark the cells in use. */
+	e = duckVM_gclist_markRoots(duckVM, dl_true);
 	if (e) goto cleanup;
-	e = dl_array_pushElement(globals_map, &key);
+	e = duckVM_gclist_drainAll(&duckVM->gclist);
+	if (e) goto cleanup;
+	duckVM->gclist.fullCollections++;
+
+	e = duckVM_gclist_startSweeping(duckVM);
 	if (e) goto cleanup;
 
  cleanup:
 	return e;
 }
 
-/* Detect cycles in linked lists using Richard Brent's algorithm.
-   source: https://stackoverflow.com/questions/2663115/how-to-detect-a-loop-in-a-linked-list */
-dl_bool_t duckVM_listIsCyclic(duckVM_object_t *rootCons) {
-	if (rootCons == dl_null) return dl_false;
+/* Start an incremental collection. Only the roots are shaded here. The rest of the heap is marked a slice at a time as
+   objects are allocated. Objects allocated while marking start out white. */
+static dl_error_t duckVM_gclist_startMarking(duckVM_t *duckVM) {
+	/**/ duckVM_gclist_clearMarks(&duckVM->gclist);
+	duckVM->gclist.marking = dl_true;
+	return duckVM_gclist_markRoots(duckVM, dl_true);
+}
 
-	duckVM_object_t *slow = rootCons;
-	duckVM_object_t *fast = rootCons;
-	int taken = 0;
-	int limit = 2;
-	while ((fast->type == duckVM_object_type_cons) && (fast->value.cons.cdr != dl_null)) {
-		fast = fast->value.cons.cdr;
-		taken++;
-		if (slow == fast) return dl_true;
-		if (taken == limit) {
-			taken = 0;
-			limit *= 2;
-			slow = fast;
+/* Finish an incremental collection and start sweeping. The roots aren't behind a write barrier, so they are traced again, along
+   with the objects the write barrier remembered. User-defined objects can change without a write barrier too. Old ones
+   are always in the remembered set, but the ones allocated while marking have to be found in the young list. */
+static dl_error_t duckVM_gclist_finishMarking(duckVM_t *duckVM) {
+	dl_error_t e = dl_error_ok;
+	duckVM_gclist_t *gclist = &duckVM->gclist;
+
+	e = duckVM_gclist_markRoots(duckVM, dl_true);
+	if (e) goto cleanup;
+	e = duckVM_gclist_markRemembered(gclist, dl_false);
+	if (e) goto cleanup;
+	DL_DOTIMES(i, gclist->youngObjects_length) {
+		duckVM_object_t *object = gclist->youngObjects[i];
+		duckVM_gclist_chunk_t *chunk = duckVM_gclist_findChunk(gclist, object);
+		if ((object->type == duckVM_object_type_user)
+		    && (object->value.user.marker != dl_null)
+		    && DUCKVM_GCLIST_GETBIT(chunk->marks, object - chunk->objects)) {
+			e = duckVM_gclist_pushGray(gclist, object);
+			if (e) goto cleanup;
 		}
 	}
-	return dl_false;
-}
+	e = duckVM_gclist_drainAll(gclist);
+	if (e) goto cleanup;
+	gclist->marking = dl_false;
+	gclist->fullCollections++;
 
+	e = duckVM_gclist_startSweeping(duckVM);
+	if (e) goto cleanup;
 
-static dl_error_t duckVM_instruction_prepareForFuncall(duckVM_t *duckVM,
-                                                       duckVM_object_t *functionObject,
-                                                       dl_uint8_t numberOfArgs) {
+ cleanup:
+	return e;
+}
+
+/* Do some collecting before an allocation. This runs when the free list is empty, and on every allocation while an
+   incremental collection is marking. An empty free list usually just means that it's time to sweep some more. */
+static dl_error_t duckVM_gclist_collect(duckVM_t *duckVM) {
 	dl_error_t e = dl_error_ok;
 	dl_error_t eError = dl_error_ok;
+	dl_error_t eGrow = dl_error_ok;
+	duckVM_gclist_t *gclist = &duckVM->gclist;
 
-	do {
-		duckVM_object_t restListObject;
-		while (functionObject->type == duckVM_object_type_composite) {
-			*functionObject = *functionObject->value.composite->value.internalComposite.function;
+	if (gclist->marking) {
+		e = duckVM_gclist_drain(gclist, gclist->sliceBudget);
+		if (e) goto cleanup;
+		/* Minor collections can't run until marking is done, so finish early if the free list ran out. */
+		if ((gclist->grayStack.elements_length > 0) && (gclist->freeObjects_length > 0)) goto cleanup;
+		e = duckVM_gclist_finishMarking(duckVM);
+		if (e) goto cleanup;
+	}
+	else {
+		/* Marks are only cleared after the sweep is done. */
+		e = duckVM_gclist_sweepSome(duckVM);
+		if (e) goto cleanup;
+		if (gclist->freeObjects_length > 0) goto cleanup;
+
+		/* Most objects die young, so try a minor collection first. A full collection leaves about
+		   `100 - targetLivePercent` percent of the heap free. Once promoted objects have eaten `fullCollectionTrigger`
+		   percent of that, do a full collection and grow the heap if that didn't help. */
+		e = duckVM_gclist_collectYoung(duckVM);
+		if (e) goto cleanup;
+		{
+			dl_size_t fullFree = (gclist->objects_length * (100 - gclist->targetLivePercent)) / 100;
+			if ((gclist->freeObjects_length * 100) > (fullFree * (100 - gclist->fullCollectionTrigger))) goto cleanup;
 		}
-		if (functionObject->type == duckVM_object_type_function) {
-			break;
+		if (gclist->sliceBudget > 0) {
+			e = duckVM_gclist_startMarking(duckVM);
+			if (e) goto cleanup;
+			/* Marking needs free objects to allocate from while it runs, so grow now instead of after sweeping. If the
+			   heap can't grow, then finish marking in one go. */
+			(void) duckVM_gclist_grow(gclist, gclist->objects_length - gclist->freeObjects_length);
+			if (gclist->freeObjects_length > 0) goto cleanup;
+			e = duckVM_gclist_finishMarking(duckVM);
 		}
-		else if (functionObject->type != duckVM_object_type_closure) {
-			e = dl_error_invalidValue;
-			eError = duckVM_error_pushRuntime(duckVM,
-			                                  DL_STR("duckVM_execute->funcall: Object is not a callback or closure."));
-			if (!e) e = eError;
-			break;
+		else {
+			e = duckVM_gclist_garbageCollect(duckVM);
 		}
-		if (functionObject->value.closure.variadic) {
-			if (numberOfArgs < functionObject->value.closure.arity) {
-				e = dl_error_invalidValue;
-				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_execute->funcall: Too few arguments."));
-				if (!e) e = eError;
-				break;
-			}
-			/* Create list. */
-			/* The original version of this did something really dirty though it didn't look like it. It popped
-			   multiple objects off the stack, then allocated a bunch more on the heap. This is fine 99.999% of the
-			   time, but since the stack is the root the garbage collector uses to trace memory, it was possible to
-			   trigger collection of the object (and possibly all its children) during one of those allocations.
-			   Moral of the story: Never perform an allocation if you have an allocated object disconnected from the
-			   stack. */
-			/* First push the new object on the stack to register it with the collector. */
-			restListObject.value.list = dl_null;
-			restListObject.type = duckVM_object_type_list;
-			e = stack_push(duckVM, &restListObject);
-			if (e) break;
-			{
-				duckVM_object_t nil;
-				nil.value.list = dl_null;
-				nil.type = duckVM_object_type_list;
-				e = stack_push(duckVM, &nil);
-				if (e) break;
-			}
-			dl_size_t args_length = (numberOfArgs - functionObject->value.closure.arity);
-			duckVM_object_t *lastConsPtr = dl_null;
-			DL_DOTIMES(k, args_length) {
-				duckVM_object_t cons;
-				duckVM_object_t *consPtr = dl_null;
-				duckVM_object_t object;
-				duckVM_object_t *objectPtr = dl_null;
-				/* Reverse order, because lisp lists are backwards. */
-				object = DL_ARRAY_GETADDRESS(duckVM->stack,
-				                             duckVM_object_t,
-				                             duckVM->stack.elements_length - 3 - k);
-				e = duckVM_gclist_pushObject(duckVM, &objectPtr, object);
-				if (e) break;
-				cons.type = duckVM_object_type_cons;
-				cons.value.cons.car = objectPtr;
-				cons.value.cons.cdr = lastConsPtr;
-				/* Make visible to collector before allocating another. */
-				DL_ARRAY_GETADDRESS(duckVM->stack,
-				                    duckVM_object_t,
-				                    duckVM->stack.elements_length - 1).value.list = objectPtr;
-				e = duckVM_gclist_pushObject(duckVM, &consPtr, cons);
-				if (e) break;
-				/* Make visible to collector before allocating another. The object just created is linked in the
-				   cons. */
-				DL_ARRAY_GETADDRESS(duckVM->stack,
-				                    duckVM_object_t,
-				                    duckVM->stack.elements_length - 2).value.list = consPtr;
-				lastConsPtr = consPtr;
+		if (e) goto cleanup;
+	}
+
+	/* A failed allocation only matters if the collection didn't free anything. */
+	eGrow = duckVM_gclist_grow(gclist, gclist->markedObjects);
+	e = duckVM_gclist_sweepSome(duckVM);
+	if (e) goto cleanup;
+	if (eGrow && (gclist->freeObjects_length == 0)) {
+		e = eGrow;
+		eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_gclist_collect: Heap allocation failed."));
+		if (eError) e = eError;
+		goto cleanup;
+	}
+
+ cleanup:
+	return e;
+}
+
+/* Compaction */
+
+/* To-space. Live objects are copied here in the order they're reached. */
+typedef struct {
+	duckVM_gclist_t *gclist;
+	duckVM_object_t *objects;
+	dl_size_t objects_length;
+} duckVM_gclist_toSpace_t;
+
+static void duckVM_gclist_pin(duckVM_gclist_t *gclist, duckVM_object_t *object) {
+	duckVM_gclist_chunk_t *chunk = duckVM_gclist_findChunk(gclist, object);
+	if (chunk != dl_null) DUCKVM_GCLIST_SETBIT(chunk->pinned, object - chunk->objects);
+}
+
+/* Return the object's new address, copying it to to-space if it hasn't been moved yet. The old copy is left free with
+   its new address in `value.list` so that other pointers to it can find it. */
+static duckVM_object_t *duckVM_gclist_forward(duckVM_gclist_toSpace_t *toSpace, duckVM_object_t *object) {
+	duckVM_gclist_chunk_t *chunk;
+	duckVM_object_t *copy;
+	if (object == dl_null) return object;
+	/* Live objects are never free, so this must be a forwarded object. */
+	if (object->type == duckVM_object_type_none) return object->value.list;
+	/* Objects that aren't on the heap, objects that were already copied, and pinned objects stay put. */
+	if ((object >= toSpace->objects) && (object < toSpace->objects + toSpace->objects_length)) return object;
+	chunk = duckVM_gclist_findChunk(toSpace->gclist, object);
+	if ((chunk == dl_null) || DUCKVM_GCLIST_GETBIT(chunk->pinned, object - chunk->objects)) return object;
+	copy = &toSpace->objects[toSpace->objects_length++];
+	*copy = *object;
+	object->type = duckVM_object_type_none;
+	object->value.list = copy;
+	return copy;
+}
+
+/* Forward everything the object points to. Mirrors `duckVM_gclist_scanObject`. User-defined objects are skipped because
+   everything their markers report is pinned. */
+static void duckVM_gclist_forwardFields(duckVM_gclist_toSpace_t *toSpace, duckVM_object_t *object) {
+	if (object->type == duckVM_object_type_list) {
+		object->value.list = duckVM_gclist_forward(toSpace, object->value.list);
+	}
+	else if (object->type == duckVM_object_type_cons) {
+		object->value.cons.car = duckVM_gclist_forward(toSpace, object->value.cons.car);
+		object->value.cons.cdr = duckVM_gclist_forward(toSpace, object->value.cons.cdr);
+	}
+	else if (object->type == duckVM_object_type_closure) {
+		object->value.closure.upvalue_array = duckVM_gclist_forward(toSpace, object->value.closure.upvalue_array);
+		object->value.closure.bytecode = duckVM_gclist_forward(toSpace, object->value.closure.bytecode);
+	}
+	else if (object->type == duckVM_object_type_upvalue) {
+		if (object->value.upvalue.type == duckVM_upvalue_type_heap_object) {
+			object->value.upvalue.value.heap_object = duckVM_gclist_forward(toSpace,
+			                                                                object->value.upvalue.value.heap_object);
+		}
+		else if (object->value.upvalue.type == duckVM_upvalue_type_heap_upvalue) {
+			object->value.upvalue.value.heap_upvalue = duckVM_gclist_forward(toSpace,
+			                                                                 object->value.upvalue.value.heap_upvalue);
+		}
+	}
+	else if (object->type == duckVM_object_type_upvalueArray) {
+		/* The payload doesn't move, so copies of the array on the upvalue array call stack see the new pointers too. */
+		DL_DOTIMES(k, object->value.upvalue_array.length) {
+			object->value.upvalue_array.upvalues[k] = duckVM_gclist_forward(toSpace,
+			                                                                object->value.upvalue_array.upvalues[k]);
+		}
+	}
+	else if (object->type == duckVM_object_type_vector) {
+		object->value.vector.internal_vector = duckVM_gclist_forward(toSpace, object->value.vector.internal_vector);
+	}
+	else if (object->type == duckVM_object_type_internalVector) {
+		if (object->value.internal_vector.initialized) {
+			DL_DOTIMES(k, object->value.internal_vector.length) {
+				object->value.internal_vector.values[k] = duckVM_gclist_forward(toSpace,
+				                                                                object->value.internal_vector.values[k]);
 			}
-			if (e) break;
-			/* Pop the temporary object. */
-			e = stack_pop(duckVM, dl_null);
-			if (e) break;
-			/* Copy the list to the proper position. */
-			restListObject.value.list = lastConsPtr;
-			DL_ARRAY_GETADDRESS(duckVM->stack,
-			                    duckVM_object_t,
-			                    (duckVM->stack.elements_length - 1 - args_length)) = restListObject;
-			/* Pop all objects other than the list. */
-			e = stack_pop_multiple(duckVM, args_length);
-			if (e) break;
 		}
-		else {
-			if (functionObject->value.closure.arity != numberOfArgs) {
-				e = dl_error_invalidValue;
-				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_execute->funcall: Incorrect number of arguments."));
-				if (!e) e = eError;
-				break;
+	}
+	else if (object->type == duckVM_object_type_string) {
+		object->value.string.internalString = duckVM_gclist_forward(toSpace, object->value.string.internalString);
+	}
+	else if (object->type == duckVM_object_type_symbol) {
+		object->value.symbol.internalString = duckVM_gclist_forward(toSpace, object->value.symbol.internalString);
+	}
+	else if (object->type == duckVM_object_type_composite) {
+		object->value.composite = duckVM_gclist_forward(toSpace, object->value.composite);
+	}
+	else if (object->type == duckVM_object_type_internalComposite) {
+		object->value.internalComposite.value = duckVM_gclist_forward(toSpace, object->value.internalComposite.value);
+		object->value.internalComposite.function = duckVM_gclist_forward(toSpace,
+		                                                                 object->value.internalComposite.function);
+	}
+}
+
+/* Pin the objects that C code might have pointers to: objects pinned through the API, user-defined objects, and
+   everything the markers of user-defined objects report. Only marked objects are looked at, so call this right after
+   a full collection. */
+static dl_error_t duckVM_gclist_pinAll(duckVM_gclist_t *gclist) {
+	dl_error_t e = dl_error_ok;
+
+	DL_DOTIMES(i, gclist->pinnedObjects.elements_length) {
+		/**/ duckVM_gclist_pin(gclist, DL_ARRAY_GETADDRESS(gclist->pinnedObjects, duckVM_object_t *, i));
+	}
+	DL_DOTIMES(i, gclist->chunks_length) {
+		duckVM_gclist_chunk_t *chunk = &gclist->chunks[i];
+		DL_DOTIMES(j, chunk->objects_length) {
+			duckVM_object_t *object = &chunk->objects[j];
+			if (!DUCKVM_GCLIST_GETBIT(chunk->marks, j) || (object->type != duckVM_object_type_user)) continue;
+			DUCKVM_GCLIST_SETBIT(chunk->pinned, j);
+			if (object->value.user.marker) {
+				/* The gray stack is empty after a full collection, so borrow it. */
+				e = object->value.user.marker(gclist, &gclist->grayStack, object);
+				if (e) goto cleanup;
+				DL_DOTIMES(k, gclist->grayStack.elements_length) {
+					duckVM_object_t *child = DL_ARRAY_GETADDRESS(gclist->grayStack, duckVM_object_t *, k);
+					if (child != dl_null) /**/ duckVM_gclist_pin(gclist, child);
+				}
+				gclist->grayStack.elements_length = 0;
 			}
 		}
-	} while (0);
-	return e;
-}                
+	}
 
+ cleanup:
+	gclist->grayStack.elements_length = 0;
+	return e;
+}
 
-int duckVM_executeInstruction(duckVM_t *duckVM,
-                              duckVM_object_t *bytecode,
-                              unsigned char **ipPtr,
-                              duckVM_halt_mode_t *halt) {
+/* Mostly-copying compaction. Live objects that aren't pinned are copied breadth-first from the roots into a new chunk,
+   and then chunks that don't have anything left in them are freed. Objects are only copied once the to-space chunk
+   has been allocated, so the heap is untouched if that fails. */
+static dl_error_t duckVM_gclist_compact(duckVM_t *duckVM) {
 	dl_error_t e = dl_error_ok;
 	dl_error_t eError = dl_error_ok;
+	duckVM_gclist_t *gclist = &duckVM->gclist;
+	duckVM_gclist_toSpace_t toSpace;
+	dl_size_t movable = 0;
+	dl_size_t kept = 0;  /* Objects in chunks that have pinned objects */
+	dl_size_t length;
 
-	dl_uint8_t *ptr1 = dl_null;
-	dl_ptrdiff_t ptrdiff1 = 0;
-	dl_ptrdiff_t ptrdiff2 = 0;
-	dl_ptrdiff_t ptrdiff3 = 0;
-	dl_size_t size1 = 0;
-	dl_size_t size2 = 0;
-	dl_uint8_t uint8 = 0;
-	duckVM_object_t object1 = {0};
-	duckVM_object_t object2 = {0};
-	duckVM_object_t object3 = {0};
-	duckVM_object_t *objectPtr1 = {0};
-	duckVM_object_t *objectPtr2 = {0};
-	duckVM_object_t cons1 = {0};
-	dl_bool_t bool1 = dl_false;
-	dl_bool_t parsedBytecode = dl_false;
-	unsigned char *ip = *ipPtr;
-	unsigned char opcode = *(ip++);
-	switch (opcode) {
-	case duckLisp_instruction_nop:
-		break;
+	/* Everything that is left after this is live, and everything else is free. */
+	e = duckVM_gclist_garbageCollect(duckVM);
+	if (e) goto cleanup;
+	e = duckVM_gclist_finishSweeping(duckVM);
+	if (e) goto cleanup;
 
-	case duckLisp_instruction_pushSymbol32:
-		size2 = *(ip++);
-		size2 = *(ip++) + (size2 << 8);
-		size2 = *(ip++) + (size2 << 8);
-		size2 = *(ip++) + (size2 << 8);
-		size1 = *(ip++);
-		size1 = *(ip++) + (size1 << 8);
-		size1 = *(ip++) + (size1 << 8);
-		size1 = *(ip++) + (size1 << 8);
-		parsedBytecode = dl_true;
-		/* Fall through */
-	case duckLisp_instruction_pushSymbol16:
-		if (!parsedBytecode) {
-			size2 = *(ip++);
-			size2 = *(ip++) + (size2 << 8);
-			size1 = *(ip++);
-			size1 = *(ip++) + (size1 << 8);
-			parsedBytecode = dl_true;
-		}
-		/* Fall through */
-	case duckLisp_instruction_pushSymbol8:
-		if (!parsedBytecode) {
-			size2 = *(ip++);
-			size1 = *(ip++);
-		}
-		{
-			dl_uint8_t *lastIp = ip;
-			ip += size1;
-			e = duckVM_object_makeSymbol(duckVM, &object1, size2, lastIp, size1);
-			if (e) break;
-		}
-		e = stack_push(duckVM, &object1);
-		if (e) {
-			eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->push-symbol: stack_push failed."));
-			if (!e) e = eError;
+	e = duckVM_gclist_pinAll(gclist);
+	if (e) goto cleanup;
+	gclist->compactions++;
+	DL_DOTIMES(i, gclist->chunks_length) {
+		duckVM_gclist_chunk_t *chunk = &gclist->chunks[i];
+		dl_bool_t hasPinned = dl_false;
+		DL_DOTIMES(j, DUCKVM_GCLIST_BITMAP_LENGTH(chunk->objects_length)) {
+			dl_uint64_t unpinned = chunk->marks[j] & ~chunk->pinned[j];
+			if (chunk->pinned[j]) hasPinned = dl_true;
+			for (; unpinned; unpinned &= unpinned - 1) movable++;
 		}
-		break;
+		if (hasPinned) kept += chunk->objects_length;
+	}
+	if (movable == 0) goto cleanup;
 
-	case duckLisp_instruction_pushStrippedSymbol32:
-		size2 = *(ip++);
-		size2 = *(ip++) + (size2 << 8);
-		size2 = *(ip++) + (size2 << 8);
-		size2 = *(ip++) + (size2 << 8);
-		parsedBytecode = dl_true;
-		/* Fall through */
-	case duckLisp_instruction_pushStrippedSymbol16:
-		if (!parsedBytecode) {
-			size2 = *(ip++);
-			size2 = *(ip++) + (size2 << 8);
-			parsedBytecode = dl_true;
-		}
-		/* Fall through */
-	case duckLisp_instruction_pushStrippedSymbol8:
-		if (!parsedBytecode) {
-			size2 = *(ip++);
-		}
-		(void) duckVM_object_makeCompressedSymbol(&object1, size2);
-		e = stack_push(duckVM, &object1);
-		if (e) {
-			eError = duckVM_error_pushRuntime(duckVM,
-			                                  DL_STR("duckVM_execute->push-stripped-symbol: stack_push failed."));
-			if (!e) e = eError;
-		}
-		break;
+	/* Leave room to allocate in, like `duckVM_gclist_grow` does, but don't go over the cap unless there's no choice. */
+	length = dl_max((movable * 100) / gclist->targetLivePercent + 1, gclist->minimumGrowth);
+	if (kept + length > gclist->maxObjects) {
+		length = dl_max(movable, (gclist->maxObjects > kept) ? gclist->maxObjects - kept : 0);
+	}
+	e = duckVM_gclist_addChunk(gclist, length);
+	if (e) {
+		eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_compact: Heap allocation failed."));
+		if (eError) e = eError;
+		goto cleanup;
+	}
+	/* `duckVM_gclist_addChunk` pushes the new chunk's objects in reverse, so the first object is on top. */
+	toSpace.gclist = gclist;
+	toSpace.objects = gclist->freeObjects[gclist->freeObjects_length - 1];
+	toSpace.objects_length = 0;
 
-	case duckLisp_instruction_pushString32:
-		size1 = *(ip++);
-		size1 = *(ip++) + (size1 << 8);
-		// Fall through
-	case duckLisp_instruction_pushString16:
-		size1 = *(ip++) + (size1 << 8);
-		// Fall through
-	case duckLisp_instruction_pushString8:
-		size1 = *(ip++) + (size1 << 8);
-		{
-			dl_uint8_t *string = ip;
-			dl_size_t string_length = size1;
-			ip += size1;
-			e = duckVM_object_makeString(duckVM, &object1, string, string_length);
-			if (e) {
-				(eError
-				 = duckVM_error_pushRuntime(duckVM,
-				                            DL_STR("duckVM_execute->push-string: duckVM_object_makeString failed.")));
-				if (!e) e = eError;
-			}
-			e = stack_push(duckVM, &object1);
-			if (e) {
-				eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->push-string: stack_push failed."));
-				if (!e) e = eError;
+	/* Roots. The stack's objects aren't on the heap, so only their contents are forwarded. */
+	DL_DOTIMES(i, duckVM->stack.elements_length) {
+		/**/ duckVM_gclist_forwardFields(&toSpace, &DL_ARRAY_GETADDRESS(duckVM->stack, duckVM_object_t, i));
+	}
+	DL_DOTIMES(i, duckVM->upvalue_stack.elements_length) {
+		duckVM_object_t **upvalue = &DL_ARRAY_GETADDRESS(duckVM->upvalue_stack, duckVM_object_t *, i);
+		*upvalue = duckVM_gclist_forward(&toSpace, *upvalue);
+	}
+	DL_DOTIMES(i, duckVM->globals.elements_length) {
+		duckVM_object_t **global = &DL_ARRAY_GETADDRESS(duckVM->globals, duckVM_object_t *, i);
+		*global = duckVM_gclist_forward(&toSpace, *global);
+	}
+	DL_DOTIMES(i, duckVM->call_stack.elements_length) {
+		duckVM_callFrame_t *frame = &DL_ARRAY_GETADDRESS(duckVM->call_stack, duckVM_callFrame_t, i);
+		frame->bytecode = duckVM_gclist_forward(&toSpace, frame->bytecode);
+		frame->tailcallBytecode = duckVM_gclist_forward(&toSpace, frame->tailcallBytecode);
+		frame->tailcallUpvalueArray = duckVM_gclist_forward(&toSpace, frame->tailcallUpvalueArray);
+	}
+	duckVM->suspendedBytecode = duckVM_gclist_forward(&toSpace, duckVM->suspendedBytecode);
+	/* Pinned objects stay put, but the things they point to don't. The to-space chunk has no pinned objects. */
+	DL_DOTIMES(i, gclist->chunks_length) {
+		duckVM_gclist_chunk_t *chunk = &gclist->chunks[i];
+		DL_DOTIMES(j, chunk->objects_length) {
+			if (DUCKVM_GCLIST_GETBIT(chunk->pinned, j)) {
+				/**/ duckVM_gclist_forwardFields(&toSpace, &chunk->objects[j]);
 			}
 		}
-		break;
-
-	case duckLisp_instruction_pushBooleanFalse:
-		object1 = duckVM_object_makeBoolean(dl_false);
-		e = stack_push(duckVM, &object1);
-		if (e) {
-			eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->push-boolean-false: stack_push failed."));
-			if (!e) e = eError;
-		}
-		break;
-	case duckLisp_instruction_pushBooleanTrue:
-		object1 = duckVM_object_makeBoolean(dl_true);
-		e = stack_push(duckVM, &object1);
-		if (e) {
-			eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->push-boolean-true: stack_push failed."));
-			if (!e) e = eError;
-		}
-		break;
-
-	case duckLisp_instruction_pushInteger32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		parsedBytecode = dl_true;
-		size1 = 0x7FFFFFFF;
-		/* Fall through */
-	case duckLisp_instruction_pushInteger16:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			size1 = 0x7FFF;
-			parsedBytecode = dl_true;
-		}
-		/* Fall through */
-	case duckLisp_instruction_pushInteger8:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			size1 = 0x7F;
-		}
-
-		ptrdiff1 = (((dl_size_t) ptrdiff1 > size1)
-		            ? (dl_ptrdiff_t) (~size1 | (dl_size_t) ptrdiff1)
-		            : ptrdiff1);
-		object1 = duckVM_object_makeInteger(ptrdiff1);
-		e = stack_push(duckVM, &object1);
-		if (e) {
-			eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->push-integer: stack_push failed."));
-			if (!e) e = eError;
-		}
-		break;
-
-	case duckLisp_instruction_pushDoubleFloat: {
-		dl_uint64_t totallyNotADoubleFloat = 0;
-		totallyNotADoubleFloat = *(ip++);
-		totallyNotADoubleFloat = *(ip++) + (totallyNotADoubleFloat << 8);
-		totallyNotADoubleFloat = *(ip++) + (totallyNotADoubleFloat << 8);
-		totallyNotADoubleFloat = *(ip++) + (totallyNotADoubleFloat << 8);
-		totallyNotADoubleFloat = *(ip++) + (totallyNotADoubleFloat << 8);
-		totallyNotADoubleFloat = *(ip++) + (totallyNotADoubleFloat << 8);
-		totallyNotADoubleFloat = *(ip++) + (totallyNotADoubleFloat << 8);
-		totallyNotADoubleFloat = *(ip++) + (totallyNotADoubleFloat << 8);
-		object1 = duckVM_object_makeFloat(*((double *) &totallyNotADoubleFloat));
-		e = stack_push(duckVM, &object1);
-		if (e) {
-			eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->push-double-float: stack_push failed."));
-			if (!e) e = eError;
-		}
-		break;
 	}
 
-	case duckLisp_instruction_pushIndex32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		// Fall through
-	case duckLisp_instruction_pushIndex16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		// Fall through
-	case duckLisp_instruction_pushIndex8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
-		if (e) {
-			eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->push-index: dl_array_get failed."));
-			if (!e) e = eError;
-			break;
-		}
-		e = stack_push(duckVM, &object1);
-		if (e) {
-			eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->push-index: stack_push failed."));
-			if (!e) e = eError;
-		}
-		break;
+	/* Cheney scan. Everything between here and the end of to-space has been copied but its contents haven't been
+	   forwarded yet. */
+	for (dl_size_t scan = 0; scan < toSpace.objects_length; scan++) {
+		/**/ duckVM_gclist_forwardFields(&toSpace, &toSpace.objects[scan]);
+	}
+	gclist->pauseWork += toSpace.objects_length;
 
-	case duckLisp_instruction_pushUpvalue32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through */
-	case duckLisp_instruction_pushUpvalue16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through */
-	case duckLisp_instruction_pushUpvalue8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		{
-			duckVM_upvalueArray_t upvalueArray;
-			if (ptrdiff1 < 0) {
-				e = dl_error_invalidValue;
-				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_execute->push-upvalue: Index pointing to upvalue is negative."));
-				if (!e) e = eError;
-				break;
-			}
-			e = dl_array_getTop(&duckVM->upvalue_array_call_stack, &upvalueArray);
-			if (e) {
-				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_execute->push-upvalue: dl_array_get failed."));
-				if (!e) e = eError;
-				break;
+	/* Moved objects are marked in their new home, and free chunks are dropped. */
+	{
+		dl_size_t chunks_length = 0;
+		DL_DOTIMES(i, gclist->chunks_length) {
+			duckVM_gclist_chunk_t *chunk = &gclist->chunks[i];
+			dl_bool_t live = dl_false;
+			if (chunk->objects == toSpace.objects) {
+				DL_DOTIMES(j, toSpace.objects_length) {
+					DUCKVM_GCLIST_SETBIT(chunk->marks, j);
+				}
+				live = dl_true;
 			}
-			e = duckVM_upvalueArray_getUpvalue(duckVM, upvalueArray, &object1, ptrdiff1);
-			if (e) {
-				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_execute->push-upvalue: duckVM_upvalueArray_getUpvalue failed."));
-				if (!e) e = eError;
-				break;
+			else {
+				DL_DOTIMES(j, chunk->objects_length) {
+					if (chunk->objects[j].type == duckVM_object_type_none) {
+						DUCKVM_GCLIST_CLEARBIT(chunk->marks, j);
+					}
+					else if (DUCKVM_GCLIST_GETBIT(chunk->marks, j)) {
+						live = dl_true;
+					}
+				}
 			}
-			e = stack_push(duckVM, &object1);
-			if (e) {
-				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_execute->push-upvalue: stack_push failed."));
-				if (!e) e = eError;
-				break;
+			if (live) {
+				gclist->chunks[chunks_length++] = *chunk;
+				continue;
 			}
-			break;
+			gclist->objects_length -= chunk->objects_length;
+			eError = DL_FREE(gclist->memoryAllocation, &chunk->objects);
+			if (eError) e = eError;
+			eError = DL_FREE(gclist->memoryAllocation, &chunk->marks);
+			if (eError) e = eError;
+			eError = DL_FREE(gclist->memoryAllocation, &chunk->remembered);
+			if (eError) e = eError;
+			eError = DL_FREE(gclist->memoryAllocation, &chunk->pinned);
+			if (eError) e = eError;
 		}
+		gclist->chunks_length = chunks_length;
+	}
 
-	case duckLisp_instruction_pushClosure32:
-		/* Fall through */
-	case duckLisp_instruction_pushVaClosure32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptr1 = ip;
-		if (ptrdiff1 & 0x80000000ULL) {
-			ptrdiff1 = -((~ptrdiff1 + 1) & 0xFFFFFFFFULL);
-		}
-		parsedBytecode = dl_true;
-		/* Fall through */
-	case duckLisp_instruction_pushClosure16:
-		/* Fall through */
-	case duckLisp_instruction_pushVaClosure16:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			ptr1 = ip;
-			if (ptrdiff1 & 0x8000ULL) {
-				ptrdiff1 = -((~ptrdiff1 + 1) & 0xFFFFULL);
-			}
-			parsedBytecode = dl_true;
-		}
-		/* Fall through */
-	case duckLisp_instruction_pushClosure8:
-		/* Fall through */
-	case duckLisp_instruction_pushVaClosure8:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptr1 = ip;
-			if (ptrdiff1 & 0x80ULL) {
-				ptrdiff1 = -((~ptrdiff1 + 1) & 0xFFULL);
-			}
-		}
+	/* The free list still points into the chunks that were freed, so build it again. Nothing is left to free, since
+	   garbage was freed before compacting and moved objects look free. */
+	gclist->freeObjects_length = 0;
+	DL_DOTIMES(i, gclist->chunks_length) {
+		gclist->chunks[i].swept = 0;
+	}
+	gclist->sweepChunk = 0;
+	eError = duckVM_gclist_finishSweeping(duckVM);
+	if (eError) e = eError;
 
-		object1 = duckVM_object_makeClosure(ptrdiff1,
-		                                    bytecode,
-		                                    dl_null,
-		                                    *(ip++),
-		                                    ((opcode == duckLisp_instruction_pushVaClosure32)
-		                                     || (opcode == duckLisp_instruction_pushVaClosure16)
-		                                     || (opcode == duckLisp_instruction_pushVaClosure8)));
+ cleanup:
+	DL_DOTIMES(i, gclist->chunks_length) {
+		duckVM_gclist_chunk_t *chunk = &gclist->chunks[i];
+		/**/ dl_memclear(chunk->pinned, DUCKVM_GCLIST_BITMAP_LENGTH(chunk->objects_length) * sizeof(dl_uint64_t));
+	}
+	return e;
+}
 
-		size1 = *(ip++);
-		size1 = *(ip++) + (size1 << 8);
-		size1 = *(ip++) + (size1 << 8);
-		size1 = *(ip++) + (size1 << 8);
+/* Heap dumps */
 
-		object1.value.closure.name += ptr1 - bytecode->value.bytecode.bytecode;
+typedef struct {
+	duckVM_gclist_t *gclist;
+	dl_array_t *snapshot;
+	/* The ID of each chunk's first object. IDs count heap slots from one, so that zero can mean null. */
+	dl_size_t *chunkIds;
+	/* Children reported by user-defined markers. */
+	dl_array_t children;
+} duckVM_gclist_heapDump_t;
 
-		/* This could also point to a static version instead since this array is never changed
-		   and multiple closures could use the same array. */
+static dl_error_t duckVM_gclist_heapDump_pushByte(duckVM_gclist_heapDump_t *dump, dl_uint8_t byte) {
+	return dl_array_pushElement(dump->snapshot, &byte);
+}
 
-		e = duckVM_gclist_pushObject(duckVM,
-		                             &object1.value.closure.upvalue_array,
-		                             duckVM_object_makeUpvalueArray(dl_null, size1));
-		if (e) {
-			eError = duckVM_error_pushRuntime(duckVM,
-			                                  DL_STR("duckVM_execute->push-closure: duckVM_gclist_pushObject failed."));
-			if (!e) e = eError;
-			break;
+/* Integers are written as eight bytes, least significant first, no matter what the host's word size is. */
+static dl_error_t duckVM_gclist_heapDump_pushInteger(duckVM_gclist_heapDump_t *dump, dl_uint64_t integer) {
+	dl_uint8_t bytes[8];
+	DL_DOTIMES(i, 8) {
+		bytes[i] = (integer >> (8 * i)) & 0xFF;
+	}
+	return dl_array_pushElements(dump->snapshot, bytes, 8);
+}
+
+static dl_uint64_t duckVM_gclist_heapDump_id(duckVM_gclist_heapDump_t *dump, duckVM_object_t *object) {
+	duckVM_gclist_chunk_t *chunk;
+	if (object == dl_null) return 0;
+	chunk = duckVM_gclist_findChunk(dump->gclist, object);
+	if (chunk == dl_null) return 0;
+	return dump->chunkIds[chunk - dump->gclist->chunks] + (object - chunk->objects);
+}
+
+/* Collect the objects that the object points to in `children`. Mirrors `duckVM_gclist_scanObject`. */
+static dl_error_t duckVM_gclist_heapDump_children(duckVM_gclist_heapDump_t *dump, duckVM_object_t *object) {
+	dl_error_t e = dl_error_ok;
+	dl_array_t *children = &dump->children;
+	children->elements_length = 0;
+
+	if (object->type == duckVM_object_type_list) {
+		e = dl_array_pushElement(children, &object->value.list);
+	}
+	else if (object->type == duckVM_object_type_cons) {
+		e = dl_array_pushElement(children, &object->value.cons.car);
+		if (e) goto cleanup;
+		e = dl_array_pushElement(children, &object->value.cons.cdr);
+	}
+	else if (object->type == duckVM_object_type_closure) {
+		e = dl_array_pushElement(children, &object->value.closure.upvalue_array);
+		if (e) goto cleanup;
+		e = dl_array_pushElement(children, &object->value.closure.bytecode);
+	}
+	else if (object->type == duckVM_object_type_upvalue) {
+		if (object->value.upvalue.type == duckVM_upvalue_type_heap_object) {
+			e = dl_array_pushElement(children, &object->value.upvalue.value.heap_object);
 		}
-		duckVM_upvalueArray_t upvalueArray;
-		e = duckVM_closure_getUpvalueArray(object1.value.closure, &upvalueArray);
-		if (e) break;
-		DL_DOTIMES(k, upvalueArray.length) {
-			upvalueArray.upvalues[k] = dl_null;
+		else if (object->value.upvalue.type == duckVM_upvalue_type_heap_upvalue) {
+			e = dl_array_pushElement(children, &object->value.upvalue.value.heap_upvalue);
 		}
-		/* Immediately push on stack so that the GC can see it. Allocating upvalues could trigger a GC. */
-		e = dl_array_pushElement(&duckVM->stack, &object1);
-		if (e) {
-			eError = duckVM_error_pushRuntime(duckVM,
-			                                  DL_STR("duckVM_execute->push-closure: dl_array_pushElement failed."));
-			if (!e) e = eError;
-			break;
+	}
+	else if (object->type == duckVM_object_type_upvalueArray) {
+		e = dl_array_pushElements(children, object->value.upvalue_array.upvalues, object->value.upvalue_array.length);
+	}
+	else if (object->type == duckVM_object_type_vector) {
+		e = dl_array_pushElement(children, &object->value.vector.internal_vector);
+	}
+	else if (object->type == duckVM_object_type_internalVector) {
+		if (object->value.internal_vector.initialized) {
+			e = dl_array_pushElements(children,
+			                          object->value.internal_vector.values,
+			                          object->value.internal_vector.length);
 		}
+	}
+	else if (object->type == duckVM_object_type_string) {
+		e = dl_array_pushElement(children, &object->value.string.internalString);
+	}
+	else if (object->type == duckVM_object_type_symbol) {
+		e = dl_array_pushElement(children, &object->value.symbol.internalString);
+	}
+	else if (object->type == duckVM_object_type_composite) {
+		e = dl_array_pushElement(children, &object->value.composite);
+	}
+	else if (object->type == duckVM_object_type_internalComposite) {
+		e = dl_array_pushElement(children, &object->value.internalComposite.value);
+		if (e) goto cleanup;
+		e = dl_array_pushElement(children, &object->value.internalComposite.function);
+	}
+	else if ((object->type == duckVM_object_type_user) && object->value.user.marker) {
+		e = object->value.user.marker(dump->gclist, children, object);
+	}
 
-		dl_bool_t recursive = dl_false;
+ cleanup:
+	return e;
+}
 
-		DL_DOTIMES(k, upvalueArray.length) {
-			ptrdiff1 = *(ip++);
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			if (ptrdiff1 > 0x7FFFFFFF) {
-				/* Nested upvalue */
-				ptrdiff1 = -(0x100000000 - ptrdiff1);
-			}
-			else {
-				/* Normal upvalue */
-				/* stack - 1 because we already pushed. */
-				ptrdiff1 = (duckVM->stack.elements_length - 1) - ptrdiff1;
-				if ((ptrdiff1 < 0) || ((dl_size_t) ptrdiff1 > duckVM->upvalue_stack.elements_length)) {
-					e = dl_error_invalidValue;
-					eError = duckVM_error_pushRuntime(duckVM,
-					                                  DL_STR("duckVM_execute->push-closure: Stack index out of bounds."));
-					if (!e) e = eError;
-					break;
-				}
-			}
-			duckVM_object_t *upvalue_pointer = dl_null;
-			if ((dl_size_t) ptrdiff1 == duckVM->upvalue_stack.elements_length) {
-				/* *Recursion* Capture upvalue we are about to push. This should only happen once. */
-				recursive = dl_true;
-				/* Our upvalue definitely doesn't exist yet. */
-				duckVM_object_t upvalue;
-				upvalue.type = duckVM_object_type_upvalue;
-				upvalue.value.upvalue.type = duckVM_upvalue_type_stack_index;  /* Lie for now. */
-				upvalue.value.upvalue.value.stack_index = ptrdiff1;
-				e = duckVM_gclist_pushObject(duckVM, &upvalue_pointer, upvalue);
-				if (e) {
-					e = dl_error_shouldntHappen;
-					eError = duckVM_error_pushRuntime(duckVM,
-					                                  DL_STR("duckVM_execute->push-closure: duckVM_gclist_pushObject failed."));
-					if (!e) e = eError;
-					break;
-				}
-				/* Break push_scope abstraction. */
-				e = dl_array_pushElement(&duckVM->upvalue_stack, dl_null);
-				if (e) {
-					e = dl_error_shouldntHappen;
-					(eError
-					 = duckVM_error_pushRuntime(duckVM,
-					                            DL_STR("duckVM_execute->push-closure: dl_array_pushElement failed.")));
-					if (!e) e = eError;
-					break;
-				}
-				/* Upvalue stack slot exists now, so insert the new UV. */
-				DL_ARRAY_GETADDRESS(duckVM->upvalue_stack, duckVM_object_t *, ptrdiff1) = upvalue_pointer;
-			}
-			else if (ptrdiff1 < 0) {
-				/* Capture upvalue in currently executing function. */
-				ptrdiff1 = -(ptrdiff1 + 1);
-				duckVM_object_t upvalue;
-				upvalue.type = duckVM_object_type_upvalue;
-				upvalue.value.upvalue.type = duckVM_upvalue_type_heap_upvalue;
-				/* Link new upvalue to upvalue from current context. */
-				upvalue.value.upvalue.value.heap_upvalue = (DL_ARRAY_GETTOPADDRESS(duckVM->upvalue_array_call_stack,
-				                                                                   duckVM_upvalueArray_t)
-				                                            .upvalues[ptrdiff1]);
-				e = duckVM_gclist_pushObject(duckVM, &upvalue_pointer, upvalue);
-				if (e) {
-					eError = duckVM_error_pushRuntime(duckVM,
-					                                  DL_STR("duckVM_execute->push-closure: duckVM_gclist_pushObject failed."));
-					if (!e) e = eError;
-					break;
-				}
-			}
-			else {
-				/* Capture upvalue on stack. */
-				e = dl_array_get(&duckVM->upvalue_stack, &upvalue_pointer, ptrdiff1);
-				if (e) {
-					eError = duckVM_error_pushRuntime(duckVM,
-					                                  DL_STR("duckVM_execute->push-closure: Retrieval of upvalue from upvalue stack failed."));
-					if (!e) e = eError;
-					break;
-				}
-				if (upvalue_pointer == dl_null) {
-					duckVM_object_t upvalue;
-					upvalue.type = duckVM_object_type_upvalue;
-					upvalue.value.upvalue.type = duckVM_upvalue_type_stack_index;
-					upvalue.value.upvalue.value.stack_index = ptrdiff1;
-					e = duckVM_gclist_pushObject(duckVM, &upvalue_pointer, upvalue);
-					if (e) {
-						eError = duckVM_error_pushRuntime(duckVM,
-						                                  DL_STR("duckVM_execute->push-closure: duckVM_gclist_pushObject failed."));
-						if (!e) e = eError;
-						break;
-					}
-					// Is this a bug? I'm not confident that this element exists.
-					/* Keep reference to upvalue on stack so that we know where to release the object to. */
-					DL_ARRAY_GETADDRESS(duckVM->upvalue_stack, duckVM_object_t *, ptrdiff1) = upvalue_pointer;
-				}
-				if (upvalue_pointer->type != duckVM_object_type_upvalue) {
-					e = dl_error_shouldntHappen;
-					eError = duckVM_error_pushRuntime(duckVM,
-					                                  DL_STR("duckVM_execute->push-closure: Captured object is not an upvalue."));
-					if (!e) e = eError;
-					break;
-				}
-			}
-			if (e) break;
-			upvalueArray.upvalues[k] = upvalue_pointer;
+static dl_error_t duckVM_gclist_heapDump_pushObject(duckVM_gclist_heapDump_t *dump, duckVM_object_t *object) {
+	dl_error_t e = dl_error_ok;
+	dl_size_t size = sizeof(duckVM_object_t);
+	dl_size_t references = 0;
+
+	if (object->type == duckVM_object_type_upvalueArray) {
+		size += duckVM_gclist_payloadSize(object->value.upvalue_array.upvalues);
+	}
+	else if ((object->type == duckVM_object_type_internalVector) && object->value.internal_vector.initialized) {
+		size += duckVM_gclist_payloadSize(object->value.internal_vector.values);
+	}
+	else if (object->type == duckVM_object_type_bytecode) {
+		size += duckVM_gclist_payloadSize(object->value.bytecode.bytecode);
+		size += duckVM_gclist_payloadSize(object->value.bytecode.decoded);
+	}
+	else if (object->type == duckVM_object_type_internalString) {
+		size += duckVM_gclist_payloadSize(object->value.internalString.value);
+	}
+
+	e = duckVM_gclist_heapDump_children(dump, object);
+	if (e) goto cleanup;
+	/* Null children and objects that aren't on the heap are left out. */
+	DL_DOTIMES(i, dump->children.elements_length) {
+		duckVM_object_t *child = DL_ARRAY_GETADDRESS(dump->children, duckVM_object_t *, i);
+		if (duckVM_gclist_heapDump_id(dump, child) != 0) references++;
+	}
+
+	e = duckVM_gclist_heapDump_pushInteger(dump, duckVM_gclist_heapDump_id(dump, object));
+	if (e) goto cleanup;
+	e = duckVM_gclist_heapDump_pushByte(dump, object->type);
+	if (e) goto cleanup;
+	e = duckVM_gclist_heapDump_pushInteger(dump, size);
+	if (e) goto cleanup;
+	e = duckVM_gclist_heapDump_pushInteger(dump, references);
+	if (e) goto cleanup;
+	DL_DOTIMES(i, dump->children.elements_length) {
+		dl_uint64_t id = duckVM_gclist_heapDump_id(dump, DL_ARRAY_GETADDRESS(dump->children, duckVM_object_t *, i));
+		if (id == 0) continue;
+		e = duckVM_gclist_heapDump_pushInteger(dump, id);
+		if (e) goto cleanup;
+	}
+
+ cleanup:
+	return e;
+}
+
+static dl_error_t duckVM_gclist_heapDump_pushRoot(duckVM_gclist_heapDump_t *dump,
+                                                  duckVM_heapRoot_t category,
+                                                  dl_size_t index,
+                                                  duckVM_object_t *object,
+                                                  dl_size_t *roots_length) {
+	dl_error_t e = dl_error_ok;
+	dl_uint64_t id = duckVM_gclist_heapDump_id(dump, object);
+	if (id == 0) return e;
+	e = duckVM_gclist_heapDump_pushByte(dump, category);
+	if (e) return e;
+	e = duckVM_gclist_heapDump_pushInteger(dump, index);
+	if (e) return e;
+	e = duckVM_gclist_heapDump_pushInteger(dump, id);
+	if (e) return e;
+	(*roots_length)++;
+	return e;
+}
+
+/* Visits the same roots as `duckVM_gclist_markRoots`. */
+static dl_error_t duckVM_gclist_heapDump_pushRoots(duckVM_t *duckVM,
+                                                   duckVM_gclist_heapDump_t *dump,
+                                                   dl_size_t *roots_length) {
+	dl_error_t e = dl_error_ok;
+
+	DL_DOTIMES(i, duckVM->stack.elements_length) {
+		e = duckVM_gclist_heapDump_children(dump, &DL_ARRAY_GETADDRESS(duckVM->stack, duckVM_object_t, i));
+		if (e) goto cleanup;
+		DL_DOTIMES(j, dump->children.elements_length) {
+			e = duckVM_gclist_heapDump_pushRoot(dump,
+			                                    duckVM_heapRoot_stack,
+			                                    i,
+			                                    DL_ARRAY_GETADDRESS(dump->children, duckVM_object_t *, j),
+			                                    roots_length);
+			if (e) goto cleanup;
 		}
-		if (e) break;
-		if (!recursive) {
-			/* Break push_scope abstraction. */
-			e = dl_array_pushElement(&duckVM->upvalue_stack, dl_null);
-			if (e) {
-				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_execute->push-closure: dl_array_pushElement failed."));
-				if (!e) e = eError;
-				break;
-			}
+	}
+	DL_DOTIMES(i, duckVM->upvalue_stack.elements_length) {
+		e = duckVM_gclist_heapDump_pushRoot(dump,
+		                                    duckVM_heapRoot_upvalueStack,
+		                                    i,
+		                                    DL_ARRAY_GETADDRESS(duckVM->upvalue_stack, duckVM_object_t *, i),
+		                                    roots_length);
+		if (e) goto cleanup;
+	}
+	DL_DOTIMES(i, duckVM->globals.elements_length) {
+		e = duckVM_gclist_heapDump_pushRoot(dump,
+		                                    duckVM_heapRoot_global,
+		                                    i,
+		                                    DL_ARRAY_GETADDRESS(duckVM->globals, duckVM_object_t *, i),
+		                                    roots_length);
+		if (e) goto cleanup;
+	}
+	DL_DOTIMES(i, duckVM->call_stack.elements_length) {
+		duckVM_callFrame_t *frame = &DL_ARRAY_GETADDRESS(duckVM->call_stack, duckVM_callFrame_t, i);
+		e = duckVM_gclist_heapDump_pushRoot(dump, duckVM_heapRoot_callStack, i, frame->bytecode, roots_length);
+		if (e) goto cleanup;
+		e = duckVM_gclist_heapDump_pushRoot(dump, duckVM_heapRoot_callStack, i, frame->tailcallBytecode, roots_length);
+		if (e) goto cleanup;
+		e = duckVM_gclist_heapDump_pushRoot(dump,
+		                                    duckVM_heapRoot_callStack,
+		                                    i,
+		                                    frame->tailcallUpvalueArray,
+		                                    roots_length);
+		if (e) goto cleanup;
+	}
+	e = duckVM_gclist_heapDump_pushRoot(dump, duckVM_heapRoot_bytecode, 0, duckVM->currentBytecode, roots_length);
+	if (e) goto cleanup;
+	e = duckVM_gclist_heapDump_pushRoot(dump, duckVM_heapRoot_bytecode, 1, duckVM->suspendedBytecode, roots_length);
+	if (e) goto cleanup;
+	DL_DOTIMES(i, duckVM->gclist.pinnedObjects.elements_length) {
+		e = duckVM_gclist_heapDump_pushRoot(dump,
+		                                    duckVM_heapRoot_pinned,
+		                                    i,
+		                                    DL_ARRAY_GETADDRESS(duckVM->gclist.pinnedObjects, duckVM_object_t *, i),
+		                                    roots_length);
+		if (e) goto cleanup;
+	}
+
+ cleanup:
+	return e;
+}
+
+/* Overwrite a count that was written as a placeholder. */
+static void duckVM_gclist_heapDump_patchInteger(duckVM_gclist_heapDump_t *dump, dl_size_t offset, dl_uint64_t integer) {
+	DL_DOTIMES(i, 8) {
+		DL_ARRAY_GETADDRESS(*dump->snapshot, dl_uint8_t, offset + i) = (integer >> (8 * i)) & 0xFF;
+	}
+}
+
+static dl_error_t duckVM_gclist_dumpHeap(duckVM_t *duckVM, dl_array_t *snapshot) {
+	dl_error_t e = dl_error_ok;
+	dl_error_t eError = dl_error_ok;
+	duckVM_gclist_t *gclist = &duckVM->gclist;
+	duckVM_gclist_heapDump_t dump;
+	dl_size_t objects_length = 0;
+	dl_size_t objectsOffset;
+	dl_size_t roots_length = 0;
+	dl_size_t rootsOffset;
+	dl_size_t id = 1;
+
+	dump.gclist = gclist;
+	dump.snapshot = snapshot;
+	dump.chunkIds = dl_null;
+	/**/ dl_array_init(&dump.children, gclist->memoryAllocation, sizeof(duckVM_object_t *), dl_array_strategy_double);
+
+	/* Everything that is left after this is live. */
+	e = duckVM_gclist_garbageCollect(duckVM);
+	if (e) goto cleanup;
+	e = duckVM_gclist_finishSweeping(duckVM);
+	if (e) goto cleanup;
+
+	e = DL_MALLOC(gclist->memoryAllocation, &dump.chunkIds, dl_max(gclist->chunks_length, 1), dl_size_t);
+	if (e) goto cleanup;
+	DL_DOTIMES(i, gclist->chunks_length) {
+		dump.chunkIds[i] = id;
+		id += gclist->chunks[i].objects_length;
+	}
+
+	e = dl_array_pushElements(snapshot, DUCKVM_HEAPDUMP_MAGIC, sizeof(DUCKVM_HEAPDUMP_MAGIC));
+	if (e) goto cleanup;
+	e = duckVM_gclist_heapDump_pushByte(&dump, DUCKVM_HEAPDUMP_VERSION);
+	if (e) goto cleanup;
+
+	objectsOffset = snapshot->elements_length;
+	e = duckVM_gclist_heapDump_pushInteger(&dump, 0);
+	if (e) goto cleanup;
+	DL_DOTIMES(i, gclist->chunks_length) {
+		duckVM_gclist_chunk_t *chunk = &gclist->chunks[i];
+		DL_DOTIMES(j, chunk->objects_length) {
+			if (chunk->objects[j].type == duckVM_object_type_none) continue;
+			e = duckVM_gclist_heapDump_pushObject(&dump, &chunk->objects[j]);
+			if (e) goto cleanup;
+			objects_length++;
 		}
-		DL_ARRAY_GETTOPADDRESS(duckVM->stack, duckVM_object_t) = object1;
+	}
+	/**/ duckVM_gclist_heapDump_patchInteger(&dump, objectsOffset, objects_length);
 
-		break;
+	rootsOffset = snapshot->elements_length;
+	e = duckVM_gclist_heapDump_pushInteger(&dump, 0);
+	if (e) goto cleanup;
+	e = duckVM_gclist_heapDump_pushRoots(duckVM, &dump, &roots_length);
+	if (e) goto cleanup;
+	/**/ duckVM_gclist_heapDump_patchInteger(&dump, rootsOffset, roots_length);
 
-	case duckLisp_instruction_pushGlobal32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		parsedBytecode = dl_true;
-		/* Fall through */
-	case duckLisp_instruction_pushGlobal16:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			parsedBytecode = dl_true;
+ cleanup:
+	if (dump.chunkIds != dl_null) {
+		eError = DL_FREE(gclist->memoryAllocation, &dump.chunkIds);
+		if (eError) e = eError;
+	}
+	eError = dl_array_quit(&dump.children);
+	if (eError) e = eError;
+	return e;
+}
+
+static dl_error_t duckVM_gclist_pushObject(duckVM_t *duckVM, duckVM_object_t **objectOut, duckVM_object_t objectIn) {
+	dl_error_t e = dl_error_ok;
+	dl_error_t eError = dl_error_ok;
+
+	duckVM_gclist_t *gclist = &duckVM->gclist;
+	duckVM_object_t *heapObject = dl_null;
+
+	// Try once
+	if (gclist->marking || (gclist->freeObjects_length == 0)) {
+		// STOP THE WORLD
+		gclist->pauseWork = 0;
+		e = duckVM_gclist_collect(duckVM);
+		/**/ duckVM_gclist_endPause(gclist);
+		if (e) {
+			eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_gclist_pushObject: Garbage collection failed."));
+			if (!e) e = eError;
+			goto cleanup;
 		}
-		/* Fall through */
-	case duckLisp_instruction_pushGlobal8:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
+
+		// Try twice
+		if (gclist->freeObjects_length == 0) {
+			e = dl_error_outOfMemory;
+			eError = duckVM_error_pushRuntime(duckVM,
+			                                  DL_STR("duckVM_gclist_pushObject: Garbage collection failed. Out of memory."));
+			if (!e) e = eError;
+			goto cleanup;
 		}
-		{
-			duckVM_object_t *global;
-			e = duckVM_global_get(duckVM, &global, ptrdiff1);
+	}
+
+	heapObject = gclist->freeObjects[--gclist->freeObjects_length];
+	gclist->youngObjects[gclist->youngObjects_length++] = heapObject;
+	gclist->objectsAllocated++;
+	*heapObject = objectIn;
+	if (objectIn.type == duckVM_object_type_upvalueArray) {
+		if (objectIn.value.upvalue_array.length > 0) {
+			e = duckVM_gclist_allocPayload(gclist,
+			                               (void **) &heapObject->value.upvalue_array.upvalues,
+			                               objectIn.value.upvalue_array.length * sizeof(duckVM_object_t *));
 			if (e) {
-				e = dl_error_invalidValue;
 				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_execute->push-global: Could not find dynamic variable."));
-				if (eError) e = eError;
-				break;
+				                                  DL_STR("duckVM_gclist_pushObject: Upvalue array allocation failed."));
+				if (!e) e = eError;
+				goto cleanup;
 			}
-			e = stack_push(duckVM, global);
+			/* Don't copy the source array. */
+		}
+		else {
+			heapObject->value.upvalue_array.upvalues = dl_null;
+		}
+		if (e) goto cleanup;
+	}
+	else if (objectIn.type == duckVM_object_type_internalVector) {
+		if (objectIn.value.internal_vector.length > 0) {
+			e = duckVM_gclist_allocPayload(gclist,
+			                               (void **) &heapObject->value.internal_vector.values,
+			                               objectIn.value.internal_vector.length * sizeof(duckVM_object_t *));
 			if (e) {
 				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_execute->push-global: stack_push failed."));
+				                                  DL_STR("duckVM_gclist_pushObject: Vector allocation failed."));
 				if (!e) e = eError;
-				break;
+				goto cleanup;
+			}
+			if (objectIn.value.internal_vector.initialized) {
+				(void) dl_memcopy_noOverlap(heapObject->value.internal_vector.values,
+				                            objectIn.value.internal_vector.values,
+				                            objectIn.value.internal_vector.length * sizeof(duckVM_object_t *));
 			}
 		}
-		break;
-
-	case duckLisp_instruction_releaseUpvalues32:
-	case duckLisp_instruction_releaseUpvalues16:
-	case duckLisp_instruction_releaseUpvalues8:
-		size1 = *(ip++);
-
-		DL_DOTIMES(k, size1) {
-			ptrdiff1 = *(ip++);
-			switch (opcode) {
-			case duckLisp_instruction_releaseUpvalues32:
-				ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-				ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-				/* Fall through */
-			case duckLisp_instruction_releaseUpvalues16:
-				ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-				/* Fall through */
-			case duckLisp_instruction_releaseUpvalues8:
-				break;
-			default:
-				e = dl_error_invalidValue;
-				break;
-			}
-			ptrdiff1 = duckVM->stack.elements_length - ptrdiff1;
-			if (ptrdiff1 < 0) {
-				e = dl_error_invalidValue;
-				break;
-			}
-			duckVM_object_t *upvalue = DL_ARRAY_GETADDRESS(duckVM->upvalue_stack, duckVM_object_t *, ptrdiff1);
-			if (upvalue != dl_null) {
-				if (upvalue->type != duckVM_object_type_upvalue) {
-					eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->release-upvalues: Captured object is not an upvalue."));
-					if (!e) e = eError;
-					break;
-				}
-				duckVM_object_t *object = &DL_ARRAY_GETADDRESS(duckVM->stack, duckVM_object_t, ptrdiff1);
-				e = duckVM_gclist_pushObject(duckVM, &upvalue->value.upvalue.value.heap_object, *object);
-				if (e) break;
-				upvalue->value.upvalue.type = duckVM_upvalue_type_heap_object;
-				/* Render the original object unusable. */
-				object->type = duckVM_object_type_list;
-				object->value.list = dl_null;
-				DL_ARRAY_GETADDRESS(duckVM->upvalue_stack, duckVM_object_t *, ptrdiff1) = dl_null;
-			}
-		}
-		if (e) break;
-		break;
-
-	case duckLisp_instruction_setUpvalue32:
-		ptrdiff1 = *(ip++);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		parsedBytecode = dl_true;
-		/* Fall through */
-	case duckLisp_instruction_setUpvalue16:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff2 = *(ip++);
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			parsedBytecode = dl_true;
-		}
-		/* Fall through */
-	case duckLisp_instruction_setUpvalue8:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff2 = *(ip++);
-		}
-		{
-			// Need another stack with same depth as call stack to pull out upvalues.
-			// Like to live dangerously?
-			if (ptrdiff1 < 0) {
-				e = dl_error_invalidValue;
-				break;
-			}
-			e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff2);
-			if (e) break;
-			duckVM_object_t *upvalue = DL_ARRAY_GETTOPADDRESS(duckVM->upvalue_array_call_stack,
-			                                                  duckVM_upvalueArray_t).upvalues[ptrdiff1];
-			if (upvalue->value.upvalue.type == duckVM_upvalue_type_stack_index) {
-				e = dl_array_set(&duckVM->stack, &object1, upvalue->value.upvalue.value.stack_index);
-				if (e) break;
-			}
-			else if (upvalue->value.upvalue.type == duckVM_upvalue_type_heap_object) {
-				*upvalue->value.upvalue.value.heap_object = object1;
-			}
-			else {
-				while (upvalue->value.upvalue.type == duckVM_upvalue_type_heap_upvalue) {
-					upvalue = upvalue->value.upvalue.value.heap_upvalue;
-				}
-				if (upvalue->value.upvalue.type == duckVM_upvalue_type_stack_index) {
-					e = dl_array_set(&duckVM->stack, &object1, upvalue->value.upvalue.value.stack_index);
-					if (e) break;
-				}
-				else {
-					*upvalue->value.upvalue.value.heap_object = object1;
-				}
-			}
-		}
-		break;
-
-	case duckLisp_instruction_setGlobal32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		parsedBytecode = dl_true;
-		/* Fall through */
-	case duckLisp_instruction_setGlobal16:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			ptrdiff2 = *(ip++);
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			parsedBytecode = dl_true;
-		}
-		/* Fall through */
-	case duckLisp_instruction_setGlobal8:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff2 = *(ip++);
+		else {
+			heapObject->value.internal_vector.values = dl_null;
 		}
-		e = duckVM_gclist_pushObject(duckVM,
-		                             &objectPtr1,
-		                             DL_ARRAY_GETADDRESS(duckVM->stack,
-		                                                 duckVM_object_t,
-		                                                 duckVM->stack.elements_length - ptrdiff1));
-		if (e) break;
-		e = duckVM_global_set(duckVM, objectPtr1, ptrdiff2);
-		if (e) break;
-		break;
-
-	case duckLisp_instruction_funcall32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through */
-	case duckLisp_instruction_funcall16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through */
-	case duckLisp_instruction_funcall8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		uint8 = *(ip++);
-		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
-		if (e) break;
-		e = duckVM_instruction_prepareForFuncall(duckVM, &object1, uint8);
-		if (e) break;
-		if (object1.type == duckVM_object_type_function) {
-			e = object1.value.function.callback(duckVM);
+		if (e) goto cleanup;
+	}
+	else if (objectIn.type == duckVM_object_type_bytecode) {
+		if (objectIn.value.bytecode.bytecode_length > 0) {
+			e = duckVM_gclist_allocPayload(gclist,
+			                               (void **) &heapObject->value.bytecode.bytecode,
+			                               objectIn.value.bytecode.bytecode_length);
 			if (e) {
 				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_execute->funcall: C callback returned error."));
+				                                  DL_STR("duckVM_gclist_pushObject: Bytecode allocation failed."));
 				if (!e) e = eError;
-				break;
+				goto cleanup;
 			}
-			break;
-		}
-		else if (object1.type != duckVM_object_type_closure) {
-			e = dl_error_invalidValue;
-			eError = duckVM_error_pushRuntime(duckVM,
-			                                  DL_STR("duckVM_execute->funcall: Object is not a callback or closure."));
-			if (!e) e = eError;
-			break;
-		}
-		/* Call. */
-		e = call_stack_push(duckVM, ip, bytecode, &object1.value.closure.upvalue_array->value.upvalue_array);
-		if (e) break;
-		bytecode = object1.value.closure.bytecode;
-		ip = &bytecode->value.bytecode.bytecode[object1.value.closure.name];
-		break;
-
-	case duckLisp_instruction_apply32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through */
-	case duckLisp_instruction_apply16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through */
-	case duckLisp_instruction_apply8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		uint8 = *(ip++);
-		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
-		if (e) break;
-		while (object1.type == duckVM_object_type_composite) {
-			object1 = *object1.value.composite->value.internalComposite.function;
-		}
-		if (object1.type != duckVM_object_type_closure) {
-			e = dl_error_invalidValue;
-			eError = duckVM_error_pushRuntime(duckVM,
-			                                  DL_STR("duckVM_execute->apply: Applied object is not a closure."));
-			if (eError) e = eError;
-			break;
+			/**/ dl_memcopy_noOverlap(heapObject->value.bytecode.bytecode,
+			                          objectIn.value.bytecode.bytecode,
+			                          objectIn.value.bytecode.bytecode_length);
+			/* Filled in by `duckVM_loadBytecode`, or the first time a call or return goes to it. */
+			heapObject->value.bytecode.decoded = dl_null;
 		}
-		duckVM_object_t rest;
-		e = stack_pop(duckVM, &rest);
-		if (e) break;
-		if (rest.type != duckVM_object_type_list) {
-			e = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->apply: Last argument is not a list."));
-			e = dl_error_invalidValue;
-			break;
+		else {
+			heapObject->value.bytecode.bytecode = dl_null;
+			heapObject->value.bytecode.bytecode_length = 0;
+			heapObject->value.bytecode.decoded = dl_null;
 		}
-		while ((uint8 < object1.value.closure.arity) && (rest.value.list != dl_null)) {
-			if (rest.value.list->type != duckVM_object_type_cons) {
-				e = dl_error_invalidValue;
+		if (e) goto cleanup;
+	}
+	else if (objectIn.type == duckVM_object_type_internalString) {
+		if (objectIn.value.internalString.value_length > 0) {
+			e = duckVM_gclist_allocPayload(gclist,
+			                               (void **) &heapObject->value.internalString.value,
+			                               objectIn.value.internalString.value_length);
+			if (e) {
 				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_execute->apply: Object pointed to by list root is not a list."));
-				if (eError) e = eError;
-				break;
-			}
-			/* (push (car rest) stack) */
-			{
-				duckVM_object_t *car = rest.value.list->value.cons.car;
-				if ((car == dl_null) || (car->type == duckVM_object_type_cons)) {
-					duckVM_object_t list = duckVM_object_makeList(car);
-					e = stack_push(duckVM, &list);
-				}
-				else {
-					e = stack_push(duckVM, car);
-				}
-				if (e) break;
-			}
-			/* (setf rest (cdr rest)) */
-			rest.value.list = rest.value.list->value.cons.cdr;
-			uint8++;
-		}
-		if (e) break;
-		if (object1.value.closure.variadic) {
-			if (uint8 < object1.value.closure.arity) {
-				e = dl_error_invalidValue;
-				break;
-			}
-			/* Create list. */
-			/* The original version of this did something really dirty though it didn't look like it. It popped
-			   multiple objects off the stack, then allocated a bunch more on the heap. This is fine 99.999% of the
-			   time, but since the stack is the root the garbage collector uses to trace memory, it was possible to
-			   trigger collection of the object (and possibly all its children) during one of those allocations.
-			   Moral of the story: Never perform an allocation if you have an allocated object disconnected from the
-			   stack. */
-			/* First push the new object on the stack to register it with the collector. */
-			object2.value.list = rest.value.list;
-			object2.type = duckVM_object_type_list;
-			e = stack_push(duckVM, &object2);
-			if (e) break;
-			object3.value.list = dl_null;
-			object3.type = duckVM_object_type_list;
-			e = stack_push(duckVM, &object3);
-			if (e) break;
-			dl_size_t args_length = (uint8 - object1.value.closure.arity);
-			duckVM_object_t *lastConsPtr = rest.value.list;
-			DL_DOTIMES(k, args_length) {
-				duckVM_object_t cons;
-				duckVM_object_t *consPtr = dl_null;
-				duckVM_object_t object;
-				duckVM_object_t *objectPtr = dl_null;
-				/* Reverse order, because lisp lists are backwards. */
-				object = DL_ARRAY_GETADDRESS(duckVM->stack,
-				                             duckVM_object_t,
-				                             duckVM->stack.elements_length - 3 - k);
-				e = duckVM_gclist_pushObject(duckVM, &objectPtr, object);
-				if (e) break;
-				cons.type = duckVM_object_type_cons;
-				cons.value.cons.car = objectPtr;
-				cons.value.cons.cdr = lastConsPtr;
-				/* Make visible to collector before allocating another. */
-				DL_ARRAY_GETADDRESS(duckVM->stack,
-				                    duckVM_object_t,
-				                    duckVM->stack.elements_length - 1).value.list = objectPtr;
-				e = duckVM_gclist_pushObject(duckVM, &consPtr, cons);
-				if (e) break;
-				/* Make visible to collector before allocating another. The object just created is linked in the
-				   cons. */
-				DL_ARRAY_GETADDRESS(duckVM->stack,
-				                    duckVM_object_t,
-				                    duckVM->stack.elements_length - 2).value.list = consPtr;
-				lastConsPtr = consPtr;
+				                                  DL_STR("duckVM_gclist_pushObject: String allocation failed."));
+				if (!e) e = eError;
+				goto cleanup;
 			}
-			if (e) break;
-			/* Pop the temporary object. */
-			e = stack_pop(duckVM, dl_null);
-			if (e) break;
-			/* Copy the list to the proper position. */
-			object2.value.list = lastConsPtr;
-			DL_ARRAY_GETADDRESS(duckVM->stack,
-			                    duckVM_object_t,
-			                    (duckVM->stack.elements_length - 1 - args_length)) = object2;
-			/* Pop all objects other than the list. */
-			e = stack_pop_multiple(duckVM, args_length);
-			if (e) break;
+			/**/ dl_memcopy_noOverlap(heapObject->value.internalString.value,
+			                          objectIn.value.internalString.value,
+			                          objectIn.value.internalString.value_length);
 		}
 		else {
-			if (object1.value.closure.arity != uint8) {
-				e = dl_error_invalidValue;
-				break;
-			}
+			heapObject->value.internalString.value = dl_null;
+			heapObject->value.internalString.value_length = 0;
+		}
+		if (e) goto cleanup;
+	}
+	*objectOut = heapObject;
+
+ cleanup:
+	if (e && (heapObject != dl_null)) {
+		/* The payload wasn't allocated, so the object still points at the caller's. Put the slot back before the
+		   collector frees memory it doesn't own. */
+		heapObject->type = duckVM_object_type_none;
+		--gclist->youngObjects_length;
+		gclist->freeObjects[gclist->freeObjects_length++] = heapObject;
+		--gclist->objectsAllocated;
+	}
+
+	return e;
+}
+
+
+dl_error_t duckVM_init(duckVM_t *duckVM, dl_memoryAllocation_t *memoryAllocation, dl_size_t maxObjects) {
+	dl_error_t e = dl_error_ok;
+
+	duckVM->memoryAllocation = memoryAllocation;
+	duckVM->currentBytecode = dl_null;
+	duckVM->budgeted = dl_false;
+	duckVM->instructionBudget = 0;
+	duckVM->suspendedBytecode = dl_null;
+	duckVM->suspendedIp = dl_null;
+	duckVM->nextUserType = duckVM_object_type_last;
+	/**/ dl_array_init(&duckVM->errors, duckVM->memoryAllocation, sizeof(dl_uint8_t), dl_array_strategy_double);
+	/**/ dl_array_init(&duckVM->stack, duckVM->memoryAllocation, sizeof(duckVM_object_t), dl_array_strategy_double);
+	/**/ dl_array_init(&duckVM->call_stack,
+	                   duckVM->memoryAllocation,
+	                   sizeof(duckVM_callFrame_t),
+	                   dl_array_strategy_double);
+	/**/ dl_array_init(&duckVM->upvalue_stack,
+	                   duckVM->memoryAllocation,
+	                   sizeof(duckVM_object_t *),
+	                   dl_array_strategy_double);
+	/**/ dl_array_init(&duckVM->upvalue_array_call_stack,
+	                   duckVM->memoryAllocation,
+	                   sizeof(duckVM_upvalueArray_t),
+	                   dl_array_strategy_double);
+	e = dl_array_pushElement(&duckVM->upvalue_array_call_stack, dl_null);
+	if (e) goto cleanup;
+	/**/ dl_array_init(&duckVM->globals,
+	                   duckVM->memoryAllocation,
+	                   sizeof(duckVM_object_t *),
+	                   dl_array_strategy_double);
+	/**/ dl_array_init(&duckVM->callbacks,
+	                   duckVM->memoryAllocation,
+	                   sizeof(duckVM_function_t),
+	                   dl_array_strategy_double);
+	e = duckVM_gclist_init(&duckVM->gclist, duckVM->memoryAllocation, duckVM, maxObjects);
+	if (e) goto cleanup;
+	duckVM->duckLisp = dl_null;
+	duckVM->userData = dl_null;
+
+ cleanup:
+	return e;
+}
+
+void duckVM_quit(duckVM_t *duckVM) {
+	dl_error_t e;
+	e = dl_array_quit(&duckVM->stack);
+	e = dl_array_quit(&duckVM->upvalue_stack);
+	e = dl_array_quit(&duckVM->globals);
+	e = dl_array_quit(&duckVM->callbacks);
+	e = dl_array_quit(&duckVM->call_stack);
+	duckVM->currentBytecode = dl_null;
+	duckVM->suspendedBytecode = dl_null;
+	e = duckVM_gclist_garbageCollect(duckVM);
+	e = duckVM_gclist_finishSweeping(duckVM);
+	e = dl_array_quit(&duckVM->upvalue_array_call_stack);
+	/**/ duckVM_gclist_quit(&duckVM->gclist);
+	e = dl_array_quit(&duckVM->errors);
+	duckVM->duckLisp = dl_null;
+	duckVM->userData = dl_null;
+	(void) e;
+}
+
+static dl_error_t stack_push(duckVM_t *duckVM, duckVM_object_t *object) {
+	dl_error_t e = dl_error_ok;
+	e = dl_array_pushElement(&duckVM->stack, object);
+	if (e) goto cleanup;
+	e = dl_array_pushElement(&duckVM->upvalue_stack, dl_null);
+ cleanup:
+	if (e) {
+		dl_error_t eError = duckVM_error_pushRuntime(duckVM, DL_STR("stack_push: Failed."));
+		if (!e) e = eError;
+	}
+	return e;
+}
+
+/* This is only used by the FFI. */
+static dl_error_t stack_pop(duckVM_t *duckVM, duckVM_object_t *object) {
+	dl_error_t e = dl_error_ok;
+	e = dl_array_popElement(&duckVM->stack, object);
+	if (e) goto cleanup;
+	e = dl_array_popElement(&duckVM->upvalue_stack, dl_null);
+ cleanup:
+	if (e) {
+		dl_error_t eError = duckVM_error_pushRuntime(duckVM, DL_STR("stack_pop: Failed."));
+		if (!e) e = eError;
+	}
+	return e;
+}
+
+static dl_error_t stack_pop_multiple(duckVM_t *duckVM, dl_size_t pops) {
+	dl_error_t e = dl_error_ok;
+	e = dl_array_popElements(&duckVM->upvalue_stack, dl_null, pops);
+	if (e) goto cleanup;
+	e = dl_array_popElements(&duckVM->stack, dl_null, pops);
+ cleanup:
+	if (e) {
+		dl_error_t eError = duckVM_error_pushRuntime(duckVM, DL_STR("stack_pop_multiple: Failed."));
+		if (!e) e = eError;
+	}
+	return e;
+}
+
+/* Only for verified instructions, which are known not to pop more than is on the stack. */
+static void stack_pop_multiple_unchecked(duckVM_t *duckVM, dl_size_t pops) {
+	duckVM->upvalue_stack.elements_length -= pops;
+	duckVM->stack.elements_length -= pops;
+}
+
+static dl_error_t stack_getTop(duckVM_t *duckVM, duckVM_object_t *element) {
+	return dl_array_getTop(&duckVM->stack, element);
+}
+
+static dl_error_t stack_get(duckVM_t *duckVM, duckVM_object_t *element, dl_ptrdiff_t index) {
+	if (index < 0) {
+		index = duckVM->stack.elements_length + index;
+	}
+	return dl_array_get(&duckVM->stack, element, index);
+}
+
+static dl_error_t stack_set(duckVM_t *duckVM, duckVM_object_t *element, dl_ptrdiff_t index) {
+	if (index < 0) {
+		index = duckVM->stack.elements_length + index;
+	}
+	return dl_array_set(&duckVM->stack, element, index);
+}
+
+static dl_error_t call_stack_push(duckVM_t *duckVM,
+                                  dl_uint8_t *ip,
+                                  duckVM_object_t *bytecode,
+                                  duckVM_upvalueArray_t *upvalueArray,
+                                  dl_size_t stackBase) {
+	dl_error_t e = dl_error_ok;
+	duckVM_callFrame_t frame;
+	frame.ip = ip;
+	frame.bytecode = bytecode;
+	frame.tailcallBytecode = dl_null;
+	frame.tailcallUpvalueArray = dl_null;
+	frame.stackBase = stackBase;
+	e = dl_array_pushElement(&duckVM->call_stack, &frame);
+	if (e) goto cleanup;
+	e = dl_array_pushElement(&duckVM->upvalue_array_call_stack, upvalueArray);
+	if (e) goto cleanup;
+ cleanup:
+	if (e) {
+		dl_error_t eError = duckVM_error_pushRuntime(duckVM, DL_STR("call_stack_push: Failed."));
+		if (!e) e = eError;
+	}
+	return e;
+}
+
+static dl_error_t call_stack_pop(duckVM_t *duckVM, dl_uint8_t **ip, duckVM_object_t **bytecode) {
+	dl_error_t e = dl_error_ok;
+	duckVM_callFrame_t frame;
+	e = dl_array_popElement(&duckVM->call_stack, &frame);
+	if (e) goto cleanup;
+	*ip = frame.ip;
+	*bytecode = frame.bytecode;
+	e = dl_array_popElement(&duckVM->upvalue_array_call_stack, dl_null);
+ cleanup:
+	if (e && (e != dl_error_bufferUnderflow)) {
+		dl_error_t eError = duckVM_error_pushRuntime(duckVM, DL_STR("call_stack_pop: Failed."));
+		if (!e) e = eError;
+	}
+	return e;
+}
+
+/* Stack length under the arguments of a closure that is about to be called. */
+static dl_size_t duckVM_closure_stackBase(duckVM_t *duckVM, duckVM_closure_t closure) {
+	return duckVM->stack.elements_length - closure.arity - (closure.variadic ? 1 : 0);
+}
+
+/* Unverified code may return with the stack in any state, but verified code assumes its callees leave the return
+   value right above their arguments. Don't let unverified code return to verified code with less than that. */
+static dl_error_t duckVM_checkReturn(duckVM_t *duckVM) {
+	dl_error_t e = dl_error_ok;
+	duckVM_callFrame_t *frame = dl_null;
+	duckVM_bytecode_t *bytecode = dl_null;
+	duckVM_decodedBytecode_t *decoded = dl_null;
+
+	if (duckVM->call_stack.elements_length == 0) goto cleanup;
+	frame = &DL_ARRAY_GETTOPADDRESS(duckVM->call_stack, duckVM_callFrame_t);
+	bytecode = &frame->bytecode->value.bytecode;
+	decoded = bytecode->decoded;
+	if (decoded == dl_null) goto cleanup;
+	if (!decoded->instructions[decoded->indices[frame->ip - bytecode->bytecode]].verified) goto cleanup;
+	if (duckVM->stack.elements_length <= frame->stackBase) {
+		dl_error_t eError = dl_error_ok;
+		e = dl_error_invalidValue;
+		eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->return: Stack underflow in caller."));
+		if (eError) e = eError;
+	}
+
+ cleanup:
+	return e;
+}
+
+/* C callbacks have to pop their arguments and push one return value. Verified code counts on the return value being
+   right where the arguments started, like it does for returns. */
+static dl_error_t duckVM_checkCallback(duckVM_t *duckVM, dl_size_t stackLength, dl_size_t arity) {
+	dl_error_t e = dl_error_ok;
+	if ((arity > stackLength) || (duckVM->stack.elements_length != stackLength - arity + 1)) {
+		dl_error_t eError = dl_error_ok;
+		e = dl_error_invalidValue;
+		eError = duckVM_error_pushRuntime(duckVM,
+		                                  DL_STR("duckVM_execute->c-call: C callback did not replace its arguments with one return value."));
+		if (eError) e = eError;
+	}
+	return e;
+}
+
+/* Globals are indexed directly by their key, which is the symbol ID of the global's name. Symbol IDs are allocated
+   sequentially by the compiler, so the table stays dense. */
+dl_error_t duckVM_global_get(const duckVM_t *duckVM, duckVM_object_t **global, const dl_ptrdiff_t key) {
+	duckVM_object_t *object = dl_null;
+	if ((key < 0) || ((dl_size_t) key >= duckVM->globals.elements_length)) return dl_error_invalidValue;
+	object = DL_ARRAY_GETADDRESS(duckVM->globals, duckVM_object_t *, key);
+	if (object == dl_null) return dl_error_invalidValue;
+	*global = object;
+	return dl_error_ok;
+}
+
+dl_error_t duckVM_global_set(duckVM_t *duckVM, duckVM_object_t *value, dl_ptrdiff_t key) {
+	dl_error_t e = dl_error_ok;
+
+	dl_array_t *globals = &duckVM->globals;
+	if (key < 0) {
+		e = dl_error_invalidValue;
+		goto cleanup;
+	}
+	if ((dl_size_t) key >= globals->elements_length) {
+		/* Fill the gap with undefined globals. */
+		e = dl_array_pushElements(globals, dl_null, key + 1 - globals->elements_length);
+		if (e) goto cleanup;
+	}
+	DL_ARRAY_GETADDRESS(*globals, duckVM_object_t *, key) = value;
+	if (value != dl_null) {
+		e = duckVM_gclist_globalBarrier(&duckVM->gclist, value);
+		if (e) goto cleanup;
+	}
+
+	/* Keep the callback table in sync so that `ccall` doesn't have to check the global's type. */
+	if ((value != dl_null) && (value->type == duckVM_object_type_function)) {
+		dl_array_t *callbacks = &duckVM->callbacks;
+		if ((dl_size_t) key >= callbacks->elements_length) {
+			e = dl_array_pushElements(callbacks, dl_null, key + 1 - callbacks->elements_length);
+			if (e) goto cleanup;
+		}
+		DL_ARRAY_GETADDRESS(*callbacks, duckVM_function_t, key) = value->value.function;
+	}
+	else if ((dl_size_t) key < duckVM->callbacks.elements_length) {
+		DL_ARRAY_GETADDRESS(duckVM->callbacks, duckVM_function_t, key).callback = dl_null;
+	}
+
+ cleanup:
+	return e;
+}
+
+/* Get the C function linked to `key`. Returns null if the global isn't a C function. */
+static dl_error_t (*duckVM_callback_get(const duckVM_t *duckVM, const dl_ptrdiff_t key))(duckVM_t *) {
+	if ((key < 0) || ((dl_size_t) key >= duckVM->callbacks.elements_length)) return dl_null;
+	return DL_ARRAY_GETADDRESS(duckVM->callbacks, duckVM_function_t, key).callback;
+}
+
+/* Detect cycles in linked lists using Richard Brent's algorithm.
+   source: https://stackoverflow.com/questions/2663115/how-to-detect-a-loop-in-a-linked-list */
+dl_bool_t duckVM_listIsCyclic(duckVM_object_t *rootCons) {
+	if (rootCons == dl_null) return dl_false;
+
+	duckVM_object_t *slow = rootCons;
+	duckVM_object_t *fast = rootCons;
+	int taken = 0;
+	int limit = 2;
+	while ((fast->type == duckVM_object_type_cons) && (fast->value.cons.cdr != dl_null)) {
+		fast = fast->value.cons.cdr;
+		taken++;
+		if (slow == fast) return dl_true;
+		if (taken == limit) {
+			taken = 0;
+			limit *= 2;
+			slow = fast;
+		}
+	}
+	return dl_false;
+}
+
+
+static dl_error_t duckVM_instruction_prepareForFuncall(duckVM_t *duckVM,
+                                                       duckVM_object_t *functionObject,
+                                                       dl_uint8_t numberOfArgs) {
+	dl_error_t e = dl_error_ok;
+	dl_error_t eError = dl_error_ok;
+
+	do {
+		duckVM_object_t restListObject;
+		while (functionObject->type == duckVM_object_type_composite) {
+			*functionObject = *functionObject->value.composite->value.internalComposite.function;
+		}
+		if (functionObject->type == duckVM_object_type_function) {
+			break;
+		}
+		else if (functionObject->type != duckVM_object_type_closure) {
+			e = dl_error_invalidValue;
+			eError = duckVM_error_pushRuntime(duckVM,
+			                                  DL_STR("duckVM_execute->funcall: Object is not a callback or closure."));
+			if (!e) e = eError;
+			break;
+		}
+		/* Verified function bodies assume their arguments are really there. */
+		if (numberOfArgs > duckVM->stack.elements_length) {
+			e = dl_error_invalidValue;
+			eError = duckVM_error_pushRuntime(duckVM,
+			                                  DL_STR("duckVM_execute->funcall: Not enough objects on the stack."));
+			if (!e) e = eError;
+			break;
+		}
+		if (functionObject->value.closure.variadic) {
+			if (numberOfArgs < functionObject->value.closure.arity) {
+				e = dl_error_invalidValue;
+				eError = duckVM_error_pushRuntime(duckVM,
+				                                  DL_STR("duckVM_execute->funcall: Too few arguments."));
+				if (!e) e = eError;
+				break;
+			}
+			/* Create list. */
+			/* The original version of this did something really dirty though it didn't look like it. It popped
+			   multiple objects off the stack, then allocated a bunch more on the heap. This is fine 99.999% of the
+			   time, but since the stack is the root the garbage collector uses to trace memory, it was possible to
+			   trigger collection of the object (and possibly all its children) during one of those allocations.
+			   Moral of the story: Never perform an allocation if you have an allocated object disconnected from the
+			   stack. */
+			/* First push the new object on the stack to register it with the collector. */
+			restListObject.value.list = dl_null;
+			restListObject.type = duckVM_object_type_list;
+			e = stack_push(duckVM, &restListObject);
+			if (e) break;
+			{
+				duckVM_object_t nil;
+				nil.value.list = dl_null;
+				nil.type = duckVM_object_type_list;
+				e = stack_push(duckVM, &nil);
+				if (e) break;
+			}
+			dl_size_t args_length = (numberOfArgs - functionObject->value.closure.arity);
+			duckVM_object_t *lastConsPtr = dl_null;
+			DL_DOTIMES(k, args_length) {
+				duckVM_object_t cons;
+				duckVM_object_t *consPtr = dl_null;
+				duckVM_object_t object;
+				duckVM_object_t *objectPtr = dl_null;
+				/* Reverse order, because lisp lists are backwards. */
+				object = DL_ARRAY_GETADDRESS(duckVM->stack,
+				                             duckVM_object_t,
+				                             duckVM->stack.elements_length - 3 - k);
+				e = duckVM_gclist_pushObject(duckVM, &objectPtr, object);
+				if (e) break;
+				cons.type = duckVM_object_type_cons;
+				cons.value.cons.car = objectPtr;
+				cons.value.cons.cdr = lastConsPtr;
+				/* Make visible to collector before allocating another. */
+				DL_ARRAY_GETADDRESS(duckVM->stack,
+				                    duckVM_object_t,
+				                    duckVM->stack.elements_length - 1).value.list = objectPtr;
+				e = duckVM_gclist_pushObject(duckVM, &consPtr, cons);
+				if (e) break;
+				/* Make visible to collector before allocating another. The object just created is linked in the
+				   cons. */
+				DL_ARRAY_GETADDRESS(duckVM->stack,
+				                    duckVM_object_t,
+				                    duckVM->stack.elements_length - 2).value.list = consPtr;
+				lastConsPtr = consPtr;
+			}
+			if (e) break;
+			/* Pop the temporary object. */
+			e = stack_pop(duckVM, dl_null);
+			if (e) break;
+			/* Copy the list to the proper position. */
+			restListObject.value.list = lastConsPtr;
+			DL_ARRAY_GETADDRESS(duckVM->stack,
+			                    duckVM_object_t,
+			                    (duckVM->stack.elements_length - 1 - args_length)) = restListObject;
+			/* Pop all objects other than the list. */
+			e = stack_pop_multiple(duckVM, args_length);
+			if (e) break;
+		}
+		else {
+			if (functionObject->value.closure.arity != numberOfArgs) {
+				e = dl_error_invalidValue;
+				eError = duckVM_error_pushRuntime(duckVM,
+				                                  DL_STR("duckVM_execute->funcall: Incorrect number of arguments."));
+				if (!e) e = eError;
+				break;
+			}
+		}
+	} while (0);
+	return e;
+}                
+
+static dl_bool_t duckVM_isTruthy(const duckVM_object_t *object) {
+	switch (object->type) {
+	case duckVM_object_type_bool:
+		return object->value.boolean;
+	case duckVM_object_type_integer:
+		return object->value.integer != 0;
+	case duckVM_object_type_float:
+		return object->value.floatingPoint != 0.0;
+	case duckVM_object_type_list:
+		return object->value.list != dl_null;
+	case duckVM_object_type_symbol:
+		/* Fall through */
+	case duckVM_object_type_closure:
+		/* Fall through */
+	case duckVM_object_type_function:
+		/* Fall through */
+	case duckVM_object_type_string:
+		return dl_true;
+	case duckVM_object_type_vector:
+		return ((object->value.vector.internal_vector != dl_null)
+		        && ((dl_size_t) object->value.vector.offset
+		            < object->value.vector.internal_vector->value.internal_vector.length));
+	default:
+		return dl_false;
+	}
+}
+
+/* Numeric comparison shared by `less`, `greater`, and their fused branches. `greater` is `less` with its operands
+   swapped. */
+static dl_error_t duckVM_less(const duckVM_object_t *left, const duckVM_object_t *right, dl_bool_t *result) {
+	switch (left->type) {
+	case duckVM_object_type_float:
+		switch (right->type) {
+		case duckVM_object_type_float:
+			*result = left->value.floatingPoint < right->value.floatingPoint;
+			break;
+		case duckVM_object_type_integer:
+			*result = left->value.floatingPoint < right->value.integer;
+			break;
+		case duckVM_object_type_bool:
+			*result = left->value.floatingPoint < right->value.boolean;
+			break;
+		default:
+			return dl_error_invalidValue;
+		}
+		break;
+	case duckVM_object_type_integer:
+		switch (right->type) {
+		case duckVM_object_type_float:
+			*result = left->value.integer < right->value.floatingPoint;
+			break;
+		case duckVM_object_type_integer:
+			*result = left->value.integer < right->value.integer;
+			break;
+		case duckVM_object_type_bool:
+			*result = left->value.integer < right->value.boolean;
+			break;
+		default:
+			return dl_error_invalidValue;
+		}
+		break;
+	case duckVM_object_type_bool:
+		switch (right->type) {
+		case duckVM_object_type_float:
+			*result = left->value.boolean < right->value.floatingPoint;
+			break;
+		case duckVM_object_type_integer:
+			*result = left->value.boolean < right->value.integer;
+			break;
+		case duckVM_object_type_bool:
+			*result = left->value.boolean < right->value.boolean;
+			break;
+		default:
+			return dl_error_invalidValue;
+		}
+		break;
+	default:
+		return dl_error_invalidValue;
+	}
+	return dl_error_ok;
+}
+
+static dl_error_t duckVM_equal(const duckVM_object_t *left, const duckVM_object_t *right, dl_bool_t *result) {
+	switch (left->type) {
+	case duckVM_object_type_list:
+		switch (right->type) {
+		case duckVM_object_type_list:
+			*result = left->value.list == right->value.list;
+			break;
+		default:
+			*result = dl_false;
+		}
+		break;
+	case duckVM_object_type_symbol:
+		switch (right->type) {
+		case duckVM_object_type_symbol:
+			*result = left->value.symbol.id == right->value.symbol.id;
+			break;
+		default:
+			*result = dl_false;
+		}
+		break;
+	case duckVM_object_type_string:
+		switch (right->type) {
+		case duckVM_object_type_string:
+			if ((left->value.string.length - left->value.string.offset == 0)
+			    && (right->value.string.length - right->value.string.offset == 0)) {
+				*result = dl_true;
+			}
+			else if ((left->value.string.length - left->value.string.offset == 0)
+			         || (right->value.string.length - right->value.string.offset == 0)) {
+				*result = dl_false;
+			}
+			else {
+				/**/ dl_string_compare(result,
+				                       (left->value.string.internalString->value.internalString.value
+				                        + left->value.string.offset),
+				                       left->value.string.length - left->value.string.offset,
+				                       (right->value.string.internalString->value.internalString.value
+				                        + right->value.string.offset),
+				                       right->value.string.length - right->value.string.offset);
+			}
+			break;
+		default:
+			*result = dl_false;
+		}
+		break;
+	case duckVM_object_type_float:
+		switch (right->type) {
+		case duckVM_object_type_float:
+			*result = left->value.floatingPoint == right->value.floatingPoint;
+			break;
+		default:
+			*result = dl_false;
+		}
+		break;
+	case duckVM_object_type_integer:
+		switch (right->type) {
+		case duckVM_object_type_integer:
+			*result = left->value.integer == right->value.integer;
+			break;
+		default:
+			*result = dl_false;
+		}
+		break;
+	case duckVM_object_type_bool:
+		switch (right->type) {
+		case duckVM_object_type_bool:
+			*result = left->value.boolean == right->value.boolean;
+			break;
+		default:
+			*result = dl_false;
+		}
+		break;
+	case duckVM_object_type_vector:
+		switch (right->type) {
+		case duckVM_object_type_vector:
+			*result = ((left->value.vector.internal_vector == right->value.vector.internal_vector)
+			                         && (left->value.vector.offset == right->value.vector.offset));
+			break;
+		default:
+			*result = dl_false;
+		}
+		break;
+	case duckVM_object_type_type:
+		switch (right->type) {
+		case duckVM_object_type_type:
+			*result = (left->value.type == right->value.type);
+			break;
+		default:
+			*result = dl_false;
+		}
+		break;
+	default:
+		return dl_error_invalidValue;
+	}
+	return dl_error_ok;
+}
+
+static dl_bool_t duckVM_isNull(const duckVM_object_t *object) {
+	switch (object->type) {
+	case duckVM_object_type_list:
+		return object->value.list == dl_null;
+	case duckVM_object_type_vector:
+		return !((object->value.vector.internal_vector != dl_null)
+		         && ((dl_size_t) object->value.vector.offset
+		             < object->value.vector.internal_vector->value.internal_vector.length));
+	case duckVM_object_type_string:
+		return !((object->value.string.internalString != dl_null)
+		         && ((dl_size_t) object->value.string.offset < object->value.string.length));
+	default:
+		return dl_false;
+	}
+}
+
+/* Run a type-specialized arithmetic instruction. Returns false without touching the stack if the operands
+   aren't the expected type, in which case the generic instruction should be run instead. */
+static dl_bool_t duckVM_instruction_typedArithmetic(duckVM_t *duckVM,
+                                                    const duckVM_decodedInstruction_t *decoded,
+                                                    duckVM_object_t *result) {
+	duckVM_object_t *left = dl_null;
+	duckVM_object_t *right = dl_null;
+	dl_size_t length = duckVM->stack.elements_length;
+	dl_size_t family = 0;
+
+	if (!decoded->verified
+	    && ((decoded->operands[0] < 1) || ((dl_size_t) decoded->operands[0] > length)
+	        || (decoded->operands[1] < 1) || ((dl_size_t) decoded->operands[1] > length))) {
+		return dl_false;
+	}
+	left = &DL_ARRAY_GETADDRESS(duckVM->stack, duckVM_object_t, length - decoded->operands[0]);
+	right = &DL_ARRAY_GETADDRESS(duckVM->stack, duckVM_object_t, length - decoded->operands[1]);
+	/* Each family is three integer instructions followed by three float instructions. */
+	family = (decoded->opcode - duckLisp_instruction_addInt8) / 3;
+	if (family % 2) {
+		if ((left->type != duckVM_object_type_float) || (right->type != duckVM_object_type_float)) return dl_false;
+	}
+	else {
+		if ((left->type != duckVM_object_type_integer) || (right->type != duckVM_object_type_integer)) return dl_false;
+	}
+	switch (family) {
+	case 0:
+		*result = duckVM_object_makeInteger(left->value.integer + right->value.integer);
+		break;
+	case 1:
+		*result = duckVM_object_makeFloat(left->value.floatingPoint + right->value.floatingPoint);
+		break;
+	case 2:
+		*result = duckVM_object_makeInteger(left->value.integer - right->value.integer);
+		break;
+	case 3:
+		*result = duckVM_object_makeFloat(left->value.floatingPoint - right->value.floatingPoint);
+		break;
+	case 4:
+		*result = duckVM_object_makeInteger(left->value.integer * right->value.integer);
+		break;
+	case 5:
+		*result = duckVM_object_makeFloat(left->value.floatingPoint * right->value.floatingPoint);
+		break;
+	case 6:
+		*result = duckVM_object_makeBoolean(left->value.integer < right->value.integer);
+		break;
+	case 7:
+		*result = duckVM_object_makeBoolean(left->value.floatingPoint < right->value.floatingPoint);
+		break;
+	case 8:
+		*result = duckVM_object_makeBoolean(left->value.integer > right->value.integer);
+		break;
+	default:
+		*result = duckVM_object_makeBoolean(left->value.floatingPoint > right->value.floatingPoint);
+	}
+	return dl_true;
+}
+
+/* Run the comparison of a decoded compare-and-branch instruction, then pop. `*branch` is set if the branch should be
+   taken. */
+static dl_error_t duckVM_instruction_brCompare(duckVM_t *duckVM,
+                                               const duckVM_decodedInstruction_t *decoded,
+                                               dl_bool_t *branch) {
+	dl_error_t e = dl_error_ok;
+	duckVM_object_t *left = dl_null;
+	duckVM_object_t *right = dl_null;
+	dl_size_t length = duckVM->stack.elements_length;
+
+	/* `brNullp` only has one index, so it's decoded into both slots. */
+	if (!decoded->verified
+	    && ((decoded->bytes[0] == 0) || (decoded->bytes[0] > length)
+	        || (decoded->bytes[1] == 0) || (decoded->bytes[1] > length))) {
+		return dl_error_invalidValue;
+	}
+	left = &DL_ARRAY_GETADDRESS(duckVM->stack, duckVM_object_t, length - decoded->bytes[0]);
+	right = &DL_ARRAY_GETADDRESS(duckVM->stack, duckVM_object_t, length - decoded->bytes[1]);
+	/* Each family has an 8, 16, and 32 bit version. */
+	switch ((decoded->opcode - duckLisp_instruction_brLess8) / 3) {
+	case 0:
+		e = duckVM_less(left, right, branch);
+		break;
+	case 1:
+		e = duckVM_less(right, left, branch);
+		break;
+	case 2:
+		e = duckVM_equal(left, right, branch);
+		break;
+	default:
+		*branch = duckVM_isNull(left);
+	}
+	if (e) return e;
+	/* The boolean was never pushed, so the pop count doesn't include it. */
+	if (decoded->verified) {
+		stack_pop_multiple_unchecked(duckVM, decoded->operands[1]);
+		return dl_error_ok;
+	}
+	return stack_pop_multiple(duckVM, decoded->operands[1]);
+}
+
+/* Call the object `index` elements from the top of the stack. `*ip` should point to the next instruction. */
+static dl_error_t duckVM_instruction_funcall(duckVM_t *duckVM,
+                                             dl_uint8_t **ip,
+                                             duckVM_object_t **bytecode,
+                                             dl_ptrdiff_t index,
+                                             dl_uint8_t numberOfArgs) {
+	dl_error_t e = dl_error_ok;
+	dl_error_t eError = dl_error_ok;
+
+	duckVM_object_t functionObject;
+
+	do {
+		e = dl_array_get(&duckVM->stack, &functionObject, duckVM->stack.elements_length - index);
+		if (e) break;
+		e = duckVM_instruction_prepareForFuncall(duckVM, &functionObject, numberOfArgs);
+		if (e) break;
+		if (functionObject.type == duckVM_object_type_function) {
+			dl_size_t stackLength = duckVM->stack.elements_length;
+			e = functionObject.value.function.callback(duckVM);
+			if (e) {
+				eError = duckVM_error_pushRuntime(duckVM,
+				                                  DL_STR("duckVM_execute->funcall: C callback returned error."));
+				if (!e) e = eError;
+				break;
+			}
+			e = duckVM_checkCallback(duckVM, stackLength, numberOfArgs);
+			break;
+		}
+		else if (functionObject.type != duckVM_object_type_closure) {
+			e = dl_error_invalidValue;
+			eError = duckVM_error_pushRuntime(duckVM,
+			                                  DL_STR("duckVM_execute->funcall: Object is not a callback or closure."));
+			if (!e) e = eError;
+			break;
+		}
+		/* Call. */
+		e = call_stack_push(duckVM,
+		                    *ip,
+		                    *bytecode,
+		                    &functionObject.value.closure.upvalue_array->value.upvalue_array,
+		                    duckVM_closure_stackBase(duckVM, functionObject.value.closure));
+		if (e) break;
+		*bytecode = functionObject.value.closure.bytecode;
+		*ip = &(*bytecode)->value.bytecode.bytecode[functionObject.value.closure.name];
+	} while (0);
+	return e;
+}
+
+/* Call the object `index` elements from the top of the stack, reusing the current frame. `count` is the number of
+   objects that would have been popped from under the return value on the way back to the caller. Those objects are
+   popped now, and the arguments slide down to take their place. If the frame can't be reused, this is a normal
+   `funcall` and the instructions following it will clean up the frame as if this were never a tail call. */
+static dl_error_t duckVM_instruction_tailcall(duckVM_t *duckVM,
+                                              dl_uint8_t **ip,
+                                              duckVM_object_t **bytecode,
+                                              dl_ptrdiff_t index,
+                                              dl_uint8_t numberOfArgs,
+                                              dl_size_t count) {
+	dl_error_t e = dl_error_ok;
+	dl_error_t eError = dl_error_ok;
+
+	duckVM_object_t functionObject;
+	duckVM_callFrame_t *frame = dl_null;
+	dl_size_t args_length;
+	dl_size_t base;
+
+	do {
+		/* There's no frame to reuse at the top level. */
+		if (duckVM->call_stack.elements_length == 0) {
+			e = duckVM_instruction_funcall(duckVM, ip, bytecode, index, numberOfArgs);
+			break;
+		}
+		e = dl_array_get(&duckVM->stack, &functionObject, duckVM->stack.elements_length - index);
+		if (e) break;
+		/* Composites resolve to their function, and variadic arguments are packed into a list. */
+		e = duckVM_instruction_prepareForFuncall(duckVM, &functionObject, numberOfArgs);
+		if (e) break;
+		if (functionObject.type == duckVM_object_type_function) {
+			dl_size_t stackLength = duckVM->stack.elements_length;
+			e = functionObject.value.function.callback(duckVM);
+			if (e) {
+				eError = duckVM_error_pushRuntime(duckVM,
+				                                  DL_STR("duckVM_execute->tail-call: C callback returned error."));
+				if (!e) e = eError;
+				break;
+			}
+			e = duckVM_checkCallback(duckVM, stackLength, numberOfArgs);
+			break;
+		}
+		args_length = functionObject.value.closure.arity + (functionObject.value.closure.variadic ? 1 : 0);
+		base = duckVM->stack.elements_length - args_length;
+		if (count > base) {
+			e = dl_error_invalidValue;
+			eError = duckVM_error_pushRuntime(duckVM,
+			                                  DL_STR("duckVM_execute->tail-call: Pop count is larger than the stack."));
+			if (!e) e = eError;
+			break;
+		}
+		frame = &DL_ARRAY_GETTOPADDRESS(duckVM->call_stack, duckVM_callFrame_t);
+		/* Objects in the frame that have been captured still need to be released. Bail and let the rest of the
+		   function do it. Also bail if the pop would dig into the caller's frame, which only unverified code can ask
+		   for. */
+		{
+			dl_bool_t keepFrame = (base - count) < frame->stackBase;
+			DL_DOTIMES(k, count) {
+				if (DL_ARRAY_GETADDRESS(duckVM->upvalue_stack, duckVM_object_t *, base - count + k) != dl_null) {
+					keepFrame = dl_true;
+					break;
+				}
+			}
+			if (keepFrame) {
+				e = call_stack_push(duckVM,
+				                    *ip,
+				                    *bytecode,
+				                    &functionObject.value.closure.upvalue_array->value.upvalue_array,
+				                    base);
+				if (e) break;
+				*bytecode = functionObject.value.closure.bytecode;
+				*ip = &(*bytecode)->value.bytecode.bytecode[functionObject.value.closure.name];
+				break;
+			}
+		}
+		if (count > 0) {
+			/**/ dl_memcopy(&DL_ARRAY_GETADDRESS(duckVM->stack, duckVM_object_t, base - count),
+			                &DL_ARRAY_GETADDRESS(duckVM->stack, duckVM_object_t, base),
+			                args_length * sizeof(duckVM_object_t));
+			e = stack_pop_multiple(duckVM, count);
+			if (e) break;
+		}
+		/* Become the callee. */
+		frame->tailcallBytecode = functionObject.value.closure.bytecode;
+		frame->tailcallUpvalueArray = functionObject.value.closure.upvalue_array;
+		DL_ARRAY_GETTOPADDRESS(duckVM->upvalue_array_call_stack, duckVM_upvalueArray_t)
+			= functionObject.value.closure.upvalue_array->value.upvalue_array;
+		*bytecode = functionObject.value.closure.bytecode;
+		*ip = &(*bytecode)->value.bytecode.bytecode[functionObject.value.closure.name];
+	} while (0);
+	return e;
+}
+
+/* Pop `count` objects from under the return value and return to the caller. `checked` is set if the return
+   instruction wasn't verified. */
+static dl_error_t duckVM_instruction_return(duckVM_t *duckVM,
+                                            dl_uint8_t **ip,
+                                            duckVM_object_t **bytecode,
+                                            dl_ptrdiff_t count,
+                                            duckVM_halt_mode_t *halt,
+                                            dl_bool_t checked) {
+	dl_error_t e = dl_error_ok;
+
+	duckVM_object_t returnValue;
+
+	do {
+		if (duckVM->stack.elements_length > 0) {
+			e = dl_array_getTop(&duckVM->stack, &returnValue);
+			if (e) break;
+		}
+		e = stack_pop_multiple(duckVM, count);
+		if (e) break;
+		if (duckVM->stack.elements_length > 0) {
+			e = stack_pop_multiple(duckVM, 1);
+			if (e) break;
+			e = stack_push(duckVM, &returnValue);
+			if (e) break;
+		}
+		if (checked) {
+			e = duckVM_checkReturn(duckVM);
+			if (e) break;
+		}
+		e = call_stack_pop(duckVM, ip, bytecode);
+		if (e == dl_error_bufferUnderflow) {
+			*halt = duckVM_halt_mode_halt;
+			e = dl_error_ok;
+		}
+	} while (0);
+	return e;
+}
+
+static dl_error_t duckVM_instruction_ccall(duckVM_t *duckVM, dl_ptrdiff_t key, dl_uint8_t arity) {
+	dl_error_t e = dl_error_ok;
+	dl_error_t eError = dl_error_ok;
+
+	dl_size_t stackLength = duckVM->stack.elements_length;
+	dl_error_t (*callback)(duckVM_t *) = duckVM_callback_get(duckVM, key);
+	if (callback == dl_null) {
+		e = dl_error_invalidValue;
+		eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->c-call: Could not find global callback."));
+		if (eError) e = eError;
+		goto cleanup;
+	}
+	e = callback(duckVM);
+	if (e) {
+		eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->c-call: C callback returned error."));
+		if (!e) e = eError;
+		goto cleanup;
+	}
+	e = duckVM_checkCallback(duckVM, stackLength, arity);
+
+ cleanup:
+	return e;
+}
+
+static dl_size_t duckVM_decodeUnsigned(dl_uint8_t **ip, dl_size_t width) {
+	dl_size_t value = 0;
+	DL_DOTIMES(i, width) {
+		value = *((*ip)++) + (value << 8);
+	}
+	return value;
+}
+
+static dl_ptrdiff_t duckVM_decodeSigned(dl_uint8_t **ip, dl_size_t width) {
+	dl_size_t value = duckVM_decodeUnsigned(ip, width);
+	dl_size_t signBit = (dl_size_t) 1 << (8 * width - 1);
+	return (dl_ptrdiff_t) ((value ^ signBit) - signBit);
+}
+
+/* Read a relative address and convert it to an offset from the start of the bytecode. Addresses are relative to the
+   end of the address itself. */
+static dl_ptrdiff_t duckVM_decodeAddress(dl_uint8_t **ip, dl_uint8_t *bytecode, dl_size_t width) {
+	dl_ptrdiff_t address = duckVM_decodeSigned(ip, width);
+	return address + (*ip - bytecode);
+}
+
+/* Parse the operands of the instruction at `offset` so that it doesn't have to be done every time it runs. The
+   instruction must already be known to be well-formed. Branch targets are left as offsets. */
+static void duckVM_decodeInstruction(duckVM_decodedInstruction_t *decoded, dl_uint8_t *bytecode, dl_size_t offset) {
+	dl_uint8_t *ip = &bytecode[offset];
+	dl_uint8_t opcode = *(ip++);
+	dl_size_t width = 1;
+	dl_size_t count = 0;
+
+	decoded->offset = offset;
+	decoded->opcode = opcode;
+	/* Only the verifier may set this. */
+	decoded->verified = dl_false;
+	switch (opcode) {
+	case duckLisp_instruction_nop:
+		/* Fall through */
+	case duckLisp_instruction_pushBooleanFalse:
+		/* Fall through */
+	case duckLisp_instruction_pushBooleanTrue:
+		/* Fall through */
+	case duckLisp_instruction_makeType:
+		/* Fall through */
+	case duckLisp_instruction_return0:
+		/* Fall through */
+	case duckLisp_instruction_halt:
+		/* Fall through */
+	case duckLisp_instruction_nil:
+		break;
+
+	case duckLisp_instruction_pushDoubleFloat: {
+		dl_uint64_t totallyNotADoubleFloat = 0;
+		DL_DOTIMES(k, 8) {
+			totallyNotADoubleFloat = *(ip++) + (totallyNotADoubleFloat << 8);
+		}
+		/* `operands` is at least 12 bytes, even where pointers are 32 bits. */
+		/**/ dl_memcopy_noOverlap(decoded->operands, &totallyNotADoubleFloat, sizeof(double));
+		break;
+	}
+
+	case duckLisp_instruction_pushString8:
+		/* Fall through */
+	case duckLisp_instruction_pushString16:
+		/* Fall through */
+	case duckLisp_instruction_pushString32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_pushString8);
+		decoded->operands[0] = duckVM_decodeUnsigned(&ip, width);
+		decoded->operands[1] = ip - bytecode;
+		break;
+
+	case duckLisp_instruction_pushSymbol8:
+		/* Fall through */
+	case duckLisp_instruction_pushSymbol16:
+		/* Fall through */
+	case duckLisp_instruction_pushSymbol32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_pushSymbol8);
+		/* ID, then the name. */
+		decoded->operands[0] = duckVM_decodeUnsigned(&ip, width);
+		decoded->operands[1] = duckVM_decodeUnsigned(&ip, width);
+		decoded->operands[2] = ip - bytecode;
+		break;
+
+	case duckLisp_instruction_pushInteger8:
+		/* Fall through */
+	case duckLisp_instruction_pushInteger16:
+		/* Fall through */
+	case duckLisp_instruction_pushInteger32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_pushInteger8);
+		decoded->operands[0] = duckVM_decodeSigned(&ip, width);
+		break;
+
+	case duckLisp_instruction_pushClosure8:
+		/* Fall through */
+	case duckLisp_instruction_pushClosure16:
+		/* Fall through */
+	case duckLisp_instruction_pushClosure32:
+		/* Fall through */
+	case duckLisp_instruction_pushVaClosure8:
+		/* Fall through */
+	case duckLisp_instruction_pushVaClosure16:
+		/* Fall through */
+	case duckLisp_instruction_pushVaClosure32:
+		width = (dl_size_t) 1 << ((opcode - duckLisp_instruction_pushClosure8) % 3);
+		decoded->operands[0] = duckVM_decodeAddress(&ip, bytecode, width);
+		decoded->bytes[0] = *(ip++);
+		/* Captured upvalues, four bytes each. */
+		decoded->operands[1] = duckVM_decodeUnsigned(&ip, 4);
+		decoded->operands[2] = ip - bytecode;
+		break;
+
+	case duckLisp_instruction_setUpvalue8:
+		/* Fall through */
+	case duckLisp_instruction_setUpvalue16:
+		/* Fall through */
+	case duckLisp_instruction_setUpvalue32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_setUpvalue8);
+		decoded->operands[0] = *(ip++);
+		decoded->operands[1] = duckVM_decodeUnsigned(&ip, width);
+		break;
+
+	case duckLisp_instruction_releaseUpvalues8:
+		/* Fall through */
+	case duckLisp_instruction_releaseUpvalues16:
+		/* Fall through */
+	case duckLisp_instruction_releaseUpvalues32:
+		/* A one byte count regardless of the width, then the indices. */
+		decoded->operands[0] = *(ip++);
+		decoded->operands[1] = ip - bytecode;
+		break;
+	case duckLisp_instruction_vector8:
+		/* Fall through */
+	case duckLisp_instruction_vector16:
+		/* Fall through */
+	case duckLisp_instruction_vector32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_vector8);
+		decoded->operands[0] = duckVM_decodeUnsigned(&ip, width);
+		decoded->operands[1] = ip - bytecode;
+		break;
+
+	case duckLisp_instruction_funcall8:
+		/* Fall through */
+	case duckLisp_instruction_funcall16:
+		/* Fall through */
+	case duckLisp_instruction_funcall32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_funcall8);
+		goto callOperands;
+	case duckLisp_instruction_apply8:
+		/* Fall through */
+	case duckLisp_instruction_apply16:
+		/* Fall through */
+	case duckLisp_instruction_apply32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_apply8);
+		goto callOperands;
+	case duckLisp_instruction_ccall8:
+		/* Fall through */
+	case duckLisp_instruction_ccall16:
+		/* Fall through */
+	case duckLisp_instruction_ccall32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_ccall8);
+	callOperands:
+		/* The function's stack index or callback key, then the argument count. */
+		decoded->operands[0] = duckVM_decodeUnsigned(&ip, width);
+		decoded->bytes[0] = *(ip++);
+		break;
+	case duckLisp_instruction_call8:
+		/* Fall through */
+	case duckLisp_instruction_call16:
+		/* Fall through */
+	case duckLisp_instruction_call32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_call8);
+		decoded->operands[0] = duckVM_decodeAddress(&ip, bytecode, width);
+		decoded->bytes[0] = *(ip++);
+		break;
+	case duckLisp_instruction_tailcall8:
+		/* Fall through */
+	case duckLisp_instruction_tailcall16:
+		/* Fall through */
+	case duckLisp_instruction_tailcall32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_tailcall8);
+		decoded->operands[0] = duckVM_decodeUnsigned(&ip, width);
+		decoded->bytes[0] = *(ip++);
+		decoded->operands[1] = duckVM_decodeUnsigned(&ip, width);
+		break;
+
+	case duckLisp_instruction_jump8:
+		/* Fall through */
+	case duckLisp_instruction_jump16:
+		/* Fall through */
+	case duckLisp_instruction_jump32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_jump8);
+		decoded->operands[0] = duckVM_decodeAddress(&ip, bytecode, width);
+		break;
+	case duckLisp_instruction_brnz8:
+		/* Fall through */
+	case duckLisp_instruction_brnz16:
+		/* Fall through */
+	case duckLisp_instruction_brnz32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_brnz8);
+		decoded->operands[0] = duckVM_decodeAddress(&ip, bytecode, width);
+		decoded->operands[1] = *(ip++);
+		break;
+	case duckLisp_instruction_brLess8:
+		/* Fall through */
+	case duckLisp_instruction_brLess16:
+		/* Fall through */
+	case duckLisp_instruction_brLess32:
+		/* Fall through */
+	case duckLisp_instruction_brGreater8:
+		/* Fall through */
+	case duckLisp_instruction_brGreater16:
+		/* Fall through */
+	case duckLisp_instruction_brGreater32:
+		/* Fall through */
+	case duckLisp_instruction_brEqual8:
+		/* Fall through */
+	case duckLisp_instruction_brEqual16:
+		/* Fall through */
+	case duckLisp_instruction_brEqual32:
+		/* Fall through */
+	case duckLisp_instruction_brNullp8:
+		/* Fall through */
+	case duckLisp_instruction_brNullp16:
+		/* Fall through */
+	case duckLisp_instruction_brNullp32:
+		/* Each family has an 8, 16, and 32 bit version, in that order. */
+		width = (dl_size_t) 1 << ((opcode - duckLisp_instruction_brLess8) % 3);
+		decoded->operands[0] = duckVM_decodeAddress(&ip, bytecode, width);
+		decoded->operands[1] = *(ip++);
+		decoded->bytes[0] = *(ip++);
+		/* `brNullp` only has one index, so it's decoded into both slots. */
+		decoded->bytes[1] = ((opcode >= duckLisp_instruction_brNullp8)
+		                     ? decoded->bytes[0]
+		                     : *(ip++));
+		break;
+
+		/* Everything else is one to three operands of the same width. */
+	case duckLisp_instruction_pushIndex8:
+		/* Fall through */
+	case duckLisp_instruction_pushStrippedSymbol8:
+		/* Fall through */
+	case duckLisp_instruction_pushUpvalue8:
+		/* Fall through */
+	case duckLisp_instruction_pushGlobal8:
+		/* Fall through */
+	case duckLisp_instruction_pop8:
+		/* Fall through */
+	case duckLisp_instruction_return8:
+		/* Fall through */
+	case duckLisp_instruction_not8:
+		/* Fall through */
+	case duckLisp_instruction_car8:
+		/* Fall through */
+	case duckLisp_instruction_cdr8:
+		/* Fall through */
+	case duckLisp_instruction_nullp8:
+		/* Fall through */
+	case duckLisp_instruction_typeof8:
+		/* Fall through */
+	case duckLisp_instruction_compositeValue8:
+		/* Fall through */
+	case duckLisp_instruction_compositeFunction8:
+		/* Fall through */
+	case duckLisp_instruction_makeString8:
+		/* Fall through */
+	case duckLisp_instruction_length8:
+		/* Fall through */
+	case duckLisp_instruction_symbolString8:
+		/* Fall through */
+	case duckLisp_instruction_symbolId8:
+		width = 1;
+		count = 1;
+		break;
+	case duckLisp_instruction_pushIndex16:
+		/* Fall through */
+	case duckLisp_instruction_pushStrippedSymbol16:
+		/* Fall through */
+	case duckLisp_instruction_pushUpvalue16:
+		/* Fall through */
+	case duckLisp_instruction_pushGlobal16:
+		/* Fall through */
+	case duckLisp_instruction_pop16:
+		/* Fall through */
+	case duckLisp_instruction_return16:
+		/* Fall through */
+	case duckLisp_instruction_not16:
+		/* Fall through */
+	case duckLisp_instruction_car16:
+		/* Fall through */
+	case duckLisp_instruction_cdr16:
+		/* Fall through */
+	case duckLisp_instruction_nullp16:
+		/* Fall through */
+	case duckLisp_instruction_typeof16:
+		/* Fall through */
+	case duckLisp_instruction_compositeValue16:
+		/* Fall through */
+	case duckLisp_instruction_compositeFunction16:
+		/* Fall through */
+	case duckLisp_instruction_makeString16:
+		/* Fall through */
+	case duckLisp_instruction_length16:
+		/* Fall through */
+	case duckLisp_instruction_symbolString16:
+		/* Fall through */
+	case duckLisp_instruction_symbolId16:
+		width = 2;
+		count = 1;
+		break;
+	case duckLisp_instruction_pushIndex32:
+		/* Fall through */
+	case duckLisp_instruction_pushStrippedSymbol32:
+		/* Fall through */
+	case duckLisp_instruction_pushUpvalue32:
+		/* Fall through */
+	case duckLisp_instruction_pushGlobal32:
+		/* Fall through */
+	case duckLisp_instruction_pop32:
+		/* Fall through */
+	case duckLisp_instruction_return32:
+		/* Fall through */
+	case duckLisp_instruction_not32:
+		/* Fall through */
+	case duckLisp_instruction_car32:
+		/* Fall through */
+	case duckLisp_instruction_cdr32:
+		/* Fall through */
+	case duckLisp_instruction_nullp32:
+		/* Fall through */
+	case duckLisp_instruction_typeof32:
+		/* Fall through */
+	case duckLisp_instruction_compositeValue32:
+		/* Fall through */
+	case duckLisp_instruction_compositeFunction32:
+		/* Fall through */
+	case duckLisp_instruction_makeString32:
+		/* Fall through */
+	case duckLisp_instruction_length32:
+		/* Fall through */
+	case duckLisp_instruction_symbolString32:
+		/* Fall through */
+	case duckLisp_instruction_symbolId32:
+		width = 4;
+		count = 1;
+		break;
+
+	case duckLisp_instruction_setGlobal8:
+		/* Fall through */
+	case duckLisp_instruction_move8:
+		/* Fall through */
+	case duckLisp_instruction_mul8:
+		/* Fall through */
+	case duckLisp_instruction_div8:
+		/* Fall through */
+	case duckLisp_instruction_add8:
+		/* Fall through */
+	case duckLisp_instruction_sub8:
+		/* Fall through */
+	case duckLisp_instruction_equal8:
+		/* Fall through */
+	case duckLisp_instruction_greater8:
+		/* Fall through */
+	case duckLisp_instruction_less8:
+		/* Fall through */
+	case duckLisp_instruction_cons8:
+		/* Fall through */
+	case duckLisp_instruction_makeVector8:
+		/* Fall through */
+	case duckLisp_instruction_getVecElt8:
+		/* Fall through */
+	case duckLisp_instruction_setCar8:
+		/* Fall through */
+	case duckLisp_instruction_setCdr8:
+		/* Fall through */
+	case duckLisp_instruction_setCompositeValue8:
+		/* Fall through */
+	case duckLisp_instruction_setCompositeFunction8:
+		/* Fall through */
+	case duckLisp_instruction_concatenate8:
+		width = 1;
+		count = 2;
+		break;
+	case duckLisp_instruction_setGlobal16:
+		/* Fall through */
+	case duckLisp_instruction_move16:
+		/* Fall through */
+	case duckLisp_instruction_mul16:
+		/* Fall through */
+	case duckLisp_instruction_div16:
+		/* Fall through */
+	case duckLisp_instruction_add16:
+		/* Fall through */
+	case duckLisp_instruction_sub16:
+		/* Fall through */
+	case duckLisp_instruction_equal16:
+		/* Fall through */
+	case duckLisp_instruction_greater16:
+		/* Fall through */
+	case duckLisp_instruction_less16:
+		/* Fall through */
+	case duckLisp_instruction_cons16:
+		/* Fall through */
+	case duckLisp_instruction_makeVector16:
+		/* Fall through */
+	case duckLisp_instruction_getVecElt16:
+		/* Fall through */
+	case duckLisp_instruction_setCar16:
+		/* Fall through */
+	case duckLisp_instruction_setCdr16:
+		/* Fall through */
+	case duckLisp_instruction_setCompositeValue16:
+		/* Fall through */
+	case duckLisp_instruction_setCompositeFunction16:
+		/* Fall through */
+	case duckLisp_instruction_concatenate16:
+		width = 2;
+		count = 2;
+		break;
+	case duckLisp_instruction_setGlobal32:
+		/* Fall through */
+	case duckLisp_instruction_move32:
+		/* Fall through */
+	case duckLisp_instruction_mul32:
+		/* Fall through */
+	case duckLisp_instruction_div32:
+		/* Fall through */
+	case duckLisp_instruction_add32:
+		/* Fall through */
+	case duckLisp_instruction_sub32:
+		/* Fall through */
+	case duckLisp_instruction_equal32:
+		/* Fall through */
+	case duckLisp_instruction_greater32:
+		/* Fall through */
+	case duckLisp_instruction_less32:
+		/* Fall through */
+	case duckLisp_instruction_cons32:
+		/* Fall through */
+	case duckLisp_instruction_makeVector32:
+		/* Fall through */
+	case duckLisp_instruction_getVecElt32:
+		/* Fall through */
+	case duckLisp_instruction_setCar32:
+		/* Fall through */
+	case duckLisp_instruction_setCdr32:
+		/* Fall through */
+	case duckLisp_instruction_setCompositeValue32:
+		/* Fall through */
+	case duckLisp_instruction_setCompositeFunction32:
+		/* Fall through */
+	case duckLisp_instruction_concatenate32:
+		width = 4;
+		count = 2;
+		break;
+
+	case duckLisp_instruction_setVecElt8:
+		/* Fall through */
+	case duckLisp_instruction_makeInstance8:
+		/* Fall through */
+	case duckLisp_instruction_substring8:
+		width = 1;
+		count = 3;
+		break;
+	case duckLisp_instruction_setVecElt16:
+		/* Fall through */
+	case duckLisp_instruction_makeInstance16:
+		/* Fall through */
+	case duckLisp_instruction_substring16:
+		width = 2;
+		count = 3;
+		break;
+	case duckLisp_instruction_setVecElt32:
+		/* Fall through */
+	case duckLisp_instruction_makeInstance32:
+		/* Fall through */
+	case duckLisp_instruction_substring32:
+		width = 4;
+		count = 3;
+		break;
+
+	default:
+		if ((opcode >= duckLisp_instruction_addInt8) && (opcode <= duckLisp_instruction_greaterFloat32)) {
+			/* Type-specialized arithmetic takes the same operands as the generic version. */
+			width = (dl_size_t) 1 << ((opcode - duckLisp_instruction_addInt8) % 3);
+			count = 2;
+		}
+		else {
+			decoded->opcode = DUCKVM_OPCODE_INVALID;
+		}
+	}
+	DL_DOTIMES(k, count) {
+		decoded->operands[k] = duckVM_decodeUnsigned(&ip, width);
+	}
+}
+
+/* Bytecode verification */
+
+/* What the verifier needs to know about an instruction. */
+typedef struct {
+	dl_size_t length;
+	dl_size_t deepestIndex;  /* Deepest stack index the instruction reads. Zero if it doesn't read the stack. */
+	dl_size_t pops;  /* Objects removed from the stack. */
+	dl_size_t pushes;  /* Objects added after the pops. */
+	dl_bool_t fallsThrough;
+	dl_ptrdiff_t branch;  /* Offset of the branch target, or -1. */
+	dl_ptrdiff_t function;  /* Offset of the body of a closure being created, or -1. */
+	dl_size_t functionDepth;  /* Number of arguments on the stack when that body is entered. */
+} duckVM_verifierInstruction_t;
+
+/* Read a big-endian operand. Fails instead of reading past the end of the bytecode. */
+static dl_bool_t duckVM_verifier_read(const duckVM_bytecode_t *bytecode,
+                                      dl_size_t *offset,
+                                      dl_size_t width,
+                                      dl_size_t *value) {
+	if ((width > bytecode->bytecode_length) || (*offset > bytecode->bytecode_length - width)) return dl_false;
+	*value = 0;
+	DL_DOTIMES(k, width) {
+		*value = bytecode->bytecode[(*offset)++] + (*value << 8);
+	}
+	return dl_true;
+}
+
+/* Read a stack index. Index zero is the slot above the top of the stack, so it's never valid. The instruction is still
+   parsed so the decoder can step over it, but no frame is deep enough to verify it. */
+static dl_bool_t duckVM_verifier_readIndex(const duckVM_bytecode_t *bytecode,
+                                           dl_size_t *offset,
+                                           dl_size_t width,
+                                           duckVM_verifierInstruction_t *instruction) {
+	dl_size_t index = 0;
+	if (!duckVM_verifier_read(bytecode, offset, width, &index)) return dl_false;
+	if (index == 0) index = (dl_size_t) -1;
+	if (index > instruction->deepestIndex) instruction->deepestIndex = index;
+	return dl_true;
+}
+
+/* Read a relative address and convert it to an offset from the start of the bytecode. Addresses are relative to the
+   end of the address itself. */
+static dl_bool_t duckVM_verifier_readAddress(const duckVM_bytecode_t *bytecode,
+                                             dl_size_t *offset,
+                                             dl_size_t width,
+                                             dl_ptrdiff_t *address) {
+	dl_size_t value = 0;
+	dl_size_t signBit = (dl_size_t) 1 << (8 * width - 1);
+	if (!duckVM_verifier_read(bytecode, offset, width, &value)) return dl_false;
+	*address = (dl_ptrdiff_t) *offset + (dl_ptrdiff_t) ((value ^ signBit) - signBit);
+	return dl_true;
+}
+
+/* Skip `length` bytes of inline data. */
+static dl_bool_t duckVM_verifier_skip(const duckVM_bytecode_t *bytecode, dl_size_t *offset, dl_size_t length) {
+	if (length > bytecode->bytecode_length - *offset) return dl_false;
+	*offset += length;
+	return dl_true;
+}
+
+/* Parse the instruction at `start`. Returns false if the instruction is malformed or if it's one the verifier doesn't
+   understand. */
+static dl_bool_t duckVM_verifier_parse(const duckVM_bytecode_t *bytecode,
+                                       dl_size_t start,
+                                       duckVM_verifierInstruction_t *instruction) {
+	dl_size_t offset = start;
+	dl_size_t width = 1;
+	dl_size_t value = 0;
+	dl_size_t count = 0;
+	dl_uint8_t opcode;
+
+	instruction->deepestIndex = 0;
+	instruction->pops = 0;
+	instruction->pushes = 0;
+	instruction->fallsThrough = dl_true;
+	instruction->branch = -1;
+	instruction->function = -1;
+	instruction->functionDepth = 0;
+
+	if (start >= bytecode->bytecode_length) return dl_false;
+	opcode = bytecode->bytecode[offset++];
+	switch (opcode) {
+	case duckLisp_instruction_nop:
+		break;
+
+	case duckLisp_instruction_pushBooleanFalse:
+		/* Fall through */
+	case duckLisp_instruction_pushBooleanTrue:
+		/* Fall through */
+	case duckLisp_instruction_makeType:
+		/* Fall through */
+	case duckLisp_instruction_nil:
+		instruction->pushes = 1;
+		break;
+
+	case duckLisp_instruction_pushDoubleFloat:
+		if (!duckVM_verifier_skip(bytecode, &offset, 8)) return dl_false;
+		instruction->pushes = 1;
+		break;
+
+	case duckLisp_instruction_pushString8:
+		/* Fall through */
+	case duckLisp_instruction_pushString16:
+		/* Fall through */
+	case duckLisp_instruction_pushString32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_pushString8);
+		if (!duckVM_verifier_read(bytecode, &offset, width, &value)) return dl_false;
+		if (!duckVM_verifier_skip(bytecode, &offset, value)) return dl_false;
+		instruction->pushes = 1;
+		break;
+
+	case duckLisp_instruction_pushSymbol8:
+		/* Fall through */
+	case duckLisp_instruction_pushSymbol16:
+		/* Fall through */
+	case duckLisp_instruction_pushSymbol32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_pushSymbol8);
+		/* ID, then the name. */
+		if (!duckVM_verifier_read(bytecode, &offset, width, &value)) return dl_false;
+		if (!duckVM_verifier_read(bytecode, &offset, width, &value)) return dl_false;
+		if (!duckVM_verifier_skip(bytecode, &offset, value)) return dl_false;
+		instruction->pushes = 1;
+		break;
+
+	case duckLisp_instruction_pushInteger8:
+		/* Fall through */
+	case duckLisp_instruction_pushInteger16:
+		/* Fall through */
+	case duckLisp_instruction_pushInteger32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_pushInteger8);
+		if (!duckVM_verifier_read(bytecode, &offset, width, &value)) return dl_false;
+		instruction->pushes = 1;
+		break;
+	case duckLisp_instruction_pushStrippedSymbol8:
+		/* Fall through */
+	case duckLisp_instruction_pushStrippedSymbol16:
+		/* Fall through */
+	case duckLisp_instruction_pushStrippedSymbol32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_pushStrippedSymbol8);
+		if (!duckVM_verifier_read(bytecode, &offset, width, &value)) return dl_false;
+		instruction->pushes = 1;
+		break;
+	case duckLisp_instruction_pushIndex8:
+		/* Fall through */
+	case duckLisp_instruction_pushIndex16:
+		/* Fall through */
+	case duckLisp_instruction_pushIndex32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_pushIndex8);
+		if (!duckVM_verifier_readIndex(bytecode, &offset, width, instruction)) return dl_false;
+		instruction->pushes = 1;
+		break;
+	case duckLisp_instruction_pushUpvalue8:
+		/* Fall through */
+	case duckLisp_instruction_pushUpvalue16:
+		/* Fall through */
+	case duckLisp_instruction_pushUpvalue32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_pushUpvalue8);
+		if (!duckVM_verifier_read(bytecode, &offset, width, &value)) return dl_false;
+		instruction->pushes = 1;
+		break;
+	case duckLisp_instruction_pushGlobal8:
+		/* Fall through */
+	case duckLisp_instruction_pushGlobal16:
+		/* Fall through */
+	case duckLisp_instruction_pushGlobal32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_pushGlobal8);
+		if (!duckVM_verifier_read(bytecode, &offset, width, &value)) return dl_false;
+		instruction->pushes = 1;
+		break;
+
+	case duckLisp_instruction_pushClosure8:
+		/* Fall through */
+	case duckLisp_instruction_pushClosure16:
+		/* Fall through */
+	case duckLisp_instruction_pushClosure32:
+		/* Fall through */
+	case duckLisp_instruction_pushVaClosure8:
+		/* Fall through */
+	case duckLisp_instruction_pushVaClosure16:
+		/* Fall through */
+	case duckLisp_instruction_pushVaClosure32:
+		width = (dl_size_t) 1 << ((opcode - duckLisp_instruction_pushClosure8) % 3);
+		if (!duckVM_verifier_readAddress(bytecode, &offset, width, &instruction->function)) return dl_false;
+		/* Arity */
+		if (!duckVM_verifier_read(bytecode, &offset, 1, &value)) return dl_false;
+		instruction->functionDepth = value + (opcode >= duckLisp_instruction_pushVaClosure8);
+		/* Captured upvalues. These are checked by the VM. */
+		if (!duckVM_verifier_read(bytecode, &offset, 4, &count)) return dl_false;
+		if (count > (bytecode->bytecode_length - offset) / 4) return dl_false;
+		offset += 4 * count;
+		instruction->pushes = 1;
+		break;
+
+	case duckLisp_instruction_setUpvalue8:
+		/* Fall through */
+	case duckLisp_instruction_setUpvalue16:
+		/* Fall through */
+	case duckLisp_instruction_setUpvalue32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_setUpvalue8);
+		if (!duckVM_verifier_read(bytecode, &offset, 1, &value)) return dl_false;
+		if (!duckVM_verifier_readIndex(bytecode, &offset, width, instruction)) return dl_false;
+		break;
+	case duckLisp_instruction_setGlobal8:
+		/* Fall through */
+	case duckLisp_instruction_setGlobal16:
+		/* Fall through */
+	case duckLisp_instruction_setGlobal32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_setGlobal8);
+		if (!duckVM_verifier_readIndex(bytecode, &offset, width, instruction)) return dl_false;
+		if (!duckVM_verifier_read(bytecode, &offset, width, &value)) return dl_false;
+		break;
+	case duckLisp_instruction_releaseUpvalues8:
+		/* Fall through */
+	case duckLisp_instruction_releaseUpvalues16:
+		/* Fall through */
+	case duckLisp_instruction_releaseUpvalues32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_releaseUpvalues8);
+		/* The VM reads a one byte count regardless of the width. */
+		if (!duckVM_verifier_read(bytecode, &offset, 1, &count)) return dl_false;
+		DL_DOTIMES(k, count) {
+			if (!duckVM_verifier_readIndex(bytecode, &offset, width, instruction)) return dl_false;
+		}
+		break;
+
+		/* Calls replace their arguments with the return value. */
+	case duckLisp_instruction_funcall8:
+		/* Fall through */
+	case duckLisp_instruction_funcall16:
+		/* Fall through */
+	case duckLisp_instruction_funcall32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_funcall8);
+		if (!duckVM_verifier_readIndex(bytecode, &offset, width, instruction)) return dl_false;
+		if (!duckVM_verifier_read(bytecode, &offset, 1, &instruction->pops)) return dl_false;
+		instruction->pushes = 1;
+		break;
+	case duckLisp_instruction_tailcall8:
+		/* Fall through */
+	case duckLisp_instruction_tailcall16:
+		/* Fall through */
+	case duckLisp_instruction_tailcall32:
+		/* If the frame can't be reused, this is a `funcall`. If it can, control never comes back here. */
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_tailcall8);
+		if (!duckVM_verifier_readIndex(bytecode, &offset, width, instruction)) return dl_false;
+		if (!duckVM_verifier_read(bytecode, &offset, 1, &instruction->pops)) return dl_false;
+		if (!duckVM_verifier_read(bytecode, &offset, width, &value)) return dl_false;
+		instruction->pushes = 1;
+		break;
+	case duckLisp_instruction_apply8:
+		/* Fall through */
+	case duckLisp_instruction_apply16:
+		/* Fall through */
+	case duckLisp_instruction_apply32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_apply8);
+		if (!duckVM_verifier_readIndex(bytecode, &offset, width, instruction)) return dl_false;
+		if (!duckVM_verifier_read(bytecode, &offset, 1, &instruction->pops)) return dl_false;
+		/* The list of remaining arguments. */
+		instruction->pops++;
+		instruction->pushes = 1;
+		break;
+	case duckLisp_instruction_ccall8:
+		/* Fall through */
+	case duckLisp_instruction_ccall16:
+		/* Fall through */
+	case duckLisp_instruction_ccall32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_ccall8);
+		if (!duckVM_verifier_read(bytecode, &offset, width, &value)) return dl_false;
+		if (!duckVM_verifier_read(bytecode, &offset, 1, &instruction->pops)) return dl_false;
+		instruction->pushes = 1;
+		break;
+
+	case duckLisp_instruction_jump8:
+		/* Fall through */
+	case duckLisp_instruction_jump16:
+		/* Fall through */
+	case duckLisp_instruction_jump32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_jump8);
+		if (!duckVM_verifier_readAddress(bytecode, &offset, width, &instruction->branch)) return dl_false;
+		instruction->fallsThrough = dl_false;
+		break;
+	case duckLisp_instruction_brnz8:
+		/* Fall through */
+	case duckLisp_instruction_brnz16:
+		/* Fall through */
+	case duckLisp_instruction_brnz32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_brnz8);
+		if (!duckVM_verifier_readAddress(bytecode, &offset, width, &instruction->branch)) return dl_false;
+		if (!duckVM_verifier_read(bytecode, &offset, 1, &instruction->pops)) return dl_false;
+		/* The condition is on top. */
+		instruction->deepestIndex = 1;
+		break;
+	case duckLisp_instruction_brLess8:
+		/* Fall through */
+	case duckLisp_instruction_brLess16:
+		/* Fall through */
+	case duckLisp_instruction_brLess32:
+		/* Fall through */
+	case duckLisp_instruction_brGreater8:
+		/* Fall through */
+	case duckLisp_instruction_brGreater16:
+		/* Fall through */
+	case duckLisp_instruction_brGreater32:
+		/* Fall through */
+	case duckLisp_instruction_brEqual8:
+		/* Fall through */
+	case duckLisp_instruction_brEqual16:
+		/* Fall through */
+	case duckLisp_instruction_brEqual32:
+		/* Fall through */
+	case duckLisp_instruction_brNullp8:
+		/* Fall through */
+	case duckLisp_instruction_brNullp16:
+		/* Fall through */
+	case duckLisp_instruction_brNullp32:
+		width = (dl_size_t) 1 << ((opcode - duckLisp_instruction_brLess8) % 3);
+		if (!duckVM_verifier_readAddress(bytecode, &offset, width, &instruction->branch)) return dl_false;
+		if (!duckVM_verifier_read(bytecode, &offset, 1, &instruction->pops)) return dl_false;
+		if (!duckVM_verifier_readIndex(bytecode, &offset, 1, instruction)) return dl_false;
+		if (opcode < duckLisp_instruction_brNullp8) {
+			if (!duckVM_verifier_readIndex(bytecode, &offset, 1, instruction)) return dl_false;
+		}
+		break;
+
+	case duckLisp_instruction_pop8:
+		/* Fall through */
+	case duckLisp_instruction_pop16:
+		/* Fall through */
+	case duckLisp_instruction_pop32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_pop8);
+		if (!duckVM_verifier_read(bytecode, &offset, width, &instruction->pops)) return dl_false;
+		break;
+	case duckLisp_instruction_move8:
+		/* Fall through */
+	case duckLisp_instruction_move16:
+		/* Fall through */
+	case duckLisp_instruction_move32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_move8);
+		count = 2;
+		/* Doesn't push anything. */
+		DL_DOTIMES(k, count) {
+			if (!duckVM_verifier_readIndex(bytecode, &offset, width, instruction)) return dl_false;
 		}
-		/* Call. */
-		e = call_stack_push(duckVM, ip, bytecode, &object1.value.closure.upvalue_array->value.upvalue_array);
-		if (e) break;
-		bytecode = object1.value.closure.bytecode;
-		ip = &bytecode->value.bytecode.bytecode[object1.value.closure.name];
 		break;
 
-		/* I probably don't need an `if` if I research the standard a bit. */
-	case duckLisp_instruction_call32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+		/* Instructions that read one stack index and push their result. */
+	case duckLisp_instruction_not8:
+		/* Fall through */
+	case duckLisp_instruction_car8:
+		/* Fall through */
+	case duckLisp_instruction_cdr8:
+		/* Fall through */
+	case duckLisp_instruction_nullp8:
+		/* Fall through */
+	case duckLisp_instruction_typeof8:
+		/* Fall through */
+	case duckLisp_instruction_compositeValue8:
+		/* Fall through */
+	case duckLisp_instruction_compositeFunction8:
+		/* Fall through */
+	case duckLisp_instruction_makeString8:
+		/* Fall through */
+	case duckLisp_instruction_length8:
+		/* Fall through */
+	case duckLisp_instruction_symbolString8:
+		/* Fall through */
+	case duckLisp_instruction_symbolId8:
+		width = 1;
+		count = 1;
+		goto indexedOperator;
+	case duckLisp_instruction_not16:
+		/* Fall through */
+	case duckLisp_instruction_car16:
+		/* Fall through */
+	case duckLisp_instruction_cdr16:
+		/* Fall through */
+	case duckLisp_instruction_nullp16:
+		/* Fall through */
+	case duckLisp_instruction_typeof16:
+		/* Fall through */
+	case duckLisp_instruction_compositeValue16:
+		/* Fall through */
+	case duckLisp_instruction_compositeFunction16:
+		/* Fall through */
+	case duckLisp_instruction_makeString16:
+		/* Fall through */
+	case duckLisp_instruction_length16:
+		/* Fall through */
+	case duckLisp_instruction_symbolString16:
+		/* Fall through */
+	case duckLisp_instruction_symbolId16:
+		width = 2;
+		count = 1;
+		goto indexedOperator;
+	case duckLisp_instruction_not32:
+		/* Fall through */
+	case duckLisp_instruction_car32:
+		/* Fall through */
+	case duckLisp_instruction_cdr32:
+		/* Fall through */
+	case duckLisp_instruction_nullp32:
+		/* Fall through */
+	case duckLisp_instruction_typeof32:
+		/* Fall through */
+	case duckLisp_instruction_compositeValue32:
+		/* Fall through */
+	case duckLisp_instruction_compositeFunction32:
+		/* Fall through */
+	case duckLisp_instruction_makeString32:
+		/* Fall through */
+	case duckLisp_instruction_length32:
+		/* Fall through */
+	case duckLisp_instruction_symbolString32:
+		/* Fall through */
+	case duckLisp_instruction_symbolId32:
+		width = 4;
+		count = 1;
+		goto indexedOperator;
+
+		/* Two stack indices. */
+	case duckLisp_instruction_mul8:
+		/* Fall through */
+	case duckLisp_instruction_div8:
+		/* Fall through */
+	case duckLisp_instruction_add8:
+		/* Fall through */
+	case duckLisp_instruction_sub8:
+		/* Fall through */
+	case duckLisp_instruction_equal8:
+		/* Fall through */
+	case duckLisp_instruction_greater8:
+		/* Fall through */
+	case duckLisp_instruction_less8:
+		/* Fall through */
+	case duckLisp_instruction_cons8:
+		/* Fall through */
+	case duckLisp_instruction_makeVector8:
+		/* Fall through */
+	case duckLisp_instruction_getVecElt8:
+		/* Fall through */
+	case duckLisp_instruction_setCar8:
+		/* Fall through */
+	case duckLisp_instruction_setCdr8:
+		/* Fall through */
+	case duckLisp_instruction_setCompositeValue8:
+		/* Fall through */
+	case duckLisp_instruction_setCompositeFunction8:
+		/* Fall through */
+	case duckLisp_instruction_concatenate8:
+		width = 1;
+		count = 2;
+		goto indexedOperator;
+	case duckLisp_instruction_mul16:
+		/* Fall through */
+	case duckLisp_instruction_div16:
+		/* Fall through */
+	case duckLisp_instruction_add16:
+		/* Fall through */
+	case duckLisp_instruction_sub16:
+		/* Fall through */
+	case duckLisp_instruction_equal16:
+		/* Fall through */
+	case duckLisp_instruction_greater16:
+		/* Fall through */
+	case duckLisp_instruction_less16:
+		/* Fall through */
+	case duckLisp_instruction_cons16:
+		/* Fall through */
+	case duckLisp_instruction_makeVector16:
+		/* Fall through */
+	case duckLisp_instruction_getVecElt16:
+		/* Fall through */
+	case duckLisp_instruction_setCar16:
+		/* Fall through */
+	case duckLisp_instruction_setCdr16:
+		/* Fall through */
+	case duckLisp_instruction_setCompositeValue16:
+		/* Fall through */
+	case duckLisp_instruction_setCompositeFunction16:
+		/* Fall through */
+	case duckLisp_instruction_concatenate16:
+		width = 2;
+		count = 2;
+		goto indexedOperator;
+	case duckLisp_instruction_mul32:
+		/* Fall through */
+	case duckLisp_instruction_div32:
+		/* Fall through */
+	case duckLisp_instruction_add32:
+		/* Fall through */
+	case duckLisp_instruction_sub32:
+		/* Fall through */
+	case duckLisp_instruction_equal32:
+		/* Fall through */
+	case duckLisp_instruction_greater32:
+		/* Fall through */
+	case duckLisp_instruction_less32:
+		/* Fall through */
+	case duckLisp_instruction_cons32:
+		/* Fall through */
+	case duckLisp_instruction_makeVector32:
+		/* Fall through */
+	case duckLisp_instruction_getVecElt32:
+		/* Fall through */
+	case duckLisp_instruction_setCar32:
+		/* Fall through */
+	case duckLisp_instruction_setCdr32:
+		/* Fall through */
+	case duckLisp_instruction_setCompositeValue32:
+		/* Fall through */
+	case duckLisp_instruction_setCompositeFunction32:
+		/* Fall through */
+	case duckLisp_instruction_concatenate32:
+		width = 4;
+		count = 2;
+		goto indexedOperator;
+
+		/* Three stack indices. */
+	case duckLisp_instruction_setVecElt8:
 		/* Fall through */
-	case duckLisp_instruction_call16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+	case duckLisp_instruction_makeInstance8:
 		/* Fall through */
-	case duckLisp_instruction_call8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		call_stack_push(duckVM, ip, bytecode, dl_null);
-		if (e) break;
-		if (opcode == duckLisp_instruction_call32) {
-			if (ptrdiff1 & 0x80000000ULL) {
-				ip -= ((~ptrdiff1 + 1) & 0xFFFFFFFFULL);
-			}
-			else {
-				ip += ptrdiff1;
-			}
-		}
-		else if (opcode == duckLisp_instruction_call16) {
-			if (ptrdiff1 & 0x8000ULL) {
-				ip -= ((~ptrdiff1 + 1) & 0xFFFFULL);
-			}
-			else {
-				ip += ptrdiff1;
-			}
-		}
-		else {
-			if (ptrdiff1 & 0x80ULL) {
-				ip -= ((~ptrdiff1 + 1) & 0xFFULL);
-			}
-			else {
-				ip += ptrdiff1;
-			}
-		}
-		--ip;
-		break;
+	case duckLisp_instruction_substring8:
+		width = 1;
+		count = 3;
+		goto indexedOperator;
+	case duckLisp_instruction_setVecElt16:
+		/* Fall through */
+	case duckLisp_instruction_makeInstance16:
+		/* Fall through */
+	case duckLisp_instruction_substring16:
+		width = 2;
+		count = 3;
+		goto indexedOperator;
+	case duckLisp_instruction_setVecElt32:
+		/* Fall through */
+	case duckLisp_instruction_makeInstance32:
+		/* Fall through */
+	case duckLisp_instruction_substring32:
+		width = 4;
+		count = 3;
+		goto indexedOperator;
 
-	case duckLisp_instruction_ccall32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+	case duckLisp_instruction_addInt8:
 		/* Fall through */
-	case duckLisp_instruction_ccall16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+	case duckLisp_instruction_addInt16:
 		/* Fall through */
-	case duckLisp_instruction_ccall8:
-		// I should probably delete this and have `funcall` handle callbacks.
-		{
-			duckVM_object_t *global;
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			e = duckVM_global_get(duckVM, &global, ptrdiff1);
-			if (e) {
-				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_execute->c-call: Could not find global callback."));
-				if (!e) e = eError;
-				break;
-			}
-			e = global->value.function.callback(duckVM);
-			if (e) {
-				eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->c-call: C callback returned error."));
-				if (!e) e = eError;
-				break;
-			}
-		}
+	case duckLisp_instruction_addInt32:
+		/* Fall through */
+	case duckLisp_instruction_addFloat8:
+		/* Fall through */
+	case duckLisp_instruction_addFloat16:
+		/* Fall through */
+	case duckLisp_instruction_addFloat32:
+		/* Fall through */
+	case duckLisp_instruction_subInt8:
+		/* Fall through */
+	case duckLisp_instruction_subInt16:
+		/* Fall through */
+	case duckLisp_instruction_subInt32:
+		/* Fall through */
+	case duckLisp_instruction_subFloat8:
+		/* Fall through */
+	case duckLisp_instruction_subFloat16:
+		/* Fall through */
+	case duckLisp_instruction_subFloat32:
+		/* Fall through */
+	case duckLisp_instruction_mulInt8:
+		/* Fall through */
+	case duckLisp_instruction_mulInt16:
+		/* Fall through */
+	case duckLisp_instruction_mulInt32:
+		/* Fall through */
+	case duckLisp_instruction_mulFloat8:
+		/* Fall through */
+	case duckLisp_instruction_mulFloat16:
+		/* Fall through */
+	case duckLisp_instruction_mulFloat32:
+		/* Fall through */
+	case duckLisp_instruction_lessInt8:
+		/* Fall through */
+	case duckLisp_instruction_lessInt16:
+		/* Fall through */
+	case duckLisp_instruction_lessInt32:
+		/* Fall through */
+	case duckLisp_instruction_lessFloat8:
+		/* Fall through */
+	case duckLisp_instruction_lessFloat16:
+		/* Fall through */
+	case duckLisp_instruction_lessFloat32:
+		/* Fall through */
+	case duckLisp_instruction_greaterInt8:
+		/* Fall through */
+	case duckLisp_instruction_greaterInt16:
+		/* Fall through */
+	case duckLisp_instruction_greaterInt32:
+		/* Fall through */
+	case duckLisp_instruction_greaterFloat8:
+		/* Fall through */
+	case duckLisp_instruction_greaterFloat16:
+		/* Fall through */
+	case duckLisp_instruction_greaterFloat32:
+		width = (dl_size_t) 1 << ((opcode - duckLisp_instruction_addInt8) % 3);
+		count = 2;
+		goto indexedOperator;
+
+	case duckLisp_instruction_vector8:
+		/* Fall through */
+	case duckLisp_instruction_vector16:
+		/* Fall through */
+	case duckLisp_instruction_vector32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_vector8);
+		if (!duckVM_verifier_read(bytecode, &offset, width, &count)) return dl_false;
+		if (count > (bytecode->bytecode_length - offset) / width) return dl_false;
+	indexedOperator:
+		DL_DOTIMES(k, count) {
+			if (!duckVM_verifier_readIndex(bytecode, &offset, width, instruction)) return dl_false;
+		}
+		instruction->pushes = 1;
 		break;
 
-		// I probably don't need an `if` if I research the standard a bit.
-	case duckLisp_instruction_jump32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		if (ptrdiff1 & 0x80000000ULL) {
-			ip -= ((~ptrdiff1 + 1) & 0xFFFFFFFFULL);
-		}
-		else {
-			ip += ptrdiff1;
-		}
+	case duckLisp_instruction_return8:
+		/* Fall through */
+	case duckLisp_instruction_return16:
+		/* Fall through */
+	case duckLisp_instruction_return32:
+		width = (dl_size_t) 1 << (opcode - duckLisp_instruction_return8);
+		if (!duckVM_verifier_read(bytecode, &offset, width, &value)) return dl_false;
+		/* The caller expects the return value to be left right above the arguments, so the frame can't be any
+		   smaller than the objects being popped plus the return value. */
+		instruction->deepestIndex = value + 1;
+		instruction->fallsThrough = dl_false;
 		break;
-	case duckLisp_instruction_jump16:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		if (ptrdiff1 & 0x8000ULL) {
-			ip -= ((~ptrdiff1 + 1) & 0xFFFFULL);
-		}
-		else {
-			ip += ptrdiff1;
-		}
+	case duckLisp_instruction_return0:
+		instruction->deepestIndex = 1;
+		instruction->fallsThrough = dl_false;
 		break;
-	case duckLisp_instruction_jump8:
-		ptrdiff1 = *(ip++);
-		if (ptrdiff1 & 0x80ULL) {
-			ip -= ((~ptrdiff1 + 1) & 0xFFULL);
-		}
-		else {
-			ip += ptrdiff1;
-		}
+	case duckLisp_instruction_halt:
+		instruction->fallsThrough = dl_false;
 		break;
 
-		// I probably don't need an `if` if I research the standard a bit.
-	case duckLisp_instruction_brnz32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		parsedBytecode = dl_true;
-		/* Fall through */
-	case duckLisp_instruction_brnz16:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			parsedBytecode = dl_true;
+	default:
+		/* `call`, `acall`, and `brz` are never generated. */
+		return dl_false;
+	}
+	instruction->length = offset - start;
+	return dl_true;
+}
+
+/* Mark the instruction at `offset` as reachable with `depth` objects in the current frame. Fails if it was already
+   reached with a different depth. */
+static dl_error_t duckVM_verifier_reach(dl_array_t *worklist,
+                                        dl_size_t *depths,
+                                        dl_size_t length,
+                                        dl_ptrdiff_t offset,
+                                        dl_size_t depth,
+                                        dl_bool_t *ok) {
+	if ((offset < 0) || ((dl_size_t) offset >= length)) {
+		*ok = dl_false;
+		return dl_error_ok;
+	}
+	if (depths[offset] == 0) {
+		depths[offset] = depth + 1;
+		return dl_array_pushElement(worklist, &offset);
+	}
+	if (depths[offset] != depth + 1) *ok = dl_false;
+	return dl_error_ok;
+}
+
+/* Prove that the bytecode is safe to run without checking stack indices. It must:
+   - never read a stack index deeper than its own frame,
+   - only branch to the start of an instruction, and
+   - have the same stack depth on every path into an instruction.
+   If it passes, every reachable instruction is marked as verified. If it doesn't, nothing is marked and the
+   bytecode runs on the checked path. The only error this returns is a failed allocation. */
+static dl_error_t duckVM_verifyBytecode(duckVM_t *duckVM, duckVM_bytecode_t *bytecode) {
+	dl_error_t e = dl_error_ok;
+	dl_error_t eError = dl_error_ok;
+
+	dl_size_t length = bytecode->bytecode_length;
+	/* Stack depth on entry to each instruction, plus one. Zero if the instruction hasn't been reached. */
+	dl_size_t *depths = dl_null;
+	dl_array_t worklist;  /* dl_array_t:dl_ptrdiff_t */
+	duckVM_verifierInstruction_t instruction;
+	dl_ptrdiff_t offset = 0;
+	dl_size_t depth = 0;
+	dl_size_t end = 0;
+	dl_bool_t ok = dl_true;
+	/**/ dl_array_init(&worklist, duckVM->memoryAllocation, sizeof(dl_ptrdiff_t), dl_array_strategy_double);
+
+	if ((length == 0) || (bytecode->decoded == dl_null)) goto cleanup;
+
+	e = DL_MALLOC(duckVM->memoryAllocation, &depths, length, dl_size_t);
+	if (e) {
+		eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_verifyBytecode: Allocation failed."));
+		if (eError) e = eError;
+		goto cleanup;
+	}
+	/**/ dl_memclear(depths, length * sizeof(dl_size_t));
+
+	/* Top-level code can't assume anything is on the stack. */
+	e = duckVM_verifier_reach(&worklist, depths, length, 0, 0, &ok);
+	if (e) goto cleanup;
+	while (ok && (worklist.elements_length > 0)) {
+		e = dl_array_popElement(&worklist, &offset);
+		if (e) goto cleanup;
+		depth = depths[offset] - 1;
+		if (!duckVM_verifier_parse(bytecode, offset, &instruction)
+		    || (instruction.deepestIndex > depth)
+		    || (instruction.pops > depth)) {
+			ok = dl_false;
+			break;
 		}
-		/* Fall through */
-	case duckLisp_instruction_brnz8:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
+		depth = depth - instruction.pops + instruction.pushes;
+		if (instruction.fallsThrough) {
+			e = duckVM_verifier_reach(&worklist, depths, length, offset + instruction.length, depth, &ok);
+			if (e) goto cleanup;
 		}
-		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - 1);
-		if (e) break;
-		ptrdiff2 = *(ip++);
-		e = stack_pop_multiple(duckVM, ptrdiff2);
-		if (e) break;
-		{
-			dl_bool_t truthy = dl_false;
-			if (object1.type == duckVM_object_type_bool) {
-				truthy = object1.value.boolean;
-			}
-			else if (object1.type == duckVM_object_type_integer) {
-				truthy = object1.value.integer != 0;
-			}
-			else if (object1.type == duckVM_object_type_float) {
-				truthy = object1.value.floatingPoint != 0.0;
-			}
-			else if (object1.type == duckVM_object_type_symbol) {
-				truthy = dl_true;
-			}
-			else if (object1.type == duckVM_object_type_list) {
-				truthy = object1.value.list != dl_null;
-			}
-			else if (object1.type == duckVM_object_type_closure) {
-				truthy = dl_true;
-			}
-			else if (object1.type == duckVM_object_type_function) {
-				truthy = dl_true;
-			}
-			else if (object1.type == duckVM_object_type_string) {
-				truthy = dl_true;
-			}
-			else if (object1.type == duckVM_object_type_vector) {
-				truthy = ((object1.value.vector.internal_vector != dl_null)
-				          && ((dl_size_t) object1.value.vector.offset
-				              < object1.value.vector.internal_vector->value.internal_vector.length));
-			}
-			if (truthy) {
-				if ((opcode == duckLisp_instruction_brnz8) && (ptrdiff1 & 0x80ULL)) {
-					ip -= ((~ptrdiff1 + 1) & 0xFFULL);
-				}
-				else if ((opcode == duckLisp_instruction_brnz16) && (ptrdiff1 & 0x8000ULL)) {
-					ip -= ((~ptrdiff1 + 1) & 0xFFFFULL);
-				}
-				else if ((opcode == duckLisp_instruction_brnz32) && (ptrdiff1 & 0x80000000ULL)) {
-					ip -= ((~ptrdiff1 + 1) & 0xFFFFFFFFULL);
-				}
-				else {
-					ip += ptrdiff1;
-				}
-				--ip; /* This accounts for the pop argument. */
-			}
+		if (instruction.branch != -1) {
+			e = duckVM_verifier_reach(&worklist, depths, length, instruction.branch, depth, &ok);
+			if (e) goto cleanup;
 		}
-		break;
+		if (instruction.function != -1) {
+			/* Function bodies start with only their arguments. */
+			e = duckVM_verifier_reach(&worklist, depths, length, instruction.function, instruction.functionDepth, &ok);
+			if (e) goto cleanup;
+		}
+	}
+	if (!ok) goto cleanup;
+
+	/* Every branch target was parsed as an instruction, but it might be in the middle of some other instruction. */
+	DL_DOTIMES(k, length) {
+		if (depths[k] == 0) continue;
+		if ((dl_size_t) k < end) goto cleanup;
+		(void) duckVM_verifier_parse(bytecode, k, &instruction);
+		end = k + instruction.length;
+	}
 
-		// I probably don't need an `if` if I research the standard a bit.
-	case duckLisp_instruction_pop32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		// Fall through
-	case duckLisp_instruction_pop16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		// Fall through
-	case duckLisp_instruction_pop8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		e = stack_pop_multiple(duckVM, ptrdiff1);
-		break;
+	DL_DOTIMES(k, length) {
+		if (depths[k] == 0) continue;
+		bytecode->decoded->instructions[bytecode->decoded->indices[k]].verified = dl_true;
+	}
 
-		// I probably don't need an `if` if I research the standard a bit.
-	case duckLisp_instruction_move32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		parsedBytecode = dl_true;
-		// Fall through
-	case duckLisp_instruction_move16:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			ptrdiff2 = *(ip++);
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			parsedBytecode = dl_true;
-		}
-		// Fall through
-	case duckLisp_instruction_move8:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff2 = *(ip++);
+ cleanup:
+	if (depths != dl_null) {
+		eError = DL_FREE(duckVM->memoryAllocation, &depths);
+		if (eError) e = eError;
+	}
+	eError = dl_array_quit(&worklist);
+	if (eError) e = eError;
+	return e;
+}
+
+
+/* Length of the instruction at `offset`, or zero if it can't be run. */
+static dl_size_t duckVM_decoder_length(const duckVM_bytecode_t *bytecode, dl_size_t offset) {
+	duckVM_verifierInstruction_t instruction;
+	dl_uint8_t opcode = bytecode->bytecode[offset];
+	if (duckVM_verifier_parse(bytecode, offset, &instruction)) return instruction.length;
+	/* `call` is never generated, so the verifier rejects it, but it can still be run. */
+	if ((opcode >= duckLisp_instruction_call8) && (opcode <= duckLisp_instruction_call32)) {
+		dl_size_t length = 2 + ((dl_size_t) 1 << (opcode - duckLisp_instruction_call8));
+		if (length <= bytecode->bytecode_length - offset) return length;
+	}
+	return 0;
+}
+
+/* Decode every instruction of the bytecode into one array, in order, followed by a `DUCKVM_OPCODE_INVALID`. An
+   instruction that can't be parsed is decoded as `DUCKVM_OPCODE_INVALID` too, and decoding stops there since there's
+   no telling where the next instruction starts. This takes 32 bytes per instruction and 4 bytes per byte of
+   bytecode. */
+static dl_error_t duckVM_decodeBytecode(duckVM_t *duckVM, duckVM_bytecode_t *bytecode) {
+	dl_error_t e = dl_error_ok;
+	dl_error_t eError = dl_error_ok;
+
+	duckVM_decodedBytecode_t *decoded = dl_null;
+	duckVM_decodedInstruction_t *instructions = dl_null;
+	void *payload = dl_null;
+	dl_size_t offset = 0;
+	dl_size_t length = 0;
+	dl_size_t instructionLength = 0;
+	/* Keeps the instructions aligned. */
+	dl_size_t headerSize = ((sizeof(duckVM_decodedBytecode_t) + sizeof(duckVM_decodedInstruction_t) - 1)
+	                        / sizeof(duckVM_decodedInstruction_t)
+	                        * sizeof(duckVM_decodedInstruction_t));
+
+	/* Offsets and indices are stored in 32 bits. */
+	if (bytecode->bytecode_length >= 0xFFFFFFFFu) {
+		e = dl_error_invalidValue;
+		eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_decodeBytecode: Bytecode is too long."));
+		if (eError) e = eError;
+		goto cleanup;
+	}
+	while (offset < bytecode->bytecode_length) {
+		instructionLength = duckVM_decoder_length(bytecode, offset);
+		length++;
+		if (instructionLength == 0) break;
+		offset += instructionLength;
+	}
+
+	e = duckVM_gclist_allocPayload(&duckVM->gclist,
+	                               &payload,
+	                               (headerSize
+	                                + (length + 1) * sizeof(duckVM_decodedInstruction_t)
+	                                + (bytecode->bytecode_length + 1) * sizeof(dl_uint32_t)));
+	if (e) {
+		eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_decodeBytecode: Allocation failed."));
+		if (eError) e = eError;
+		goto cleanup;
+	}
+	decoded = payload;
+	decoded->length = length;
+	decoded->instructions = (duckVM_decodedInstruction_t *) ((dl_uint8_t *) payload + headerSize);
+	decoded->indices = (dl_uint32_t *) &decoded->instructions[length + 1];
+	instructions = decoded->instructions;
+	/**/ dl_memclear(instructions, (length + 1) * sizeof(duckVM_decodedInstruction_t));
+	DL_DOTIMES(k, bytecode->bytecode_length + 1) {
+		decoded->indices[k] = length;
+	}
+
+	offset = 0;
+	DL_DOTIMES(k, length) {
+		instructionLength = duckVM_decoder_length(bytecode, offset);
+		decoded->indices[offset] = k;
+		if (instructionLength == 0) {
+			instructions[k].opcode = DUCKVM_OPCODE_INVALID;
+			instructions[k].offset = offset;
+			break;
 		}
-		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
-		if (e) break;
-		object2 = object1;
-		e = dl_array_set(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
-		if (e) break;
+		duckVM_decodeInstruction(&instructions[k], bytecode->bytecode, offset);
+		offset += instructionLength;
+	}
+	instructions[length].opcode = DUCKVM_OPCODE_INVALID;
+	instructions[length].offset = bytecode->bytecode_length;
+
+	/* Resolve branches so that the VM can go straight to the instruction. Branches to anywhere that isn't the start of
+	   an instruction go to the invalid instruction at the end. */
+	DL_DOTIMES(k, length) {
+		dl_uint8_t opcode = instructions[k].opcode;
+		dl_ptrdiff_t target = instructions[k].operands[0];
+		if (((opcode < duckLisp_instruction_call8) || (opcode > duckLisp_instruction_call32))
+		    && ((opcode < duckLisp_instruction_jump8) || (opcode > duckLisp_instruction_jump32))
+		    && ((opcode < duckLisp_instruction_brnz8) || (opcode > duckLisp_instruction_brnz32))
+		    && ((opcode < duckLisp_instruction_brLess8) || (opcode > duckLisp_instruction_brNullp32))) {
+			continue;
+		}
+		instructions[k].operands[0] = (((target < 0) || ((dl_size_t) target > bytecode->bytecode_length))
+		                               ? (dl_ptrdiff_t) length
+		                               : (dl_ptrdiff_t) decoded->indices[target]);
+	}
+	duckVM->gclist.decodedBytes += duckVM_gclist_payloadSize(payload);
+	bytecode->decoded = decoded;
+
+ cleanup:
+	return e;
+}
+
+/* Find the decoded instruction that `ip` points to, decoding the bytecode first if it hasn't been yet. Calls and
+   returns use this, since they only know where they're going by address. An `ip` that isn't at the start of an
+   instruction gets one that fails when run. */
+static dl_error_t duckVM_instructionAt(duckVM_t *duckVM,
+                                       duckVM_object_t *bytecode,
+                                       dl_uint8_t *ip,
+                                       duckVM_decodedInstruction_t **instruction) {
+	dl_error_t e = dl_error_ok;
+	duckVM_bytecode_t *internalBytecode = &bytecode->value.bytecode;
+	dl_ptrdiff_t offset = ip - internalBytecode->bytecode;
+
+	if (internalBytecode->decoded == dl_null) {
+		e = duckVM_decodeBytecode(duckVM, internalBytecode);
+		if (e) goto cleanup;
+	}
+	if ((offset < 0) || ((dl_size_t) offset > internalBytecode->bytecode_length)) {
+		offset = internalBytecode->bytecode_length;
+	}
+	*instruction = &internalBytecode->decoded->instructions[internalBytecode->decoded->indices[offset]];
+
+ cleanup:
+	return e;
+}
+
+/* With `USE_THREADED_DISPATCH`, `duckVM_executeInstruction` doesn't return after every instruction. It keeps running
+   until the VM halts or an error occurs, so the locals below are only set up once per call instead of once per
+   instruction. GCC and Clang jump directly from the end of one instruction to the next instruction's handler using
+   computed gotos. Other compilers fall back to looping around the switch. */
+#if defined(USE_THREADED_DISPATCH) && defined(__GNUC__)
+# define DUCKVM_THREADED_GOTO
+#endif
+
+#ifdef DUCKVM_THREADED_GOTO
+# define DUCKVM_LABEL(name) duckVM_op_##name:
+/* Labels as values and range initializers aren't ISO C. The extra label after each `case` also hides the
+   "Fall through" comments from GCC, but those are still checked in the switch build. */
+# pragma GCC diagnostic push
+# pragma GCC diagnostic ignored "-Wpedantic"
+# pragma GCC diagnostic ignored "-Woverride-init"
+# pragma GCC diagnostic ignored "-Wimplicit-fallthrough"
+#else
+# define DUCKVM_LABEL(name)
+#endif
+
+int duckVM_executeInstruction(duckVM_t *duckVM,
+                              duckVM_object_t **bytecodePtr,
+                              duckVM_decodedInstruction_t **instructionPtr,
+                              duckVM_halt_mode_t *halt) {
+	dl_error_t e = dl_error_ok;
+	dl_error_t eError = dl_error_ok;
+
+	dl_ptrdiff_t ptrdiff1 = 0;
+	dl_ptrdiff_t ptrdiff2 = 0;
+	dl_ptrdiff_t ptrdiff3 = 0;
+	dl_size_t size1 = 0;
+	dl_size_t size2 = 0;
+	dl_uint8_t uint8 = 0;
+	duckVM_object_t object1 = {0};
+	duckVM_object_t object2 = {0};
+	duckVM_object_t object3 = {0};
+	duckVM_object_t *objectPtr1 = {0};
+	duckVM_object_t *objectPtr2 = {0};
+	duckVM_object_t cons1 = {0};
+	dl_bool_t bool1 = dl_false;
+	duckVM_object_t *bytecode = *bytecodePtr;
+	duckVM_decodedInstruction_t *instruction = *instructionPtr;
+	/* The instruction to run after this one. Jumps, calls, and returns change it. */
+	duckVM_decodedInstruction_t *next = dl_null;
+	/* Only used to read inline data, and for calls and returns, which keep track of where they are by address. */
+	dl_uint8_t *ip = dl_null;
+	dl_uint8_t opcode;
+#ifdef DUCKVM_THREADED_GOTO
+	/* Every width of an instruction goes to the same handler. */
+	static const void *const dispatchTable[256] = {
+		[0 ... 255] = &&duckVM_op_default,
+		[duckLisp_instruction_nop] = &&duckVM_op_nop,
+		[duckLisp_instruction_pushString8 ... duckLisp_instruction_pushString32] = &&duckVM_op_pushString,
+		[duckLisp_instruction_pushBooleanFalse] = &&duckVM_op_pushBooleanFalse,
+		[duckLisp_instruction_pushBooleanTrue] = &&duckVM_op_pushBooleanTrue,
+		[duckLisp_instruction_pushInteger8 ... duckLisp_instruction_pushInteger32] = &&duckVM_op_pushInteger,
+		[duckLisp_instruction_pushDoubleFloat] = &&duckVM_op_pushDoubleFloat,
+		[duckLisp_instruction_pushIndex8 ... duckLisp_instruction_pushIndex32] = &&duckVM_op_pushIndex,
+		[duckLisp_instruction_pushSymbol8 ... duckLisp_instruction_pushSymbol32] = &&duckVM_op_pushSymbol,
+		[duckLisp_instruction_pushStrippedSymbol8 ... duckLisp_instruction_pushStrippedSymbol32] = &&duckVM_op_pushStrippedSymbol,
+		[duckLisp_instruction_pushUpvalue8 ... duckLisp_instruction_pushUpvalue32] = &&duckVM_op_pushUpvalue,
+		[duckLisp_instruction_pushClosure8 ... duckLisp_instruction_pushVaClosure32] = &&duckVM_op_pushClosure,
+		[duckLisp_instruction_pushGlobal8 ... duckLisp_instruction_pushGlobal32] = &&duckVM_op_pushGlobal,
+		[duckLisp_instruction_setUpvalue8 ... duckLisp_instruction_setUpvalue32] = &&duckVM_op_setUpvalue,
+		[duckLisp_instruction_setGlobal8 ... duckLisp_instruction_setGlobal32] = &&duckVM_op_setGlobal,
+		[duckLisp_instruction_releaseUpvalues8 ... duckLisp_instruction_releaseUpvalues32] = &&duckVM_op_releaseUpvalues,
+		[duckLisp_instruction_funcall8 ... duckLisp_instruction_funcall32] = &&duckVM_op_funcall,
+		[duckLisp_instruction_apply8 ... duckLisp_instruction_apply32] = &&duckVM_op_apply,
+		[duckLisp_instruction_call8 ... duckLisp_instruction_call32] = &&duckVM_op_call,
+		[duckLisp_instruction_ccall8 ... duckLisp_instruction_ccall32] = &&duckVM_op_ccall,
+		[duckLisp_instruction_jump8 ... duckLisp_instruction_jump32] = &&duckVM_op_jump,
+		[duckLisp_instruction_brnz8 ... duckLisp_instruction_brnz32] = &&duckVM_op_brnz,
+		[duckLisp_instruction_move8 ... duckLisp_instruction_move32] = &&duckVM_op_move,
+		[duckLisp_instruction_not8 ... duckLisp_instruction_not32] = &&duckVM_op_not,
+		[duckLisp_instruction_mul8 ... duckLisp_instruction_mul32] = &&duckVM_op_mul,
+		[duckLisp_instruction_div8 ... duckLisp_instruction_div32] = &&duckVM_op_div,
+		[duckLisp_instruction_add8 ... duckLisp_instruction_add32] = &&duckVM_op_add,
+		[duckLisp_instruction_sub8 ... duckLisp_instruction_sub32] = &&duckVM_op_sub,
+		[duckLisp_instruction_equal8 ... duckLisp_instruction_equal32] = &&duckVM_op_equal,
+		[duckLisp_instruction_greater8 ... duckLisp_instruction_greater32] = &&duckVM_op_greater,
+		[duckLisp_instruction_less8 ... duckLisp_instruction_less32] = &&duckVM_op_less,
+		[duckLisp_instruction_cons8 ... duckLisp_instruction_cons32] = &&duckVM_op_cons,
+		[duckLisp_instruction_vector8 ... duckLisp_instruction_vector32] = &&duckVM_op_vector,
+		[duckLisp_instruction_makeVector8 ... duckLisp_instruction_makeVector32] = &&duckVM_op_makeVector,
+		[duckLisp_instruction_getVecElt8 ... duckLisp_instruction_getVecElt32] = &&duckVM_op_getVecElt,
+		[duckLisp_instruction_setVecElt8 ... duckLisp_instruction_setVecElt32] = &&duckVM_op_setVecElt,
+		[duckLisp_instruction_car8 ... duckLisp_instruction_car32] = &&duckVM_op_car,
+		[duckLisp_instruction_cdr8 ... duckLisp_instruction_cdr32] = &&duckVM_op_cdr,
+		[duckLisp_instruction_setCar8 ... duckLisp_instruction_setCar32] = &&duckVM_op_setCar,
+		[duckLisp_instruction_setCdr8 ... duckLisp_instruction_setCdr32] = &&duckVM_op_setCdr,
+		[duckLisp_instruction_nullp8 ... duckLisp_instruction_nullp32] = &&duckVM_op_nullp,
+		[duckLisp_instruction_typeof8 ... duckLisp_instruction_typeof32] = &&duckVM_op_typeof,
+		[duckLisp_instruction_makeType] = &&duckVM_op_makeType,
+		[duckLisp_instruction_makeInstance8 ... duckLisp_instruction_makeInstance32] = &&duckVM_op_makeInstance,
+		[duckLisp_instruction_compositeValue8 ... duckLisp_instruction_compositeValue32] = &&duckVM_op_compositeValue,
+		[duckLisp_instruction_compositeFunction8 ... duckLisp_instruction_compositeFunction32] = &&duckVM_op_compositeFunction,
+		[duckLisp_instruction_setCompositeValue8 ... duckLisp_instruction_setCompositeValue32] = &&duckVM_op_setCompositeValue,
+		[duckLisp_instruction_setCompositeFunction8 ... duckLisp_instruction_setCompositeFunction32] = &&duckVM_op_setCompositeFunction,
+		[duckLisp_instruction_makeString8 ... duckLisp_instruction_makeString32] = &&duckVM_op_makeString,
+		[duckLisp_instruction_concatenate8 ... duckLisp_instruction_concatenate32] = &&duckVM_op_concatenate,
+		[duckLisp_instruction_substring8 ... duckLisp_instruction_substring32] = &&duckVM_op_substring,
+		[duckLisp_instruction_length8 ... duckLisp_instruction_length32] = &&duckVM_op_length,
+		[duckLisp_instruction_symbolString8 ... duckLisp_instruction_symbolString32] = &&duckVM_op_symbolString,
+		[duckLisp_instruction_symbolId8 ... duckLisp_instruction_symbolId32] = &&duckVM_op_symbolId,
+		[duckLisp_instruction_pop8 ... duckLisp_instruction_pop32] = &&duckVM_op_pop,
+		[duckLisp_instruction_return0] = &&duckVM_op_return0,
+		[duckLisp_instruction_return8 ... duckLisp_instruction_return32] = &&duckVM_op_return,
+		[duckLisp_instruction_halt] = &&duckVM_op_halt,
+		[duckLisp_instruction_nil] = &&duckVM_op_nil,
+		[duckLisp_instruction_brLess8 ... duckLisp_instruction_brNullp32] = &&duckVM_op_brCompare,
+		[duckLisp_instruction_tailcall8 ... duckLisp_instruction_tailcall32] = &&duckVM_op_tailcall,
+		[duckLisp_instruction_addInt8 ... duckLisp_instruction_addFloat32] = &&duckVM_op_addTyped,
+		[duckLisp_instruction_subInt8 ... duckLisp_instruction_subFloat32] = &&duckVM_op_subTyped,
+		[duckLisp_instruction_mulInt8 ... duckLisp_instruction_mulFloat32] = &&duckVM_op_mulTyped,
+		[duckLisp_instruction_lessInt8 ... duckLisp_instruction_lessFloat32] = &&duckVM_op_lessTyped,
+		[duckLisp_instruction_greaterInt8 ... duckLisp_instruction_greaterFloat32] = &&duckVM_op_greaterTyped,
+	};
+#endif
+#ifdef USE_THREADED_DISPATCH
+ dispatch:
+#endif
+	next = instruction + 1;
+	opcode = instruction->opcode;
+#ifdef DUCKVM_THREADED_GOTO
+	goto *dispatchTable[opcode];
+#endif
+	switch (opcode) {
+	case duckLisp_instruction_nop: DUCKVM_LABEL(nop)
 		break;
 
-		// I probably don't need an `if` if I research the standard a bit.
-	case duckLisp_instruction_not32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+	case duckLisp_instruction_pushSymbol8:
 		/* Fall through */
-	case duckLisp_instruction_not16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+	case duckLisp_instruction_pushSymbol16:
 		/* Fall through */
-	case duckLisp_instruction_not8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
+	case duckLisp_instruction_pushSymbol32: DUCKVM_LABEL(pushSymbol)
+		size2 = instruction->operands[0];
+		size1 = instruction->operands[1];
+		e = duckVM_object_makeSymbol(duckVM,
+		                             &object1,
+		                             size2,
+		                             &bytecode->value.bytecode.bytecode[instruction->operands[2]],
+		                             size1);
 		if (e) break;
-		switch (object1.type) {
-		case duckVM_object_type_vector:
-			object1.type = duckVM_object_type_bool;
-			object1.value.boolean = object1.value.vector.internal_vector == dl_null;
-			break;
-		case duckVM_object_type_list:
-			object1.type = duckVM_object_type_bool;
-			object1.value.boolean = object1.value.list == dl_null;
-			break;
-		case duckVM_object_type_integer:
-			object1.value.integer = !object1.value.integer;
-			break;
-		case duckVM_object_type_float:
-			object1.value.floatingPoint = !object1.value.floatingPoint;
-			break;
-		case duckVM_object_type_bool:
-			object1.value.boolean = !object1.value.boolean;
-			break;
-		default:
-			e = dl_error_invalidValue;
-			eError = duckVM_error_pushRuntime(duckVM,
-			                                  DL_STR("duckVM_execute->not: Object is not a boolean, integer, float, list, or vector."));
+		e = stack_push(duckVM, &object1);
+		if (e) {
+			eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->push-symbol: stack_push failed."));
 			if (!e) e = eError;
-			goto cleanup;
 		}
-		e = stack_push(duckVM, &object1);
 		break;
 
-		// I probably don't need an `if` if I research the standard a bit.
-	case duckLisp_instruction_mul32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
-		if (e) break;
-		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
-		if (e) break;
-		switch (object1.type) {
-		case duckVM_object_type_float:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint *= object2.value.floatingPoint;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.floatingPoint *= object2.value.integer;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.floatingPoint *= object2.value.boolean;
-				object1.type = duckVM_object_type_float;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		case duckVM_object_type_integer:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.integer * object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				/* Type already set. */
-				object1.value.integer *= object2.value.integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.integer *= object2.value.boolean;
-				object1.type = duckVM_object_type_integer;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		case duckVM_object_type_bool:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.boolean * object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.integer = object1.value.boolean * object2.value.integer;
-				object1.type = duckVM_object_type_integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.boolean *= object2.value.boolean;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		default:
-			e = dl_error_invalidValue;
-			goto cleanup;
-		}
-		e = stack_push(duckVM, &object1);
-		if (e) break;
-		break;
-	case duckLisp_instruction_mul16:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
-		if (e) break;
-		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
-		if (e) break;
-		switch (object1.type) {
-		case duckVM_object_type_float:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint *= object2.value.floatingPoint;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.floatingPoint *= object2.value.integer;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.floatingPoint *= object2.value.boolean;
-				object1.type = duckVM_object_type_float;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		case duckVM_object_type_integer:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.integer * object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				/* Type already set. */
-				object1.value.integer *= object2.value.integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.integer *= object2.value.boolean;
-				object1.type = duckVM_object_type_integer;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		case duckVM_object_type_bool:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.boolean * object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.integer = object1.value.boolean * object2.value.integer;
-				object1.type = duckVM_object_type_integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.boolean *= object2.value.boolean;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		default:
-			e = dl_error_invalidValue;
-			goto cleanup;
-		}
-		e = stack_push(duckVM, &object1);
-		break;
-	case duckLisp_instruction_mul8:
-		ptrdiff1 = *(ip++);
-		ptrdiff2 = *(ip++);
-		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
-		if (e) break;
-		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
-		if (e) break;
-		switch (object1.type) {
-		case duckVM_object_type_float:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint *= object2.value.floatingPoint;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.floatingPoint *= object2.value.integer;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.floatingPoint *= object2.value.boolean;
-				object1.type = duckVM_object_type_float;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		case duckVM_object_type_integer:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.integer * object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				/* Type already set. */
-				object1.value.integer *= object2.value.integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.integer *= object2.value.boolean;
-				object1.type = duckVM_object_type_integer;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		case duckVM_object_type_bool:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.boolean * object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.integer = object1.value.boolean * object2.value.integer;
-				object1.type = duckVM_object_type_integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.boolean *= object2.value.boolean;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		default:
-			e = dl_error_invalidValue;
-			goto cleanup;
+	case duckLisp_instruction_pushStrippedSymbol8:
+		/* Fall through */
+	case duckLisp_instruction_pushStrippedSymbol16:
+		/* Fall through */
+	case duckLisp_instruction_pushStrippedSymbol32: DUCKVM_LABEL(pushStrippedSymbol)
+		size2 = instruction->operands[0];
+		(void) duckVM_object_makeCompressedSymbol(&object1, size2);
+		e = stack_push(duckVM, &object1);
+		if (e) {
+			eError = duckVM_error_pushRuntime(duckVM,
+			                                  DL_STR("duckVM_execute->push-stripped-symbol: stack_push failed."));
+			if (!e) e = eError;
+		}
+		break;
+
+	case duckLisp_instruction_pushString8:
+		/* Fall through */
+	case duckLisp_instruction_pushString16:
+		/* Fall through */
+	case duckLisp_instruction_pushString32: DUCKVM_LABEL(pushString)
+		e = duckVM_object_makeString(duckVM,
+		                             &object1,
+		                             &bytecode->value.bytecode.bytecode[instruction->operands[1]],
+		                             instruction->operands[0]);
+		if (e) {
+			(eError
+			 = duckVM_error_pushRuntime(duckVM,
+			                            DL_STR("duckVM_execute->push-string: duckVM_object_makeString failed.")));
+			if (!e) e = eError;
 		}
 		e = stack_push(duckVM, &object1);
+		if (e) {
+			eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->push-string: stack_push failed."));
+			if (!e) e = eError;
+		}
 		break;
 
-		// I probably don't need an `if` if I research the standard a bit.
-	case duckLisp_instruction_div32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
-		if (e) break;
-		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
-		if (e) break;
-		switch (object1.type) {
-		case duckVM_object_type_float:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint /= object2.value.floatingPoint;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.floatingPoint /= object2.value.integer;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.floatingPoint /= object2.value.boolean;
-				object1.type = duckVM_object_type_float;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		case duckVM_object_type_integer:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.integer / object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				/* Type already set. */
-				object1.value.integer /= object2.value.integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.integer /= object2.value.boolean;
-				object1.type = duckVM_object_type_integer;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		case duckVM_object_type_bool:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.boolean / object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.integer = object1.value.boolean / object2.value.integer;
-				object1.type = duckVM_object_type_integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.boolean /= object2.value.boolean;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		default:
-			e = dl_error_invalidValue;
-			goto cleanup;
+	case duckLisp_instruction_pushBooleanFalse: DUCKVM_LABEL(pushBooleanFalse)
+		object1 = duckVM_object_makeBoolean(dl_false);
+		e = stack_push(duckVM, &object1);
+		if (e) {
+			eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->push-boolean-false: stack_push failed."));
+			if (!e) e = eError;
 		}
+		break;
+	case duckLisp_instruction_pushBooleanTrue: DUCKVM_LABEL(pushBooleanTrue)
+		object1 = duckVM_object_makeBoolean(dl_true);
 		e = stack_push(duckVM, &object1);
-		if (e) break;
+		if (e) {
+			eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->push-boolean-true: stack_push failed."));
+			if (!e) e = eError;
+		}
 		break;
-	case duckLisp_instruction_div16:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
-		if (e) break;
-		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
-		if (e) break;
-		switch (object1.type) {
-		case duckVM_object_type_float:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint /= object2.value.floatingPoint;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.floatingPoint /= object2.value.integer;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.floatingPoint /= object2.value.boolean;
-				object1.type = duckVM_object_type_float;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		case duckVM_object_type_integer:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.integer / object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				/* Type already set. */
-				object1.value.integer /= object2.value.integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.integer /= object2.value.boolean;
-				object1.type = duckVM_object_type_integer;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		case duckVM_object_type_bool:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.boolean / object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.integer = object1.value.boolean / object2.value.integer;
-				object1.type = duckVM_object_type_integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.boolean /= object2.value.boolean;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		default:
-			e = dl_error_invalidValue;
-			goto cleanup;
+
+	case duckLisp_instruction_pushInteger8:
+		/* Fall through */
+	case duckLisp_instruction_pushInteger16:
+		/* Fall through */
+	case duckLisp_instruction_pushInteger32: DUCKVM_LABEL(pushInteger)
+		object1 = duckVM_object_makeInteger(instruction->operands[0]);
+		e = stack_push(duckVM, &object1);
+		if (e) {
+			eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->push-integer: stack_push failed."));
+			if (!e) e = eError;
 		}
+		break;
+
+	case duckLisp_instruction_pushDoubleFloat: DUCKVM_LABEL(pushDoubleFloat) {
+		double doubleFloat;
+		/**/ dl_memcopy_noOverlap(&doubleFloat, instruction->operands, sizeof(double));
+		object1 = duckVM_object_makeFloat(doubleFloat);
 		e = stack_push(duckVM, &object1);
+		if (e) {
+			eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->push-double-float: stack_push failed."));
+			if (!e) e = eError;
+		}
 		break;
-	case duckLisp_instruction_div8:
-		ptrdiff1 = *(ip++);
-		ptrdiff2 = *(ip++);
-		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
-		if (e) break;
-		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
-		if (e) break;
-		switch (object1.type) {
-		case duckVM_object_type_float:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint /= object2.value.floatingPoint;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.floatingPoint /= object2.value.integer;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.floatingPoint /= object2.value.boolean;
-				object1.type = duckVM_object_type_float;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		case duckVM_object_type_integer:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.integer / object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				/* Type already set. */
-				object1.value.integer /= object2.value.integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.integer /= object2.value.boolean;
-				object1.type = duckVM_object_type_integer;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		case duckVM_object_type_bool:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.boolean / object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.integer = object1.value.boolean / object2.value.integer;
-				object1.type = duckVM_object_type_integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.boolean /= object2.value.boolean;
+	}
+
+	case duckLisp_instruction_pushIndex8:
+		/* Fall through */
+	case duckLisp_instruction_pushIndex16:
+		/* Fall through */
+	case duckLisp_instruction_pushIndex32: DUCKVM_LABEL(pushIndex)
+		ptrdiff1 = instruction->operands[0];
+		if (instruction->verified) {
+			object1 = DL_ARRAY_GETADDRESS(duckVM->stack, duckVM_object_t, duckVM->stack.elements_length - ptrdiff1);
+		}
+		else {
+			e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
+			if (e) {
+				eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->push-index: dl_array_get failed."));
+				if (!e) e = eError;
 				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
 			}
-			break;
-		default:
-			e = dl_error_invalidValue;
-			goto cleanup;
 		}
 		e = stack_push(duckVM, &object1);
+		if (e) {
+			eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->push-index: stack_push failed."));
+			if (!e) e = eError;
+		}
 		break;
 
-	case duckLisp_instruction_add32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		parsedBytecode = dl_true;
+	case duckLisp_instruction_pushUpvalue8:
 		/* Fall through */
-	case duckLisp_instruction_add16:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			ptrdiff2 = *(ip++);
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			parsedBytecode = dl_true;
-		}
+	case duckLisp_instruction_pushUpvalue16:
 		/* Fall through */
-	case duckLisp_instruction_add8:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff2 = *(ip++);
-		}
-		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
-		if (e) break;
-		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
-		if (e) break;
-		switch (object1.type) {
-		case duckVM_object_type_float:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint += object2.value.floatingPoint;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.floatingPoint += object2.value.integer;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.floatingPoint += object2.value.boolean;
-				object1.type = duckVM_object_type_float;
-				break;
-			default:
+	case duckLisp_instruction_pushUpvalue32: DUCKVM_LABEL(pushUpvalue)
+		ptrdiff1 = instruction->operands[0];
+		{
+			duckVM_upvalueArray_t upvalueArray;
+			if (ptrdiff1 < 0) {
 				e = dl_error_invalidValue;
 				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_execute->add: Invalid type combination."));
-				if (eError) e = eError;
+				                                  DL_STR("duckVM_execute->push-upvalue: Index pointing to upvalue is negative."));
+				if (!e) e = eError;
 				break;
 			}
-			break;
-		case duckVM_object_type_integer:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.integer + object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				/* Type already set. */
-				object1.value.integer += object2.value.integer;
+			e = dl_array_getTop(&duckVM->upvalue_array_call_stack, &upvalueArray);
+			if (e) {
+				eError = duckVM_error_pushRuntime(duckVM,
+				                                  DL_STR("duckVM_execute->push-upvalue: dl_array_get failed."));
+				if (!e) e = eError;
 				break;
-			case duckVM_object_type_bool:
-				object1.value.integer += object2.value.boolean;
-				object1.type = duckVM_object_type_integer;
+			}
+			e = duckVM_upvalueArray_getUpvalue(duckVM, upvalueArray, &object1, ptrdiff1);
+			if (e) {
+				eError = duckVM_error_pushRuntime(duckVM,
+				                                  DL_STR("duckVM_execute->push-upvalue: duckVM_upvalueArray_getUpvalue failed."));
+				if (!e) e = eError;
 				break;
-			default:
-				e = dl_error_invalidValue;
+			}
+			e = stack_push(duckVM, &object1);
+			if (e) {
 				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_execute->add: Invalid type combination."));
-				if (eError) e = eError;
+				                                  DL_STR("duckVM_execute->push-upvalue: stack_push failed."));
+				if (!e) e = eError;
 				break;
 			}
 			break;
-		case duckVM_object_type_bool:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.boolean + object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.integer = object1.value.boolean + object2.value.integer;
-				object1.type = duckVM_object_type_integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.boolean += object2.value.boolean;
+		}
+
+	case duckLisp_instruction_pushClosure8:
+		/* Fall through */
+	case duckLisp_instruction_pushClosure16:
+		/* Fall through */
+	case duckLisp_instruction_pushClosure32:
+		/* Fall through */
+	case duckLisp_instruction_pushVaClosure8:
+		/* Fall through */
+	case duckLisp_instruction_pushVaClosure16:
+		/* Fall through */
+	case duckLisp_instruction_pushVaClosure32: DUCKVM_LABEL(pushClosure)
+		/* Already an offset from the start of the bytecode. */
+		ptrdiff1 = instruction->operands[0];
+		if ((ptrdiff1 < 0) || ((dl_size_t) ptrdiff1 >= bytecode->value.bytecode.bytecode_length)) {
+			e = dl_error_invalidValue;
+			eError = duckVM_error_pushRuntime(duckVM,
+			                                  DL_STR("duckVM_execute->push-closure: Closure address out of bounds."));
+			if (!e) e = eError;
+			break;
+		}
+		object1 = duckVM_object_makeClosure(ptrdiff1,
+		                                    bytecode,
+		                                    dl_null,
+		                                    instruction->bytes[0],
+		                                    ((opcode == duckLisp_instruction_pushVaClosure32)
+		                                     || (opcode == duckLisp_instruction_pushVaClosure16)
+		                                     || (opcode == duckLisp_instruction_pushVaClosure8)));
+
+		size1 = instruction->operands[1];
+		ip = &bytecode->value.bytecode.bytecode[instruction->operands[2]];
+
+		/* This could also point to a static version instead since this array is never changed
+		   and multiple closures could use the same array. */
+
+		e = duckVM_gclist_pushObject(duckVM,
+		                             &object1.value.closure.upvalue_array,
+		                             duckVM_object_makeUpvalueArray(dl_null, size1));
+		if (e) {
+			eError = duckVM_error_pushRuntime(duckVM,
+			                                  DL_STR("duckVM_execute->push-closure: duckVM_gclist_pushObject failed."));
+			if (!e) e = eError;
+			break;
+		}
+		duckVM_upvalueArray_t upvalueArray;
+		e = duckVM_closure_getUpvalueArray(object1.value.closure, &upvalueArray);
+		if (e) break;
+		DL_DOTIMES(k, upvalueArray.length) {
+			upvalueArray.upvalues[k] = dl_null;
+		}
+		/* Immediately push on stack so that the GC can see it. Allocating upvalues could trigger a GC. */
+		e = dl_array_pushElement(&duckVM->stack, &object1);
+		if (e) {
+			eError = duckVM_error_pushRuntime(duckVM,
+			                                  DL_STR("duckVM_execute->push-closure: dl_array_pushElement failed."));
+			if (!e) e = eError;
+			break;
+		}
+
+		dl_bool_t recursive = dl_false;
+
+		DL_DOTIMES(k, upvalueArray.length) {
+			ptrdiff1 = *(ip++);
+			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+			if (ptrdiff1 > 0x7FFFFFFF) {
+				/* Nested upvalue */
+				ptrdiff1 = -(0x100000000 - ptrdiff1);
+			}
+			else {
+				/* Normal upvalue */
+				/* stack - 1 because we already pushed. */
+				ptrdiff1 = (duckVM->stack.elements_length - 1) - ptrdiff1;
+				if ((ptrdiff1 < 0) || ((dl_size_t) ptrdiff1 > duckVM->upvalue_stack.elements_length)) {
+					e = dl_error_invalidValue;
+					eError = duckVM_error_pushRuntime(duckVM,
+					                                  DL_STR("duckVM_execute->push-closure: Stack index out of bounds."));
+					if (!e) e = eError;
+					break;
+				}
+			}
+			duckVM_object_t *upvalue_pointer = dl_null;
+			if ((dl_size_t) ptrdiff1 == duckVM->upvalue_stack.elements_length) {
+				/* *Recursion* Capture upvalue we are about to push. This should only happen once. */
+				recursive = dl_true;
+				/* Our upvalue definitely doesn't exist yet. */
+				duckVM_object_t upvalue;
+				upvalue.type = duckVM_object_type_upvalue;
+				upvalue.value.upvalue.type = duckVM_upvalue_type_stack_index;  /* Lie for now. */
+				upvalue.value.upvalue.value.stack_index = ptrdiff1;
+				e = duckVM_gclist_pushObject(duckVM, &upvalue_pointer, upvalue);
+				if (e) {
+					e = dl_error_shouldntHappen;
+					eError = duckVM_error_pushRuntime(duckVM,
+					                                  DL_STR("duckVM_execute->push-closure: duckVM_gclist_pushObject failed."));
+					if (!e) e = eError;
+					break;
+				}
+				/* Break push_scope abstraction. */
+				e = dl_array_pushElement(&duckVM->upvalue_stack, dl_null);
+				if (e) {
+					e = dl_error_shouldntHappen;
+					(eError
+					 = duckVM_error_pushRuntime(duckVM,
+					                            DL_STR("duckVM_execute->push-closure: dl_array_pushElement failed.")));
+					if (!e) e = eError;
+					break;
+				}
+				/* Upvalue stack slot exists now, so insert the new UV. */
+				DL_ARRAY_GETADDRESS(duckVM->upvalue_stack, duckVM_object_t *, ptrdiff1) = upvalue_pointer;
+			}
+			else if (ptrdiff1 < 0) {
+				/* Capture upvalue in currently executing function. */
+				ptrdiff1 = -(ptrdiff1 + 1);
+				duckVM_object_t upvalue;
+				upvalue.type = duckVM_object_type_upvalue;
+				upvalue.value.upvalue.type = duckVM_upvalue_type_heap_upvalue;
+				/* Link new upvalue to upvalue from current context. */
+				upvalue.value.upvalue.value.heap_upvalue = (DL_ARRAY_GETTOPADDRESS(duckVM->upvalue_array_call_stack,
+				                                                                   duckVM_upvalueArray_t)
+				                                            .upvalues[ptrdiff1]);
+				e = duckVM_gclist_pushObject(duckVM, &upvalue_pointer, upvalue);
+				if (e) {
+					eError = duckVM_error_pushRuntime(duckVM,
+					                                  DL_STR("duckVM_execute->push-closure: duckVM_gclist_pushObject failed."));
+					if (!e) e = eError;
+					break;
+				}
+			}
+			else {
+				/* Capture upvalue on stack. */
+				e = dl_array_get(&duckVM->upvalue_stack, &upvalue_pointer, ptrdiff1);
+				if (e) {
+					eError = duckVM_error_pushRuntime(duckVM,
+					                                  DL_STR("duckVM_execute->push-closure: Retrieval of upvalue from upvalue stack failed."));
+					if (!e) e = eError;
+					break;
+				}
+				if (upvalue_pointer == dl_null) {
+					duckVM_object_t upvalue;
+					upvalue.type = duckVM_object_type_upvalue;
+					upvalue.value.upvalue.type = duckVM_upvalue_type_stack_index;
+					upvalue.value.upvalue.value.stack_index = ptrdiff1;
+					e = duckVM_gclist_pushObject(duckVM, &upvalue_pointer, upvalue);
+					if (e) {
+						eError = duckVM_error_pushRuntime(duckVM,
+						                                  DL_STR("duckVM_execute->push-closure: duckVM_gclist_pushObject failed."));
+						if (!e) e = eError;
+						break;
+					}
+					// Is this a bug? I'm not confident that this element exists.
+					/* Keep reference to upvalue on stack so that we know where to release the object to. */
+					DL_ARRAY_GETADDRESS(duckVM->upvalue_stack, duckVM_object_t *, ptrdiff1) = upvalue_pointer;
+				}
+				if (upvalue_pointer->type != duckVM_object_type_upvalue) {
+					e = dl_error_shouldntHappen;
+					eError = duckVM_error_pushRuntime(duckVM,
+					                                  DL_STR("duckVM_execute->push-closure: Captured object is not an upvalue."));
+					if (!e) e = eError;
+					break;
+				}
+			}
+			if (e) break;
+			upvalueArray.upvalues[k] = upvalue_pointer;
+			/* Allocating the upvalue could have run a collection that made the array old. */
+			e = duckVM_gclist_writeBarrier(&duckVM->gclist, object1.value.closure.upvalue_array);
+			if (e) break;
+		}
+		if (e) break;
+		if (!recursive) {
+			/* Break push_scope abstraction. */
+			e = dl_array_pushElement(&duckVM->upvalue_stack, dl_null);
+			if (e) {
+				eError = duckVM_error_pushRuntime(duckVM,
+				                                  DL_STR("duckVM_execute->push-closure: dl_array_pushElement failed."));
+				if (!e) e = eError;
 				break;
-			default:
+			}
+		}
+		DL_ARRAY_GETTOPADDRESS(duckVM->stack, duckVM_object_t) = object1;
+
+		break;
+
+	case duckLisp_instruction_pushGlobal8:
+		/* Fall through */
+	case duckLisp_instruction_pushGlobal16:
+		/* Fall through */
+	case duckLisp_instruction_pushGlobal32: DUCKVM_LABEL(pushGlobal)
+		ptrdiff1 = instruction->operands[0];
+		{
+			duckVM_object_t *global;
+			e = duckVM_global_get(duckVM, &global, ptrdiff1);
+			if (e) {
 				e = dl_error_invalidValue;
 				eError = duckVM_error_pushRuntime(duckVM,
-				                                  DL_STR("duckVM_execute->add: Invalid type combination."));
+				                                  DL_STR("duckVM_execute->push-global: Could not find dynamic variable."));
 				if (eError) e = eError;
 				break;
 			}
-			break;
-		default:
-			e = dl_error_invalidValue;
-			eError = duckVM_error_pushRuntime(duckVM,
-			                                  DL_STR("duckVM_execute->add: Invalid type combination."));
-			if (eError) e = eError;
-			break;
+			e = stack_push(duckVM, global);
+			if (e) {
+				eError = duckVM_error_pushRuntime(duckVM,
+				                                  DL_STR("duckVM_execute->push-global: stack_push failed."));
+				if (!e) e = eError;
+				break;
+			}
 		}
-		if (e) break;
-		e = stack_push(duckVM, &object1);
 		break;
 
-		// I probably don't need an `if` if I research the standard a bit.
-	case duckLisp_instruction_sub32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
-		if (e) break;
-		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
-		if (e) break;
-		switch (object1.type) {
-		case duckVM_object_type_float:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint -= object2.value.floatingPoint;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.floatingPoint -= object2.value.integer;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.floatingPoint -= object2.value.boolean;
-				object1.type = duckVM_object_type_float;
-				break;
-			default:
+	case duckLisp_instruction_releaseUpvalues8:
+		/* Fall through */
+	case duckLisp_instruction_releaseUpvalues16:
+		/* Fall through */
+	case duckLisp_instruction_releaseUpvalues32: DUCKVM_LABEL(releaseUpvalues)
+		size1 = instruction->operands[0];
+		size2 = (dl_size_t) 1 << (opcode - duckLisp_instruction_releaseUpvalues8);
+		ip = &bytecode->value.bytecode.bytecode[instruction->operands[1]];
+
+		DL_DOTIMES(k, size1) {
+			ptrdiff1 = duckVM_decodeUnsigned(&ip, size2);
+			ptrdiff1 = duckVM->stack.elements_length - ptrdiff1;
+			if (ptrdiff1 < 0) {
 				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		case duckVM_object_type_integer:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.integer - object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				/* Type already set. */
-				object1.value.integer -= object2.value.integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.integer -= object2.value.boolean;
-				object1.type = duckVM_object_type_integer;
 				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
 			}
-			break;
-		case duckVM_object_type_bool:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.boolean - object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.integer = object1.value.boolean - object2.value.integer;
-				object1.type = duckVM_object_type_integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.boolean -= object2.value.boolean;
-				break;
-			default:
+			duckVM_object_t *upvalue = DL_ARRAY_GETADDRESS(duckVM->upvalue_stack, duckVM_object_t *, ptrdiff1);
+			if (upvalue != dl_null) {
+				if (upvalue->type != duckVM_object_type_upvalue) {
+					eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->release-upvalues: Captured object is not an upvalue."));
+					if (!e) e = eError;
+					break;
+				}
+				duckVM_object_t *object = &DL_ARRAY_GETADDRESS(duckVM->stack, duckVM_object_t, ptrdiff1);
+				e = duckVM_gclist_pushObject(duckVM, &upvalue->value.upvalue.value.heap_object, *object);
+				if (e) break;
+				upvalue->value.upvalue.type = duckVM_upvalue_type_heap_object;
+				e = duckVM_gclist_writeBarrier(&duckVM->gclist, upvalue);
+				if (e) break;
+				/* Render the original object unusable. */
+				object->type = duckVM_object_type_list;
+				object->value.list = dl_null;
+				DL_ARRAY_GETADDRESS(duckVM->upvalue_stack, duckVM_object_t *, ptrdiff1) = dl_null;
+			}
+		}
+		if (e) break;
+		break;
+
+	case duckLisp_instruction_setUpvalue8:
+		/* Fall through */
+	case duckLisp_instruction_setUpvalue16:
+		/* Fall through */
+	case duckLisp_instruction_setUpvalue32: DUCKVM_LABEL(setUpvalue)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
+		{
+			// Need another stack with same depth as call stack to pull out upvalues.
+			// Like to live dangerously?
+			if (ptrdiff1 < 0) {
 				e = dl_error_invalidValue;
-				goto cleanup;
+				break;
+			}
+			e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff2);
+			if (e) break;
+			duckVM_object_t *upvalue = DL_ARRAY_GETTOPADDRESS(duckVM->upvalue_array_call_stack,
+			                                                  duckVM_upvalueArray_t).upvalues[ptrdiff1];
+			if (upvalue->value.upvalue.type == duckVM_upvalue_type_stack_index) {
+				e = dl_array_set(&duckVM->stack, &object1, upvalue->value.upvalue.value.stack_index);
+				if (e) break;
+			}
+			else if (upvalue->value.upvalue.type == duckVM_upvalue_type_heap_object) {
+				*upvalue->value.upvalue.value.heap_object = object1;
+				e = duckVM_gclist_writeBarrier(&duckVM->gclist, upvalue->value.upvalue.value.heap_object);
+				if (e) break;
+			}
+			else {
+				while (upvalue->value.upvalue.type == duckVM_upvalue_type_heap_upvalue) {
+					upvalue = upvalue->value.upvalue.value.heap_upvalue;
+				}
+				if (upvalue->value.upvalue.type == duckVM_upvalue_type_stack_index) {
+					e = dl_array_set(&duckVM->stack, &object1, upvalue->value.upvalue.value.stack_index);
+					if (e) break;
+				}
+				else {
+					*upvalue->value.upvalue.value.heap_object = object1;
+					e = duckVM_gclist_writeBarrier(&duckVM->gclist, upvalue->value.upvalue.value.heap_object);
+					if (e) break;
+				}
 			}
-			break;
-		default:
-			e = dl_error_invalidValue;
-			goto cleanup;
 		}
-		e = stack_push(duckVM, &object1);
+		break;
+
+	case duckLisp_instruction_setGlobal8:
+		/* Fall through */
+	case duckLisp_instruction_setGlobal16:
+		/* Fall through */
+	case duckLisp_instruction_setGlobal32: DUCKVM_LABEL(setGlobal)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
+		e = duckVM_gclist_pushObject(duckVM,
+		                             &objectPtr1,
+		                             DL_ARRAY_GETADDRESS(duckVM->stack,
+		                                                 duckVM_object_t,
+		                                                 duckVM->stack.elements_length - ptrdiff1));
+		if (e) break;
+		e = duckVM_global_set(duckVM, objectPtr1, ptrdiff2);
 		if (e) break;
 		break;
-	case duckLisp_instruction_sub16:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
+
+	case duckLisp_instruction_funcall8:
+		/* Fall through */
+	case duckLisp_instruction_funcall16:
+		/* Fall through */
+	case duckLisp_instruction_funcall32: DUCKVM_LABEL(funcall)
+		/* Calls keep track of where to return to by address. */
+		ip = &bytecode->value.bytecode.bytecode[next->offset];
+		e = duckVM_instruction_funcall(duckVM, &ip, &bytecode, instruction->operands[0], instruction->bytes[0]);
+		if (e) break;
+		e = duckVM_instructionAt(duckVM, bytecode, ip, &next);
+		break;
+
+	case duckLisp_instruction_apply8:
+		/* Fall through */
+	case duckLisp_instruction_apply16:
+		/* Fall through */
+	case duckLisp_instruction_apply32: DUCKVM_LABEL(apply)
+		ptrdiff1 = instruction->operands[0];
+		uint8 = instruction->bytes[0];
+		ip = &bytecode->value.bytecode.bytecode[next->offset];
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
-		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
+		while (object1.type == duckVM_object_type_composite) {
+			object1 = *object1.value.composite->value.internalComposite.function;
+		}
+		if (object1.type != duckVM_object_type_closure) {
+			e = dl_error_invalidValue;
+			eError = duckVM_error_pushRuntime(duckVM,
+			                                  DL_STR("duckVM_execute->apply: Applied object is not a closure."));
+			if (eError) e = eError;
+			break;
+		}
+		duckVM_object_t rest;
+		e = stack_pop(duckVM, &rest);
 		if (e) break;
-		switch (object1.type) {
-		case duckVM_object_type_float:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint -= object2.value.floatingPoint;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.floatingPoint -= object2.value.integer;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.floatingPoint -= object2.value.boolean;
-				object1.type = duckVM_object_type_float;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
+		if (rest.type != duckVM_object_type_list) {
+			e = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute->apply: Last argument is not a list."));
+			e = dl_error_invalidValue;
 			break;
-		case duckVM_object_type_integer:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.integer - object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				/* Type already set. */
-				object1.value.integer -= object2.value.integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.integer -= object2.value.boolean;
-				object1.type = duckVM_object_type_integer;
-				break;
-			default:
+		}
+		while ((uint8 < object1.value.closure.arity) && (rest.value.list != dl_null)) {
+			if (rest.value.list->type != duckVM_object_type_cons) {
 				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		case duckVM_object_type_bool:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.boolean - object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.integer = object1.value.boolean - object2.value.integer;
-				object1.type = duckVM_object_type_integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.boolean -= object2.value.boolean;
+				eError = duckVM_error_pushRuntime(duckVM,
+				                                  DL_STR("duckVM_execute->apply: Object pointed to by list root is not a list."));
+				if (eError) e = eError;
 				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
 			}
-			break;
-		default:
-			e = dl_error_invalidValue;
-			goto cleanup;
+			/* (push (car rest) stack) */
+			{
+				duckVM_object_t *car = rest.value.list->value.cons.car;
+				if ((car == dl_null) || (car->type == duckVM_object_type_cons)) {
+					duckVM_object_t list = duckVM_object_makeList(car);
+					e = stack_push(duckVM, &list);
+				}
+				else {
+					e = stack_push(duckVM, car);
+				}
+				if (e) break;
+			}
+			/* (setf rest (cdr rest)) */
+			rest.value.list = rest.value.list->value.cons.cdr;
+			uint8++;
 		}
-		e = stack_push(duckVM, &object1);
-		break;
-	case duckLisp_instruction_sub8:
-		ptrdiff1 = *(ip++);
-		ptrdiff2 = *(ip++);
-		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
-		if (e) break;
-		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
 		if (e) break;
-		switch (object1.type) {
-		case duckVM_object_type_float:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint -= object2.value.floatingPoint;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.floatingPoint -= object2.value.integer;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.floatingPoint -= object2.value.boolean;
-				object1.type = duckVM_object_type_float;
-				break;
-			default:
+		if (object1.value.closure.variadic) {
+			if (uint8 < object1.value.closure.arity) {
 				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		case duckVM_object_type_integer:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.integer - object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				/* Type already set. */
-				object1.value.integer -= object2.value.integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.integer -= object2.value.boolean;
-				object1.type = duckVM_object_type_integer;
 				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
 			}
-			break;
-		case duckVM_object_type_bool:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.floatingPoint = object1.value.boolean - object2.value.floatingPoint;
-				object1.type = duckVM_object_type_float;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.integer = object1.value.boolean - object2.value.integer;
-				object1.type = duckVM_object_type_integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.boolean -= object2.value.boolean;
-				break;
-			default:
+			/* Create list. */
+			/* The original version of this did something really dirty though it didn't look like it. It popped
+			   multiple objects off the stack, then allocated a bunch more on the heap. This is fine 99.999% of the
+			   time, but since the stack is the root the garbage collector uses to trace memory, it was possible to
+			   trigger collection of the object (and possibly all its children) during one of those allocations.
+			   Moral of the story: Never perform an allocation if you have an allocated object disconnected from the
+			   stack. */
+			/* First push the new object on the stack to register it with the collector. */
+			object2.value.list = rest.value.list;
+			object2.type = duckVM_object_type_list;
+			e = stack_push(duckVM, &object2);
+			if (e) break;
+			object3.value.list = dl_null;
+			object3.type = duckVM_object_type_list;
+			e = stack_push(duckVM, &object3);
+			if (e) break;
+			dl_size_t args_length = (uint8 - object1.value.closure.arity);
+			duckVM_object_t *lastConsPtr = rest.value.list;
+			DL_DOTIMES(k, args_length) {
+				duckVM_object_t cons;
+				duckVM_object_t *consPtr = dl_null;
+				duckVM_object_t object;
+				duckVM_object_t *objectPtr = dl_null;
+				/* Reverse order, because lisp lists are backwards. */
+				object = DL_ARRAY_GETADDRESS(duckVM->stack,
+				                             duckVM_object_t,
+				                             duckVM->stack.elements_length - 3 - k);
+				e = duckVM_gclist_pushObject(duckVM, &objectPtr, object);
+				if (e) break;
+				cons.type = duckVM_object_type_cons;
+				cons.value.cons.car = objectPtr;
+				cons.value.cons.cdr = lastConsPtr;
+				/* Make visible to collector before allocating another. */
+				DL_ARRAY_GETADDRESS(duckVM->stack,
+				                    duckVM_object_t,
+				                    duckVM->stack.elements_length - 1).value.list = objectPtr;
+				e = duckVM_gclist_pushObject(duckVM, &consPtr, cons);
+				if (e) break;
+				/* Make visible to collector before allocating another. The object just created is linked in the
+				   cons. */
+				DL_ARRAY_GETADDRESS(duckVM->stack,
+				                    duckVM_object_t,
+				                    duckVM->stack.elements_length - 2).value.list = consPtr;
+				lastConsPtr = consPtr;
+			}
+			if (e) break;
+			/* Pop the temporary object. */
+			e = stack_pop(duckVM, dl_null);
+			if (e) break;
+			/* Copy the list to the proper position. */
+			object2.value.list = lastConsPtr;
+			DL_ARRAY_GETADDRESS(duckVM->stack,
+			                    duckVM_object_t,
+			                    (duckVM->stack.elements_length - 1 - args_length)) = object2;
+			/* Pop all objects other than the list. */
+			e = stack_pop_multiple(duckVM, args_length);
+			if (e) break;
+		}
+		else {
+			if (object1.value.closure.arity != uint8) {
 				e = dl_error_invalidValue;
-				goto cleanup;
+				break;
 			}
+		}
+		/* Call. */
+		e = call_stack_push(duckVM,
+		                    ip,
+		                    bytecode,
+		                    &object1.value.closure.upvalue_array->value.upvalue_array,
+		                    duckVM_closure_stackBase(duckVM, object1.value.closure));
+		if (e) break;
+		bytecode = object1.value.closure.bytecode;
+		ip = &bytecode->value.bytecode.bytecode[object1.value.closure.name];
+		e = duckVM_instructionAt(duckVM, bytecode, ip, &next);
+		break;
+
+	case duckLisp_instruction_call8:
+		/* Fall through */
+	case duckLisp_instruction_call16:
+		/* Fall through */
+	case duckLisp_instruction_call32: DUCKVM_LABEL(call)
+		e = call_stack_push(duckVM,
+		                    &bytecode->value.bytecode.bytecode[next->offset],
+		                    bytecode,
+		                    dl_null,
+		                    duckVM->stack.elements_length);
+		if (e) break;
+		next = &bytecode->value.bytecode.decoded->instructions[instruction->operands[0]];
+		break;
+
+	case duckLisp_instruction_ccall8:
+		/* Fall through */
+	case duckLisp_instruction_ccall16:
+		/* Fall through */
+	case duckLisp_instruction_ccall32: DUCKVM_LABEL(ccall)
+		// I should probably delete this and have `funcall` handle callbacks.
+		/* The callback pops its own arguments. */
+		e = duckVM_instruction_ccall(duckVM, instruction->operands[0], instruction->bytes[0]);
+		break;
+
+	case duckLisp_instruction_jump8:
+		/* Fall through */
+	case duckLisp_instruction_jump16:
+		/* Fall through */
+	case duckLisp_instruction_jump32: DUCKVM_LABEL(jump)
+		next = &bytecode->value.bytecode.decoded->instructions[instruction->operands[0]];
+		break;
+
+	case duckLisp_instruction_brnz8:
+		/* Fall through */
+	case duckLisp_instruction_brnz16:
+		/* Fall through */
+	case duckLisp_instruction_brnz32: DUCKVM_LABEL(brnz)
+		if (instruction->verified) {
+			object1 = DL_ARRAY_GETTOPADDRESS(duckVM->stack, duckVM_object_t);
+			stack_pop_multiple_unchecked(duckVM, instruction->operands[1]);
+		}
+		else {
+			e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - 1);
+			if (e) break;
+			e = stack_pop_multiple(duckVM, instruction->operands[1]);
+			if (e) break;
+		}
+		if (duckVM_isTruthy(&object1)) {
+			next = &bytecode->value.bytecode.decoded->instructions[instruction->operands[0]];
+		}
+		break;
+
+	case duckLisp_instruction_pop8:
+		/* Fall through */
+	case duckLisp_instruction_pop16:
+		/* Fall through */
+	case duckLisp_instruction_pop32: DUCKVM_LABEL(pop)
+		if (instruction->verified) {
+			stack_pop_multiple_unchecked(duckVM, instruction->operands[0]);
 			break;
-		default:
-			e = dl_error_invalidValue;
-			goto cleanup;
 		}
-		e = stack_push(duckVM, &object1);
+		e = stack_pop_multiple(duckVM, instruction->operands[0]);
 		break;
 
-		// I probably don't need an `if` if I research the standard a bit.
-	case duckLisp_instruction_greater32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
+	case duckLisp_instruction_move8:
+		/* Fall through */
+	case duckLisp_instruction_move16:
+		/* Fall through */
+	case duckLisp_instruction_move32: DUCKVM_LABEL(move)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
+		if (instruction->verified) {
+			(DL_ARRAY_GETADDRESS(duckVM->stack, duckVM_object_t, duckVM->stack.elements_length - ptrdiff2)
+			 = DL_ARRAY_GETADDRESS(duckVM->stack, duckVM_object_t, duckVM->stack.elements_length - ptrdiff1));
+			break;
+		}
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
-		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
+		object2 = object1;
+		e = dl_array_set(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
+		if (e) break;
+		break;
+
+	case duckLisp_instruction_not8:
+		/* Fall through */
+	case duckLisp_instruction_not16:
+		/* Fall through */
+	case duckLisp_instruction_not32: DUCKVM_LABEL(not)
+		ptrdiff1 = instruction->operands[0];
+		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
 		switch (object1.type) {
-		case duckVM_object_type_float:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.floatingPoint > object2.value.floatingPoint;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.floatingPoint > object2.value.integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.floatingPoint > object2.value.boolean;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
+		case duckVM_object_type_vector:
+			object1.type = duckVM_object_type_bool;
+			object1.value.boolean = object1.value.vector.internal_vector == dl_null;
+			break;
+		case duckVM_object_type_list:
+			object1.type = duckVM_object_type_bool;
+			object1.value.boolean = object1.value.list == dl_null;
 			break;
 		case duckVM_object_type_integer:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.integer > object2.value.floatingPoint;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.integer > object2.value.integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.integer > object2.value.boolean;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
+			object1.value.integer = !object1.value.integer;
+			break;
+		case duckVM_object_type_float:
+			object1.value.floatingPoint = !object1.value.floatingPoint;
 			break;
 		case duckVM_object_type_bool:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.boolean > object2.value.floatingPoint;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.boolean > object2.value.integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.boolean > object2.value.boolean;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
+			object1.value.boolean = !object1.value.boolean;
 			break;
 		default:
 			e = dl_error_invalidValue;
+			eError = duckVM_error_pushRuntime(duckVM,
+			                                  DL_STR("duckVM_execute->not: Object is not a boolean, integer, float, list, or vector."));
+			if (!e) e = eError;
 			goto cleanup;
 		}
-		object1.type = duckVM_object_type_bool;
 		e = stack_push(duckVM, &object1);
-		if (e) break;
 		break;
-	case duckLisp_instruction_greater16:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
+
+	case duckLisp_instruction_mulInt8:
+		/* Fall through */
+	case duckLisp_instruction_mulInt16:
+		/* Fall through */
+	case duckLisp_instruction_mulInt32:
+		/* Fall through */
+	case duckLisp_instruction_mulFloat8:
+		/* Fall through */
+	case duckLisp_instruction_mulFloat16:
+		/* Fall through */
+	case duckLisp_instruction_mulFloat32: DUCKVM_LABEL(mulTyped)
+		/* If the operands aren't the expected type, run the generic instruction. */
+		if (duckVM_instruction_typedArithmetic(duckVM, instruction, &object1)) {
+			e = stack_push(duckVM, &object1);
+			break;
+		}
+		/* Fall through */
+	case duckLisp_instruction_mul8:
+		/* Fall through */
+	case duckLisp_instruction_mul16:
+		/* Fall through */
+	case duckLisp_instruction_mul32: DUCKVM_LABEL(mul)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
 		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
@@ -2642,13 +5273,15 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		case duckVM_object_type_float:
 			switch (object2.type) {
 			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.floatingPoint > object2.value.floatingPoint;
+				object1.value.floatingPoint *= object2.value.floatingPoint;
 				break;
 			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.floatingPoint > object2.value.integer;
+				object1.value.floatingPoint *= object2.value.integer;
+				object1.type = duckVM_object_type_float;
 				break;
 			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.floatingPoint > object2.value.boolean;
+				object1.value.floatingPoint *= object2.value.boolean;
+				object1.type = duckVM_object_type_float;
 				break;
 			default:
 				e = dl_error_invalidValue;
@@ -2658,13 +5291,16 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		case duckVM_object_type_integer:
 			switch (object2.type) {
 			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.integer > object2.value.floatingPoint;
+				object1.value.floatingPoint = object1.value.integer * object2.value.floatingPoint;
+				object1.type = duckVM_object_type_float;
 				break;
 			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.integer > object2.value.integer;
+				/* Type already set. */
+				object1.value.integer *= object2.value.integer;
 				break;
 			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.integer > object2.value.boolean;
+				object1.value.integer *= object2.value.boolean;
+				object1.type = duckVM_object_type_integer;
 				break;
 			default:
 				e = dl_error_invalidValue;
@@ -2674,13 +5310,15 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		case duckVM_object_type_bool:
 			switch (object2.type) {
 			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.boolean > object2.value.floatingPoint;
+				object1.value.floatingPoint = object1.value.boolean * object2.value.floatingPoint;
+				object1.type = duckVM_object_type_float;
 				break;
 			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.boolean > object2.value.integer;
+				object1.value.integer = object1.value.boolean * object2.value.integer;
+				object1.type = duckVM_object_type_integer;
 				break;
 			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.boolean > object2.value.boolean;
+				object1.value.boolean *= object2.value.boolean;
 				break;
 			default:
 				e = dl_error_invalidValue;
@@ -2691,12 +5329,16 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 			e = dl_error_invalidValue;
 			goto cleanup;
 		}
-		object1.type = duckVM_object_type_bool;
 		e = stack_push(duckVM, &object1);
 		break;
-	case duckLisp_instruction_greater8:
-		ptrdiff1 = *(ip++);
-		ptrdiff2 = *(ip++);
+
+	case duckLisp_instruction_div8:
+		/* Fall through */
+	case duckLisp_instruction_div16:
+		/* Fall through */
+	case duckLisp_instruction_div32: DUCKVM_LABEL(div)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
 		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
@@ -2705,13 +5347,15 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		case duckVM_object_type_float:
 			switch (object2.type) {
 			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.floatingPoint > object2.value.floatingPoint;
+				object1.value.floatingPoint /= object2.value.floatingPoint;
 				break;
 			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.floatingPoint > object2.value.integer;
+				object1.value.floatingPoint /= object2.value.integer;
+				object1.type = duckVM_object_type_float;
 				break;
 			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.floatingPoint > object2.value.boolean;
+				object1.value.floatingPoint /= object2.value.boolean;
+				object1.type = duckVM_object_type_float;
 				break;
 			default:
 				e = dl_error_invalidValue;
@@ -2721,13 +5365,16 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		case duckVM_object_type_integer:
 			switch (object2.type) {
 			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.integer > object2.value.floatingPoint;
+				object1.value.floatingPoint = object1.value.integer / object2.value.floatingPoint;
+				object1.type = duckVM_object_type_float;
 				break;
 			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.integer > object2.value.integer;
+				/* Type already set. */
+				object1.value.integer /= object2.value.integer;
 				break;
 			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.integer > object2.value.boolean;
+				object1.value.integer /= object2.value.boolean;
+				object1.type = duckVM_object_type_integer;
 				break;
 			default:
 				e = dl_error_invalidValue;
@@ -2737,13 +5384,15 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		case duckVM_object_type_bool:
 			switch (object2.type) {
 			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.boolean > object2.value.floatingPoint;
+				object1.value.floatingPoint = object1.value.boolean / object2.value.floatingPoint;
+				object1.type = duckVM_object_type_float;
 				break;
 			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.boolean > object2.value.integer;
+				object1.value.integer = object1.value.boolean / object2.value.integer;
+				object1.type = duckVM_object_type_integer;
 				break;
 			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.boolean > object2.value.boolean;
+				object1.value.boolean /= object2.value.boolean;
 				break;
 			default:
 				e = dl_error_invalidValue;
@@ -2754,148 +5403,33 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 			e = dl_error_invalidValue;
 			goto cleanup;
 		}
-		object1.type = duckVM_object_type_bool;
 		e = stack_push(duckVM, &object1);
 		break;
 
-		// I probably don't need an `if` if I research the standard a bit.
-	case duckLisp_instruction_equal32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		parsedBytecode = dl_true;
-		// Fall through
-	case duckLisp_instruction_equal16:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			ptrdiff2 = *(ip++);
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		}
-		// Fall through
-	case duckLisp_instruction_equal8:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff2 = *(ip++);
-		}
-		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
-		if (e) break;
-		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
-		if (e) break;
-		switch (object1.type) {
-		case duckVM_object_type_list:
-			switch (object2.type) {
-			case duckVM_object_type_list:
-				object1.value.boolean = object1.value.list == object2.value.list;
-				break;
-			default:
-				object1.value.boolean = dl_false;
-			}
-			break;
-		case duckVM_object_type_symbol:
-			switch (object2.type) {
-			case duckVM_object_type_symbol:
-				object1.value.boolean = object1.value.symbol.id == object2.value.symbol.id;
-				break;
-			default:
-				object1.value.boolean = dl_false;
-			}
-			break;
-		case duckVM_object_type_string:
-			switch (object2.type) {
-			case duckVM_object_type_string:
-				if ((object1.value.string.length - object1.value.string.offset == 0)
-				    && (object2.value.string.length - object2.value.string.offset == 0)) {
-					object1.value.boolean = dl_true;
-				}
-				else if ((object1.value.string.length - object1.value.string.offset == 0)
-				         || (object2.value.string.length - object2.value.string.offset == 0)) {
-					object1.value.boolean = dl_false;
-				}
-				else {
-					/**/ dl_string_compare(&bool1,
-					                       (object1.value.string.internalString->value.internalString.value
-					                        + object1.value.string.offset),
-					                       object1.value.string.length - object1.value.string.offset,
-					                       (object2.value.string.internalString->value.internalString.value
-					                        + object2.value.string.offset),
-					                       object2.value.string.length - object2.value.string.offset);
-					object1.value.boolean = bool1;
-				}
-				break;
-			default:
-				object1.value.boolean = dl_false;
-			}
-			break;
-		case duckVM_object_type_float:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.floatingPoint == object2.value.floatingPoint;
-				break;
-			default:
-				object1.value.boolean = dl_false;
-			}
-			break;
-		case duckVM_object_type_integer:
-			switch (object2.type) {
-			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.integer == object2.value.integer;
-				break;
-			default:
-				object1.value.boolean = dl_false;
-			}
-			break;
-		case duckVM_object_type_bool:
-			switch (object2.type) {
-			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.boolean == object2.value.boolean;
-				break;
-			default:
-				object1.value.boolean = dl_false;
-			}
-			break;
-		case duckVM_object_type_vector:
-			switch (object2.type) {
-			case duckVM_object_type_vector:
-				object1.value.boolean = ((object1.value.vector.internal_vector == object2.value.vector.internal_vector)
-				                         && (object1.value.vector.offset == object2.value.vector.offset));
-				break;
-			default:
-				object1.value.boolean = dl_false;
-			}
-			break;
-		case duckVM_object_type_type:
-			switch (object2.type) {
-			case duckVM_object_type_type:
-				object1.value.boolean = (object1.value.type == object2.value.type);
-				break;
-			default:
-				object1.value.boolean = dl_false;
-			}
+	case duckLisp_instruction_addInt8:
+		/* Fall through */
+	case duckLisp_instruction_addInt16:
+		/* Fall through */
+	case duckLisp_instruction_addInt32:
+		/* Fall through */
+	case duckLisp_instruction_addFloat8:
+		/* Fall through */
+	case duckLisp_instruction_addFloat16:
+		/* Fall through */
+	case duckLisp_instruction_addFloat32: DUCKVM_LABEL(addTyped)
+		/* If the operands aren't the expected type, run the generic instruction. */
+		if (duckVM_instruction_typedArithmetic(duckVM, instruction, &object1)) {
+			e = stack_push(duckVM, &object1);
 			break;
-		default:
-			e = dl_error_invalidValue;
-			goto cleanup;
 		}
-		object1.type = duckVM_object_type_bool;
-		e = stack_push(duckVM, &object1);
-		break;
-
-		// I probably don't need an `if` if I research the standard a bit.
-	case duckLisp_instruction_less32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
+		/* Fall through */
+	case duckLisp_instruction_add8:
+		/* Fall through */
+	case duckLisp_instruction_add16:
+		/* Fall through */
+	case duckLisp_instruction_add32: DUCKVM_LABEL(add)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
 		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
@@ -2904,64 +5438,102 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		case duckVM_object_type_float:
 			switch (object2.type) {
 			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.floatingPoint < object2.value.floatingPoint;
+				object1.value.floatingPoint += object2.value.floatingPoint;
 				break;
 			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.floatingPoint < object2.value.integer;
+				object1.value.floatingPoint += object2.value.integer;
+				object1.type = duckVM_object_type_float;
 				break;
 			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.floatingPoint < object2.value.boolean;
+				object1.value.floatingPoint += object2.value.boolean;
+				object1.type = duckVM_object_type_float;
 				break;
 			default:
 				e = dl_error_invalidValue;
-				goto cleanup;
+				eError = duckVM_error_pushRuntime(duckVM,
+				                                  DL_STR("duckVM_execute->add: Invalid type combination."));
+				if (eError) e = eError;
+				break;
 			}
 			break;
 		case duckVM_object_type_integer:
 			switch (object2.type) {
 			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.integer < object2.value.floatingPoint;
+				object1.value.floatingPoint = object1.value.integer + object2.value.floatingPoint;
+				object1.type = duckVM_object_type_float;
 				break;
 			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.integer < object2.value.integer;
+				/* Type already set. */
+				object1.value.integer += object2.value.integer;
 				break;
 			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.integer < object2.value.boolean;
+				object1.value.integer += object2.value.boolean;
+				object1.type = duckVM_object_type_integer;
 				break;
 			default:
 				e = dl_error_invalidValue;
-				goto cleanup;
+				eError = duckVM_error_pushRuntime(duckVM,
+				                                  DL_STR("duckVM_execute->add: Invalid type combination."));
+				if (eError) e = eError;
+				break;
 			}
 			break;
 		case duckVM_object_type_bool:
 			switch (object2.type) {
 			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.boolean < object2.value.floatingPoint;
+				object1.value.floatingPoint = object1.value.boolean + object2.value.floatingPoint;
+				object1.type = duckVM_object_type_float;
 				break;
 			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.boolean < object2.value.integer;
+				object1.value.integer = object1.value.boolean + object2.value.integer;
+				object1.type = duckVM_object_type_integer;
 				break;
 			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.boolean < object2.value.boolean;
+				object1.value.boolean += object2.value.boolean;
 				break;
 			default:
 				e = dl_error_invalidValue;
-				goto cleanup;
+				eError = duckVM_error_pushRuntime(duckVM,
+				                                  DL_STR("duckVM_execute->add: Invalid type combination."));
+				if (eError) e = eError;
+				break;
 			}
 			break;
 		default:
 			e = dl_error_invalidValue;
-			goto cleanup;
+			eError = duckVM_error_pushRuntime(duckVM,
+			                                  DL_STR("duckVM_execute->add: Invalid type combination."));
+			if (eError) e = eError;
+			break;
 		}
-		object1.type = duckVM_object_type_bool;
-		e = stack_push(duckVM, &object1);
 		if (e) break;
+		e = stack_push(duckVM, &object1);
 		break;
-	case duckLisp_instruction_less16:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
+
+	case duckLisp_instruction_subInt8:
+		/* Fall through */
+	case duckLisp_instruction_subInt16:
+		/* Fall through */
+	case duckLisp_instruction_subInt32:
+		/* Fall through */
+	case duckLisp_instruction_subFloat8:
+		/* Fall through */
+	case duckLisp_instruction_subFloat16:
+		/* Fall through */
+	case duckLisp_instruction_subFloat32: DUCKVM_LABEL(subTyped)
+		/* If the operands aren't the expected type, run the generic instruction. */
+		if (duckVM_instruction_typedArithmetic(duckVM, instruction, &object1)) {
+			e = stack_push(duckVM, &object1);
+			break;
+		}
+		/* Fall through */
+	case duckLisp_instruction_sub8:
+		/* Fall through */
+	case duckLisp_instruction_sub16:
+		/* Fall through */
+	case duckLisp_instruction_sub32: DUCKVM_LABEL(sub)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
 		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
@@ -2970,13 +5542,15 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		case duckVM_object_type_float:
 			switch (object2.type) {
 			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.floatingPoint < object2.value.floatingPoint;
+				object1.value.floatingPoint -= object2.value.floatingPoint;
 				break;
 			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.floatingPoint < object2.value.integer;
+				object1.value.floatingPoint -= object2.value.integer;
+				object1.type = duckVM_object_type_float;
 				break;
 			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.floatingPoint < object2.value.boolean;
+				object1.value.floatingPoint -= object2.value.boolean;
+				object1.type = duckVM_object_type_float;
 				break;
 			default:
 				e = dl_error_invalidValue;
@@ -2986,13 +5560,16 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		case duckVM_object_type_integer:
 			switch (object2.type) {
 			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.integer < object2.value.floatingPoint;
+				object1.value.floatingPoint = object1.value.integer - object2.value.floatingPoint;
+				object1.type = duckVM_object_type_float;
 				break;
 			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.integer < object2.value.integer;
+				/* Type already set. */
+				object1.value.integer -= object2.value.integer;
 				break;
 			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.integer < object2.value.boolean;
+				object1.value.integer -= object2.value.boolean;
+				object1.type = duckVM_object_type_integer;
 				break;
 			default:
 				e = dl_error_invalidValue;
@@ -3002,13 +5579,15 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		case duckVM_object_type_bool:
 			switch (object2.type) {
 			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.boolean < object2.value.floatingPoint;
+				object1.value.floatingPoint = object1.value.boolean - object2.value.floatingPoint;
+				object1.type = duckVM_object_type_float;
 				break;
 			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.boolean < object2.value.integer;
+				object1.value.integer = object1.value.boolean - object2.value.integer;
+				object1.type = duckVM_object_type_integer;
 				break;
 			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.boolean < object2.value.boolean;
+				object1.value.boolean -= object2.value.boolean;
 				break;
 			default:
 				e = dl_error_invalidValue;
@@ -3019,99 +5598,104 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 			e = dl_error_invalidValue;
 			goto cleanup;
 		}
-		object1.type = duckVM_object_type_bool;
 		e = stack_push(duckVM, &object1);
 		break;
-	case duckLisp_instruction_less8:
-		ptrdiff1 = *(ip++);
-		ptrdiff2 = *(ip++);
+
+	case duckLisp_instruction_greaterInt8:
+		/* Fall through */
+	case duckLisp_instruction_greaterInt16:
+		/* Fall through */
+	case duckLisp_instruction_greaterInt32:
+		/* Fall through */
+	case duckLisp_instruction_greaterFloat8:
+		/* Fall through */
+	case duckLisp_instruction_greaterFloat16:
+		/* Fall through */
+	case duckLisp_instruction_greaterFloat32: DUCKVM_LABEL(greaterTyped)
+		/* If the operands aren't the expected type, run the generic instruction. */
+		if (duckVM_instruction_typedArithmetic(duckVM, instruction, &object1)) {
+			e = stack_push(duckVM, &object1);
+			break;
+		}
+		/* Fall through */
+	case duckLisp_instruction_greater8:
+		/* Fall through */
+	case duckLisp_instruction_greater16:
+		/* Fall through */
+	case duckLisp_instruction_greater32: DUCKVM_LABEL(greater)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
 		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
 		if (e) break;
-		switch (object1.type) {
-		case duckVM_object_type_float:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.floatingPoint < object2.value.floatingPoint;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.floatingPoint < object2.value.integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.floatingPoint < object2.value.boolean;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		case duckVM_object_type_integer:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.integer < object2.value.floatingPoint;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.integer < object2.value.integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.integer < object2.value.boolean;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
-			break;
-		case duckVM_object_type_bool:
-			switch (object2.type) {
-			case duckVM_object_type_float:
-				object1.value.boolean = object1.value.boolean < object2.value.floatingPoint;
-				break;
-			case duckVM_object_type_integer:
-				object1.value.boolean = object1.value.boolean < object2.value.integer;
-				break;
-			case duckVM_object_type_bool:
-				object1.value.boolean = object1.value.boolean < object2.value.boolean;
-				break;
-			default:
-				e = dl_error_invalidValue;
-				goto cleanup;
-			}
+		e = duckVM_less(&object2, &object1, &bool1);
+		if (e) break;
+		object1.type = duckVM_object_type_bool;
+		object1.value.boolean = bool1;
+		e = stack_push(duckVM, &object1);
+		break;
+
+	case duckLisp_instruction_equal8:
+		/* Fall through */
+	case duckLisp_instruction_equal16:
+		/* Fall through */
+	case duckLisp_instruction_equal32: DUCKVM_LABEL(equal)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
+		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
+		if (e) break;
+		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
+		if (e) break;
+		e = duckVM_equal(&object1, &object2, &bool1);
+		if (e) break;
+		object1.type = duckVM_object_type_bool;
+		object1.value.boolean = bool1;
+		e = stack_push(duckVM, &object1);
+		break;
+
+	case duckLisp_instruction_lessInt8:
+		/* Fall through */
+	case duckLisp_instruction_lessInt16:
+		/* Fall through */
+	case duckLisp_instruction_lessInt32:
+		/* Fall through */
+	case duckLisp_instruction_lessFloat8:
+		/* Fall through */
+	case duckLisp_instruction_lessFloat16:
+		/* Fall through */
+	case duckLisp_instruction_lessFloat32: DUCKVM_LABEL(lessTyped)
+		/* If the operands aren't the expected type, run the generic instruction. */
+		if (duckVM_instruction_typedArithmetic(duckVM, instruction, &object1)) {
+			e = stack_push(duckVM, &object1);
 			break;
-		default:
-			e = dl_error_invalidValue;
-			goto cleanup;
 		}
+		/* Fall through */
+	case duckLisp_instruction_less8:
+		/* Fall through */
+	case duckLisp_instruction_less16:
+		/* Fall through */
+	case duckLisp_instruction_less32: DUCKVM_LABEL(less)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
+		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
+		if (e) break;
+		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
+		if (e) break;
+		e = duckVM_less(&object1, &object2, &bool1);
+		if (e) break;
 		object1.type = duckVM_object_type_bool;
+		object1.value.boolean = bool1;
 		e = stack_push(duckVM, &object1);
 		break;
 
-		// I probably don't need an `if` if I research the standard a bit.
-	case duckLisp_instruction_cons32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		parsedBytecode = dl_true;
+	case duckLisp_instruction_cons8:
 		/* Fall through */
 	case duckLisp_instruction_cons16:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			ptrdiff2 = *(ip++);
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			parsedBytecode = dl_true;
-		}
 		/* Fall through */
-	case duckLisp_instruction_cons8:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff2 = *(ip++);
-		}
+	case duckLisp_instruction_cons32: DUCKVM_LABEL(cons)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
 		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
@@ -3125,7 +5709,8 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		if (e) break;
 		e = stack_push(duckVM, &object3);
 		if (e) break;
-		/* Create the elements of the cons. */
+		/* Create the elements of the cons. Allocating the car or cdr could have made the cons old, so each store gets
+		   a barrier before the next allocation. */
 		if (object1.type == duckVM_object_type_list) {
 			object3.value.list->value.cons.car = object1.value.list;
 		}
@@ -3134,6 +5719,8 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 			if (e) break;
 			object3.value.list->value.cons.car = objectPtr1;
 		}
+		e = duckVM_gclist_writeBarrier(&duckVM->gclist, object3.value.list);
+		if (e) break;
 		if (object2.type == duckVM_object_type_list) {
 			object3.value.list->value.cons.cdr = object2.value.list;
 		}
@@ -3142,18 +5729,19 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 			if (e) break;
 			object3.value.list->value.cons.cdr = objectPtr2;
 		}
+		e = duckVM_gclist_writeBarrier(&duckVM->gclist, object3.value.list);
+		if (e) break;
 		DL_ARRAY_GETTOPADDRESS(duckVM->stack, duckVM_object_t) = object3;
 		break;
 
-	case duckLisp_instruction_vector32:
-		size1 = *(ip++);
-		size1 = *(ip++) + (size1 << 8);
+	case duckLisp_instruction_vector8:
 		/* Fall through */
 	case duckLisp_instruction_vector16:
-		size1 = *(ip++) + (size1 << 8);
 		/* Fall through */
-	case duckLisp_instruction_vector8:
-		size1 = *(ip++) + (size1 << 8);
+	case duckLisp_instruction_vector32: DUCKVM_LABEL(vector)
+		size1 = instruction->operands[0];
+		size2 = (dl_size_t) 1 << (opcode - duckLisp_instruction_vector8);
+		ip = &bytecode->value.bytecode.bytecode[instruction->operands[1]];
 
 		object1.type = duckVM_object_type_vector;
 		object1.value.vector.offset = 0;
@@ -3170,23 +5758,13 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		/* Immediately push on stack so that the GC can see it. Allocating elements could trigger a GC. */
 		e = dl_array_pushElement(&duckVM->stack, &object1);
 		if (e) break;
+		/* Let the GC trace the elements that have been filled in so far. */
 		DL_DOTIMES(k, object1.value.vector.internal_vector->value.internal_vector.length) {
-			ptrdiff1 = *(ip++);
-			switch (opcode) {
-			case duckLisp_instruction_vector32:
-				ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-				ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-				/* Fall through */
-			case duckLisp_instruction_vector16:
-				ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-				/* Fall through */
-			case duckLisp_instruction_vector8:
-				break;
-			default:
-				e = dl_error_invalidValue;
-				break;
-			}
-			if (e) break;
+			object1.value.vector.internal_vector->value.internal_vector.values[k] = dl_null;
+		}
+		object1.value.vector.internal_vector->value.internal_vector.initialized = dl_true;
+		DL_DOTIMES(k, object1.value.vector.internal_vector->value.internal_vector.length) {
+			ptrdiff1 = duckVM_decodeUnsigned(&ip, size2);
 			/* stack - 1 because we already pushed. */
 			dl_size_t old_stack_length = duckVM->stack.elements_length - 1;
 			ptrdiff1 = old_stack_length - ptrdiff1;
@@ -3201,42 +5779,25 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 			                             &object1.value.vector.internal_vector->value.internal_vector.values[k],
 			                             object2);
 			if (e) break;
+			/* Allocating the element could have made the vector old. */
+			e = duckVM_gclist_writeBarrier(&duckVM->gclist, object1.value.vector.internal_vector);
+			if (e) break;
 		}
 		if (e) break;
 
 		/* Break push_scope abstraction. */
 		e = dl_array_pushElement(&duckVM->upvalue_stack, dl_null);
 		if (e) break;
-		object1.value.vector.internal_vector->value.internal_vector.initialized = dl_true;
 		DL_ARRAY_GETTOPADDRESS(duckVM->stack, duckVM_object_t) = object1;
 		break;
 
-	case duckLisp_instruction_makeVector32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+	case duckLisp_instruction_makeVector8:
 		/* Fall through */
 	case duckLisp_instruction_makeVector16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
 		/* Fall through */
-	case duckLisp_instruction_makeVector8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-
-		ptrdiff2 = *(ip++);
-		switch (opcode) {
-		case duckLisp_instruction_makeVector32:
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			/* Fall through */
-		case duckLisp_instruction_makeVector16:
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			/* Fall through */
-		case duckLisp_instruction_makeVector8:
-			break;
-		default:
-			e = dl_error_invalidValue;
-			break;
-		}
-		if (e) break;
+	case duckLisp_instruction_makeVector32: DUCKVM_LABEL(makeVector)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
 
 		ptrdiff1 = duckVM->stack.elements_length - ptrdiff1;
 		if ((ptrdiff1 < 0) || ((dl_size_t) ptrdiff1 > duckVM->stack.elements_length)) {
@@ -3285,6 +5846,8 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		DL_DOTIMES(k, object1.value.vector.internal_vector->value.internal_vector.length) {
 			object1.value.vector.internal_vector->value.internal_vector.values[k] = objectPtr1;
 		}
+		e = duckVM_gclist_writeBarrier(&duckVM->gclist, object1.value.vector.internal_vector);
+		if (e) break;
 
 		if (e) break;
 
@@ -3295,32 +5858,13 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		DL_ARRAY_GETTOPADDRESS(duckVM->stack, duckVM_object_t) = object1;
 		break;
 
-	case duckLisp_instruction_getVecElt32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+	case duckLisp_instruction_getVecElt8:
 		/* Fall through */
 	case duckLisp_instruction_getVecElt16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
 		/* Fall through */
-	case duckLisp_instruction_getVecElt8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-
-		ptrdiff2 = *(ip++);
-		switch (opcode) {
-		case duckLisp_instruction_getVecElt32:
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			/* Fall through */
-		case duckLisp_instruction_getVecElt16:
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			/* Fall through */
-		case duckLisp_instruction_getVecElt8:
-			break;
-		default:
-			e = dl_error_cantHappen;
-			break;
-		}
-		if (e) break;
+	case duckLisp_instruction_getVecElt32: DUCKVM_LABEL(getVecElt)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
 
 		ptrdiff1 = duckVM->stack.elements_length - ptrdiff1;
 		if ((ptrdiff1 < 0) || ((dl_size_t) ptrdiff1 > duckVM->stack.elements_length)) {
@@ -3394,49 +5938,14 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		}
 		break;
 
-	case duckLisp_instruction_setVecElt32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+	case duckLisp_instruction_setVecElt8:
 		/* Fall through */
 	case duckLisp_instruction_setVecElt16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
 		/* Fall through */
-	case duckLisp_instruction_setVecElt8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-
-		ptrdiff2 = *(ip++);
-		switch (opcode) {
-		case duckLisp_instruction_setVecElt32:
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			/* Fall through */
-		case duckLisp_instruction_setVecElt16:
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			/* Fall through */
-		case duckLisp_instruction_setVecElt8:
-			break;
-		default:
-			e = dl_error_invalidValue;
-			break;
-		}
-		if (e) break;
-
-		ptrdiff3 = *(ip++);
-		switch (opcode) {
-		case duckLisp_instruction_setVecElt32:
-			ptrdiff3 = *(ip++) + (ptrdiff3 << 8);
-			ptrdiff3 = *(ip++) + (ptrdiff3 << 8);
-			/* Fall through */
-		case duckLisp_instruction_setVecElt16:
-			ptrdiff3 = *(ip++) + (ptrdiff3 << 8);
-			/* Fall through */
-		case duckLisp_instruction_setVecElt8:
-			break;
-		default:
-			e = dl_error_invalidValue;
-			break;
-		}
-		if (e) break;
+	case duckLisp_instruction_setVecElt32: DUCKVM_LABEL(setVecElt)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
+		ptrdiff3 = instruction->operands[2];
 
 		ptrdiff1 = duckVM->stack.elements_length - ptrdiff1;
 		if ((ptrdiff1 < 0) || ((dl_size_t) ptrdiff1 > duckVM->stack.elements_length)) {
@@ -3484,21 +5993,19 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		                                                              + ptrdiff2]),
 		                             object3);
 		if (e) break;
+		e = duckVM_gclist_writeBarrier(&duckVM->gclist, object1.value.vector.internal_vector);
+		if (e) break;
 		/* Also push on stack. */
 		e = stack_push(duckVM, &object3);
 		if (e) break;
 		break;
 
-		// I probably don't need an `if` if I research the standard a bit.
-	case duckLisp_instruction_cdr32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+	case duckLisp_instruction_cdr8:
 		/* Fall through */
 	case duckLisp_instruction_cdr16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
 		/* Fall through */
-	case duckLisp_instruction_cdr8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+	case duckLisp_instruction_cdr32: DUCKVM_LABEL(cdr)
+		ptrdiff1 = instruction->operands[0];
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
 		if (object1.type == duckVM_object_type_list) {
@@ -3597,16 +6104,12 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		if (e) break;
 		break;
 
-		// I probably don't need an `if` if I research the standard a bit.
-	case duckLisp_instruction_car32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+	case duckLisp_instruction_car8:
 		/* Fall through */
 	case duckLisp_instruction_car16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
 		/* Fall through */
-	case duckLisp_instruction_car8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+	case duckLisp_instruction_car32: DUCKVM_LABEL(car)
+		ptrdiff1 = instruction->operands[0];
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
 		if (object1.type == duckVM_object_type_list) {
@@ -3694,31 +6197,13 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		if (e) break;
 		break;
 
-	case duckLisp_instruction_setCar32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		parsedBytecode = dl_true;
-		// Fall through
-	case duckLisp_instruction_setCar16:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			ptrdiff2 = *(ip++);
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			parsedBytecode = dl_true;
-		}
-		// Fall through
 	case duckLisp_instruction_setCar8:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff2 = *(ip++);
-		}
+		/* Fall through */
+	case duckLisp_instruction_setCar16:
+		/* Fall through */
+	case duckLisp_instruction_setCar32: DUCKVM_LABEL(setCar)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
 		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
@@ -3734,6 +6219,8 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 				if (e) break;
 				object2.value.list->value.cons.car = objectPtr1;
 			}
+			e = duckVM_gclist_writeBarrier(&duckVM->gclist, object2.value.list);
+			if (e) break;
 		}
 		else if ((object2.type == duckVM_object_type_vector)
 		         && (object2.value.vector.internal_vector != dl_null)) {
@@ -3741,6 +6228,8 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 			if (e) break;
 			(object2.value.vector.internal_vector
 			 ->value.internal_vector.values[object2.value.vector.offset]) = objectPtr1;
+			e = duckVM_gclist_writeBarrier(&duckVM->gclist, object2.value.vector.internal_vector);
+			if (e) break;
 		}
 		else {
 			e = dl_error_invalidValue;
@@ -3749,32 +6238,13 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		e = stack_push(duckVM, &object2);
 		break;
 
-		// I probably don't need an `if` if I research the standard a bit.
-	case duckLisp_instruction_setCdr32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		parsedBytecode = dl_true;
-		// Fall through
-	case duckLisp_instruction_setCdr16:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			ptrdiff2 = *(ip++);
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			parsedBytecode = dl_true;
-		}
-		// Fall through
 	case duckLisp_instruction_setCdr8:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff2 = *(ip++);
-		}
+		/* Fall through */
+	case duckLisp_instruction_setCdr16:
+		/* Fall through */
+	case duckLisp_instruction_setCdr32: DUCKVM_LABEL(setCdr)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
 		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
@@ -3790,6 +6260,8 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 				if (e) break;
 				object2.value.list->value.cons.cdr = objectPtr1;
 			}
+			e = duckVM_gclist_writeBarrier(&duckVM->gclist, object2.value.list);
+			if (e) break;
 		}
 		else if ((object2.type == duckVM_object_type_vector)
 		         && (object2.value.vector.internal_vector != dl_null)
@@ -3806,47 +6278,26 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		e = stack_push(duckVM, &object2);
 		break;
 
-		// I probably don't need an `if` if I research the standard a bit.
-	case duckLisp_instruction_nullp32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+	case duckLisp_instruction_nullp8:
 		/* Fall through */
 	case duckLisp_instruction_nullp16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
 		/* Fall through */
-	case duckLisp_instruction_nullp8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+	case duckLisp_instruction_nullp32: DUCKVM_LABEL(nullp)
+		ptrdiff1 = instruction->operands[0];
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
 		object2.type = duckVM_object_type_bool;
-		if (object1.type == duckVM_object_type_list) {
-			object2.value.boolean = (object1.value.list == dl_null);
-		}
-		else if (object1.type == duckVM_object_type_vector) {
-			object2.value.boolean = !((object1.value.vector.internal_vector != dl_null)
-			                          && ((dl_size_t) object1.value.vector.offset
-			                              < object1.value.vector.internal_vector->value.internal_vector.length));
-		}
-		else if (object1.type == duckVM_object_type_string) {
-			object2.value.boolean = !((object1.value.string.internalString != dl_null)
-			                          && ((dl_size_t) object1.value.string.offset < object1.value.string.length));
-		}
-		else {
-			object2.value.boolean = dl_false;
-		}
+		object2.value.boolean = duckVM_isNull(&object1);
 		e = stack_push(duckVM, &object2);
 		if (e) break;
 		break;
 
-	case duckLisp_instruction_typeof32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through. */
-	case duckLisp_instruction_typeof16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through. */
 	case duckLisp_instruction_typeof8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+		/* Fall through */
+	case duckLisp_instruction_typeof16:
+		/* Fall through */
+	case duckLisp_instruction_typeof32: DUCKVM_LABEL(typeof)
+		ptrdiff1 = instruction->operands[0];
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
 		object2.type = duckVM_object_type_type;
@@ -3857,56 +6308,21 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		if (e) break;
 		break;
 
-	case duckLisp_instruction_makeType:
+	case duckLisp_instruction_makeType: DUCKVM_LABEL(makeType)
 		object1.type = duckVM_object_type_type;
 		object1.value.type = duckVM->nextUserType++;
 		e = stack_push(duckVM, &object1);
 		if (e) break;
 		break;
 
-	case duckLisp_instruction_makeInstance32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+	case duckLisp_instruction_makeInstance8:
 		/* Fall through */
 	case duckLisp_instruction_makeInstance16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
 		/* Fall through */
-	case duckLisp_instruction_makeInstance8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-
-		ptrdiff2 = *(ip++);
-		switch (opcode) {
-		case duckLisp_instruction_makeInstance32:
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			/* Fall through */
-		case duckLisp_instruction_makeInstance16:
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			/* Fall through */
-		case duckLisp_instruction_makeInstance8:
-			break;
-		default:
-			e = dl_error_invalidValue;
-			break;
-		}
-		if (e) break;
-
-		ptrdiff3 = *(ip++);
-		switch (opcode) {
-		case duckLisp_instruction_makeInstance32:
-			ptrdiff3 = *(ip++) + (ptrdiff3 << 8);
-			ptrdiff3 = *(ip++) + (ptrdiff3 << 8);
-			/* Fall through */
-		case duckLisp_instruction_makeInstance16:
-			ptrdiff3 = *(ip++) + (ptrdiff3 << 8);
-			/* Fall through */
-		case duckLisp_instruction_makeInstance8:
-			break;
-		default:
-			e = dl_error_invalidValue;
-			break;
-		}
-		if (e) break;
+	case duckLisp_instruction_makeInstance32: DUCKVM_LABEL(makeInstance)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
+		ptrdiff3 = instruction->operands[2];
 
 		ptrdiff1 = duckVM->stack.elements_length - ptrdiff1;
 		if ((ptrdiff1 < 0) || ((dl_size_t) ptrdiff1 > duckVM->stack.elements_length)) {
@@ -3972,23 +6388,27 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 			if (e) break;
 			(DL_ARRAY_GETTOPADDRESS(duckVM->stack, duckVM_object_t).value.composite
 			 ->value.internalComposite.value) = objectPtr1;
+			/* Allocating the value could have made the internal composite old. */
+			e = duckVM_gclist_writeBarrier(&duckVM->gclist,
+			                               DL_ARRAY_GETTOPADDRESS(duckVM->stack, duckVM_object_t).value.composite);
+			if (e) break;
 			/* Function. */
 			e = duckVM_gclist_pushObject(duckVM, &objectPtr1, object3);
 			if (e) break;
 			(DL_ARRAY_GETTOPADDRESS(duckVM->stack, duckVM_object_t).value.composite
 			 ->value.internalComposite.function) = objectPtr1;
+			e = duckVM_gclist_writeBarrier(&duckVM->gclist,
+			                               DL_ARRAY_GETTOPADDRESS(duckVM->stack, duckVM_object_t).value.composite);
+			if (e) break;
 		}
 		break;
 
-	case duckLisp_instruction_compositeValue32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through. */
-	case duckLisp_instruction_compositeValue16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through. */
 	case duckLisp_instruction_compositeValue8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+		/* Fall through */
+	case duckLisp_instruction_compositeValue16:
+		/* Fall through */
+	case duckLisp_instruction_compositeValue32: DUCKVM_LABEL(compositeValue)
+		ptrdiff1 = instruction->operands[0];
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
 		if (object1.type != duckVM_object_type_composite) {
@@ -4002,15 +6422,12 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		if (e) break;
 		break;
 
-	case duckLisp_instruction_compositeFunction32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through. */
-	case duckLisp_instruction_compositeFunction16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through. */
 	case duckLisp_instruction_compositeFunction8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+		/* Fall through */
+	case duckLisp_instruction_compositeFunction16:
+		/* Fall through */
+	case duckLisp_instruction_compositeFunction32: DUCKVM_LABEL(compositeFunction)
+		ptrdiff1 = instruction->operands[0];
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
 		if (object1.type != duckVM_object_type_composite) {
@@ -4024,31 +6441,13 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		if (e) break;
 		break;
 
-	case duckLisp_instruction_setCompositeValue32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		parsedBytecode = dl_true;
+	case duckLisp_instruction_setCompositeValue8:
 		/* Fall through */
 	case duckLisp_instruction_setCompositeValue16:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			ptrdiff2 = *(ip++);
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			parsedBytecode = dl_true;
-		}
 		/* Fall through */
-	case duckLisp_instruction_setCompositeValue8:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff2 = *(ip++);
-		}
+	case duckLisp_instruction_setCompositeValue32: DUCKVM_LABEL(setCompositeValue)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
 		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
@@ -4064,34 +6463,18 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		e = duckVM_gclist_pushObject(duckVM, &objectPtr1, object2);
 		if (e) break;
 		object1.value.composite->value.internalComposite.value = objectPtr1;
+		e = duckVM_gclist_writeBarrier(&duckVM->gclist, object1.value.composite);
+		if (e) break;
 		e = stack_push(duckVM, &object1);
 		break;
 
-	case duckLisp_instruction_setCompositeFunction32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff2 = *(ip++);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-		parsedBytecode = dl_true;
+	case duckLisp_instruction_setCompositeFunction8:
 		/* Fall through */
 	case duckLisp_instruction_setCompositeFunction16:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			ptrdiff2 = *(ip++);
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			parsedBytecode = dl_true;
-		}
 		/* Fall through */
-	case duckLisp_instruction_setCompositeFunction8:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff2 = *(ip++);
-		}
+	case duckLisp_instruction_setCompositeFunction32: DUCKVM_LABEL(setCompositeFunction)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
 		e = dl_array_get(&duckVM->stack, &object2, duckVM->stack.elements_length - ptrdiff2);
@@ -4107,18 +6490,17 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		e = duckVM_gclist_pushObject(duckVM, &objectPtr1, object2);
 		if (e) break;
 		object1.value.composite->value.internalComposite.function = objectPtr1;
+		e = duckVM_gclist_writeBarrier(&duckVM->gclist, object1.value.composite);
+		if (e) break;
 		e = stack_push(duckVM, &object1);
 		break;
 
-	case duckLisp_instruction_length32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through. */
-	case duckLisp_instruction_length16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through. */
 	case duckLisp_instruction_length8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+		/* Fall through */
+	case duckLisp_instruction_length16:
+		/* Fall through */
+	case duckLisp_instruction_length32: DUCKVM_LABEL(length)
+		ptrdiff1 = instruction->operands[0];
 		{
 			e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 			if (e) break;
@@ -4162,15 +6544,12 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		}
 		break;
 
-	case duckLisp_instruction_symbolString32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through. */
-	case duckLisp_instruction_symbolString16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through. */
 	case duckLisp_instruction_symbolString8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+		/* Fall through */
+	case duckLisp_instruction_symbolString16:
+		/* Fall through */
+	case duckLisp_instruction_symbolString32: DUCKVM_LABEL(symbolString)
+		ptrdiff1 = instruction->operands[0];
 
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
@@ -4189,15 +6568,12 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		if (e) break;
 		break;
 
-	case duckLisp_instruction_symbolId32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through. */
-	case duckLisp_instruction_symbolId16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through. */
 	case duckLisp_instruction_symbolId8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+		/* Fall through */
+	case duckLisp_instruction_symbolId16:
+		/* Fall through */
+	case duckLisp_instruction_symbolId32: DUCKVM_LABEL(symbolId)
+		ptrdiff1 = instruction->operands[0];
 
 		e = dl_array_get(&duckVM->stack, &object1, duckVM->stack.elements_length - ptrdiff1);
 		if (e) break;
@@ -4214,15 +6590,12 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		if (e) break;
 		break;
 
-	case duckLisp_instruction_makeString32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through. */
-	case duckLisp_instruction_makeString16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		/* Fall through. */
 	case duckLisp_instruction_makeString8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+		/* Fall through */
+	case duckLisp_instruction_makeString16:
+		/* Fall through */
+	case duckLisp_instruction_makeString32: DUCKVM_LABEL(makeString)
+		ptrdiff1 = instruction->operands[0];
 		{
 			dl_uint8_t *string = dl_null;
 			dl_size_t string_length = 0;
@@ -4319,32 +6692,13 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		}
 		break;
 
-	case duckLisp_instruction_concatenate32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+	case duckLisp_instruction_concatenate8:
 		/* Fall through */
 	case duckLisp_instruction_concatenate16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
 		/* Fall through */
-	case duckLisp_instruction_concatenate8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-
-		ptrdiff2 = *(ip++);
-		switch (opcode) {
-		case duckLisp_instruction_concatenate32:
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			/* Fall through */
-		case duckLisp_instruction_concatenate16:
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			/* Fall through */
-		case duckLisp_instruction_concatenate8:
-			break;
-		default:
-			e = dl_error_cantHappen;
-			break;
-		}
-		if (e) break;
+	case duckLisp_instruction_concatenate32: DUCKVM_LABEL(concatenate)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
 
 		ptrdiff1 = duckVM->stack.elements_length - ptrdiff1;
 		if ((ptrdiff1 < 0) || ((dl_size_t) ptrdiff1 > duckVM->stack.elements_length)) {
@@ -4393,7 +6747,7 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 			if (object1.type == duckVM_object_type_string) {
 				object1_string = (object1.value.string.internalString->value.internalString.value
 				                  + object1.value.string.offset);
-				object1_string_length = object1.value.string.length;
+				object1_string_length = object1.value.string.length - object1.value.string.offset;
 			}
 			else {
 				object1_string = object1.value.symbol.internalString->value.internalString.value;
@@ -4402,7 +6756,7 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 			if (object2.type == duckVM_object_type_string) {
 				object2_string = (object2.value.string.internalString->value.internalString.value
 				                  + object2.value.string.offset);
-				object2_string_length = object2.value.string.length;
+				object2_string_length = object2.value.string.length - object2.value.string.offset;
 			}
 			else {
 				object2_string = object2.value.symbol.internalString->value.internalString.value;
@@ -4414,10 +6768,10 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 			e = duckVM_gclist_pushObject(duckVM, &objectPtr1, object3);
 			if (e) break;
 			objectPtr1->value.internalString.value_length = object1_string_length + object2_string_length;
-			e = DL_REALLOC(duckVM->memoryAllocation,
-			               &objectPtr1->value.internalString.value,
-			               objectPtr1->value.internalString.value_length,
-			               dl_uint8_t);
+			e = duckVM_gclist_reallocPayload(&duckVM->gclist,
+			                                 (void **) &objectPtr1->value.internalString.value,
+			                                 object1_string_length,
+			                                 objectPtr1->value.internalString.value_length);
 			if (e) break;
 			/**/ dl_memcopy_noOverlap((objectPtr1->value.internalString.value + object1_string_length),
 			                          object2_string,
@@ -4435,49 +6789,14 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		}
 		break;
 
-	case duckLisp_instruction_substring32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
+	case duckLisp_instruction_substring8:
 		/* Fall through */
 	case duckLisp_instruction_substring16:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
 		/* Fall through */
-	case duckLisp_instruction_substring8:
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-
-		ptrdiff2 = *(ip++);
-		switch (opcode) {
-		case duckLisp_instruction_substring32:
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			/* Fall through */
-		case duckLisp_instruction_substring16:
-			ptrdiff2 = *(ip++) + (ptrdiff2 << 8);
-			/* Fall through */
-		case duckLisp_instruction_substring8:
-			break;
-		default:
-			e = dl_error_cantHappen;
-			break;
-		}
-		if (e) break;
-
-		ptrdiff3 = *(ip++);
-		switch (opcode) {
-		case duckLisp_instruction_substring32:
-			ptrdiff3 = *(ip++) + (ptrdiff3 << 8);
-			ptrdiff3 = *(ip++) + (ptrdiff3 << 8);
-			/* Fall through */
-		case duckLisp_instruction_substring16:
-			ptrdiff3 = *(ip++) + (ptrdiff3 << 8);
-			/* Fall through */
-		case duckLisp_instruction_substring8:
-			break;
-		default:
-			e = dl_error_cantHappen;
-			break;
-		}
-		if (e) break;
+	case duckLisp_instruction_substring32: DUCKVM_LABEL(substring)
+		ptrdiff1 = instruction->operands[0];
+		ptrdiff2 = instruction->operands[1];
+		ptrdiff3 = instruction->operands[2];
 
 		ptrdiff1 = duckVM->stack.elements_length - ptrdiff1;
 		if ((ptrdiff1 < 0) || ((dl_size_t) ptrdiff1 > duckVM->stack.elements_length)) {
@@ -4567,85 +6886,139 @@ int duckVM_executeInstruction(duckVM_t *duckVM,
 		}
 		break;
 
-	case duckLisp_instruction_return32:
-		ptrdiff1 = *(ip++);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-		parsedBytecode = dl_true;
+	case duckLisp_instruction_return8:
 		/* Fall through */
 	case duckLisp_instruction_return16:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-			ptrdiff1 = *(ip++) + (ptrdiff1 << 8);
-			parsedBytecode = dl_true;
-		}
 		/* Fall through */
-	case duckLisp_instruction_return8:
-		if (!parsedBytecode) {
-			ptrdiff1 = *(ip++);
-		}
-
-		if (duckVM->stack.elements_length > 0) {
-			e = dl_array_getTop(&duckVM->stack, &object1);
-			if (e) break;
-		}
-		e = stack_pop_multiple(duckVM, ptrdiff1);
-		if (e) break;
-		if (duckVM->stack.elements_length > 0) {
-			e = stack_pop_multiple(duckVM, 1);
-			if (e) break;
-			e = stack_push(duckVM, &object1);
-			if (e) break;
-		}
-		e = call_stack_pop(duckVM, &ip, &bytecode);
-		if (e == dl_error_bufferUnderflow) {
-			*halt = duckVM_halt_mode_halt;
-			e = dl_error_ok;
-		}
+	case duckLisp_instruction_return32: DUCKVM_LABEL(return)
+		ip = &bytecode->value.bytecode.bytecode[next->offset];
+		e = duckVM_instruction_return(duckVM,
+		                              &ip,
+		                              &bytecode,
+		                              instruction->operands[0],
+		                              halt,
+		                              !instruction->verified);
+		if (e || (*halt != duckVM_halt_mode_run)) break;
+		e = duckVM_instructionAt(duckVM, bytecode, ip, &next);
 		break;
-	case duckLisp_instruction_return0:
+	case duckLisp_instruction_return0: DUCKVM_LABEL(return0)
+		if (!instruction->verified) {
+			e = duckVM_checkReturn(duckVM);
+			if (e) break;
+		}
+		ip = &bytecode->value.bytecode.bytecode[next->offset];
 		e = call_stack_pop(duckVM, &ip, &bytecode);
 		if (e == dl_error_bufferUnderflow) {
 			*halt = duckVM_halt_mode_halt;
 			e = dl_error_ok;
+			break;
 		}
+		if (e) break;
+		e = duckVM_instructionAt(duckVM, bytecode, ip, &next);
 		break;
 
-	case duckLisp_instruction_halt:
+	case duckLisp_instruction_halt: DUCKVM_LABEL(halt)
 		*halt = duckVM_halt_mode_halt;
 		break;
 
-	case duckLisp_instruction_nil:
+	case duckLisp_instruction_nil: DUCKVM_LABEL(nil)
 		object1.type = duckVM_object_type_list;
 		object1.value.list = dl_null;
 		e = stack_push(duckVM, &object1);
 		if (e) break;
 		break;
 
+	case duckLisp_instruction_brLess8:
+		/* Fall through */
+	case duckLisp_instruction_brLess16:
+		/* Fall through */
+	case duckLisp_instruction_brLess32:
+		/* Fall through */
+	case duckLisp_instruction_brGreater8:
+		/* Fall through */
+	case duckLisp_instruction_brGreater16:
+		/* Fall through */
+	case duckLisp_instruction_brGreater32:
+		/* Fall through */
+	case duckLisp_instruction_brEqual8:
+		/* Fall through */
+	case duckLisp_instruction_brEqual16:
+		/* Fall through */
+	case duckLisp_instruction_brEqual32:
+		/* Fall through */
+	case duckLisp_instruction_brNullp8:
+		/* Fall through */
+	case duckLisp_instruction_brNullp16:
+		/* Fall through */
+	case duckLisp_instruction_brNullp32: DUCKVM_LABEL(brCompare)
+		e = duckVM_instruction_brCompare(duckVM, instruction, &bool1);
+		if (e) break;
+		if (bool1) {
+			next = &bytecode->value.bytecode.decoded->instructions[instruction->operands[0]];
+		}
+		break;
+
+	case duckLisp_instruction_tailcall8:
+		/* Fall through */
+	case duckLisp_instruction_tailcall16:
+		/* Fall through */
+	case duckLisp_instruction_tailcall32: DUCKVM_LABEL(tailcall)
+		ip = &bytecode->value.bytecode.bytecode[next->offset];
+		e = duckVM_instruction_tailcall(duckVM,
+		                                &ip,
+		                                &bytecode,
+		                                instruction->operands[0],
+		                                instruction->bytes[0],
+		                                instruction->operands[1]);
+		if (e) break;
+		e = duckVM_instructionAt(duckVM, bytecode, ip, &next);
+		break;
+
 	default:
+#ifdef DUCKVM_THREADED_GOTO
+	duckVM_op_default:
+#endif
 		e = dl_error_invalidValue;
 		eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute: Invalid opcode."));
 		if (!e) e = eError;
 		goto cleanup;
 	}
+	if (duckVM->budgeted && !e && (*halt == duckVM_halt_mode_run)) {
+		if (--duckVM->instructionBudget == 0) *halt = duckVM_halt_mode_yield;
+	}
+#ifdef USE_THREADED_DISPATCH
+	if (e || (*halt != duckVM_halt_mode_run)) goto cleanup;
+	instruction = next;
+	goto dispatch;
+#endif
  cleanup:
-	*ipPtr = ip;
+	*instructionPtr = next;
+	*bytecodePtr = bytecode;
 	return e;
 }
 
-dl_error_t duckVM_executeWithIp(duckVM_t *duckVM,
-                                dl_uint8_t *bytecode,
-                                dl_ptrdiff_t ipOffset,
-                                dl_size_t bytecode_length) {
+#ifdef DUCKVM_THREADED_GOTO
+# pragma GCC diagnostic pop
+#endif
+#undef DUCKVM_LABEL
+
+/* Wrap raw bytecode in a heap object so that it can be switched out with other bytecodes by
+   `duckVM_executeInstruction`. */
+static dl_error_t duckVM_loadBytecode(duckVM_t *duckVM,
+                                      duckVM_object_t **bytecodeObject,
+                                      dl_uint8_t *bytecode,
+                                      dl_ptrdiff_t ipOffset,
+                                      dl_size_t bytecode_length) {
 	dl_error_t e = dl_error_ok;
+	dl_error_t eError = dl_error_ok;
 
-	duckVM_halt_mode_t halt = duckVM_halt_mode_run;
-	/* Why a reference to bytecode? So it can be switched out with other bytecodes by `duckVM_executeInstruction`. */
-	duckVM_object_t *bytecodeObject;
-	dl_uint8_t *ip = dl_null;
+	if (duckVM->suspendedBytecode != dl_null) {
+		e = dl_error_invalidValue;
+		eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_execute: VM is suspended."));
+		if (eError) e = eError;
+		goto cleanup;
+	}
 	if ((ipOffset < 0) || (bytecode_length <= (dl_size_t) ipOffset)) {
-		dl_error_t eError = dl_error_ok;
 		e = dl_error_invalidValue;
 		eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_executeWithIp: IP out of bounds."));
 		if (eError) e = eError;
@@ -4656,24 +7029,136 @@ dl_error_t duckVM_executeWithIp(duckVM_t *duckVM,
 		temp.type = duckVM_object_type_bytecode;
 		temp.value.bytecode.bytecode = bytecode;
 		temp.value.bytecode.bytecode_length = bytecode_length;
-		e = duckVM_gclist_pushObject(duckVM, &bytecodeObject, temp);
+		temp.value.bytecode.decoded = dl_null;
+		e = duckVM_gclist_pushObject(duckVM, bytecodeObject, temp);
+		if (e) goto cleanup;
+	}
+	e = duckVM_decodeBytecode(duckVM, &(*bytecodeObject)->value.bytecode);
+	if (e) goto cleanup;
+	/* Nothing can be assumed about the stack when starting from the middle of the bytecode. */
+	if (ipOffset == 0) {
+		e = duckVM_verifyBytecode(duckVM, &(*bytecodeObject)->value.bytecode);
 		if (e) goto cleanup;
 	}
-	ip = &bytecodeObject->value.bytecode.bytecode[ipOffset];
-	duckVM->currentBytecode = bytecodeObject;
-	if (bytecode_length == 0) goto cleanup;
-	do {
-		e = duckVM_executeInstruction(duckVM, bytecodeObject, &ip, &halt);
-	} while (!e && (halt == duckVM_halt_mode_run));
-	duckVM->currentBytecode = dl_null;
 
  cleanup: return e;
 }
 
+/* Run until the VM halts, yields, or fails. A yield saves the bytecode and IP for `duckVM_resume`. Everything else it
+   needs is already on the VM's stacks. Instructions are run from the decoded bytecode, so the IP is only converted on
+   the way in and out. */
+static dl_error_t duckVM_run(duckVM_t *duckVM,
+                             duckVM_object_t *bytecodeObject,
+                             dl_uint8_t *ip,
+                             duckVM_halt_mode_t *halt) {
+	dl_error_t e = dl_error_ok;
+	dl_error_t eError = dl_error_ok;
+	/* `duckVM_call` and `duckVM_execute` run bytecode from inside a callback, so there may be an outer run that still
+	   needs its bytecode kept alive. Nothing else refers to the outer bytecode once `currentBytecode` is replaced, so
+	   pin it until the inner run is done. */
+	duckVM_object_t *outerBytecode = duckVM->currentBytecode;
+	duckVM_decodedInstruction_t *instruction = dl_null;
+	*halt = duckVM_halt_mode_run;
+	if (outerBytecode != dl_null) {
+		e = duckVM_pinObject(duckVM, outerBytecode);
+		if (e) return e;
+	}
+	duckVM->currentBytecode = bytecodeObject;
+	e = duckVM_instructionAt(duckVM, bytecodeObject, ip, &instruction);
+	while (!e && (*halt == duckVM_halt_mode_run)) {
+		e = duckVM_executeInstruction(duckVM, &bytecodeObject, &instruction, halt);
+	}
+	if (!e && (*halt == duckVM_halt_mode_yield)) {
+		duckVM->suspendedBytecode = bytecodeObject;
+		duckVM->suspendedIp = &bytecodeObject->value.bytecode.bytecode[instruction->offset];
+	}
+	duckVM->currentBytecode = outerBytecode;
+	if (outerBytecode != dl_null) {
+		eError = duckVM_unpinObject(duckVM, outerBytecode);
+		if (!e) e = eError;
+	}
+	return e;
+}
+
+dl_error_t duckVM_executeWithIp(duckVM_t *duckVM,
+                                dl_uint8_t *bytecode,
+                                dl_ptrdiff_t ipOffset,
+                                dl_size_t bytecode_length) {
+	dl_error_t e = dl_error_ok;
+
+	duckVM_halt_mode_t halt = duckVM_halt_mode_run;
+	duckVM_object_t *bytecodeObject;
+	/* C callbacks that call back into the VM end up here. They expect the code they call to finish, so it runs outside
+	   of the budget. */
+	dl_bool_t budgeted = duckVM->budgeted;
+	duckVM->budgeted = dl_false;
+	e = duckVM_loadBytecode(duckVM, &bytecodeObject, bytecode, ipOffset, bytecode_length);
+	if (e) goto cleanup;
+	e = duckVM_run(duckVM, bytecodeObject, &bytecodeObject->value.bytecode.bytecode[ipOffset], &halt);
+
+ cleanup:
+	duckVM->budgeted = budgeted;
+	return e;
+}
+
 dl_error_t duckVM_execute(duckVM_t *duckVM, dl_uint8_t *bytecode, dl_size_t bytecode_length) {
 	return duckVM_executeWithIp(duckVM, bytecode, 0, bytecode_length);
 }
 
+dl_error_t duckVM_executeWithBudget(duckVM_t *duckVM,
+                                    dl_uint8_t *bytecode,
+                                    dl_size_t bytecode_length,
+                                    dl_size_t maxInstructions,
+                                    duckVM_halt_mode_t *status) {
+	dl_error_t e = dl_error_ok;
+
+	duckVM_object_t *bytecodeObject;
+	*status = duckVM_halt_mode_halt;
+	e = duckVM_loadBytecode(duckVM, &bytecodeObject, bytecode, 0, bytecode_length);
+	if (e) goto cleanup;
+	if (maxInstructions == 0) {
+		/* Nothing has run yet, so resuming starts from the top. */
+		duckVM->suspendedBytecode = bytecodeObject;
+		duckVM->suspendedIp = bytecodeObject->value.bytecode.bytecode;
+		*status = duckVM_halt_mode_yield;
+		goto cleanup;
+	}
+	duckVM->budgeted = dl_true;
+	duckVM->instructionBudget = maxInstructions;
+	e = duckVM_run(duckVM, bytecodeObject, bytecodeObject->value.bytecode.bytecode, status);
+	duckVM->budgeted = dl_false;
+
+ cleanup: return e;
+}
+
+dl_error_t duckVM_resume(duckVM_t *duckVM, dl_size_t maxInstructions, duckVM_halt_mode_t *status) {
+	dl_error_t e = dl_error_ok;
+	dl_error_t eError = dl_error_ok;
+
+	duckVM_object_t *bytecodeObject = duckVM->suspendedBytecode;
+	dl_uint8_t *ip = duckVM->suspendedIp;
+	if (bytecodeObject == dl_null) {
+		e = dl_error_invalidValue;
+		eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_resume: VM is not suspended."));
+		if (eError) e = eError;
+		goto cleanup;
+	}
+	*status = duckVM_halt_mode_yield;
+	if (maxInstructions == 0) goto cleanup;
+	duckVM->suspendedBytecode = dl_null;
+	duckVM->suspendedIp = dl_null;
+	duckVM->budgeted = dl_true;
+	duckVM->instructionBudget = maxInstructions;
+	e = duckVM_run(duckVM, bytecodeObject, ip, status);
+	duckVM->budgeted = dl_false;
+
+ cleanup: return e;
+}
+
+dl_bool_t duckVM_isSuspended(duckVM_t *duckVM) {
+	return duckVM->suspendedBytecode != dl_null;
+}
+
 dl_error_t duckVM_linkCFunction(duckVM_t *duckVM, dl_ptrdiff_t key, dl_error_t (*callback)(duckVM_t *)) {
 	dl_error_t e = dl_error_ok;
 
@@ -4700,7 +7185,36 @@ dl_error_t duckVM_linkCFunction(duckVM_t *duckVM, dl_ptrdiff_t key, dl_error_t (
 ///////////////////////////////////////
 
 dl_error_t duckVM_garbageCollect(duckVM_t *duckVM) {
-	return duckVM_gclist_garbageCollect(duckVM);
+	dl_error_t e = dl_error_ok;
+	duckVM->gclist.pauseWork = 0;
+	e = duckVM_gclist_garbageCollect(duckVM);
+	if (!e) e = duckVM_gclist_finishSweeping(duckVM);
+	/**/ duckVM_gclist_endPause(&duckVM->gclist);
+	return e;
+}
+
+dl_error_t duckVM_compact(duckVM_t *duckVM) {
+	dl_error_t e = dl_error_ok;
+	/* Instructions and callbacks hold pointers to heap objects in C variables, and those can't be fixed up. */
+	if (duckVM->currentBytecode != dl_null) {
+		dl_error_t eError = dl_error_ok;
+		e = dl_error_invalidValue;
+		eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_compact: Can't compact while the VM is running."));
+		if (eError) e = eError;
+		return e;
+	}
+	duckVM->gclist.pauseWork = 0;
+	e = duckVM_gclist_compact(duckVM);
+	/**/ duckVM_gclist_endPause(&duckVM->gclist);
+	return e;
+}
+
+dl_error_t duckVM_dumpHeap(duckVM_t *duckVM, dl_array_t *snapshot) {
+	dl_error_t e = dl_error_ok;
+	duckVM->gclist.pauseWork = 0;
+	e = duckVM_gclist_dumpHeap(duckVM, snapshot);
+	/**/ duckVM_gclist_endPause(&duckVM->gclist);
+	return e;
 }
 
 /* void duckVM_getArgLength(duckVM_t *duckVM, dl_size_t *length) { */
@@ -4733,8 +7247,134 @@ dl_error_t duckVM_allocateHeapObject(duckVM_t *duckVM, duckVM_object_t **heapObj
 	return duckVM_gclist_pushObject(duckVM, heapObjectOut, objectIn);
 }
 
+dl_error_t duckVM_pinObject(duckVM_t *duckVM, duckVM_object_t *object) {
+	return dl_array_pushElement(&duckVM->gclist.pinnedObjects, &object);
+}
+
+dl_error_t duckVM_unpinObject(duckVM_t *duckVM, duckVM_object_t *object) {
+	dl_error_t e = dl_error_ok;
+	dl_array_t *pinnedObjects = &duckVM->gclist.pinnedObjects;
+	/* Order doesn't matter, so the last pin fills the hole. */
+	DL_DOTIMES(i, pinnedObjects->elements_length) {
+		if (DL_ARRAY_GETADDRESS(*pinnedObjects, duckVM_object_t *, i) == object) {
+			DL_ARRAY_GETADDRESS(*pinnedObjects, duckVM_object_t *, i)
+				= DL_ARRAY_GETADDRESS(*pinnedObjects, duckVM_object_t *, pinnedObjects->elements_length - 1);
+			pinnedObjects->elements_length--;
+			return dl_error_ok;
+		}
+	}
+	{
+		dl_error_t eError = dl_error_ok;
+		e = dl_error_invalidValue;
+		eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_unpinObject: Object isn't pinned."));
+		if (eError) e = eError;
+	}
+	return e;
+}
+
+dl_error_t duckVM_setHeapLimits(duckVM_t *duckVM, dl_size_t maxObjects, dl_uint8_t targetLivePercent) {
+	dl_error_t e = dl_error_ok;
+	if ((targetLivePercent == 0) || (targetLivePercent > 100)) {
+		dl_error_t eError = dl_error_ok;
+		e = dl_error_invalidValue;
+		eError = duckVM_error_pushRuntime(duckVM,
+		                                  DL_STR("duckVM_setHeapLimits: Target must be between 1 and 100 percent."));
+		if (eError) e = eError;
+		goto cleanup;
+	}
+	duckVM->gclist.maxObjects = maxObjects;
+	duckVM->gclist.targetLivePercent = targetLivePercent;
+ cleanup: return e;
+}
+
+dl_error_t duckVM_setIncrementalMarking(duckVM_t *duckVM, dl_size_t sliceBudget) {
+	/* Turning it off while marking makes the next allocation finish the collection. */
+	duckVM->gclist.sliceBudget = sliceBudget;
+	return dl_error_ok;
+}
+
+dl_error_t duckVM_setParallelMarking(duckVM_t *duckVM, dl_size_t threads) {
+#ifndef USE_PARALLEL_MARKING
+	if (threads > 1) {
+		dl_error_t e = dl_error_invalidValue;
+		dl_error_t eError = duckVM_error_pushRuntime(duckVM,
+		                                             DL_STR("duckVM_setParallelMarking: Built without USE_PARALLEL_MARKING."));
+		if (eError) e = eError;
+		return e;
+	}
+#endif /* USE_PARALLEL_MARKING */
+	duckVM->gclist.markThreads = threads;
+	return dl_error_ok;
+}
+
+dl_size_t duckVM_getWorstGcPause(duckVM_t *duckVM) {
+	return duckVM->gclist.worstPause;
+}
+
+void duckVM_getGcStats(duckVM_t *duckVM, duckVM_gcStats_t *stats) {
+	duckVM_gclist_t *gclist = &duckVM->gclist;
+	stats->minorCollections = gclist->minorCollections;
+	stats->fullCollections = gclist->fullCollections;
+	stats->compactions = gclist->compactions;
+	stats->pauses = gclist->pauses;
+	stats->totalPause = gclist->totalPause;
+	stats->worstPause = gclist->worstPause;
+	stats->objectsAllocated = gclist->objectsAllocated;
+	stats->objectsFreed = gclist->objectsFreed;
+	stats->heapObjects = gclist->objects_length;
+	stats->payloadBytes = gclist->payloadBytes;
+	stats->slabBytes = gclist->payloadSlabs.elements_length * DUCKVM_GCLIST_SLAB_SIZE;
+	stats->decodedBytes = gclist->decodedBytes;
+	DL_DOTIMES(i, duckVM_object_type_last) {
+		stats->objectsInUse[i] = 0;
+	}
+	/* Objects that haven't been swept yet are only in use if they're marked. Everything that has been swept is either
+	   free or was allocated since. */
+	DL_DOTIMES(i, gclist->chunks_length) {
+		duckVM_gclist_chunk_t *chunk = &gclist->chunks[i];
+		DL_DOTIMES(j, chunk->objects_length) {
+			duckVM_object_type_t type = chunk->objects[j].type;
+			if ((type == duckVM_object_type_none)
+			    || (type >= duckVM_object_type_last)
+			    || (((dl_size_t) j >= chunk->swept) && !DUCKVM_GCLIST_GETBIT(chunk->marks, j))) {
+				continue;
+			}
+			stats->objectsInUse[type]++;
+		}
+	}
+}
+
+dl_error_t duckVM_setMinimumHeapGrowth(duckVM_t *duckVM, dl_size_t minimumGrowth) {
+	dl_error_t e = dl_error_ok;
+	if (minimumGrowth == 0) {
+		dl_error_t eError = dl_error_ok;
+		e = dl_error_invalidValue;
+		eError = duckVM_error_pushRuntime(duckVM, DL_STR("duckVM_setMinimumHeapGrowth: Growth can't be zero."));
+		if (eError) e = eError;
+		goto cleanup;
+	}
+	duckVM->gclist.minimumGrowth = minimumGrowth;
+ cleanup: return e;
+}
+
+dl_error_t duckVM_setFullCollectionTrigger(duckVM_t *duckVM, dl_uint8_t percent) {
+	dl_error_t e = dl_error_ok;
+	if (percent > 100) {
+		dl_error_t eError = dl_error_ok;
+		e = dl_error_invalidValue;
+		eError = duckVM_error_pushRuntime(duckVM,
+		                                  DL_STR("duckVM_setFullCollectionTrigger: Trigger can't be over 100 percent."));
+		if (eError) e = eError;
+		goto cleanup;
+	}
+	duckVM->gclist.fullCollectionTrigger = percent;
+ cleanup: return e;
+}
+
 dl_error_t duckVM_softReset(duckVM_t *duckVM) {
 	dl_error_t e = dl_error_ok;
+	duckVM->suspendedBytecode = dl_null;
+	duckVM->suspendedIp = dl_null;
 	e = stack_pop_multiple(duckVM, duckVM->stack.elements_length);
 	if (e) goto cleanup;
 	e = dl_array_popElements(&duckVM->upvalue_array_call_stack, dl_null, duckVM->call_stack.elements_length);
@@ -4759,10 +7399,13 @@ dl_error_t duckVM_pushGlobal(duckVM_t *duckVM, const dl_ptrdiff_t key) {
 
 /* Set the specified global variable to the value of the object on top of the stack. */
 dl_error_t duckVM_setGlobal(duckVM_t *duckVM, const dl_ptrdiff_t key) {
-	duckVM_object_t *object = dl_null;
-	dl_error_t e = stack_getTop(duckVM, object);
+	duckVM_object_t object;
+	duckVM_object_t *objectPointer = dl_null;
+	dl_error_t e = stack_getTop(duckVM, &object);
+	if (e) return e;
+	e = duckVM_gclist_pushObject(duckVM, &objectPointer, object);
 	if (e) return e;
-	return duckVM_global_set(duckVM, object, key);
+	return duckVM_global_set(duckVM, objectPointer, key);
 }
 
 
@@ -4924,6 +7567,7 @@ duckVM_object_t duckVM_object_makeBytecode(dl_uint8_t *bytecode, dl_size_t lengt
 	o.type = duckVM_object_type_bytecode;
 	o.value.bytecode.bytecode = bytecode;
 	o.value.bytecode.bytecode_length = length;
+	o.value.bytecode.decoded = dl_null;
 	return o;
 }
 
@@ -5219,6 +7863,8 @@ dl_error_t duckVM_upvalueArray_setUpvalue(duckVM_t *duckVM,
 	}
 	else if (upvalue.type == duckVM_upvalue_type_heap_object) {
 		*upvalue.value.heap_object = *object;
+		e = duckVM_gclist_writeBarrier(&duckVM->gclist, upvalue.value.heap_object);
+		if (e) return e;
 	}
 	return dl_error_ok;
 }
@@ -5589,6 +8235,18 @@ dl_error_t duckVM_call(duckVM_t *duckVM, dl_ptrdiff_t stackIndex, dl_uint8_t num
 			duckVM_object_t shim_bytecode_object[] = {duckVM_object_makeBytecode(shim_bytecode,
 			                                                                     sizeof(shim_bytecode) / sizeof(*shim_bytecode))};
 			dl_uint8_t *shim_ip = shim_bytecode;
+			/* The shim isn't on the heap, so it can't be decoded the normal way. */
+			duckVM_decodedInstruction_t shim_instructions[2];
+			dl_uint32_t shim_indices[] = {0, 1};
+			duckVM_decodedBytecode_t shim_decoded;
+			/**/ dl_memclear(shim_instructions, sizeof(shim_instructions));
+			shim_instructions[0].opcode = duckLisp_instruction_halt;
+			shim_instructions[1].opcode = DUCKVM_OPCODE_INVALID;
+			shim_instructions[1].offset = 1;
+			shim_decoded.length = 1;
+			shim_decoded.instructions = shim_instructions;
+			shim_decoded.indices = shim_indices;
+			shim_bytecode_object[0].value.bytecode.decoded = &shim_decoded;
 
 			duckVM_object_t *bytecode_object = functionObject.value.closure.bytecode;
 			duckVM_bytecode_t bytecode = bytecode_object->value.bytecode;
@@ -5596,7 +8254,8 @@ dl_error_t duckVM_call(duckVM_t *duckVM, dl_ptrdiff_t stackIndex, dl_uint8_t num
 			e = call_stack_push(duckVM,
 			                    shim_ip,
 			                    shim_bytecode_object,
-			                    &functionObject.value.closure.upvalue_array->value.upvalue_array);
+			                    &functionObject.value.closure.upvalue_array->value.upvalue_array,
+			                    duckVM_closure_stackBase(duckVM, functionObject.value.closure));
 			if (e) break;
 			/* stack: function *args */
 			e = duckVM_executeWithIp(duckVM, bytecode.bytecode, bytecode_offset, bytecode.bytecode_length);
@@ -6064,6 +8723,8 @@ dl_error_t duckVM_setCompositeValue(duckVM_t *duckVM, dl_ptrdiff_t stack_index)
 		e = duckVM_allocateHeapObject(duckVM, &heap_value, value);
 		if (e) break;
 		composite.value.composite->value.internalComposite.value = heap_value;
+		e = duckVM_gclist_writeBarrier(&duckVM->gclist, composite.value.composite);
+		if (e) break;
 	} while (0);
 	return e;
 }
@@ -6090,6 +8751,8 @@ dl_error_t duckVM_setCompositeFunction(duckVM_t *duckVM, dl_ptrdiff_t stack_inde
 		e = duckVM_allocateHeapObject(duckVM, &heap_value, value);
 		if (e) break;
 		composite.value.composite->value.internalComposite.function = heap_value;
+		e = duckVM_gclist_writeBarrier(&duckVM->gclist, composite.value.composite);
+		if (e) break;
 	} while (0);
         return e;
 }
@@ -6455,6 +9118,8 @@ dl_error_t duckVM_setFirst(duckVM_t *duckVM, dl_ptrdiff_t stack_index) {
 			duckVM_list_t list = sequence.value.list;
 			if (list) {
 				list->value.cons.car = value_pointer;
+				e = duckVM_gclist_writeBarrier(&duckVM->gclist, list);
+				if (e) break;
 			}
 			else {
 				/* Nil */
@@ -6470,6 +9135,8 @@ dl_error_t duckVM_setFirst(duckVM_t *duckVM, dl_ptrdiff_t stack_index) {
 			duckVM_vector_t vector = sequence.value.vector;
 			e = duckVM_vector_setElement(vector, value_pointer, 0);
 			if (e) break;
+			e = duckVM_gclist_writeBarrier(&duckVM->gclist, vector.internal_vector);
+			if (e) break;
 			break;
 		}
 		case duckVM_object_type_string: {
@@ -6527,6 +9194,8 @@ dl_error_t duckVM_setRest(duckVM_t *duckVM, dl_ptrdiff_t stack_index) {
 			duckVM_list_t list = sequence.value.list;
 			if (list) {
 				list->value.cons.cdr = value_pointer;
+				e = duckVM_gclist_writeBarrier(&duckVM->gclist, list);
+				if (e) break;
 			}
 			else {
 				e = dl_error_invalidValue;
@@ -6672,6 +9341,8 @@ dl_error_t duckVM_setElement(duckVM_t *duckVM, dl_ptrdiff_t sequence_index, dl_p
 			duckVM_list_t list = sequence.value.list;
 			if (list) {
 				list->value.cons.car = value_pointer;
+				e = duckVM_gclist_writeBarrier(&duckVM->gclist, list);
+				if (e) break;
 			}
 			else {
 				/* Nil */
@@ -6708,6 +9379,8 @@ dl_error_t duckVM_setElement(duckVM_t *duckVM, dl_ptrdiff_t sequence_index, dl_p
 			if (element_pointer) {
 				if (duckVM_object_type_cons == element_pointer->type) {
 					element_pointer->value.cons.car = value_pointer;
+					e = duckVM_gclist_writeBarrier(&duckVM->gclist, element_pointer);
+					if (e) break;
 				}
 				else {
 					e = dl_error_invalidValue;
@@ -6730,6 +9403,8 @@ dl_error_t duckVM_setElement(duckVM_t *duckVM, dl_ptrdiff_t sequence_index, dl_p
 			duckVM_vector_t vector = sequence.value.vector;
 			e = duckVM_vector_setElement(vector, value_pointer, sequence_index);
 			if (e) break;
+			e = duckVM_gclist_writeBarrier(&duckVM->gclist, vector.internal_vector);
+			if (e) break;
 			break;
 		}
 		case duckVM_object_type_string: {
@@ -6843,13 +9518,37 @@ dl_error_t duckVM_gclist_prettyPrint(dl_array_t *string_array, duckVM_gclist_t g
 	e = dl_array_pushElements(string_array, DL_STR("(duckVM_gclist_t) {"));
 	if (e) goto cleanup;
 
-	e = dl_array_pushElements(string_array, DL_STR("objects["));
+	e = dl_array_pushElements(string_array, DL_STR("objects_length = "));
 	if (e) goto cleanup;
 	e = dl_string_fromSize(string_array, gclist.objects_length);
 	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR(", "));
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR("maxObjects = "));
+	if (e) goto cleanup;
+	e = dl_string_fromSize(string_array, gclist.maxObjects);
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR(", "));
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR("targetLivePercent = "));
+	if (e) goto cleanup;
+	e = dl_string_fromSize(string_array, gclist.targetLivePercent);
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR(", "));
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR("chunks["));
+	if (e) goto cleanup;
+	e = dl_string_fromSize(string_array, gclist.chunks_length);
+	if (e) goto cleanup;
 	e = dl_array_pushElements(string_array, DL_STR("] = "));
 	if (e) goto cleanup;
-	if (gclist.objects == dl_null) {
+	if (gclist.chunks == dl_null) {
 		e = dl_array_pushElements(string_array, DL_STR("NULL"));
 		if (e) goto cleanup;
 	}
@@ -6879,13 +9578,13 @@ dl_error_t duckVM_gclist_prettyPrint(dl_array_t *string_array, duckVM_gclist_t g
 	e = dl_array_pushElements(string_array, DL_STR(", "));
 	if (e) goto cleanup;
 
-	e = dl_array_pushElements(string_array, DL_STR("objectInUse["));
+	e = dl_array_pushElements(string_array, DL_STR("youngObjects["));
 	if (e) goto cleanup;
-	e = dl_string_fromSize(string_array, gclist.objects_length);
+	e = dl_string_fromSize(string_array, gclist.youngObjects_length);
 	if (e) goto cleanup;
 	e = dl_array_pushElements(string_array, DL_STR("] = "));
 	if (e) goto cleanup;
-	if (gclist.objectInUse == dl_null) {
+	if (gclist.youngObjects == dl_null) {
 		e = dl_array_pushElements(string_array, DL_STR("NULL"));
 		if (e) goto cleanup;
 	}
@@ -6894,6 +9593,73 @@ dl_error_t duckVM_gclist_prettyPrint(dl_array_t *string_array, duckVM_gclist_t g
 		if (e) goto cleanup;
 	}
 
+	e = dl_array_pushElements(string_array, DL_STR(", "));
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR("rememberedSet["));
+	if (e) goto cleanup;
+	e = dl_string_fromSize(string_array, gclist.rememberedSet.elements_length);
+	if (e) goto cleanup;
+	e = dl_array_pushElements(string_array, DL_STR("] = {...}"));
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR(", "));
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR("grayStack["));
+	if (e) goto cleanup;
+	e = dl_string_fromSize(string_array, gclist.grayStack.elements_length);
+	if (e) goto cleanup;
+	e = dl_array_pushElements(string_array, DL_STR("] = {...}"));
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR(", "));
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR("sweepChunk = "));
+	if (e) goto cleanup;
+	e = dl_string_fromSize(string_array, gclist.sweepChunk);
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR(", "));
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR("markedObjects = "));
+	if (e) goto cleanup;
+	e = dl_string_fromSize(string_array, gclist.markedObjects);
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR(", "));
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR("payloadSlabs["));
+	if (e) goto cleanup;
+	e = dl_string_fromSize(string_array, gclist.payloadSlabs.elements_length);
+	if (e) goto cleanup;
+	e = dl_array_pushElements(string_array, DL_STR("] = {...}, "));
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR("marking = "));
+	if (e) goto cleanup;
+	e = dl_string_fromBool(string_array, gclist.marking);
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR(", "));
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR("sliceBudget = "));
+	if (e) goto cleanup;
+	e = dl_string_fromSize(string_array, gclist.sliceBudget);
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR(", "));
+	if (e) goto cleanup;
+
+	e = dl_array_pushElements(string_array, DL_STR("worstPause = "));
+	if (e) goto cleanup;
+	e = dl_string_fromSize(string_array, gclist.worstPause);
+	if (e) goto cleanup;
+
 	e = dl_array_pushElements(string_array, DL_STR("}"));
 	if (e) goto cleanup;
 
@@ -7041,20 +9807,21 @@ dl_error_t duckVM_prettyPrint(dl_array_t *string_array, duckVM_t duckVM) {
 
 	e = dl_array_pushElements(string_array, DL_STR("globals = {"));
 	if (e) goto cleanup;
-	DL_DOTIMES(i, duckVM.globals.elements_length) {
-		DL_DOTIMES(j, duckVM.globals_map.elements_length) {
-			dl_ptrdiff_t target_index = DL_ARRAY_GETADDRESS(duckVM.globals, dl_ptrdiff_t, i);
-			if (target_index == i) {
-				e = dl_string_fromPtrdiff(string_array, j);
-				if (e) goto cleanup;
-				e = dl_array_pushElements(string_array, DL_STR(": "));
+	{
+		dl_bool_t first = dl_true;
+		DL_DOTIMES(i, duckVM.globals.elements_length) {
+			duckVM_object_t *global = DL_ARRAY_GETADDRESS(duckVM.globals, duckVM_object_t *, i);
+			if (global == dl_null) continue;
+			if (!first) {
+				e = dl_array_pushElements(string_array, DL_STR(", "));
 				if (e) goto cleanup;
 			}
-		}
-		e = duckVM_object_prettyPrint(string_array, DL_ARRAY_GETADDRESS(duckVM.globals, duckVM_object_t, i), duckVM);
-		if (e) goto cleanup;
-		if ((dl_size_t) i != duckVM.globals.elements_length - 1) {
-			e = dl_array_pushElements(string_array, DL_STR(", "));
+			first = dl_false;
+			e = dl_string_fromPtrdiff(string_array, i);
+			if (e) goto cleanup;
+			e = dl_array_pushElements(string_array, DL_STR(": "));
+			if (e) goto cleanup;
+			e = duckVM_object_prettyPrint(string_array, *global, duckVM);
 			if (e) goto cleanup;
 		}
 	}
@@ -35,12 +35,80 @@ typedef enum {
 	duckVM_upvalue_type_heap_upvalue
 } duckVM_upvalue_type_t;
 
-typedef struct duckVM_gclist_s {
+/* A block of heap objects. Chunks are never moved or resized, so pointers to objects stay valid as the heap grows. */
+typedef struct {
 	struct duckVM_object_s *objects;
-	struct duckVM_object_s **freeObjects;
-	dl_bool_t *objectInUse;
+	/* Mark bitmap, one bit per object. An object that survived a collection stays marked until the next full
+	   collection. */
+	dl_uint64_t *marks;
+	/* Bitmap of the objects in the remembered set. */
+	dl_uint64_t *remembered;
+	/* Bitmap of the objects that compaction isn't allowed to move. Only used while compacting. */
+	dl_uint64_t *pinned;
 	dl_size_t objects_length;
+	/* Objects before this index have been swept since the last full collection. */
+	dl_size_t swept;
+} duckVM_gclist_chunk_t;
+
+/* Number of size classes for small object payloads. The smallest class holds 16 byte blocks, and each class after that
+   doubles. */
+#define DUCKVM_GCLIST_PAYLOAD_CLASSES 5
+
+typedef struct duckVM_gclist_s {
+	duckVM_gclist_chunk_t *chunks;  /* Sorted by address. */
+	dl_size_t chunks_length;
+	struct duckVM_object_s **freeObjects;
+	dl_size_t objects_length;  /* Total number of objects in all chunks. */
 	dl_size_t freeObjects_length;
+	/* The heap never grows past this many objects. */
+	dl_size_t maxObjects;
+	/* After a collection, the heap grows until no more than this percentage of it is in use. */
+	dl_uint8_t targetLivePercent;
+	/* The heap never grows by fewer than this many objects at once. */
+	dl_size_t minimumGrowth;
+	/* Minor collections are done until promoted objects have used up this percentage of the free space that the last
+	   full collection left. */
+	dl_uint8_t fullCollectionTrigger;
+	/* Objects allocated since the last collection. Minor collections only sweep these. */
+	struct duckVM_object_s **youngObjects;
+	dl_size_t youngObjects_length;
+	/* Minor collections don't trace old objects, so these are traced instead: old objects that had a pointer stored in
+	   them, and young objects stored in globals. */
+	dl_array_t rememberedSet;  /* dl_array_t:duckVM_object_t * */
+	/* Chunks before this index have been swept. Sweeping after a full collection is done as objects are allocated. */
+	dl_size_t sweepChunk;
+	/* Number of marked objects. After a full collection, this is the number of live objects. */
+	dl_size_t markedObjects;
+	/* Objects that have been marked but whose contents haven't been traced yet. */
+	dl_array_t grayStack;  /* dl_array_t:duckVM_object_t * */
+	/* Set while an incremental collection is marking. */
+	dl_bool_t marking;
+	/* Most objects an allocation traces while an incremental collection is marking. Zero disables incremental
+	   marking. */
+	dl_size_t sliceBudget;
+	/* Threads that mark the heap during the pauses of full collections. Only used if the VM was built with
+	   `USE_PARALLEL_MARKING`. */
+	dl_size_t markThreads;
+	/* Small strings, vectors, upvalue arrays, and bytecode are allocated from slabs instead of the general allocator.
+	   There is a free list of blocks for each size class. Slabs are only freed when the VM quits. */
+	void *payloadFreeLists[DUCKVM_GCLIST_PAYLOAD_CLASSES];
+	dl_array_t payloadSlabs;  /* dl_array_t:dl_uint8_t * */
+	/* Objects that C code has a pointer to. These are roots, and compaction doesn't move them. An object may be in here
+	   more than once. */
+	dl_array_t pinnedObjects;  /* dl_array_t:duckVM_object_t * */
+	/* Objects traced or swept so far in the current pause, and the most in any one pause. */
+	dl_size_t pauseWork;
+	dl_size_t worstPause;
+	/* Counters for `duckVM_getGcStats`. */
+	dl_size_t pauses;
+	dl_size_t totalPause;
+	dl_size_t minorCollections;
+	dl_size_t fullCollections;
+	dl_size_t compactions;
+	dl_size_t objectsAllocated;
+	dl_size_t objectsFreed;
+	dl_size_t payloadBytes;
+	dl_size_t decodedBytes;
 	dl_array_strategy_t strategy;
 	dl_memoryAllocation_t *memoryAllocation;
 	struct duckVM_s *duckVM;
@@ -49,6 +117,12 @@ typedef struct duckVM_gclist_s {
 typedef struct {
 	dl_uint8_t *ip;
 	struct duckVM_object_s *bytecode;
+	/* The closure being run normally sits on the caller's stack, which keeps it alive. A tail call may pop it, so the
+	   callee's bytecode and upvalues are kept here instead. Null unless the frame was reused by a tail call. */
+	struct duckVM_object_s *tailcallBytecode;
+	struct duckVM_object_s *tailcallUpvalueArray;
+	/* Stack length under the callee's arguments. Verified code expects the return value to be pushed right here. */
+	dl_size_t stackBase;
 } duckVM_callFrame_t;
 
 typedef struct duckVM_s {
@@ -58,11 +132,20 @@ typedef struct duckVM_s {
 	dl_array_t call_stack;  /* duckVM_callFrame_t */
 	/* I'm lazy and I don't want to bother with correct GC. */
 	struct duckVM_object_s *currentBytecode;
+	/* Set by `duckVM_executeWithBudget` and `duckVM_resume`. Each instruction uses up one unit of the budget, and the
+	   VM yields when it runs out. */
+	dl_bool_t budgeted;
+	dl_size_t instructionBudget;
+	/* Where a yielded execution picks up. Null if the VM isn't suspended. */
+	struct duckVM_object_s *suspendedBytecode;
+	dl_uint8_t *suspendedIp;
 	dl_array_t upvalue_stack;  /* duckVM_upvalue_t * */
 	dl_array_t upvalue_array_call_stack;  /* duckVM_upvalueArray_t */
 	/* Addressed by symbol number. */
-	dl_array_t globals;  /* duckVM_object_t * */
-	dl_array_t globals_map;  /* dl_ptrdiff_t */
+	dl_array_t globals;  /* duckVM_object_t * indexed by key. Null if the global is undefined. */
+	/* duckVM_function_t indexed by key. A copy of every global that is a C function, so that `ccall` is a single
+	   indirect call. Null if the global isn't a C function. */
+	dl_array_t callbacks;
 	duckVM_gclist_t gclist;
 	dl_size_t nextUserType;
 	void *duckLisp;
@@ -141,10 +224,41 @@ typedef struct {
 	dl_ptrdiff_t offset;
 } duckVM_vector_t;
 
+/* Stands in for anything that can't be run: an instruction that couldn't be decoded, the end of the bytecode, and
+   addresses in the middle of an instruction. Running it is an error. */
+#define DUCKVM_OPCODE_INVALID 0xFF
+
+/* One instruction with its operands parsed to native width. Every instruction takes the same amount of space so that
+   the VM can step through them by index. */
+typedef struct {
+	/* Operands in the order they're encoded in. Relative addresses are converted to absolute ones. Branch targets are
+	   indices of instructions, and closure addresses are offsets into the bytecode. Inline data like strings and
+	   upvalue lists stays in the bytecode, and the operand is its offset. */
+	dl_ptrdiff_t operands[3];
+	dl_uint32_t offset;  /* Where the instruction starts in the bytecode. */
+	dl_uint8_t opcode;  /* The original opcode, including its width. */
+	/* Set by the verifier. The instruction's stack indices are known to be in range, so they aren't checked. */
+	dl_bool_t verified;
+	/* One-byte operands: argument counts, and the stack indices compared by the compare-and-branch instructions. */
+	dl_uint8_t bytes[2];
+} duckVM_decodedInstruction_t;
+
+/* Every instruction of a bytecode, in order, decoded before it runs. The instruction at `length` is
+   `DUCKVM_OPCODE_INVALID` and has the bytecode's length as its offset. `indices` maps each offset in the bytecode,
+   and the offset just past the end, to the instruction that starts there, or to `length` if none does. Both arrays are
+   in the same block as the header. */
+typedef struct {
+	dl_size_t length;
+	duckVM_decodedInstruction_t *instructions;
+	dl_uint32_t *indices;
+} duckVM_decodedBytecode_t;
+
 /* Should never appear on the stack */
 typedef struct {
 	dl_uint8_t *bytecode;
 	dl_size_t bytecode_length;
+	/* Filled in by `duckVM_execute`, or the first time a call or return goes to this bytecode. */
+	duckVM_decodedBytecode_t *decoded;
 } duckVM_bytecode_t;
 
 /* Should never appear on the stack */
@@ -222,9 +336,54 @@ typedef struct duckVM_object_s {
 
 typedef dl_error_t (*duckVM_gclist_destructor_t)(duckVM_gclist_t *, duckVM_object_t *);
 
+/* Collector statistics. Counts are totals since the VM was initialized. */
+typedef struct {
+	dl_size_t minorCollections;
+	/* Incremental collections are counted when they finish. Compaction does a full collection too. */
+	dl_size_t fullCollections;
+	dl_size_t compactions;
+	/* Pauses are measured in objects traced or swept, like `duckVM_getWorstGcPause`. */
+	dl_size_t pauses;
+	dl_size_t totalPause;
+	dl_size_t worstPause;
+	dl_size_t objectsAllocated;
+	dl_size_t objectsFreed;
+	/* Size of the heap, and the objects in use, by type. Garbage counts as in use until the collector gets to it. */
+	dl_size_t heapObjects;
+	dl_size_t objectsInUse[duckVM_object_type_last];
+	/* Bytes of strings, vectors, upvalue arrays, and bytecode in use, rounded up to the size of their blocks. The slab
+	   bytes are what the small blocks were carved out of. */
+	dl_size_t payloadBytes;
+	dl_size_t slabBytes;
+	/* Part of `payloadBytes`. Decoded instructions take 32 bytes each, plus 4 bytes per byte of bytecode. */
+	dl_size_t decodedBytes;
+} duckVM_gcStats_t;
+
+/* Heap dumps start with this, and then a version byte. See `duckVM_dumpHeap`. */
+#define DUCKVM_HEAPDUMP_MAGIC "DLHEAP"
+#define DUCKVM_HEAPDUMP_VERSION 1
+
+/* Where a root in a heap dump came from. */
+typedef enum {
+	/* Objects pointed to by a value on the stack. The index is the stack index. */
+	duckVM_heapRoot_stack,
+	duckVM_heapRoot_upvalueStack,
+	/* The index is the global's key. */
+	duckVM_heapRoot_global,
+	/* Bytecode and upvalues held by a call frame. The index is the frame's depth. */
+	duckVM_heapRoot_callStack,
+	/* Bytecode that is running or suspended. */
+	duckVM_heapRoot_bytecode,
+	/* Objects pinned by `duckVM_pinObject`. */
+	duckVM_heapRoot_pinned,
+	duckVM_heapRoot_last,
+} duckVM_heapRoot_t;
+
 typedef enum {
 	duckVM_halt_mode_run,
 	duckVM_halt_mode_halt,
+	/* Ran out of instructions. See `duckVM_executeWithBudget`. */
+	duckVM_halt_mode_yield,
 } duckVM_halt_mode_t;
 
 
@@ -237,6 +396,18 @@ dl_error_t duckVM_init(duckVM_t *duckVM, dl_memoryAllocation_t *memoryAllocation
 void duckVM_quit(duckVM_t *duckVM);
 /* Execute bytecode. */
 dl_error_t duckVM_execute(duckVM_t *duckVM, dl_uint8_t *bytecode, dl_size_t bytecode_length);
+/* Execute at most `maxInstructions` instructions of bytecode. `status` is set to `duckVM_halt_mode_halt` if the
+   bytecode ran to completion, or to `duckVM_halt_mode_yield` if it was suspended. A suspended VM keeps its stacks and
+   can only be resumed or reset. Instructions run by C callbacks that call back into the VM aren't counted. */
+dl_error_t duckVM_executeWithBudget(duckVM_t *duckVM,
+                                    dl_uint8_t *bytecode,
+                                    dl_size_t bytecode_length,
+                                    dl_size_t maxInstructions,
+                                    duckVM_halt_mode_t *status);
+/* Continue a suspended execution for at most `maxInstructions` instructions. */
+dl_error_t duckVM_resume(duckVM_t *duckVM, dl_size_t maxInstructions, duckVM_halt_mode_t *status);
+/* Return true if the VM yielded and hasn't been resumed to completion or reset since. */
+dl_bool_t duckVM_isSuspended(duckVM_t *duckVM);
 /* Pass a C callback to the VM. `key` can be found by querying the compiler. */
 dl_error_t duckVM_linkCFunction(duckVM_t *duckVM, dl_ptrdiff_t key, dl_error_t (*callback)(duckVM_t *));
 
@@ -244,7 +415,36 @@ dl_error_t duckVM_linkCFunction(duckVM_t *duckVM, dl_ptrdiff_t key, dl_error_t (
 dl_error_t duckVM_popAll(duckVM_t *duckVM);
 /* Force garbage collection to run. */
 dl_error_t duckVM_garbageCollect(duckVM_t *duckVM);
-/* Reset the VM, but retain global variables and the contents of the heap. */
+/* Run a full collection, then move live objects next to each other in the order they are reached from the roots. List
+   spines and the values of vectors end up next to each other in memory, and chunks that end up empty are freed.
+   Pointers to heap objects held by C code are invalidated unless the object was pinned with `duckVM_pinObject`.
+   User-defined objects and the objects their markers report are never moved. Can't be called while the VM is running,
+   which includes from a C callback, but a suspended VM may be compacted. */
+dl_error_t duckVM_compact(duckVM_t *duckVM);
+/* Set the hard cap on the number of heap objects and the percentage of the heap that may be live after a collection
+   before the heap grows. The heap starts small and grows in chunks. Lowering the cap doesn't shrink the heap. */
+dl_error_t duckVM_setHeapLimits(duckVM_t *duckVM, dl_size_t maxObjects, dl_uint8_t targetLivePercent);
+/* Spread the marking of full collections over many allocations. Each allocation traces at most `sliceBudget` objects
+   until marking is done. Zero turns incremental marking off, which is the default. */
+dl_error_t duckVM_setIncrementalMarking(duckVM_t *duckVM, dl_size_t sliceBudget);
+/* Mark the heap on `threads` threads during full collections, counting the calling thread. Small heaps are still
+   marked on one thread. Markers of user-defined objects are always called on the calling thread. Fails if the VM
+   wasn't built with `USE_PARALLEL_MARKING` and `threads` is more than one. */
+dl_error_t duckVM_setParallelMarking(duckVM_t *duckVM, dl_size_t threads);
+/* The most work the collector has done in one pause, counted in objects traced or swept. */
+dl_size_t duckVM_getWorstGcPause(duckVM_t *duckVM);
+/* Fill `stats` with what the collector has been up to. Counting the objects in use walks the heap. */
+void duckVM_getGcStats(duckVM_t *duckVM, duckVM_gcStats_t *stats);
+/* Set the fewest objects the heap grows by at once. The default is 256. Bigger steps mean fewer, larger chunks. */
+dl_error_t duckVM_setMinimumHeapGrowth(duckVM_t *duckVM, dl_size_t minimumGrowth);
+/* Set how much of the free space left by a full collection promoted objects may use before the next full collection.
+   Lower percentages mean more full collections and a smaller heap. The default is 50. */
+dl_error_t duckVM_setFullCollectionTrigger(duckVM_t *duckVM, dl_uint8_t percent);
+/* Run a full collection and append a snapshot of the heap to `snapshot`, which must be an array of bytes. The snapshot
+   lists every live object with its type, its size including its payload, and the objects it points to, followed by the
+   roots. See the internals documentation for the format. `scratchwork/heap-analyzer.c` reads it. */
+dl_error_t duckVM_dumpHeap(duckVM_t *duckVM, dl_array_t *snapshot);
+/* Reset the VM, but retain global variables and the contents of the heap. Abandons a suspended execution. */
 dl_error_t duckVM_softReset(duckVM_t *duckVM);
 
 
@@ -432,6 +632,10 @@ duckVM_object_t duckVM_object_makeUser(void *data,
 
 /* Copy an object onto the heap. Advanced. */
 dl_error_t duckVM_allocateHeapObject(duckVM_t *duckVM, duckVM_object_t **heapObjectOut, duckVM_object_t objectIn);
+/* Keep a heap object alive and stop `duckVM_compact` from moving it, so that C code can hold on to a pointer to it.
+   Pins nest, so an object pinned twice has to be unpinned twice. */
+dl_error_t duckVM_pinObject(duckVM_t *duckVM, duckVM_object_t *object);
+dl_error_t duckVM_unpinObject(duckVM_t *duckVM, duckVM_object_t *object);
 
 dl_error_t duckVM_object_pop(duckVM_t *duckVM, duckVM_object_t *object);
 dl_error_t duckVM_object_push(duckVM_t *duckVM, duckVM_object_t *object);
@@ -753,6 +753,136 @@ dl_error_t duckLisp_emit_sub(duckLisp_t *duckLisp,
 	                                         source_index2);
 }
 
+dl_error_t duckLisp_emit_addInt(duckLisp_t *duckLisp,
+                                duckLisp_compileState_t *compileState,
+                                dl_array_t *assembly,
+                                const dl_ptrdiff_t source_index1,
+                                const dl_ptrdiff_t source_index2) {
+	return duckLisp_emit_binaryStackOperator(duckLisp,
+	                                         compileState,
+	                                         assembly,
+	                                         duckLisp_instructionClass_addInt,
+	                                         source_index1,
+	                                         source_index2);
+}
+
+dl_error_t duckLisp_emit_addFloat(duckLisp_t *duckLisp,
+                                  duckLisp_compileState_t *compileState,
+                                  dl_array_t *assembly,
+                                  const dl_ptrdiff_t source_index1,
+                                  const dl_ptrdiff_t source_index2) {
+	return duckLisp_emit_binaryStackOperator(duckLisp,
+	                                         compileState,
+	                                         assembly,
+	                                         duckLisp_instructionClass_addFloat,
+	                                         source_index1,
+	                                         source_index2);
+}
+
+dl_error_t duckLisp_emit_subInt(duckLisp_t *duckLisp,
+                                duckLisp_compileState_t *compileState,
+                                dl_array_t *assembly,
+                                const dl_ptrdiff_t source_index1,
+                                const dl_ptrdiff_t source_index2) {
+	return duckLisp_emit_binaryStackOperator(duckLisp,
+	                                         compileState,
+	                                         assembly,
+	                                         duckLisp_instructionClass_subInt,
+	                                         source_index1,
+	                                         source_index2);
+}
+
+dl_error_t duckLisp_emit_subFloat(duckLisp_t *duckLisp,
+                                  duckLisp_compileState_t *compileState,
+                                  dl_array_t *assembly,
+                                  const dl_ptrdiff_t source_index1,
+                                  const dl_ptrdiff_t source_index2) {
+	return duckLisp_emit_binaryStackOperator(duckLisp,
+	                                         compileState,
+	                                         assembly,
+	                                         duckLisp_instructionClass_subFloat,
+	                                         source_index1,
+	                                         source_index2);
+}
+
+dl_error_t duckLisp_emit_mulInt(duckLisp_t *duckLisp,
+                                duckLisp_compileState_t *compileState,
+                                dl_array_t *assembly,
+                                const dl_ptrdiff_t source_index1,
+                                const dl_ptrdiff_t source_index2) {
+	return duckLisp_emit_binaryStackOperator(duckLisp,
+	                                         compileState,
+	                                         assembly,
+	                                         duckLisp_instructionClass_mulInt,
+	                                         source_index1,
+	                                         source_index2);
+}
+
+dl_error_t duckLisp_emit_mulFloat(duckLisp_t *duckLisp,
+                                  duckLisp_compileState_t *compileState,
+                                  dl_array_t *assembly,
+                                  const dl_ptrdiff_t source_index1,
+                                  const dl_ptrdiff_t source_index2) {
+	return duckLisp_emit_binaryStackOperator(duckLisp,
+	                                         compileState,
+	                                         assembly,
+	                                         duckLisp_instructionClass_mulFloat,
+	                                         source_index1,
+	                                         source_index2);
+}
+
+dl_error_t duckLisp_emit_lessInt(duckLisp_t *duckLisp,
+                                 duckLisp_compileState_t *compileState,
+                                 dl_array_t *assembly,
+                                 const dl_ptrdiff_t source_index1,
+                                 const dl_ptrdiff_t source_index2) {
+	return duckLisp_emit_binaryStackOperator(duckLisp,
+	                                         compileState,
+	                                         assembly,
+	                                         duckLisp_instructionClass_lessInt,
+	                                         source_index1,
+	                                         source_index2);
+}
+
+dl_error_t duckLisp_emit_lessFloat(duckLisp_t *duckLisp,
+                                   duckLisp_compileState_t *compileState,
+                                   dl_array_t *assembly,
+                                   const dl_ptrdiff_t source_index1,
+                                   const dl_ptrdiff_t source_index2) {
+	return duckLisp_emit_binaryStackOperator(duckLisp,
+	                                         compileState,
+	                                         assembly,
+	                                         duckLisp_instructionClass_lessFloat,
+	                                         source_index1,
+	                                         source_index2);
+}
+
+dl_error_t duckLisp_emit_greaterInt(duckLisp_t *duckLisp,
+                                    duckLisp_compileState_t *compileState,
+                                    dl_array_t *assembly,
+                                    const dl_ptrdiff_t source_index1,
+                                    const dl_ptrdiff_t source_index2) {
+	return duckLisp_emit_binaryStackOperator(duckLisp,
+	                                         compileState,
+	                                         assembly,
+	                                         duckLisp_instructionClass_greaterInt,
+	                                         source_index1,
+	                                         source_index2);
+}
+
+dl_error_t duckLisp_emit_greaterFloat(duckLisp_t *duckLisp,
+                                      duckLisp_compileState_t *compileState,
+                                      dl_array_t *assembly,
+                                      const dl_ptrdiff_t source_index1,
+                                      const dl_ptrdiff_t source_index2) {
+	return duckLisp_emit_binaryStackOperator(duckLisp,
+	                                         compileState,
+	                                         assembly,
+	                                         duckLisp_instructionClass_greaterFloat,
+	                                         source_index1,
+	                                         source_index2);
+}
+
 dl_error_t duckLisp_emit_nop(duckLisp_t *duckLisp, duckLisp_compileState_t *compileState, dl_array_t *assembly) {
 	return duckLisp_emit_nullaryOperator(duckLisp, compileState, assembly, duckLisp_instructionClass_nop);
 	/**/ duckLisp_localsLength_decrement(compileState);
@@ -1133,11 +1263,21 @@ dl_error_t duckLisp_emit_releaseUpvalues(duckLisp_t *duckLisp,
 dl_error_t duckLisp_emit_ccall(duckLisp_t *duckLisp,
                                duckLisp_compileState_t *compileState,
                                dl_array_t *assembly,
-                               dl_ptrdiff_t callback_index) {
-	duckLisp_instructionArgClass_t argument = {0};
-	argument.type = duckLisp_instructionArgClass_type_integer;
-	argument.value.integer = callback_index;
-	return duckLisp_emit_unaryOperator(duckLisp, compileState, assembly, duckLisp_instructionClass_ccall, argument);
+                               dl_ptrdiff_t callback_index,
+                               dl_uint8_t arity) {
+	duckLisp_instructionArgClass_t argument0 = {0};
+	duckLisp_instructionArgClass_t argument1 = {0};
+	argument0.type = duckLisp_instructionArgClass_type_integer;
+	argument0.value.integer = callback_index;
+	/* The VM doesn't need the arity, but the bytecode verifier can't track the stack across the call without it. */
+	argument1.type = duckLisp_instructionArgClass_type_integer;
+	argument1.value.integer = arity;
+	return duckLisp_emit_binaryOperator(duckLisp,
+	                                    compileState,
+	                                    assembly,
+	                                    duckLisp_instructionClass_ccall,
+	                                    argument0,
+	                                    argument1);
 }
 
 dl_error_t duckLisp_emit_pushIndex(duckLisp_t *duckLisp,
@@ -265,6 +265,66 @@ dl_error_t duckLisp_emit_sub(duckLisp_t *duckLisp,
                              const dl_ptrdiff_t source_index1,
                              const dl_ptrdiff_t source_index2);
 
+dl_error_t duckLisp_emit_addInt(duckLisp_t *duckLisp,
+                                duckLisp_compileState_t *compileState,
+                                dl_array_t *assembly,
+                                const dl_ptrdiff_t source_index1,
+                                const dl_ptrdiff_t source_index2);
+
+dl_error_t duckLisp_emit_addFloat(duckLisp_t *duckLisp,
+                                  duckLisp_compileState_t *compileState,
+                                  dl_array_t *assembly,
+                                  const dl_ptrdiff_t source_index1,
+                                  const dl_ptrdiff_t source_index2);
+
+dl_error_t duckLisp_emit_subInt(duckLisp_t *duckLisp,
+                                duckLisp_compileState_t *compileState,
+                                dl_array_t *assembly,
+                                const dl_ptrdiff_t source_index1,
+                                const dl_ptrdiff_t source_index2);
+
+dl_error_t duckLisp_emit_subFloat(duckLisp_t *duckLisp,
+                                  duckLisp_compileState_t *compileState,
+                                  dl_array_t *assembly,
+                                  const dl_ptrdiff_t source_index1,
+                                  const dl_ptrdiff_t source_index2);
+
+dl_error_t duckLisp_emit_mulInt(duckLisp_t *duckLisp,
+                                duckLisp_compileState_t *compileState,
+                                dl_array_t *assembly,
+                                const dl_ptrdiff_t source_index1,
+                                const dl_ptrdiff_t source_index2);
+
+dl_error_t duckLisp_emit_mulFloat(duckLisp_t *duckLisp,
+                                  duckLisp_compileState_t *compileState,
+                                  dl_array_t *assembly,
+                                  const dl_ptrdiff_t source_index1,
+                                  const dl_ptrdiff_t source_index2);
+
+dl_error_t duckLisp_emit_lessInt(duckLisp_t *duckLisp,
+                                 duckLisp_compileState_t *compileState,
+                                 dl_array_t *assembly,
+                                 const dl_ptrdiff_t source_index1,
+                                 const dl_ptrdiff_t source_index2);
+
+dl_error_t duckLisp_emit_lessFloat(duckLisp_t *duckLisp,
+                                   duckLisp_compileState_t *compileState,
+                                   dl_array_t *assembly,
+                                   const dl_ptrdiff_t source_index1,
+                                   const dl_ptrdiff_t source_index2);
+
+dl_error_t duckLisp_emit_greaterInt(duckLisp_t *duckLisp,
+                                    duckLisp_compileState_t *compileState,
+                                    dl_array_t *assembly,
+                                    const dl_ptrdiff_t source_index1,
+                                    const dl_ptrdiff_t source_index2);
+
+dl_error_t duckLisp_emit_greaterFloat(duckLisp_t *duckLisp,
+                                      duckLisp_compileState_t *compileState,
+                                      dl_array_t *assembly,
+                                      const dl_ptrdiff_t source_index1,
+                                      const dl_ptrdiff_t source_index2);
+
 dl_error_t duckLisp_emit_nop(duckLisp_t *duckLisp, duckLisp_compileState_t *compileState, dl_array_t *assembly);
 
 dl_error_t duckLisp_emit_setStatic(duckLisp_t *duckLisp,
@@ -336,7 +396,8 @@ dl_error_t duckLisp_emit_releaseUpvalues(duckLisp_t *duckLisp,
 dl_error_t duckLisp_emit_ccall(duckLisp_t *duckLisp,
                                duckLisp_compileState_t *compileState,
                                dl_array_t *assembly,
-                               dl_ptrdiff_t callback_index);
+                               dl_ptrdiff_t callback_index,
+                               dl_uint8_t arity);
 
 dl_error_t duckLisp_emit_pushIndex(duckLisp_t *duckLisp,
                                    duckLisp_compileState_t *compileState,
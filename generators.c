@@ -147,6 +147,139 @@ dl_error_t duckLisp_generator_binaryArithmeticOperator(duckLisp_t *duckLisp,
 	return e;
 }
 
+/* Guess the type of the value an expression evaluates to. Only literals, local variables, and arithmetic on those are
+   understood. Everything else is unknown. */
+duckLisp_valueType_t duckLisp_generator_inferType(duckLisp_t *duckLisp,
+                                                  duckLisp_compileState_t *compileState,
+                                                  duckLisp_ast_compoundExpression_t *compoundExpression) {
+	duckLisp_ast_expression_t *expression = dl_null;
+	duckLisp_ast_identifier_t *name = dl_null;
+	duckLisp_functionType_t functionType = duckLisp_functionType_none;
+	dl_ptrdiff_t functionIndex = -1;
+	dl_error_t (*generator)(duckLisp_t*, duckLisp_compileState_t*, dl_array_t*, duckLisp_ast_expression_t*);
+	duckLisp_valueType_t type1;
+	duckLisp_valueType_t type2;
+
+	switch (compoundExpression->type) {
+	case duckLisp_ast_type_int:
+		return duckLisp_valueType_integer;
+	case duckLisp_ast_type_float:
+		return duckLisp_valueType_float;
+	case duckLisp_ast_type_identifier:
+		return duckLisp_scope_getLocalType(compileState->currentCompileState,
+		                                   compoundExpression->value.identifier.value,
+		                                   compoundExpression->value.identifier.value_length);
+	case duckLisp_ast_type_expression:
+		break;
+	default:
+		return duckLisp_valueType_unknown;
+	}
+
+	expression = &compoundExpression->value.expression;
+	if ((expression->compoundExpressions_length != 3)
+	    || (expression->compoundExpressions[0].type != duckLisp_ast_type_identifier)) {
+		return duckLisp_valueType_unknown;
+	}
+	name = &expression->compoundExpressions[0].value.identifier;
+	if (duckLisp_scope_getFunctionFromName(duckLisp,
+	                                       compileState->currentCompileState,
+	                                       &functionType,
+	                                       &functionIndex,
+	                                       name->value,
+	                                       name->value_length)
+	    || (functionType != duckLisp_functionType_generator)
+	    || dl_array_get(&duckLisp->generators_stack, &generator, functionIndex)) {
+		return duckLisp_valueType_unknown;
+	}
+	if ((generator != duckLisp_generator_add)
+	    && (generator != duckLisp_generator_sub)
+	    && (generator != duckLisp_generator_multiply)) {
+		return duckLisp_valueType_unknown;
+	}
+
+	type1 = duckLisp_generator_inferType(duckLisp, compileState, &expression->compoundExpressions[1]);
+	type2 = duckLisp_generator_inferType(duckLisp, compileState, &expression->compoundExpressions[2]);
+	if ((type1 == duckLisp_valueType_unknown) || (type2 == duckLisp_valueType_unknown)) {
+		return duckLisp_valueType_unknown;
+	}
+	/* Mixing integers and floats produces a float. */
+	if ((type1 == duckLisp_valueType_float) || (type2 == duckLisp_valueType_float)) {
+		return duckLisp_valueType_float;
+	}
+	return duckLisp_valueType_integer;
+}
+
+/* Same as `duckLisp_generator_binaryArithmeticOperator`, but if both operands are known to be integers or known to be
+   floats, the specialized instruction is emitted instead. */
+dl_error_t duckLisp_generator_typedArithmeticOperator(duckLisp_t *duckLisp,
+                                                      duckLisp_compileState_t *compileState,
+                                                      dl_array_t *assembly,
+                                                      duckLisp_ast_expression_t *expression,
+                                                      dl_error_t (*emitter)(duckLisp_t *,
+                                                                            duckLisp_compileState_t *,
+                                                                            dl_array_t *,
+                                                                            dl_ptrdiff_t,
+                                                                            dl_ptrdiff_t),
+                                                      dl_error_t (*integerEmitter)(duckLisp_t *,
+                                                                                   duckLisp_compileState_t *,
+                                                                                   dl_array_t *,
+                                                                                   dl_ptrdiff_t,
+                                                                                   dl_ptrdiff_t),
+                                                      dl_error_t (*floatEmitter)(duckLisp_t *,
+                                                                                 duckLisp_compileState_t *,
+                                                                                 dl_array_t *,
+                                                                                 dl_ptrdiff_t,
+                                                                                 dl_ptrdiff_t)) {
+	dl_error_t e = dl_error_ok;
+
+	dl_ptrdiff_t destination_index;
+	dl_ptrdiff_t source_index;
+	duckLisp_valueType_t destination_type = duckLisp_valueType_unknown;
+	duckLisp_valueType_t source_type = duckLisp_valueType_unknown;
+
+	e = duckLisp_checkArgsAndReportError(duckLisp, *expression, 3, dl_false);
+	if (e) goto cleanup;
+
+#ifndef NO_OPTIMIZE_TYPES
+	/* Guess the types before compiling, since the operands might assign to the variables they use. The guess doesn't
+	   have to be right. The VM checks. */
+	destination_type = duckLisp_generator_inferType(duckLisp, compileState, &expression->compoundExpressions[1]);
+	source_type = duckLisp_generator_inferType(duckLisp, compileState, &expression->compoundExpressions[2]);
+#endif /* NO_OPTIMIZE_TYPES */
+
+	e = duckLisp_compile_compoundExpression(duckLisp,
+	                                        compileState,
+	                                        assembly,
+	                                        expression->compoundExpressions[0].value.identifier.value,
+	                                        expression->compoundExpressions[0].value.identifier.value_length,
+	                                        &expression->compoundExpressions[1],
+	                                        &destination_index,
+	                                        dl_null,
+	                                        dl_false);
+	if (e) goto cleanup;
+
+	e = duckLisp_compile_compoundExpression(duckLisp,
+	                                        compileState,
+	                                        assembly,
+	                                        expression->compoundExpressions[0].value.identifier.value,
+	                                        expression->compoundExpressions[0].value.identifier.value_length,
+	                                        &expression->compoundExpressions[2],
+	                                        &source_index,
+	                                        dl_null,
+	                                        dl_false);
+	if (e) goto cleanup;
+
+	if (destination_type == source_type) {
+		if (destination_type == duckLisp_valueType_integer) emitter = integerEmitter;
+		else if (destination_type == duckLisp_valueType_float) emitter = floatEmitter;
+	}
+	e = emitter(duckLisp, compileState, assembly, destination_index, source_index);
+	if (e) goto cleanup;
+
+ cleanup:
+	return e;
+}
+
 dl_error_t duckLisp_generator_ternaryArithmeticOperator(duckLisp_t *duckLisp,
                                                         duckLisp_compileState_t *compileState,
                                                         dl_array_t *assembly,
@@ -671,7 +804,9 @@ dl_error_t duckLisp_generator_quote_helper(duckLisp_t *duckLisp,
 			                   duckLisp->symbols_array.elements_length);
 			if (e) goto cleanup;
 			tempIdentifier.value_length = tree->value.identifier.value_length;
-			e = dl_malloc(duckLisp->memoryAllocation, (void **) &tempIdentifier.value, tempIdentifier.value_length);
+			e = dl_malloc(duckLisp->persistentMemoryAllocation,
+			              (void **) &tempIdentifier.value,
+			              tempIdentifier.value_length);
 			if (e) goto cleanup;
 			/**/ dl_memcopy_noOverlap(tempIdentifier.value, tree->value.identifier.value, tempIdentifier.value_length);
 			e = dl_array_pushElement(&duckLisp->symbols_array, (void *) &tempIdentifier);
@@ -802,7 +937,9 @@ dl_error_t duckLisp_generator_quote(duckLisp_t *duckLisp,
 			                   duckLisp->symbols_array.elements_length);
 			if (e) goto cleanup;
 			tempIdentifier.value_length = tree->value.identifier.value_length;
-			e = dl_malloc(duckLisp->memoryAllocation, (void **) &tempIdentifier.value, tempIdentifier.value_length);
+			e = dl_malloc(duckLisp->persistentMemoryAllocation,
+			              (void **) &tempIdentifier.value,
+			              tempIdentifier.value_length);
 			if (e) goto cleanup;
 			/**/ dl_memcopy_noOverlap(tempIdentifier.value, tree->value.identifier.value, tempIdentifier.value_length);
 			e = dl_array_pushElement(&duckLisp->symbols_array, (void *) &tempIdentifier);
@@ -1254,8 +1391,14 @@ dl_error_t duckLisp_generator_comptime(duckLisp_t *duckLisp,
 		/* Save disassembly. */
 		if (duckLisp->disassemble) {
 			dl_array_t string;
-			(void) dl_array_init(&string, duckLisp->memoryAllocation, sizeof(dl_uint8_t), dl_array_strategy_double);
-			e = duckLisp_disassemble(&string, duckLisp->memoryAllocation, bytecode.elements, bytecode.elements_length);
+			(void) dl_array_init(&string,
+			                     duckLisp->persistentMemoryAllocation,
+			                     sizeof(dl_uint8_t),
+			                     dl_array_strategy_double);
+			e = duckLisp_disassemble(&string,
+			                         duckLisp->persistentMemoryAllocation,
+			                         bytecode.elements,
+			                         bytecode.elements_length);
 			if (e) goto cleanup;
 			e = dl_array_pushElement(&duckLisp->disassemblies, &string);
 			if (e) goto cleanup;
@@ -1376,9 +1519,12 @@ dl_error_t duckLisp_generator_defmacro(duckLisp_t *duckLisp,
 	/* Save disassembly. */
 	if (duckLisp->disassemble) {
 		dl_array_t string;
-		(void) dl_array_init(&string, duckLisp->memoryAllocation, sizeof(dl_uint8_t), dl_array_strategy_double);
+		(void) dl_array_init(&string,
+		                     duckLisp->persistentMemoryAllocation,
+		                     sizeof(dl_uint8_t),
+		                     dl_array_strategy_double);
 		e = duckLisp_disassemble(&string,
-		                         duckLisp->memoryAllocation,
+		                         duckLisp->persistentMemoryAllocation,
 		                         macroBytecode.elements,
 		                         macroBytecode.elements_length);
 		if (e) goto cleanup;
@@ -1749,6 +1895,7 @@ dl_error_t duckLisp_generator_createVar_raw(duckLisp_t *duckLisp,
 	/* Insert arg1 into this scope's name trie. */
 	/* This is not actually where stack variables are allocated. The magic happens in
 	   `duckLisp_generator_expression`. */
+	duckLisp_valueType_t type = duckLisp_generator_inferType(duckLisp, compileState, &expression->compoundExpressions[2]);
 	dl_size_t startLocals_length = duckLisp_localsLength_get(compileState);
 	e = duckLisp_compile_compoundExpression(duckLisp,
 	                                        compileState,
@@ -1767,6 +1914,11 @@ dl_error_t duckLisp_generator_createVar_raw(duckLisp_t *duckLisp,
 	                             expression->compoundExpressions[1].value.identifier.value,
 	                             expression->compoundExpressions[1].value.identifier.value_length);
 	if (e) goto cleanup;
+	e = duckLisp_scope_setLocalType(compileState->currentCompileState,
+	                                expression->compoundExpressions[1].value.identifier.value,
+	                                expression->compoundExpressions[1].value.identifier.value_length,
+	                                type);
+	if (e) goto cleanup;
 	compileState->currentCompileState->locals_length = endLocals_length;
 
 	e = duckLisp_emit_move(duckLisp, compileState, assembly, startStack_length, duckLisp_localsLength_get(compileState) - 1);
@@ -2019,11 +2171,13 @@ dl_error_t duckLisp_generator_multiply(duckLisp_t *duckLisp,
                                        duckLisp_compileState_t *compileState,
                                        dl_array_t *assembly,
                                        duckLisp_ast_expression_t *expression) {
-	return duckLisp_generator_binaryArithmeticOperator(duckLisp,
-	                                                   compileState,
-	                                                   assembly,
-	                                                   expression,
-	                                                   duckLisp_emit_multiply);
+	return duckLisp_generator_typedArithmeticOperator(duckLisp,
+	                                                  compileState,
+	                                                  assembly,
+	                                                  expression,
+	                                                  duckLisp_emit_multiply,
+	                                                  duckLisp_emit_mulInt,
+	                                                  duckLisp_emit_mulFloat);
 }
 
 dl_error_t duckLisp_generator_divide(duckLisp_t *duckLisp,
@@ -2041,22 +2195,26 @@ dl_error_t duckLisp_generator_add(duckLisp_t *duckLisp,
                                   duckLisp_compileState_t *compileState,
                                   dl_array_t *assembly,
                                   duckLisp_ast_expression_t *expression) {
-	return duckLisp_generator_binaryArithmeticOperator(duckLisp,
-	                                                   compileState,
-	                                                   assembly,
-	                                                   expression,
-	                                                   duckLisp_emit_add);
+	return duckLisp_generator_typedArithmeticOperator(duckLisp,
+	                                                  compileState,
+	                                                  assembly,
+	                                                  expression,
+	                                                  duckLisp_emit_add,
+	                                                  duckLisp_emit_addInt,
+	                                                  duckLisp_emit_addFloat);
 }
 
 dl_error_t duckLisp_generator_sub(duckLisp_t *duckLisp,
                                   duckLisp_compileState_t *compileState,
                                   dl_array_t *assembly,
                                   duckLisp_ast_expression_t *expression) {
-	return duckLisp_generator_binaryArithmeticOperator(duckLisp,
-	                                                   compileState,
-	                                                   assembly,
-	                                                   expression,
-	                                                   duckLisp_emit_sub);
+	return duckLisp_generator_typedArithmeticOperator(duckLisp,
+	                                                  compileState,
+	                                                  assembly,
+	                                                  expression,
+	                                                  duckLisp_emit_sub,
+	                                                  duckLisp_emit_subInt,
+	                                                  duckLisp_emit_subFloat);
 }
 
 dl_error_t duckLisp_generator_equal(duckLisp_t *duckLisp,
@@ -2074,22 +2232,26 @@ dl_error_t duckLisp_generator_greater(duckLisp_t *duckLisp,
                                       duckLisp_compileState_t *compileState,
                                       dl_array_t *assembly,
                                       duckLisp_ast_expression_t *expression) {
-	return duckLisp_generator_binaryArithmeticOperator(duckLisp,
-	                                                   compileState,
-	                                                   assembly,
-	                                                   expression,
-	                                                   duckLisp_emit_greater);
+	return duckLisp_generator_typedArithmeticOperator(duckLisp,
+	                                                  compileState,
+	                                                  assembly,
+	                                                  expression,
+	                                                  duckLisp_emit_greater,
+	                                                  duckLisp_emit_greaterInt,
+	                                                  duckLisp_emit_greaterFloat);
 }
 
 dl_error_t duckLisp_generator_less(duckLisp_t *duckLisp,
                                    duckLisp_compileState_t *compileState,
                                    dl_array_t *assembly,
                                    duckLisp_ast_expression_t *expression) {
-	return duckLisp_generator_binaryArithmeticOperator(duckLisp,
-	                                                   compileState,
-	                                                   assembly,
-	                                                   expression,
-	                                                   duckLisp_emit_less);
+	return duckLisp_generator_typedArithmeticOperator(duckLisp,
+	                                                  compileState,
+	                                                  assembly,
+	                                                  expression,
+	                                                  duckLisp_emit_less,
+	                                                  duckLisp_emit_lessInt,
+	                                                  duckLisp_emit_lessFloat);
 }
 
 dl_error_t duckLisp_generator_while(duckLisp_t *duckLisp,
@@ -2928,6 +3090,7 @@ dl_error_t duckLisp_generator_setq(duckLisp_t *duckLisp,
 
 	dl_ptrdiff_t identifier_index = -1;
 	dl_ptrdiff_t index = -1;
+	duckLisp_valueType_t type = duckLisp_valueType_unknown;
 
 	/* Check arguments for call and type errors. */
 
@@ -2949,6 +3112,20 @@ dl_error_t duckLisp_generator_setq(duckLisp_t *duckLisp,
 		goto cleanup;
 	}
 
+	/* The variable keeps its type only if it's assigned a value of the same type. This doesn't help code that was
+	   already compiled assuming the old type, like the test of a loop, but the VM catches those. */
+	type = duckLisp_generator_inferType(duckLisp, compileState, &expression->compoundExpressions[2]);
+	if (type != duckLisp_scope_getLocalType(compileState->currentCompileState,
+	                                        expression->compoundExpressions[1].value.identifier.value,
+	                                        expression->compoundExpressions[1].value.identifier.value_length)) {
+		type = duckLisp_valueType_unknown;
+	}
+	e = duckLisp_scope_setLocalType(compileState->currentCompileState,
+	                                expression->compoundExpressions[1].value.identifier.value,
+	                                expression->compoundExpressions[1].value.identifier.value_length,
+	                                type);
+	if (e) goto cleanup;
+
 	e = duckLisp_compile_compoundExpression(duckLisp,
 	                                        compileState,
 	                                        assembly,
@@ -3526,7 +3703,11 @@ dl_error_t duckLisp_generator_callback(duckLisp_t *duckLisp,
 	}
 
 	/* Create the string variable. */
-	e = duckLisp_emit_ccall(duckLisp, compileState, assembly, callback_key);
+	e = duckLisp_emit_ccall(duckLisp,
+	                        compileState,
+	                        assembly,
+	                        callback_key,
+	                        expression->compoundExpressions_length - 1);
 	if (e) goto cleanup;
 
 	compileState->currentCompileState->locals_length = outerStartStack_length + 1;
@@ -3665,8 +3846,14 @@ dl_error_t duckLisp_generator_macro(duckLisp_t *duckLisp,
 	/* Save disassembly. */
 	if (duckLisp->disassemble) {
 		dl_array_t string;
-		(void) dl_array_init(&string, duckLisp->memoryAllocation, sizeof(dl_uint8_t), dl_array_strategy_double);
-		e = duckLisp_disassemble(&string, duckLisp->memoryAllocation, bytecode.elements, bytecode.elements_length);
+		(void) dl_array_init(&string,
+		                     duckLisp->persistentMemoryAllocation,
+		                     sizeof(dl_uint8_t),
+		                     dl_array_strategy_double);
+		e = duckLisp_disassemble(&string,
+		                         duckLisp->persistentMemoryAllocation,
+		                         bytecode.elements,
+		                         bytecode.elements_length);
 		if (e) goto cleanupArrays;
 		e = dl_array_pushElement(&duckLisp->disassemblies, &string);
 		if (e) goto cleanupArrays;
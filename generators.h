@@ -54,6 +54,30 @@ dl_error_t duckLisp_generator_binaryArithmeticOperator(duckLisp_t *duckLisp,
                                                                              dl_ptrdiff_t,
                                                                              dl_ptrdiff_t));
 
+duckLisp_valueType_t duckLisp_generator_inferType(duckLisp_t *duckLisp,
+                                                  duckLisp_compileState_t *compileState,
+                                                  duckLisp_ast_compoundExpression_t *compoundExpression);
+
+dl_error_t duckLisp_generator_typedArithmeticOperator(duckLisp_t *duckLisp,
+                                                      duckLisp_compileState_t *compileState,
+                                                      dl_array_t *assembly,
+                                                      duckLisp_ast_expression_t *expression,
+                                                      dl_error_t (*emitter)(duckLisp_t *,
+                                                                            duckLisp_compileState_t *,
+                                                                            dl_array_t *,
+                                                                            dl_ptrdiff_t,
+                                                                            dl_ptrdiff_t),
+                                                      dl_error_t (*integerEmitter)(duckLisp_t *,
+                                                                                   duckLisp_compileState_t *,
+                                                                                   dl_array_t *,
+                                                                                   dl_ptrdiff_t,
+                                                                                   dl_ptrdiff_t),
+                                                      dl_error_t (*floatEmitter)(duckLisp_t *,
+                                                                                 duckLisp_compileState_t *,
+                                                                                 dl_array_t *,
+                                                                                 dl_ptrdiff_t,
+                                                                                 dl_ptrdiff_t));
+
 dl_error_t duckLisp_generator_ternaryArithmeticOperator(duckLisp_t *duckLisp,
                                                         duckLisp_compileState_t *compileState,
                                                         dl_array_t *assembly,
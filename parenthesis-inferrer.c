@@ -343,6 +343,8 @@ static dl_error_t inferrerScope_prettyPrint(dl_array_t *string_array, inferrerSc
 
 typedef struct {
 	dl_memoryAllocation_t *memoryAllocation;
+	/* Nodes that end up in the AST being inferred */
+	dl_memoryAllocation_t *astMemoryAllocation;
 	duckLisp_t duckLisp;
 	duckVM_t duckVM;
 	dl_array_t *errors;  /* dl_array_t:duckLisp_error_t */
@@ -873,6 +875,7 @@ static dl_error_t inferrerScope_quit(inferrerScope_t *inferrerScope, dl_memoryAl
 
 static dl_error_t inferrerState_init(inferrerState_t *inferrerState,
                                      dl_memoryAllocation_t *memoryAllocation,
+                                     dl_memoryAllocation_t *astMemoryAllocation,
                                      dl_size_t maxComptimeVmObjects,
                                      dl_array_t *errors,
                                      dl_array_t *log,
@@ -888,6 +891,7 @@ static dl_error_t inferrerState_init(inferrerState_t *inferrerState,
 	                     sizeof(vmContext_t),
 	                     dl_array_strategy_double);
 	inferrerState->memoryAllocation = memoryAllocation;
+	inferrerState->astMemoryAllocation = astMemoryAllocation;
 	e = duckLisp_init(&inferrerState->duckLisp, memoryAllocation, maxComptimeVmObjects, maxComptimeVmObjects);
 	if (e) goto cleanup;
 	e = duckVM_init(&inferrerState->duckVM, memoryAllocation, maxComptimeVmObjects);
@@ -929,6 +933,7 @@ static dl_error_t inferrerState_quit(inferrerState_t *inferrerState) {
 	(void) duckVM_quit(&inferrerState->duckVM);
 	(void) duckLisp_quit(&inferrerState->duckLisp);
 	inferrerState->memoryAllocation = dl_null;
+	inferrerState->astMemoryAllocation = dl_null;
 	return e;
 }
 
@@ -1367,7 +1372,7 @@ static dl_error_t inferArgument(inferrerState_t *state,
 			if (type.type.type == inferrerTypeSignature_type_expression) {
 				dl_array_t newExpression;  /* dl_array_t:duckLisp_ast_compoundExpression_t */
 				(void) dl_array_init(&newExpression,
-				                     state->memoryAllocation,
+				                     state->astMemoryAllocation,
 				                     sizeof(duckLisp_ast_compoundExpression_t),
 				                     dl_array_strategy_double);
 				if (!parenthesized) {
@@ -1930,6 +1935,7 @@ static dl_error_t generator_declarationScope(duckLisp_t *duckLisp,
 
 
 dl_error_t duckLisp_inferParentheses(dl_memoryAllocation_t *memoryAllocation,
+                                     dl_memoryAllocation_t *astMemoryAllocation,
                                      const dl_size_t maxComptimeVmObjects,
                                      dl_array_t *errors,
                                      dl_array_t *log,
@@ -1941,7 +1947,14 @@ dl_error_t duckLisp_inferParentheses(dl_memoryAllocation_t *memoryAllocation,
 	dl_error_t eError = dl_error_ok;
 
 	inferrerState_t state;
-	e = inferrerState_init(&state, memoryAllocation, maxComptimeVmObjects, errors, log, fileName, fileName_length);
+	e = inferrerState_init(&state,
+	                       memoryAllocation,
+	                       astMemoryAllocation,
+	                       maxComptimeVmObjects,
+	                       errors,
+	                       log,
+	                       fileName,
+	                       fileName_length);
 	if (e) return e;
 
 	struct {
@@ -39,7 +39,10 @@ typedef struct {
 dl_error_t duckLisp_parenthesisInferrer_declarationPrototype_prettyPrint(dl_array_t *string_array,
                                                                          duckLisp_parenthesisInferrer_declarationPrototype_t declarationPrototype);
 
+/* The inferrer's compiler and VM allocate from `memoryAllocation`, and they are gone by the time this returns. New nodes
+   in `ast` come from `astMemoryAllocation`, which should be whatever the rest of the AST was allocated from. */
 dl_error_t duckLisp_inferParentheses(dl_memoryAllocation_t *memoryAllocation,
+                                     dl_memoryAllocation_t *astMemoryAllocation,
                                      const dl_size_t maxComptimeVmObjects,
                                      dl_array_t *errors,
                                      dl_array_t *log,
@@ -36,7 +36,7 @@ static dl_error_t duckLisp_error_pushSyntax(duckLisp_t *duckLisp,
                                             const dl_size_t fileName_length,
                                             const dl_uint8_t *source,
                                             const dl_size_t source_length,
-                                            const dl_ptrdiff_t start_index,
+                                            dl_ptrdiff_t start_index,
                                             const dl_ptrdiff_t end_index,
                                             const dl_bool_t throwErrors) {
 	dl_error_t e = dl_error_ok;
@@ -53,6 +53,9 @@ static dl_error_t duckLisp_error_pushSyntax(duckLisp_t *duckLisp,
 		if (e) goto cleanup;
 	}
 
+	/* A negative index means the error is at the end of the source, like an unmatched parenthesis. */
+	if (start_index < 0) start_index = source_length;
+
 	/* This is inefficient. That should be OK as this is only run a few times max per compile. */
 	DL_DOTIMES(i, start_index) {
 		if (source[i] == '\n') {
@@ -155,7 +158,7 @@ static dl_error_t parse_comment(duckLisp_t *duckLisp,
 	dl_ptrdiff_t start_index = *index;
 	dl_ptrdiff_t stop_index = start_index;
 
-	if (source[stop_index] != ';') {
+	if ((stop_index >= (dl_ptrdiff_t) source_length) || (source[stop_index] != ';')) {
 		return dl_error_invalidValue;
 	}
 
@@ -182,7 +185,7 @@ dl_error_t parse_irrelevant(duckLisp_t *duckLisp,
 		if (indexCopy >= (dl_ptrdiff_t) source_length) {
 			return dl_error_invalidValue;
 		}
-		while (dl_string_isSpace(source[indexCopy])) indexCopy++;
+		while ((indexCopy < (dl_ptrdiff_t) source_length) && dl_string_isSpace(source[indexCopy])) indexCopy++;
 		dl_error_t e = parse_comment(dl_null, source, source_length, dl_null, &indexCopy, dl_false);
 		if (e) break;
 	}
@@ -850,7 +853,7 @@ static dl_error_t parse_int(duckLisp_t *duckLisp,
 			indexCopy++;
 			hexadecimal = dl_true;
 
-			if (!dl_string_isHexadecimalDigit(source[indexCopy])) {
+			if ((indexCopy >= (dl_ptrdiff_t) source_length) || !dl_string_isHexadecimalDigit(source[indexCopy])) {
 				eError = duckLisp_error_pushSyntax(duckLisp,
 				                                   DL_STR("Expected a digit in integer."),
 				                                   fileName,
@@ -1043,7 +1046,7 @@ static dl_error_t parse_float(duckLisp_t *duckLisp,
 			indexCopy++;
 		}
 
-		if (source[indexCopy] == '.') {
+		if ((indexCopy < (dl_ptrdiff_t) source_length) && (source[indexCopy] == '.')) {
 			hasDecimalPointOrExponent = dl_true;
 			indexCopy++;
 
@@ -1064,7 +1067,7 @@ static dl_error_t parse_float(duckLisp_t *duckLisp,
 	}
 
 	/* …e3 */
-	if (dl_string_toLower(source[indexCopy]) == 'e') {
+	if ((indexCopy < (dl_ptrdiff_t) source_length) && (dl_string_toLower(source[indexCopy]) == 'e')) {
 		hasDecimalPointOrExponent = dl_true;
 		indexCopy++;
 
@@ -1527,7 +1530,10 @@ dl_error_t duckLisp_read(duckLisp_t *duckLisp,
 
 #ifdef USE_PARENTHESIS_INFERENCE
 	if (parenthesisInferenceEnabled) {
-		e = duckLisp_inferParentheses(duckLisp->memoryAllocation,
+		/* The AST may be in the compile arena, but the inferrer builds a whole compiler and VM for itself. Those are
+		   freed before this returns, so they would only pile up in the arena. */
+		e = duckLisp_inferParentheses(duckLisp->persistentMemoryAllocation,
+		                              duckLisp->memoryAllocation,
 		                              maxComptimeVmObjects,
 		                              &duckLisp->errors,
 		                              &duckLisp->inferrerLog,
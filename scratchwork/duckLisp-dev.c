@@ -543,6 +543,62 @@ dl_error_t duckLispDev_callback_garbageCollect(duckVM_t *duckVM) {
 	return e;
 }
 
+/* Write a heap snapshot for `heap-analyzer` to a file. */
+dl_error_t duckLispDev_callback_dumpHeap(duckVM_t *duckVM) {
+	dl_error_t e = dl_error_ok;
+	dl_error_t eError = dl_error_ok;
+
+	duckVM_object_t fileName_object;
+	char *fileName = NULL;
+	dl_array_t snapshot;
+	FILE *file = NULL;
+
+	/**/ dl_array_init(&snapshot, duckVM->memoryAllocation, sizeof(dl_uint8_t), dl_array_strategy_double);
+
+	e = duckVM_object_pop(duckVM, &fileName_object);
+	if (e) goto cleanup;
+	if (fileName_object.type != duckVM_object_type_string) {
+		e = dl_error_invalidValue;
+		eError = duckVM_error_pushRuntime(duckVM,
+		                                  DL_STR("duckVM_execute->callback->dump-heap: Argument (file-name) must be a string."));
+		if (eError) e = eError;
+		goto cleanup;
+	}
+
+	fileName = malloc(sizeof(char)
+	                  * (fileName_object.value.string.internalString->value.internalString.value_length + 1));
+	if (fileName == NULL) {
+		e = dl_error_outOfMemory;
+		goto cleanup;
+	}
+	memcpy(fileName,
+	       fileName_object.value.string.internalString->value.internalString.value,
+	       fileName_object.value.string.internalString->value.internalString.value_length);
+	fileName[fileName_object.value.string.internalString->value.internalString.value_length] = '\0';
+
+	e = duckVM_dumpHeap(duckVM, &snapshot);
+	if (e) goto cleanup;
+
+	file = fopen(fileName, "wb");
+	if ((file == NULL)
+	    || (fwrite(snapshot.elements, 1, snapshot.elements_length, file) != snapshot.elements_length)) {
+		e = dl_error_invalidValue;
+		eError = duckVM_error_pushRuntime(duckVM,
+		                                  DL_STR("duckVM_execute->callback->dump-heap: Couldn't write the file."));
+		if (eError) e = eError;
+		goto cleanup;
+	}
+
+	e = duckVM_pushNil(duckVM);
+
+ cleanup:
+	if (file) /**/ fclose(file);
+	if (fileName) /**/ free(fileName);
+	eError = dl_array_quit(&snapshot);
+	if (eError) e = eError;
+	return e;
+}
+
 dl_error_t duckLispDev_callback_toggleAssembly(duckVM_t *duckVM) {
 	g_disassemble = !g_disassemble;
 	return duckVM_pushNil(duckVM);
@@ -1356,6 +1412,7 @@ int main(int argc, char *argv[]) {
 		{DL_STR("print"),           duckLispDev_callback_print,             DL_STR("(I)")},
 		{DL_STR("print-stack"),     duckLispDev_callback_printStack,        DL_STR("()")},
 		{DL_STR("garbage-collect"), duckLispDev_callback_garbageCollect,    DL_STR("()")},
+		{DL_STR("dump-heap"),       duckLispDev_callback_dumpHeap,          DL_STR("(I)")},
 		{DL_STR("disassemble"),     duckLispDev_callback_toggleAssembly,    DL_STR("()")},
 #ifdef USE_PARENTHESIS_INFERENCE
 		{DL_STR("inference"),       duckLispDev_callback_toggleHanabi,      DL_STR("()")},
@@ -415,19 +415,120 @@ void printErrors(dl_array_t errors) {
 	printf(COLOR_NORMAL);
 }
 
-dl_error_t runTest(const unsigned char *fileBaseName, dl_uint8_t *text, size_t text_length) {
+/* Tests pass by returning true. The return value is popped. */
+dl_error_t checkReturnValue(duckVM_t *duckVM) {
+	dl_error_t e = dl_error_ok;
+	duckVM_object_type_t objectType;
+
+	e = duckVM_typeOf(duckVM, &objectType);
+	if (e) goto cleanup;
+	if (objectType == duckVM_object_type_bool) {
+		dl_bool_t returnedBoolean;
+		e = duckVM_copyBoolean(duckVM, &returnedBoolean);
+		if (e) goto cleanup;
+		if (!returnedBoolean) {
+			e = dl_error_invalidValue;
+			puts(COLOR_YELLOW "Test returned \"fail\"" COLOR_NORMAL);
+		}
+	}
+	else {
+		e = dl_error_invalidValue;
+		printf(COLOR_YELLOW "Test didn't return a boolean. type: %i\n" COLOR_NORMAL, objectType);
+	}
+	if (e) goto cleanup;
+	/* Pop return value. */
+	e = duckVM_pop(duckVM);
+	if (e) goto cleanup;
+
+ cleanup:
+	return e;
+}
+
+/* No test recurses deeper than this without tail calls. The call stack never shrinks, so its size is the deepest the
+   test went. A tail call that pushes a frame instead of reusing one will blow through this. */
+#define MAX_CALL_DEPTH 1024
+
+dl_error_t checkCallDepth(duckVM_t *duckVM) {
+	dl_error_t e = dl_error_ok;
+#ifdef NO_OPTIMIZE_TAILCALLS
+	/* Every call pushes a frame. */
+	(void) duckVM;
+#else /* NO_OPTIMIZE_TAILCALLS */
+	dl_size_t depth = duckVM->call_stack.elements_memorySize / duckVM->call_stack.element_size;
+	if (depth > MAX_CALL_DEPTH) {
+		e = dl_error_invalidValue;
+		printf(COLOR_YELLOW "Call stack grew to %lu frames.\n" COLOR_NORMAL, (unsigned long) depth);
+	}
+#endif /* NO_OPTIMIZE_TAILCALLS */
+	return e;
+}
+
+/* Every object the VM allocated should either have been freed or still be in use. */
+dl_error_t checkGcStats(duckVM_t *duckVM) {
+	dl_error_t e = dl_error_ok;
+	dl_error_t eError = dl_error_ok;
+	duckVM_gcStats_t stats;
+	dl_size_t inUse = 0;
+	dl_array_t snapshot;
+	dl_size_t dumped = 0;
+
+	/**/ dl_array_init(&snapshot, duckVM->memoryAllocation, sizeof(dl_uint8_t), dl_array_strategy_double);
+
+	/* Finish sweeping so that no garbage is left. */
+	e = duckVM_garbageCollect(duckVM);
+	if (e) goto cleanup;
+	/**/ duckVM_getGcStats(duckVM, &stats);
+	DL_DOTIMES(i, duckVM_object_type_last) {
+		inUse += stats.objectsInUse[i];
+	}
+	if (stats.objectsAllocated - stats.objectsFreed != inUse) {
+		e = dl_error_invalidValue;
+		printf(COLOR_YELLOW "GC statistics don't add up. allocated: %lu freed: %lu in use: %lu\n" COLOR_NORMAL,
+		       (unsigned long) stats.objectsAllocated,
+		       (unsigned long) stats.objectsFreed,
+		       (unsigned long) inUse);
+		goto cleanup;
+	}
+
+	/* The heap dump should see the same objects. The object count follows the eight byte header. */
+	e = duckVM_dumpHeap(duckVM, &snapshot);
+	if (e) goto cleanup;
+	DL_DOTIMES(i, 8) {
+		dumped |= (dl_size_t) DL_ARRAY_GETADDRESS(snapshot, dl_uint8_t, 8 + i) << (8 * i);
+	}
+	if (dumped != inUse) {
+		e = dl_error_invalidValue;
+		printf(COLOR_YELLOW "Heap dump has %lu objects, but %lu are in use.\n" COLOR_NORMAL,
+		       (unsigned long) dumped,
+		       (unsigned long) inUse);
+	}
+
+ cleanup:
+	eError = dl_array_quit(&snapshot);
+	if (eError) e = eError;
+	return e;
+}
+
+dl_error_t runTest(const unsigned char *fileBaseName, dl_uint8_t *text, size_t text_length, bool inferParentheses) {
 	dl_error_t e = dl_error_ok;
 
 	const size_t duckLispMemory_size = 1024 * 1024;
 	const size_t duckVMMaxObjects = 1024;
 
 	void *memory = NULL;
-	dl_memoryAllocation_t ma;
+	dl_memoryAllocation_t ma = {0};
+#ifdef USE_THREADSAFE_MALLOC
+	dl_memoryAllocation_t shared = {0};
+#endif /* USE_THREADSAFE_MALLOC */
 	duckLisp_t duckLisp = {0};
 	unsigned char *bytecode = NULL;
 	dl_size_t bytecode_length;
 	duckVM_t duckVM = {0};
-	duckVM_object_type_t objectType;
+	duckVM_halt_mode_t status;
+
+#ifndef USE_PARENTHESIS_INFERENCE
+	(void) inferParentheses;
+#endif /* USE_PARENTHESIS_INFERENCE */
 
 	memory = malloc(duckLispMemory_size);
 	if (memory == NULL) {
@@ -436,7 +537,13 @@ dl_error_t runTest(const unsigned char *fileBaseName, dl_uint8_t *text, size_t t
 		goto cleanup;
 	}
 
+#ifdef USE_THREADSAFE_MALLOC
+	/* Allocate through a thread cache so that caches get tested too. */
+	e = dl_memory_init(&shared, memory, duckLispMemory_size, dl_memoryFit_segregated);
+	if (!e) e = dl_memory_initThreadCache(&ma, &shared);
+#else /* USE_THREADSAFE_MALLOC */
 	e = dl_memory_init(&ma, memory, duckLispMemory_size, dl_memoryFit_best);
+#endif /* USE_THREADSAFE_MALLOC */
 	if (e) {
 		puts(COLOR_YELLOW "Memory allocation initialization failed" COLOR_NORMAL);
 		goto cleanup;
@@ -447,7 +554,7 @@ dl_error_t runTest(const unsigned char *fileBaseName, dl_uint8_t *text, size_t t
 	                  duckVMMaxObjects
 #ifdef USE_PARENTHESIS_INFERENCE
 	                  ,
-	                  0
+	                  duckVMMaxObjects
 #endif /* USE_PARENTHESIS_INFERENCE */
 	                  );
 	if (e) {
@@ -457,7 +564,7 @@ dl_error_t runTest(const unsigned char *fileBaseName, dl_uint8_t *text, size_t t
 
 	e = duckLisp_loadString(&duckLisp,
 #ifdef USE_PARENTHESIS_INFERENCE
-	                        dl_false,
+	                        inferParentheses,
 #endif /* USE_PARENTHESIS_INFERENCE */
 	                        &bytecode,
 	                        &bytecode_length,
@@ -488,27 +595,48 @@ dl_error_t runTest(const unsigned char *fileBaseName, dl_uint8_t *text, size_t t
 		goto cleanup;
 	}
 
-	e = duckVM_typeOf(&duckVM, &objectType);
+	e = checkReturnValue(&duckVM);
 	if (e) goto cleanup;
-	if (objectType == duckVM_object_type_bool) {
-		dl_bool_t returnedBoolean;
-		e = duckVM_copyBoolean(&duckVM, &returnedBoolean);
-		if (e) goto cleanup;
-		if (returnedBoolean) {
-			printf(COLOR_GREEN "PASS" COLOR_NORMAL " %s\n" , fileBaseName);
-		}
-		else {
-			e = dl_error_invalidValue;
-			puts(COLOR_YELLOW "Test returned \"fail\"" COLOR_NORMAL);
+	e = checkGcStats(&duckVM);
+	if (e) goto cleanup;
+	e = checkCallDepth(&duckVM);
+	if (e) goto cleanup;
+
+	/* Run it again a few instructions at a time in a fresh VM. Suspending shouldn't change the result. Neither should
+	   marking a few objects at a time, or moving objects around while the VM is suspended. */
+	duckVM_quit(&duckVM);
+	e = duckVM_init(&duckVM, &ma, duckVMMaxObjects);
+	if (e) {
+		puts(COLOR_YELLOW "VM initialization failed" COLOR_NORMAL);
+		goto cleanup;
+	}
+	e = duckVM_setIncrementalMarking(&duckVM, 4);
+	if (e) goto cleanup;
+
+	e = duckVM_executeWithBudget(&duckVM, bytecode, bytecode_length, 3, &status);
+	for (dl_size_t slices = 1; !e && (status == duckVM_halt_mode_yield); slices++) {
+		if (slices % 64 == 0) {
+			e = duckVM_compact(&duckVM);
+			if (e) break;
 		}
+		e = duckVM_resume(&duckVM, 3, &status);
 	}
-	else {
-		e = dl_error_invalidValue;
-		printf(COLOR_YELLOW "Test didn't return a boolean. type: %i\n" COLOR_NORMAL, objectType);
+	if (e) {
+		puts(COLOR_YELLOW "Budgeted execution failed" COLOR_NORMAL);
+
+		printErrors(duckVM.errors);
+
+		goto cleanup;
 	}
-	/* Pop return value. */
-	e = duckVM_pop(&duckVM);
+
+	e = checkReturnValue(&duckVM);
+	if (e) goto cleanup;
+	e = checkGcStats(&duckVM);
 	if (e) goto cleanup;
+	e = checkCallDepth(&duckVM);
+	if (e) goto cleanup;
+
+	printf(COLOR_GREEN "PASS" COLOR_NORMAL " %s\n" , fileBaseName);
 
  cleanup:
 
@@ -521,14 +649,87 @@ dl_error_t runTest(const unsigned char *fileBaseName, dl_uint8_t *text, size_t t
 		printf(COLOR_RED "FAIL" COLOR_NORMAL " %s\n", fileBaseName);
 	}
 
-	(void) duckVM_quit(&duckVM);
+	duckVM_quit(&duckVM);
 	(void) duckLisp_quit(&duckLisp);
+#ifdef USE_THREADSAFE_MALLOC
+	/**/ dl_memory_quitThreadCache(&ma);
+	(void) dl_memory_quit(&shared);
+#else /* USE_THREADSAFE_MALLOC */
 	(void) dl_memory_quit(&ma);
+#endif /* USE_THREADSAFE_MALLOC */
 	(void) free(memory);
 
 	return e;
 }
 
+#ifdef USE_DUCKLIB_MALLOC
+/* A string that doesn't fit in the VM's memory can't have its payload allocated. The VM shouldn't keep the half-made
+   object around, since it still points at the caller's string, and the collector would free that. */
+dl_error_t runPayloadFailureTest(void) {
+	dl_error_t e = dl_error_ok;
+
+	const char *testName = "payload-failure";
+	const size_t memory_size = 64 * 1024;
+	const size_t string_length = 2 * memory_size;
+
+	void *memory = NULL;
+	dl_uint8_t *string = NULL;
+	dl_memoryAllocation_t ma = {0};
+	duckVM_t duckVM = {0};
+	bool vmInitialized = false;
+	duckVM_gcStats_t stats;
+
+	memory = malloc(memory_size);
+	string = calloc(string_length, sizeof(dl_uint8_t));
+	if ((memory == NULL) || (string == NULL)) {
+		e = dl_error_outOfMemory;
+		perror("Test malloc failed");
+		goto cleanup;
+	}
+	e = dl_memory_init(&ma, memory, memory_size, dl_memoryFit_best);
+	if (e) {
+		puts(COLOR_YELLOW "Memory allocation initialization failed" COLOR_NORMAL);
+		goto cleanup;
+	}
+	e = duckVM_init(&duckVM, &ma, 64);
+	if (e) {
+		puts(COLOR_YELLOW "VM initialization failed" COLOR_NORMAL);
+		goto cleanup;
+	}
+	vmInitialized = true;
+
+	if (!duckVM_pushString(&duckVM, string, string_length)) {
+		e = dl_error_invalidValue;
+		puts(COLOR_YELLOW "Pushing a string bigger than the VM's memory succeeded" COLOR_NORMAL);
+		goto cleanup;
+	}
+	/* The collector would free the caller's string here if the object had been kept. */
+	e = duckVM_garbageCollect(&duckVM);
+	if (e) {
+		puts(COLOR_YELLOW "Garbage collection failed" COLOR_NORMAL);
+		goto cleanup;
+	}
+	duckVM_getGcStats(&duckVM, &stats);
+	if ((stats.objectsAllocated != 0) || (stats.objectsInUse[duckVM_object_type_internalString] != 0)) {
+		e = dl_error_invalidValue;
+		printf(COLOR_YELLOW "%lu objects were allocated, and %lu strings are in use.\n" COLOR_NORMAL,
+		       (unsigned long) stats.objectsAllocated,
+		       (unsigned long) stats.objectsInUse[duckVM_object_type_internalString]);
+		goto cleanup;
+	}
+
+	printf(COLOR_GREEN "PASS" COLOR_NORMAL " %s\n", testName);
+
+ cleanup:
+	if (e) printf(COLOR_RED "FAIL" COLOR_NORMAL " %s\n", testName);
+	if (vmInitialized) duckVM_quit(&duckVM);
+	(void) dl_memory_quit(&ma);
+	if (string != NULL) free(string);
+	if (memory != NULL) free(memory);
+	return e;
+}
+#endif /* USE_DUCKLIB_MALLOC */
+
 int main(int argc, char *argv[]) {
 	dl_error_t e = dl_error_ok;
 
@@ -561,7 +762,12 @@ int main(int argc, char *argv[]) {
 		char *extension = strrchr((const char *) fileBaseName, '.');
 		if (extension == NULL) continue;
 		extension++;
-		if (0 != strcmp(extension, "dl")) continue;
+		/* ".hna" files are written for parenthesis inference, so they can only be run if it was built in. */
+		bool inferParentheses = (0 == strcmp(extension, "hna"));
+#ifndef USE_PARENTHESIS_INFERENCE
+		if (inferParentheses) continue;
+#endif /* USE_PARENTHESIS_INFERENCE */
+		if (!inferParentheses && (0 != strcmp(extension, "dl"))) continue;
 
 		// +1 for '/'. +1 for '\0'.
 		const size_t path_length = directoryName_length + 1 + strlen((const char *) fileBaseName) + 1;
@@ -606,7 +812,7 @@ int main(int argc, char *argv[]) {
 				if (end) break;
 			}
 
-			e = runTest(fileBaseName, text, text_length);
+			e = runTest(fileBaseName, text, text_length, inferParentheses);
 			if (e == dl_error_outOfMemory) {
 				goto testCleanup;
 			}
@@ -620,6 +826,12 @@ int main(int argc, char *argv[]) {
 		}
 	}
 
+#ifdef USE_DUCKLIB_MALLOC
+	e = runPayloadFailureTest();
+	if (e == dl_error_outOfMemory) goto cleanup;
+	e = dl_error_ok;
+#endif /* USE_DUCKLIB_MALLOC */
+
  cleanup:
 
 	if (directory != NULL) (void) closedir(directory);
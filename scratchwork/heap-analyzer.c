@@ -0,0 +1,604 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../DuckLib/core.h"
+#include "../duckVM.h"
+
+/* Reads a heap snapshot written by `duckVM_dumpHeap` and reports what is keeping memory alive.
+
+   Each root, like a stack slot or a global, gets a node of its own that points to the objects it holds. A made-up root
+   points to all of those, and the dominator tree is built from there. An object's retained size is its size plus the
+   sizes of everything it dominates, which is what would be freed if nothing pointed to it anymore. A root's retained
+   size is everything its node dominates, which is what it alone keeps alive. Objects that are reachable from more than
+   one root are dominated by the made-up root and are reported as shared. */
+
+#define COLOR_NORMAL    "\x1B[0m"
+#define COLOR_YELLOW    "\x1B[33m"
+
+#define DEFAULT_COUNT 20
+
+
+typedef struct {
+	dl_uint64_t id;
+	dl_uint8_t type;
+	dl_uint64_t size;
+	/* Range in `edges`. */
+	size_t edges_start;
+	size_t edges_length;
+} object_t;
+
+typedef struct {
+	dl_uint8_t category;
+	dl_uint64_t index;
+	/* Index in `objects`, plus one. Zero if the object isn't in the snapshot. */
+	size_t node;
+} root_t;
+
+typedef struct {
+	/* Node zero is the made-up root, so object `i` is node `i + 1`. The node of root `r` comes after all the objects, at
+	   `objects_length + 1 + r`. */
+	object_t *objects;
+	size_t objects_length;
+	size_t *edges;
+	size_t edges_length;
+	/* Sorted so that the objects held by the same root are together. */
+	root_t *roots;
+	size_t roots_length;
+	/* Where each root's objects start in `roots`. There's one more entry at the end for the last root's end. */
+	size_t *rootStarts;
+	size_t rootNodes_length;
+} snapshot_t;
+
+typedef struct {
+	size_t *idom;
+	dl_uint64_t *retained;
+	dl_bool_t *reachable;
+} dominators_t;
+
+static const char *typeNames[duckVM_object_type_last] = {
+	[duckVM_object_type_none] = "none",
+	[duckVM_object_type_bool] = "bool",
+	[duckVM_object_type_integer] = "integer",
+	[duckVM_object_type_float] = "float",
+	[duckVM_object_type_string] = "string",
+	[duckVM_object_type_list] = "list",
+	[duckVM_object_type_symbol] = "symbol",
+	[duckVM_object_type_function] = "function",
+	[duckVM_object_type_closure] = "closure",
+	[duckVM_object_type_vector] = "vector",
+	[duckVM_object_type_type] = "type",
+	[duckVM_object_type_composite] = "composite",
+	[duckVM_object_type_user] = "user",
+	[duckVM_object_type_cons] = "cons",
+	[duckVM_object_type_upvalue] = "upvalue",
+	[duckVM_object_type_upvalueArray] = "upvalue array",
+	[duckVM_object_type_internalVector] = "internal vector",
+	[duckVM_object_type_bytecode] = "bytecode",
+	[duckVM_object_type_internalComposite] = "internal composite",
+	[duckVM_object_type_internalString] = "internal string",
+};
+
+static const char *rootNames[duckVM_heapRoot_last] = {
+	[duckVM_heapRoot_stack] = "stack",
+	[duckVM_heapRoot_upvalueStack] = "upvalue stack",
+	[duckVM_heapRoot_global] = "global",
+	[duckVM_heapRoot_callStack] = "call frame",
+	[duckVM_heapRoot_bytecode] = "bytecode",
+	[duckVM_heapRoot_pinned] = "pinned",
+};
+
+static const char *typeName(dl_uint8_t type) {
+	if ((type >= duckVM_object_type_last) || (typeNames[type] == NULL)) return "unknown";
+	return typeNames[type];
+}
+
+static const char *rootName(dl_uint8_t category) {
+	if (category >= duckVM_heapRoot_last) return "unknown";
+	return rootNames[category];
+}
+
+
+/* Parsing */
+
+typedef struct {
+	const unsigned char *data;
+	size_t length;
+	size_t offset;
+} reader_t;
+
+static dl_bool_t readByte(reader_t *reader, dl_uint8_t *byte) {
+	if (reader->offset + 1 > reader->length) return dl_false;
+	*byte = reader->data[reader->offset++];
+	return dl_true;
+}
+
+static dl_bool_t readInteger(reader_t *reader, dl_uint64_t *integer) {
+	if (reader->offset + 8 > reader->length) return dl_false;
+	*integer = 0;
+	for (size_t i = 0; i < 8; i++) {
+		*integer |= (dl_uint64_t) reader->data[reader->offset + i] << (8 * i);
+	}
+	reader->offset += 8;
+	return dl_true;
+}
+
+static int compareRoots(const void *l, const void *r) {
+	const root_t *left = l;
+	const root_t *right = r;
+	if (left->category != right->category) return (left->category > right->category) - (left->category < right->category);
+	return (left->index > right->index) - (left->index < right->index);
+}
+
+static int compareIds(const void *l, const void *r) {
+	dl_uint64_t left = ((const object_t *) l)->id;
+	dl_uint64_t right = ((const object_t *) r)->id;
+	return (left > right) - (left < right);
+}
+
+/* Find an object's node by ID. The objects are sorted by ID. Returns zero if there is no such object. */
+static size_t findNode(snapshot_t *snapshot, dl_uint64_t id) {
+	size_t low = 0;
+	size_t high = snapshot->objects_length;
+	while (low < high) {
+		size_t middle = low + (high - low) / 2;
+		if (id < snapshot->objects[middle].id) high = middle;
+		else if (id > snapshot->objects[middle].id) low = middle + 1;
+		else return middle + 1;
+	}
+	return 0;
+}
+
+/* Read the whole snapshot. Edges are stored as IDs at first, and then replaced with nodes once every object is known. */
+static dl_bool_t parseSnapshot(snapshot_t *snapshot, const unsigned char *data, size_t length) {
+	reader_t reader = {data, length, 0};
+	dl_uint8_t version;
+	dl_uint64_t count;
+	size_t edges_size = 0;
+
+	if ((length < sizeof(DUCKVM_HEAPDUMP_MAGIC))
+	    || memcmp(data, DUCKVM_HEAPDUMP_MAGIC, sizeof(DUCKVM_HEAPDUMP_MAGIC))) {
+		puts("Not a heap snapshot.");
+		return dl_false;
+	}
+	reader.offset = sizeof(DUCKVM_HEAPDUMP_MAGIC);
+	if (!readByte(&reader, &version) || (version != DUCKVM_HEAPDUMP_VERSION)) {
+		printf("Unsupported snapshot version. Expected %i.\n", DUCKVM_HEAPDUMP_VERSION);
+		return dl_false;
+	}
+
+	if (!readInteger(&reader, &count)) goto truncated;
+	/* Every object takes at least 25 bytes, so this can't allocate much more than the file size. */
+	if (count > length / 25) goto truncated;
+	snapshot->objects = malloc((count + 1) * sizeof(object_t));
+	if (snapshot->objects == NULL) goto outOfMemory;
+	snapshot->objects_length = count;
+	for (size_t i = 0; i < count; i++) {
+		object_t *object = &snapshot->objects[i];
+		dl_uint64_t references;
+		if (!readInteger(&reader, &object->id)) goto truncated;
+		if (!readByte(&reader, &object->type)) goto truncated;
+		if (!readInteger(&reader, &object->size)) goto truncated;
+		if (!readInteger(&reader, &references)) goto truncated;
+		if (references > (length - reader.offset) / 8) goto truncated;
+		object->edges_start = snapshot->edges_length;
+		object->edges_length = references;
+		if (snapshot->edges_length + references > edges_size) {
+			size_t *edges;
+			edges_size = 2 * (snapshot->edges_length + references);
+			edges = realloc(snapshot->edges, edges_size * sizeof(size_t));
+			if (edges == NULL) goto outOfMemory;
+			snapshot->edges = edges;
+		}
+		for (size_t j = 0; j < references; j++) {
+			dl_uint64_t id = 0;
+			/**/ readInteger(&reader, &id);
+			snapshot->edges[snapshot->edges_length++] = id;
+		}
+	}
+
+	if (!readInteger(&reader, &count)) goto truncated;
+	if (count > length / 17) goto truncated;
+	snapshot->roots = malloc((count + 1) * sizeof(root_t));
+	if (snapshot->roots == NULL) goto outOfMemory;
+	snapshot->roots_length = count;
+	for (size_t i = 0; i < count; i++) {
+		root_t *root = &snapshot->roots[i];
+		dl_uint64_t id;
+		if (!readByte(&reader, &root->category)) goto truncated;
+		if (!readInteger(&reader, &root->index)) goto truncated;
+		if (!readInteger(&reader, &id)) goto truncated;
+		root->node = id;
+	}
+
+	/* Objects are written in address order, which is already sorted by ID, but don't count on it. Sorting moves the
+	   objects, but their edge ranges go with them. */
+	qsort(snapshot->objects, snapshot->objects_length, sizeof(object_t), compareIds);
+	for (size_t i = 0; i < snapshot->edges_length; i++) {
+		snapshot->edges[i] = findNode(snapshot, snapshot->edges[i]);
+	}
+	for (size_t i = 0; i < snapshot->roots_length; i++) {
+		snapshot->roots[i].node = findNode(snapshot, snapshot->roots[i].node);
+	}
+
+	/* A root may hold several objects, like a value on the stack that is also an upvalue. Those all hang off the same
+	   root node. */
+	qsort(snapshot->roots, snapshot->roots_length, sizeof(root_t), compareRoots);
+	snapshot->rootStarts = malloc((snapshot->roots_length + 1) * sizeof(size_t));
+	if (snapshot->rootStarts == NULL) goto outOfMemory;
+	for (size_t i = 0; i < snapshot->roots_length; i++) {
+		if ((i > 0) && !compareRoots(&snapshot->roots[i - 1], &snapshot->roots[i])) continue;
+		snapshot->rootStarts[snapshot->rootNodes_length++] = i;
+	}
+	snapshot->rootStarts[snapshot->rootNodes_length] = snapshot->roots_length;
+	return dl_true;
+
+ truncated:
+	puts("Snapshot is truncated or corrupt.");
+	return dl_false;
+ outOfMemory:
+	puts("Out of memory.");
+	return dl_false;
+}
+
+
+/* Dominators */
+
+static size_t nodeCount(snapshot_t *snapshot) {
+	return snapshot->objects_length + 1 + snapshot->rootNodes_length;
+}
+
+/* The made-up root's successors are the root nodes, and a root node's successors are the objects it holds. */
+static size_t successorCount(snapshot_t *snapshot, size_t node) {
+	size_t root = node - snapshot->objects_length - 1;
+	if (node == 0) return snapshot->rootNodes_length;
+	if (node <= snapshot->objects_length) return snapshot->objects[node - 1].edges_length;
+	return snapshot->rootStarts[root + 1] - snapshot->rootStarts[root];
+}
+
+static size_t successor(snapshot_t *snapshot, size_t node, size_t i) {
+	size_t root = node - snapshot->objects_length - 1;
+	if (node == 0) return snapshot->objects_length + 1 + i;
+	if (node <= snapshot->objects_length) return snapshot->edges[snapshot->objects[node - 1].edges_start + i];
+	return snapshot->roots[snapshot->rootStarts[root] + i].node;
+}
+
+/* Number the reachable nodes in reverse postorder with an explicit stack, since the heap can be deeper than the C
+   stack. Returns the number of reachable nodes. */
+static size_t reversePostorder(snapshot_t *snapshot, size_t *order, size_t *orderIndex, dl_bool_t *reachable) {
+	size_t nodes = nodeCount(snapshot);
+	size_t *stack = malloc(nodes * sizeof(size_t));
+	size_t *next = calloc(nodes, sizeof(size_t));
+	size_t stack_length = 0;
+	size_t postorder = 0;
+	size_t reached = 0;
+
+	if ((stack == NULL) || (next == NULL)) {
+		free(stack);
+		free(next);
+		return 0;
+	}
+	stack[stack_length++] = 0;
+	reachable[0] = dl_true;
+	reached++;
+	while (stack_length > 0) {
+		size_t node = stack[stack_length - 1];
+		if (next[node] < successorCount(snapshot, node)) {
+			size_t child = successor(snapshot, node, next[node]++);
+			if ((child != 0) && !reachable[child]) {
+				reachable[child] = dl_true;
+				reached++;
+				stack[stack_length++] = child;
+			}
+		}
+		else {
+			--stack_length;
+			order[postorder++] = node;
+		}
+	}
+	/* Flip it. */
+	for (size_t i = 0; i < reached / 2; i++) {
+		size_t temp = order[i];
+		order[i] = order[reached - 1 - i];
+		order[reached - 1 - i] = temp;
+	}
+	for (size_t i = 0; i < reached; i++) {
+		orderIndex[order[i]] = i;
+	}
+	free(stack);
+	free(next);
+	return reached;
+}
+
+static size_t intersect(size_t *idom, size_t *orderIndex, size_t left, size_t right) {
+	while (left != right) {
+		while (orderIndex[left] > orderIndex[right]) left = idom[left];
+		while (orderIndex[right] > orderIndex[left]) right = idom[right];
+	}
+	return left;
+}
+
+/* Cooper, Harvey, and Kennedy's "A Simple, Fast Dominance Algorithm". It wants predecessors, so those are built first.
+   */
+static dl_bool_t findDominators(snapshot_t *snapshot, dominators_t *dominators) {
+	size_t nodes = nodeCount(snapshot);
+	size_t *order = malloc(nodes * sizeof(size_t));
+	size_t *orderIndex = malloc(nodes * sizeof(size_t));
+	size_t *predecessorStart = calloc(nodes + 1, sizeof(size_t));
+	size_t *predecessors = malloc((snapshot->edges_length + snapshot->roots_length + snapshot->rootNodes_length + 1)
+	                              * sizeof(size_t));
+	size_t reached;
+	dl_bool_t changed = dl_true;
+	dl_bool_t ok = dl_false;
+	const size_t undefined = (size_t) -1;
+
+	dominators->idom = malloc(nodes * sizeof(size_t));
+	dominators->retained = calloc(nodes, sizeof(dl_uint64_t));
+	dominators->reachable = calloc(nodes, sizeof(dl_bool_t));
+	if ((order == NULL) || (orderIndex == NULL) || (predecessorStart == NULL) || (predecessors == NULL)
+	    || (dominators->idom == NULL) || (dominators->retained == NULL) || (dominators->reachable == NULL)) {
+		goto cleanup;
+	}
+
+	reached = reversePostorder(snapshot, order, orderIndex, dominators->reachable);
+	if (reached == 0) goto cleanup;
+
+	/* Predecessors of reachable nodes, in compressed rows. */
+	for (size_t node = 0; node < nodes; node++) {
+		if (!dominators->reachable[node]) continue;
+		for (size_t i = 0; i < successorCount(snapshot, node); i++) {
+			size_t child = successor(snapshot, node, i);
+			if (child != 0) predecessorStart[child + 1]++;
+		}
+	}
+	for (size_t node = 0; node < nodes; node++) {
+		predecessorStart[node + 1] += predecessorStart[node];
+	}
+	{
+		size_t *fill = malloc(nodes * sizeof(size_t));
+		if (fill == NULL) goto cleanup;
+		memcpy(fill, predecessorStart, nodes * sizeof(size_t));
+		for (size_t node = 0; node < nodes; node++) {
+			if (!dominators->reachable[node]) continue;
+			for (size_t i = 0; i < successorCount(snapshot, node); i++) {
+				size_t child = successor(snapshot, node, i);
+				if (child != 0) predecessors[fill[child]++] = node;
+			}
+		}
+		free(fill);
+	}
+
+	for (size_t node = 0; node < nodes; node++) {
+		dominators->idom[node] = undefined;
+	}
+	dominators->idom[0] = 0;
+	while (changed) {
+		changed = dl_false;
+		for (size_t i = 1; i < reached; i++) {
+			size_t node = order[i];
+			size_t newIdom = undefined;
+			for (size_t j = predecessorStart[node]; j < predecessorStart[node + 1]; j++) {
+				size_t predecessor = predecessors[j];
+				if (dominators->idom[predecessor] == undefined) continue;
+				newIdom = ((newIdom == undefined)
+				           ? predecessor
+				           : intersect(dominators->idom, orderIndex, predecessor, newIdom));
+			}
+			if (dominators->idom[node] != newIdom) {
+				dominators->idom[node] = newIdom;
+				changed = dl_true;
+			}
+		}
+	}
+
+	/* Children come after their dominators in reverse postorder, so going backwards adds each subtree up before it is
+	   added to its parent. */
+	for (size_t i = reached; i-- > 0;) {
+		size_t node = order[i];
+		if (node == 0) continue;
+		/* Root nodes take no space of their own. */
+		if (node <= snapshot->objects_length) dominators->retained[node] += snapshot->objects[node - 1].size;
+		dominators->retained[dominators->idom[node]] += dominators->retained[node];
+	}
+	ok = dl_true;
+
+ cleanup:
+	if (!ok) puts("Out of memory.");
+	free(order);
+	free(orderIndex);
+	free(predecessorStart);
+	free(predecessors);
+	return ok;
+}
+
+
+/* Reports */
+
+typedef struct {
+	dl_uint8_t category;
+	dl_uint64_t index;
+	dl_uint64_t retained;
+	size_t objects;
+} rootTotal_t;
+
+static int compareRootTotals(const void *l, const void *r) {
+	dl_uint64_t left = ((const rootTotal_t *) l)->retained;
+	dl_uint64_t right = ((const rootTotal_t *) r)->retained;
+	return (left < right) - (left > right);
+}
+
+static dominators_t *g_dominators;
+
+static int compareRetained(const void *l, const void *r) {
+	dl_uint64_t left = g_dominators->retained[*(const size_t *) l];
+	dl_uint64_t right = g_dominators->retained[*(const size_t *) r];
+	return (left < right) - (left > right);
+}
+
+static void reportTypes(snapshot_t *snapshot, dominators_t *dominators) {
+	size_t counts[256] = {0};
+	dl_uint64_t sizes[256] = {0};
+	size_t unreachable = 0;
+	dl_uint64_t total = 0;
+
+	for (size_t i = 0; i < snapshot->objects_length; i++) {
+		object_t *object = &snapshot->objects[i];
+		counts[object->type]++;
+		sizes[object->type] += object->size;
+		total += object->size;
+		if (!dominators->reachable[i + 1]) unreachable++;
+	}
+	printf("%lu objects, %llu bytes, %lu roots\n",
+	       (unsigned long) snapshot->objects_length,
+	       (unsigned long long) total,
+	       (unsigned long) snapshot->roots_length);
+	if (unreachable > 0) {
+		/* Probably kept alive by a user-defined object's marker that the dump couldn't see. */
+		printf("%lu objects aren't reachable from any root.\n", (unsigned long) unreachable);
+	}
+	puts("\nBy type:");
+	printf("  %-20s %10s %12s\n", "type", "objects", "bytes");
+	for (size_t type = 0; type < 256; type++) {
+		if (counts[type] == 0) continue;
+		printf("  %-20s %10lu %12llu\n",
+		       typeName(type),
+		       (unsigned long) counts[type],
+		       (unsigned long long) sizes[type]);
+	}
+}
+
+/* Charge each root with what it alone keeps alive. A global holding the only reference to a big list gets the whole
+   list. Two globals holding the same list get nothing, and the list shows up as shared. */
+static dl_bool_t reportRoots(snapshot_t *snapshot, dominators_t *dominators, size_t count) {
+	rootTotal_t *totals = malloc((snapshot->rootNodes_length + 1) * sizeof(rootTotal_t));
+	dl_uint64_t shared = dominators->retained[0];
+
+	if (totals == NULL) {
+		puts("Out of memory.");
+		return dl_false;
+	}
+	for (size_t i = 0; i < snapshot->rootNodes_length; i++) {
+		root_t *root = &snapshot->roots[snapshot->rootStarts[i]];
+		rootTotal_t *total = &totals[i];
+		total->category = root->category;
+		total->index = root->index;
+		total->retained = dominators->retained[snapshot->objects_length + 1 + i];
+		total->objects = snapshot->rootStarts[i + 1] - snapshot->rootStarts[i];
+		shared -= total->retained;
+	}
+	qsort(totals, snapshot->rootNodes_length, sizeof(rootTotal_t), compareRootTotals);
+
+	printf("\nRetained by root (top %lu of %lu):\n", (unsigned long) dl_min(count, snapshot->rootNodes_length),
+	       (unsigned long) snapshot->rootNodes_length);
+	printf("  %-24s %12s\n", "root", "bytes");
+	for (size_t i = 0; (i < snapshot->rootNodes_length) && (i < count); i++) {
+		char name[64];
+		/**/ snprintf(name, sizeof(name), "%s %llu", rootName(totals[i].category),
+		              (unsigned long long) totals[i].index);
+		printf("  %-24s %12llu\n", name, (unsigned long long) totals[i].retained);
+	}
+	printf("  %-24s %12llu\n", "(shared by several)", (unsigned long long) shared);
+
+	free(totals);
+	return dl_true;
+}
+
+static dl_bool_t reportDominators(snapshot_t *snapshot, dominators_t *dominators, size_t count) {
+	size_t *nodes = malloc((snapshot->objects_length + 1) * sizeof(size_t));
+	size_t nodes_length = 0;
+
+	if (nodes == NULL) {
+		puts("Out of memory.");
+		return dl_false;
+	}
+	for (size_t node = 1; node <= snapshot->objects_length; node++) {
+		if (dominators->reachable[node]) nodes[nodes_length++] = node;
+	}
+	g_dominators = dominators;
+	qsort(nodes, nodes_length, sizeof(size_t), compareRetained);
+
+	printf("\nBiggest dominators (top %lu):\n", (unsigned long) dl_min(count, nodes_length));
+	printf("  %-10s %-20s %10s %12s  %s\n", "id", "type", "bytes", "retained", "dominated by");
+	for (size_t i = 0; (i < nodes_length) && (i < count); i++) {
+		size_t node = nodes[i];
+		object_t *object = &snapshot->objects[node - 1];
+		size_t idom = dominators->idom[node];
+		printf("  %-10llu %-20s %10llu %12llu  ",
+		       (unsigned long long) object->id,
+		       typeName(object->type),
+		       (unsigned long long) object->size,
+		       (unsigned long long) dominators->retained[node]);
+		if (idom == 0) {
+			puts("several roots");
+		}
+		else if (idom > snapshot->objects_length) {
+			root_t *root = &snapshot->roots[snapshot->rootStarts[idom - snapshot->objects_length - 1]];
+			printf("%s %llu\n", rootName(root->category), (unsigned long long) root->index);
+		}
+		else {
+			printf("%llu\n", (unsigned long long) snapshot->objects[idom - 1].id);
+		}
+	}
+
+	free(nodes);
+	return dl_true;
+}
+
+
+int main(int argc, char *argv[]) {
+	int result = 1;
+	FILE *file = NULL;
+	unsigned char *data = NULL;
+	long length;
+	size_t count = DEFAULT_COUNT;
+	snapshot_t snapshot = {0};
+	dominators_t dominators = {0};
+
+	if ((argc != 2) && (argc != 3)) {
+		printf(COLOR_YELLOW
+		       "Usage:\n"
+		       "./heap-analyzer snapshot [count]      Report what keeps the heap alive, showing the biggest `count`\n"
+		       "\n"
+		       "Write a snapshot with `duckVM_dumpHeap`, or with `(dump-heap \"file\")` in duckLisp-dev.\n"
+		       COLOR_NORMAL);
+		return 1;
+	}
+	if (argc == 3) count = strtoul(argv[2], NULL, 10);
+
+	file = fopen(argv[1], "rb");
+	if (file == NULL) {
+		printf("Could not open \"%s\".\n", argv[1]);
+		goto cleanup;
+	}
+	if (fseek(file, 0, SEEK_END) || ((length = ftell(file)) < 0) || fseek(file, 0, SEEK_SET)) {
+		puts("Could not read the file.");
+		goto cleanup;
+	}
+	data = malloc(length + 1);
+	if (data == NULL) {
+		puts("Out of memory.");
+		goto cleanup;
+	}
+	if (fread(data, 1, length, file) != (size_t) length) {
+		puts("Could not read the file.");
+		goto cleanup;
+	}
+
+	if (!parseSnapshot(&snapshot, data, length)) goto cleanup;
+	if (!findDominators(&snapshot, &dominators)) goto cleanup;
+	/**/ reportTypes(&snapshot, &dominators);
+	if (!reportRoots(&snapshot, &dominators, count)) goto cleanup;
+	if (!reportDominators(&snapshot, &dominators, count)) goto cleanup;
+	result = 0;
+
+ cleanup:
+	if (file) /**/ fclose(file);
+	free(data);
+	free(snapshot.objects);
+	free(snapshot.edges);
+	free(snapshot.roots);
+	free(snapshot.rootStarts);
+	free(dominators.idom);
+	free(dominators.retained);
+	free(dominators.reachable);
+	return result;
+}
@@ -0,0 +1,438 @@
+#ifdef USE_THREADSAFE_MALLOC
+/* For `clock_gettime`. `clock` adds up the time of every thread. */
+#define _POSIX_C_SOURCE 199309L
+#endif /* USE_THREADSAFE_MALLOC */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef USE_THREADSAFE_MALLOC
+#include <pthread.h>
+#endif /* USE_THREADSAFE_MALLOC */
+#include "../DuckLib/core.h"
+#include "../DuckLib/memory.h"
+#include "../duckVM.h"
+#include "../duckLisp.h"
+
+/* Compare DuckLib's fit strategies on the allocation patterns sketched in allocation.txt: plain malloc/free churn,
+   blocks that grow with realloc like `dl_array_t`s do, and a real compile and run. Only meaningful when built with
+   `USE_DUCKLIB_MALLOC`. Otherwise every fit is just the C library's malloc. */
+
+#define MEMORY_SIZE (64 * 1024 * 1024)
+#define MAX_OBJECTS 100000
+#define SLOTS 2000
+#define OPERATIONS 200000
+#define THREADS 4
+#define MAILBOXES 64
+
+
+static const struct {
+	dl_memoryFit_t fit;
+	const char *name;
+} fits[] = {
+	{dl_memoryFit_first,      "first"},
+	{dl_memoryFit_next,       "next"},
+	{dl_memoryFit_best,       "best"},
+	{dl_memoryFit_worst,      "worst"},
+	{dl_memoryFit_segregated, "segregated"},
+};
+
+typedef struct {
+	dl_uint8_t *memory;
+	dl_size_t size;
+} slot_t;
+
+
+static double seconds(clock_t start, clock_t end) {
+	return (double) (end - start) / CLOCKS_PER_SEC;
+}
+
+/* The benchmark has to do the same work for every fit, so use our own generator instead of `rand`. */
+static dl_size_t nextRandom(dl_uint64_t *state) {
+	*state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+	return (dl_size_t) (*state >> 33);
+}
+
+/* Mostly small blocks with the occasional big one, like the compiler's strings and arrays. */
+static dl_size_t randomSize(dl_uint64_t *state) {
+	dl_size_t roll = nextRandom(state) % 100;
+	if (roll < 70) return 8 + nextRandom(state) % 56;
+	if (roll < 95) return 64 + nextRandom(state) % 448;
+	return 512 + nextRandom(state) % 7680;
+}
+
+/* Check that a block still holds what was written to it, so that a broken allocator can't win. */
+static dl_error_t checkSlot(slot_t *slot) {
+	if ((slot->memory[0] != (dl_uint8_t) slot->size) || (slot->memory[slot->size - 1] != (dl_uint8_t) slot->size)) {
+		puts("Allocator corrupted a block.");
+		return dl_error_shouldntHappen;
+	}
+	return dl_error_ok;
+}
+
+static void fillSlot(slot_t *slot, dl_size_t size) {
+	slot->size = size;
+	slot->memory[0] = (dl_uint8_t) size;
+	slot->memory[size - 1] = (dl_uint8_t) size;
+}
+
+/* malloc, then free. Random blocks are freed and replaced, so the heap fragments. */
+static dl_error_t trace_churn(dl_memoryAllocation_t *memoryAllocation, slot_t *slots) {
+	dl_error_t e = dl_error_ok;
+	dl_uint64_t state = 1;
+
+	DL_DOTIMES(i, OPERATIONS) {
+		slot_t *slot = &slots[nextRandom(&state) % SLOTS];
+		if (slot->memory != dl_null) {
+			e = checkSlot(slot);
+			if (e) break;
+			e = DL_FREE(memoryAllocation, &slot->memory);
+			if (e) break;
+		}
+		else {
+			dl_size_t size = randomSize(&state);
+			e = DL_MALLOC(memoryAllocation, &slot->memory, size, dl_uint8_t);
+			if (e) break;
+			/**/ fillSlot(slot, size);
+		}
+	}
+	return e;
+}
+
+/* realloc. Blocks grow by doubling like arrays do, and are freed once they get big. */
+static dl_error_t trace_grow(dl_memoryAllocation_t *memoryAllocation, slot_t *slots) {
+	dl_error_t e = dl_error_ok;
+	dl_uint64_t state = 2;
+
+	DL_DOTIMES(i, OPERATIONS) {
+		slot_t *slot = &slots[nextRandom(&state) % SLOTS];
+		if (slot->memory == dl_null) {
+			e = DL_MALLOC(memoryAllocation, &slot->memory, 16, dl_uint8_t);
+			if (e) break;
+			/**/ fillSlot(slot, 16);
+			continue;
+		}
+		e = checkSlot(slot);
+		if (e) break;
+		if (slot->size >= 4096) {
+			e = DL_FREE(memoryAllocation, &slot->memory);
+			if (e) break;
+		}
+		else {
+			e = DL_REALLOC(memoryAllocation, &slot->memory, 2 * slot->size, dl_uint8_t);
+			if (e) break;
+			/* realloc copied the first byte. */
+			slot->memory[2 * slot->size - 1] = (dl_uint8_t) (2 * slot->size);
+			slot->memory[0] = (dl_uint8_t) (2 * slot->size);
+			slot->size *= 2;
+		}
+	}
+	return e;
+}
+
+/* Compile and run a script. The compiler makes lots of small short-lived allocations, and the VM makes a few big ones
+   that last. */
+static dl_error_t trace_script(dl_memoryAllocation_t *memoryAllocation, slot_t *slots) {
+	dl_error_t e = dl_error_ok;
+	duckLisp_t duckLisp;
+	duckVM_t duckVM;
+	dl_uint8_t *bytecode = dl_null;
+	dl_size_t bytecode_length = 0;
+	const char *source = ("(() (__defun build (n) (__var l ()) (__while (__> n 0) (__setq l (__cons n l)) (__setq n (__- n 1))) l)"
+	                      " (__defun sum (l) (__var s 0) (__while l (__setq s (__+ s (__car l))) (__setq l (__cdr l))) s)"
+	                      " (__var total 0)"
+	                      " (__var i 0)"
+	                      " (__while (__< i 200) (__setq total (__+ total (sum (build 500)))) (__setq i (__+ i 1)))"
+	                      " total)");
+	(void) slots;
+
+	DL_DOTIMES(i, 20) {
+		e = duckLisp_init(&duckLisp,
+		                  memoryAllocation,
+		                  MAX_OBJECTS
+#ifdef USE_PARENTHESIS_INFERENCE
+		                  ,
+		                  0
+#endif /* USE_PARENTHESIS_INFERENCE */
+		                  );
+		if (e) return e;
+		e = duckVM_init(&duckVM, memoryAllocation, MAX_OBJECTS);
+		if (e) {
+			(void) duckLisp_quit(&duckLisp);
+			return e;
+		}
+		e = duckLisp_loadString(&duckLisp,
+#ifdef USE_PARENTHESIS_INFERENCE
+		                        dl_false,
+#endif /* USE_PARENTHESIS_INFERENCE */
+		                        &bytecode,
+		                        &bytecode_length,
+		                        (const dl_uint8_t *) source,
+		                        strlen(source),
+		                        DL_STR("<memory-bench>"));
+		if (!e) e = duckVM_execute(&duckVM, bytecode, bytecode_length);
+		if (bytecode != dl_null) (void) DL_FREE(memoryAllocation, &bytecode);
+		duckVM_quit(&duckVM);
+		(void) duckLisp_quit(&duckLisp);
+		if (e) return e;
+	}
+	return e;
+}
+
+#ifdef USE_THREADSAFE_MALLOC
+
+/* Several threads share one region, either by locking it on every call or through their own thread caches. Some blocks
+   get passed through mailboxes and are freed by whichever thread picks them up, so caches get remote frees. */
+
+typedef struct {
+	dl_memoryAllocation_t *shared;
+	dl_bool_t cached;
+	dl_error_t (*trace)(dl_memoryAllocation_t *, slot_t *);
+	dl_error_t e;
+} thread_t;
+
+static void *mailboxes[MAILBOXES];
+
+static double wallSeconds(void) {
+	struct timespec now;
+	/**/ clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double) now.tv_sec + 1e-9 * (double) now.tv_nsec;
+}
+
+/* Like `trace_churn`, but every eighth block is posted to a mailbox, and every eighth operation frees someone's post. */
+static dl_error_t trace_sharedChurn(dl_memoryAllocation_t *memoryAllocation, slot_t *slots) {
+	dl_error_t e = dl_error_ok;
+	dl_uint64_t state = (dl_uint64_t) (size_t) slots;
+
+	DL_DOTIMES(i, OPERATIONS) {
+		slot_t *slot = &slots[nextRandom(&state) % (SLOTS / THREADS)];
+		if (nextRandom(&state) % 8 == 0) {
+			dl_uint8_t *post = __atomic_exchange_n(&mailboxes[nextRandom(&state) % MAILBOXES], dl_null, __ATOMIC_ACQ_REL);
+			if (post != dl_null) {
+				if (post[0] != 0xA5) {
+					puts("Allocator corrupted a posted block.");
+					e = dl_error_shouldntHappen;
+					break;
+				}
+				e = DL_FREE(memoryAllocation, &post);
+				if (e) break;
+			}
+		}
+		if (slot->memory != dl_null) {
+			e = checkSlot(slot);
+			if (e) break;
+			e = DL_FREE(memoryAllocation, &slot->memory);
+			if (e) break;
+		}
+		else {
+			dl_size_t size = randomSize(&state);
+			e = DL_MALLOC(memoryAllocation, &slot->memory, size, dl_uint8_t);
+			if (e) break;
+			if (nextRandom(&state) % 8 == 0) {
+				dl_uint8_t *post = slot->memory;
+				post[0] = 0xA5;
+				slot->memory = dl_null;
+				post = __atomic_exchange_n(&mailboxes[nextRandom(&state) % MAILBOXES], post, __ATOMIC_ACQ_REL);
+				if (post != dl_null) {
+					e = DL_FREE(memoryAllocation, &post);
+					if (e) break;
+				}
+			}
+			else {
+				/**/ fillSlot(slot, size);
+			}
+		}
+	}
+	DL_DOTIMES(i, SLOTS / THREADS) {
+		if (slots[i].memory != dl_null) {
+			dl_error_t eError = DL_FREE(memoryAllocation, &slots[i].memory);
+			if (!e) e = eError;
+		}
+	}
+	return e;
+}
+
+static void *runThread(void *argument) {
+	thread_t *thread = argument;
+	dl_memoryAllocation_t cache;
+	dl_memoryAllocation_t *memoryAllocation = thread->shared;
+	slot_t *slots = calloc(SLOTS / THREADS, sizeof(slot_t));
+
+	if (slots == NULL) {
+		thread->e = dl_error_outOfMemory;
+		return dl_null;
+	}
+	if (thread->cached) {
+		thread->e = dl_memory_initThreadCache(&cache, thread->shared);
+		if (thread->e) goto cleanup;
+		memoryAllocation = &cache;
+	}
+	thread->e = thread->trace(memoryAllocation, slots);
+	if (thread->cached) /**/ dl_memory_quitThreadCache(&cache);
+ cleanup:
+	free(slots);
+	return dl_null;
+}
+
+/* The compiler and VM don't give back everything they allocate, so leaks can only be checked for traces that free
+   everything. */
+static dl_error_t runThreads(const char *name,
+                             dl_error_t (*trace)(dl_memoryAllocation_t *, slot_t *),
+                             dl_bool_t freesEverything,
+                             void *memory) {
+	dl_error_t e = dl_error_ok;
+	const char *modes[] = {"locked", "cached"};
+
+	printf("%s:\n", name);
+	DL_DOTIMES(mode, 2) {
+		dl_memoryAllocation_t shared;
+		dl_memoryAllocation_t cache;
+		dl_memoryAllocation_t *memoryAllocation = &shared;
+		pthread_t handles[THREADS];
+		thread_t threads[THREADS];
+		dl_size_t baseline;
+		double start, end;
+
+		e = dl_memory_init(&shared, memory, MEMORY_SIZE, dl_memoryFit_segregated);
+		if (e) {
+			puts("dl_memory_init failed.");
+			break;
+		}
+		/**/ dl_memory_usage(&baseline, shared);
+		/**/ memset(mailboxes, 0, sizeof(mailboxes));
+		start = wallSeconds();
+		DL_DOTIMES(i, THREADS) {
+			threads[i].shared = &shared;
+			threads[i].cached = mode;
+			threads[i].trace = trace;
+			threads[i].e = dl_error_ok;
+			if (pthread_create(&handles[i], NULL, runThread, &threads[i])) {
+				puts("pthread_create failed.");
+				exit(1);
+			}
+		}
+		DL_DOTIMES(i, THREADS) {
+			/**/ pthread_join(handles[i], NULL);
+			if (!e) e = threads[i].e;
+		}
+		end = wallSeconds();
+
+		/* Every thread is gone, so whatever is left in the mailboxes gets remote freed. */
+		if (mode) {
+			dl_error_t eError = dl_memory_initThreadCache(&cache, &shared);
+			if (!e) e = eError;
+			memoryAllocation = &cache;
+		}
+		DL_DOTIMES(i, MAILBOXES) {
+			if (mailboxes[i] != dl_null) {
+				dl_error_t eError = dl_free(memoryAllocation, &mailboxes[i]);
+				if (!e) e = eError;
+			}
+		}
+		if (mode) /**/ dl_memory_quitThreadCache(&cache);
+
+		if (e) {
+			printf("  %-10s failed. (%s)\n", modes[mode], dl_errorString[e]);
+			dl_memory_quit(&shared);
+			break;
+		}
+		if (freesEverything) {
+			dl_size_t used;
+			/**/ dl_memory_usage(&used, shared);
+			if (used != baseline) {
+				printf("  %-10s leaked %lu bytes.\n", modes[mode], (unsigned long) (used - baseline));
+				e = dl_error_shouldntHappen;
+				dl_memory_quit(&shared);
+				break;
+			}
+		}
+		printf("  %-10s %8.2f ms\n", modes[mode], 1e3 * (end - start));
+		dl_memory_quit(&shared);
+	}
+	return e;
+}
+
+#endif /* USE_THREADSAFE_MALLOC */
+
+static dl_error_t runTrace(const char *name, dl_error_t (*trace)(dl_memoryAllocation_t *, slot_t *), void *memory) {
+	dl_error_t e = dl_error_ok;
+	slot_t *slots = calloc(SLOTS, sizeof(slot_t));
+
+	if (slots == NULL) return dl_error_outOfMemory;
+	printf("%s:\n", name);
+	DL_DOTIMES(i, sizeof(fits) / sizeof(*fits)) {
+		dl_memoryAllocation_t memoryAllocation;
+		clock_t start, end;
+
+		e = dl_memory_init(&memoryAllocation, memory, MEMORY_SIZE, fits[i].fit);
+		if (e) {
+			puts("dl_memory_init failed.");
+			break;
+		}
+		/**/ memset(slots, 0, SLOTS * sizeof(slot_t));
+		start = clock();
+		e = trace(&memoryAllocation, slots);
+		end = clock();
+		if (e == dl_error_outOfMemory) {
+			/* Next fit only searches after the most recent block and never wraps around, so it can run out early. That's not a
+			   reason to stop comparing the others. */
+			printf("  %-10s ran out of memory\n", fits[i].name);
+			e = dl_error_ok;
+			continue;
+		}
+		if (e) {
+			printf("  %-10s failed. (%s)\n", fits[i].name, dl_errorString[e]);
+			break;
+		}
+		printf("  %-10s %8.2f ms\n", fits[i].name, 1e3 * seconds(start, end));
+#ifdef USE_MEMORY_PROFILING
+		{
+			dl_memoryProfile_t profile;
+			/**/ dl_memory_getProfile(&profile, &memoryAllocation);
+			printf("  %-10s %lu mallocs, %lu reallocs, %lu frees, %ld bytes at peak, largest of %lu free bytes is %lu\n",
+			       "",
+			       (unsigned long) profile.mallocs,
+			       (unsigned long) profile.reallocs,
+			       (unsigned long) profile.frees,
+			       (long) profile.peakBytes,
+			       (unsigned long) profile.freeBytes,
+			       (unsigned long) profile.largestFreeBlock);
+		}
+#endif /* USE_MEMORY_PROFILING */
+		/* The region is reused, so everything left over can just be dropped. */
+		dl_memory_quit(&memoryAllocation);
+	}
+
+	free(slots);
+	return e;
+}
+
+int main(void) {
+	dl_error_t e = dl_error_ok;
+	void *memory = malloc(MEMORY_SIZE);
+
+	if (memory == NULL) {
+		puts("malloc failed.");
+		return 1;
+	}
+#ifndef USE_DUCKLIB_MALLOC
+	puts("Built without USE_DUCKLIB_MALLOC, so every fit uses the C library's allocator.");
+#endif /* USE_DUCKLIB_MALLOC */
+
+	e = runTrace("churn", trace_churn, memory);
+	if (e) goto cleanup;
+	e = runTrace("grow", trace_grow, memory);
+	if (e) goto cleanup;
+	e = runTrace("script", trace_script, memory);
+	if (e) goto cleanup;
+#ifdef USE_THREADSAFE_MALLOC
+	e = runThreads("threads churn", trace_sharedChurn, dl_true, memory);
+	if (e) goto cleanup;
+	e = runThreads("threads script", trace_script, dl_false, memory);
+	if (e) goto cleanup;
+#endif /* USE_THREADSAFE_MALLOC */
+
+ cleanup:
+	free(memory);
+	return e;
+}
@@ -6,6 +6,340 @@
 #include "../DuckLib/core.h"
 #include "../DuckLib/memory.h"
 
+#define ARENA_CHUNK_SIZE 256
+#define ARENA_BLOCKS 16
+#define ARENA_BLOCK_SIZE 64
+
+/* Arenas only get used by the compiler, and mostly in ways that don't hit their edge cases, so poke at those here. */
+static dl_error_t checkArena(void *memory, size_t size) {
+	dl_error_t error = dl_error_ok;
+	dl_memoryAllocation_t parent;
+	dl_memoryAllocation_t arena = {0};
+	unsigned char *foreign = NULL;
+	unsigned char *a = NULL;
+	unsigned char *b = NULL;
+	unsigned char *blocks[ARENA_BLOCKS] = {0};
+	void *old;
+	size_t parentUsed;
+	size_t parentUsedAfter;
+	size_t used;
+
+	/* Best fit's block list grows as blocks are allocated, so only segregated fit's usage comes back down exactly. */
+	error = dl_memory_init(&parent, memory, size, dl_memoryFit_segregated);
+	if (error) {
+		printf("Could not initialize memory allocator. (%s)\n", dl_errorString[error]);
+		return error;
+	}
+	error = dl_memory_initArena(&arena, &parent, ARENA_CHUNK_SIZE);
+	if (error) {
+		printf("Could not initialize arena. (%s)\n", dl_errorString[error]);
+		goto l_cleanup;
+	}
+
+	/* Memory from the parent should go back to the parent. Parent usage is always zero with the C library's malloc. */
+	dl_memory_usage(&parentUsed, parent);
+	error = dl_malloc(&parent, (void **) &foreign, 100);
+	if (error) goto l_error;
+	for (size_t i = 0; i < 100; i++) foreign[i] = i;
+	error = dl_realloc(&arena, (void **) &foreign, 200);
+	if (error) goto l_error;
+	for (size_t i = 0; i < 100; i++) {
+		if (foreign[i] != i) {
+			printf("Failed: Byte %zu of a foreign block is %u after dl_realloc on the arena.\n", i, foreign[i]);
+			goto l_fail;
+		}
+	}
+	error = dl_free(&arena, (void **) &foreign);
+	if (error) goto l_error;
+	dl_memory_usage(&parentUsedAfter, parent);
+	if ((arena.used != 0) || (parentUsedAfter != parentUsed)) {
+		printf("Failed: A foreign block was kept by the arena. Arena: %zu bytes. Parent: %zu bytes, %zu before.\n",
+		       (size_t) arena.used,
+		       parentUsedAfter,
+		       parentUsed);
+		goto l_fail;
+	}
+
+	/* Only the most recent block grows in place or gives its memory back. */
+	error = dl_malloc(&arena, (void **) &a, 32);
+	if (error) goto l_error;
+	used = arena.used;
+	error = dl_malloc(&arena, (void **) &b, 32);
+	if (error) goto l_error;
+	old = b;
+	error = dl_realloc(&arena, (void **) &b, 64);
+	if (error) goto l_error;
+	if ((void *) b != old) {
+		printf("Failed: The most recent block moved when it grew.\n");
+		goto l_fail;
+	}
+	error = dl_free(&arena, (void **) &b);
+	if (error) goto l_error;
+	if (arena.used != used) {
+		printf("Failed: Freeing the most recent block left %zu bytes in use instead of %zu.\n", (size_t) arena.used, used);
+		goto l_fail;
+	}
+	for (size_t i = 0; i < 32; i++) a[i] = i;
+	error = dl_malloc(&arena, (void **) &b, 32);
+	if (error) goto l_error;
+	old = a;
+	error = dl_realloc(&arena, (void **) &a, 64);
+	if (error) goto l_error;
+	if ((void *) a == old) {
+		printf("Failed: A block that isn't the most recent grew in place.\n");
+		goto l_fail;
+	}
+	for (size_t i = 0; i < 32; i++) {
+		if (a[i] != i) {
+			printf("Failed: Byte %zu of a moved block is %u.\n", i, a[i]);
+			goto l_fail;
+		}
+	}
+	error = dl_memory_resetArena(&arena);
+	if (error) goto l_error;
+
+	/* A round that takes several chunks should fit in the one chunk that's kept after a reset. Blocks from a single
+	   chunk are evenly spaced. */
+	for (size_t round = 0; round < 2; round++) {
+		dl_bool_t evenlySpaced = dl_true;
+		for (size_t i = 0; i < ARENA_BLOCKS; i++) {
+			error = dl_malloc(&arena, (void **) &blocks[i], ARENA_BLOCK_SIZE);
+			if (error) goto l_error;
+			if ((i > 1) && (blocks[i] - blocks[i - 1] != blocks[1] - blocks[0])) evenlySpaced = dl_false;
+		}
+		if (evenlySpaced != (round != 0)) {
+			printf("Failed: Round %zu of %u %u byte blocks %s from one chunk.\n",
+			       round,
+			       ARENA_BLOCKS,
+			       ARENA_BLOCK_SIZE,
+			       evenlySpaced ? "came" : "didn't come");
+			goto l_fail;
+		}
+		if (round == 0) dl_memory_usage(&parentUsed, parent);
+		error = dl_memory_resetArena(&arena);
+		if (error) goto l_error;
+	}
+	dl_memory_usage(&parentUsedAfter, parent);
+	if (parentUsedAfter > parentUsed) {
+		printf("Failed: The arena took %zu bytes from its parent after a reset, up from %zu.\n", parentUsedAfter, parentUsed);
+		goto l_fail;
+	}
+
+	printf("Arena checks passed.\n");
+	goto l_cleanup;
+
+ l_error:
+	printf("Arena check failed. (%s)\n", dl_errorString[error]);
+	goto l_cleanup;
+ l_fail:
+	error = dl_error_invalidValue;
+ l_cleanup:
+	dl_memory_quitArena(&arena);
+	dl_memory_quit(&parent);
+	return error;
+}
+
+#ifdef USE_MEMORY_PROFILING
+static dl_bool_t checkCounts(const char *name,
+                             const dl_memoryProfile_t *profile,
+                             dl_size_t mallocs,
+                             dl_size_t frees,
+                             dl_size_t reallocs,
+                             dl_size_t failures,
+                             const dl_size_t sizes[DL_MEMORY_PROFILE_SIZES]) {
+	dl_bool_t passed = ((profile->mallocs == mallocs)
+	                    && (profile->frees == frees)
+	                    && (profile->reallocs == reallocs)
+	                    && (profile->failures == failures));
+	if (!passed) {
+		printf("Failed: %s counted %zu mallocs, %zu frees, %zu reallocs, and %zu failures"
+		       " instead of %zu, %zu, %zu, and %zu.\n",
+		       name,
+		       (size_t) profile->mallocs,
+		       (size_t) profile->frees,
+		       (size_t) profile->reallocs,
+		       (size_t) profile->failures,
+		       (size_t) mallocs,
+		       (size_t) frees,
+		       (size_t) reallocs,
+		       (size_t) failures);
+	}
+	for (size_t i = 0; i < DL_MEMORY_PROFILE_SIZES; i++) {
+		if (profile->sizes[i] != sizes[i]) {
+			printf("Failed: %s counted %zu sizes in slot %zu instead of %zu.\n",
+			       name,
+			       (size_t) profile->sizes[i],
+			       i,
+			       (size_t) sizes[i]);
+			passed = dl_false;
+		}
+	}
+	return passed;
+}
+
+/* Run a known sequence through an allocation and an arena on top of it, and check what the profiles say about it.
+   Slot 0 counts sizes up to 16 bytes, and slot n counts sizes up to 2^(n + 4) bytes, so 128 goes in slot 3. */
+static dl_error_t checkProfile(void *memory, size_t size) {
+	dl_error_t error = dl_error_ok;
+	dl_memoryAllocation_t parent;
+	dl_memoryAllocation_t arena = {0};
+	dl_memoryProfile_t profile;
+	dl_memoryProfile_t before;
+	dl_ptrdiff_t peakBytes;
+	dl_bool_t roundedUp = dl_false;
+	void *a = NULL;
+	void *b = NULL;
+	void *c = NULL;
+	void *x = NULL;
+	void *y = NULL;
+	void *huge = NULL;
+
+	/* Everything coalesces back into one block with segregated fit, so the free memory should be the same at the end. */
+	error = dl_memory_init(&parent, memory, size, dl_memoryFit_segregated);
+	if (error) {
+		printf("Could not initialize memory allocator. (%s)\n", dl_errorString[error]);
+		return error;
+	}
+	/**/ dl_memory_getProfile(&before, &parent);
+
+	error = dl_malloc(&parent, &a, 10);
+	if (error) goto l_error;
+	error = dl_malloc(&parent, &b, 128);
+	if (error) goto l_error;
+	error = dl_realloc(&parent, &a, 1000);
+	if (error) goto l_error;
+	error = dl_realloc(&parent, &c, 5);
+	if (error) goto l_error;
+	/**/ dl_memory_getProfile(&profile, &parent);
+	peakBytes = profile.bytes;
+#ifdef USE_DUCKLIB_MALLOC
+	/* DuckLib rounds blocks up. */
+	roundedUp = dl_true;
+#endif /* USE_DUCKLIB_MALLOC */
+	if ((peakBytes < 1133) || (!roundedUp && (peakBytes != 1133)) || (profile.peakBytes != peakBytes)) {
+		printf("Failed: %td bytes are out with a peak of %td after asking for 1133.\n", peakBytes, profile.peakBytes);
+		goto l_fail;
+	}
+
+	error = dl_realloc(&parent, &a, 20);
+	if (error) goto l_error;
+#ifdef USE_DUCKLIB_MALLOC
+	/* The C library would happily hand this out. */
+	if (!dl_malloc(&parent, &huge, 2 * size)) {
+		printf("Failed: dl_malloc handed out more memory than the allocation has.\n");
+		goto l_fail;
+	}
+#endif /* USE_DUCKLIB_MALLOC */
+	error = dl_free(&parent, &a);
+	if (error) goto l_error;
+	error = dl_free(&parent, &b);
+	if (error) goto l_error;
+	error = dl_free(&parent, &c);
+	if (error) goto l_error;
+
+	/**/ dl_memory_getProfile(&profile, &parent);
+	{
+#ifdef USE_DUCKLIB_MALLOC
+		const dl_size_t sizes[DL_MEMORY_PROFILE_SIZES] = {2, 1, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+		if (!checkCounts("dl_malloc", &profile, 3, 3, 3, 1, sizes)) goto l_fail;
+#else /* USE_DUCKLIB_MALLOC */
+		const dl_size_t sizes[DL_MEMORY_PROFILE_SIZES] = {2, 1, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+		if (!checkCounts("malloc", &profile, 2, 3, 3, 0, sizes)) goto l_fail;
+#endif /* USE_DUCKLIB_MALLOC */
+	}
+	if ((profile.bytes != 0) || (profile.peakBytes != peakBytes)) {
+		printf("Failed: %td bytes are out with a peak of %td after freeing everything. The peak was %td.\n",
+		       profile.bytes,
+		       profile.peakBytes,
+		       peakBytes);
+		goto l_fail;
+	}
+	/* Both are zero with the C library's malloc. */
+	if ((profile.freeBytes != before.freeBytes) || (profile.largestFreeBlock != before.largestFreeBlock)) {
+		printf("Failed: %zu bytes are free with a largest block of %zu, but there were %zu and %zu to start.\n",
+		       (size_t) profile.freeBytes,
+		       (size_t) profile.largestFreeBlock,
+		       (size_t) before.freeBytes,
+		       (size_t) before.largestFreeBlock);
+		goto l_fail;
+	}
+
+	/* Arenas count their blocks rounded up to the alignment, so stick to multiples of it. The arena's free memory is
+	   the end of its newest chunk, which `y' fills. */
+	error = dl_memory_initArena(&arena, &parent, 256);
+	if (error) {
+		printf("Could not initialize arena. (%s)\n", dl_errorString[error]);
+		goto l_cleanup;
+	}
+	error = dl_malloc(&arena, &x, 48);
+	if (error) goto l_error;
+	error = dl_malloc(&arena, &y, 496);
+	if (error) goto l_error;
+	/**/ dl_memory_getProfile(&before, &arena);
+	error = dl_realloc(&arena, &y, 400);
+	if (error) goto l_error;
+	/**/ dl_memory_getProfile(&profile, &arena);
+	if ((profile.bytes != 448) || (profile.freeBytes != before.freeBytes + 96)) {
+		printf("Failed: Shrinking the arena's newest block left %td bytes out and %zu free instead of 448 and %zu.\n",
+		       profile.bytes,
+		       (size_t) profile.freeBytes,
+		       (size_t) before.freeBytes + 96);
+		goto l_fail;
+	}
+	if (!dl_malloc(&arena, &huge, (dl_size_t) -1)) {
+		printf("Failed: The arena handed out more memory than there is.\n");
+		goto l_fail;
+	}
+	/**/ dl_memory_getProfile(&before, &arena);
+	error = dl_free(&arena, &x);
+	if (error) goto l_error;
+	/**/ dl_memory_getProfile(&profile, &arena);
+	if (profile.freeBytes != before.freeBytes) {
+		printf("Failed: Freeing an old block changed the arena's free memory from %zu to %zu bytes.\n",
+		       (size_t) before.freeBytes,
+		       (size_t) profile.freeBytes);
+		goto l_fail;
+	}
+	error = dl_free(&arena, &y);
+	if (error) goto l_error;
+
+	/**/ dl_memory_getProfile(&profile, &arena);
+	{
+		const dl_size_t sizes[DL_MEMORY_PROFILE_SIZES] = {0, 0, 1, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+		if (!checkCounts("The arena", &profile, 3, 2, 1, 1, sizes)) goto l_fail;
+	}
+	if ((profile.bytes != 0) || (profile.peakBytes != 544)) {
+		printf("Failed: The arena has %td bytes out with a peak of %td instead of 0 and 544.\n",
+		       profile.bytes,
+		       profile.peakBytes);
+		goto l_fail;
+	}
+	if ((profile.freeBytes < before.freeBytes + 400) || (profile.largestFreeBlock != profile.freeBytes)) {
+		printf("Failed: Freeing the arena's newest block left %zu bytes free with a largest block of %zu, up from %zu.\n",
+		       (size_t) profile.freeBytes,
+		       (size_t) profile.largestFreeBlock,
+		       (size_t) before.freeBytes);
+		goto l_fail;
+	}
+
+	printf("Profile checks passed.\n");
+	goto l_cleanup;
+
+ l_error:
+	printf("Profile check failed. (%s)\n", dl_errorString[error]);
+	goto l_cleanup;
+ l_fail:
+	error = dl_error_invalidValue;
+ l_cleanup:
+	dl_memory_quitArena(&arena);
+	if (a != NULL) (void) dl_free(&parent, &a);
+	if (b != NULL) (void) dl_free(&parent, &b);
+	if (c != NULL) (void) dl_free(&parent, &c);
+	dl_memory_quit(&parent);
+	return error;
+}
+#endif /* USE_MEMORY_PROFILING */
+
 int main(int argc, char *argv[]) {
 	dl_error_t error = dl_error_ok;
 
@@ -39,6 +373,13 @@ int main(int argc, char *argv[]) {
 		goto l_cleanup;
 	}
 	
+	error = checkArena(memory, size);
+	if (error) goto l_cleanup;
+#ifdef USE_MEMORY_PROFILING
+	error = checkProfile(memory, size);
+	if (error) goto l_cleanup;
+#endif /* USE_MEMORY_PROFILING */
+
 	srand((unsigned int) time(NULL));
 	
 	for (unsigned long long k = 0; k < iterations; k++) {
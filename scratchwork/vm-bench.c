@@ -0,0 +1,614 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../DuckLib/core.h"
+#include "../DuckLib/memory.h"
+#include "../duckVM.h"
+#include "../duckLisp.h"
+
+/* Microbenchmarks for the VM's C API. */
+
+#define MEMORY_SIZE (64 * 1024 * 1024)
+#define MAX_OBJECTS 100000
+#define ACCESSES 10000000
+#define CALLBACKS 1000
+
+
+static double seconds(clock_t start, clock_t end) {
+	return (double) (end - start) / CLOCKS_PER_SEC;
+}
+
+/* Time global variable access with an increasing number of globals defined. The time per access should stay flat. */
+static dl_error_t bench_globals(dl_memoryAllocation_t *memoryAllocation) {
+	dl_error_t e = dl_error_ok;
+	const dl_size_t globalCounts[] = {10, 100, 1000, 10000};
+
+	puts("globals:");
+	DL_DOTIMES(i, sizeof(globalCounts) / sizeof(*globalCounts)) {
+		duckVM_t duckVM;
+		dl_size_t globalCount = globalCounts[i];
+		clock_t start, end;
+
+		e = duckVM_init(&duckVM, memoryAllocation, MAX_OBJECTS);
+		if (e) {
+			puts("duckVM_init failed.");
+			return e;
+		}
+
+		DL_DOTIMES(key, globalCount) {
+			e = duckVM_pushInteger(&duckVM);
+			if (e) break;
+			e = duckVM_setInteger(&duckVM, key);
+			if (e) break;
+			e = duckVM_setGlobal(&duckVM, key);
+			if (e) break;
+			e = duckVM_pop(&duckVM);
+			if (e) break;
+		}
+		if (e) {
+			puts("Failed to define globals.");
+			duckVM_quit(&duckVM);
+			return e;
+		}
+
+		start = clock();
+		DL_DOTIMES(j, ACCESSES) {
+			/* Hit the most recently defined global, which was the slowest case for the old linear scan. */
+			e = duckVM_pushGlobal(&duckVM, globalCount - 1 - (j & 7));
+			if (e) break;
+			e = duckVM_pop(&duckVM);
+			if (e) break;
+		}
+		end = clock();
+		if (e) {
+			puts("Failed to access globals.");
+			duckVM_quit(&duckVM);
+			return e;
+		}
+		printf("  %6lu globals: %6.2f ns/access\n",
+		       (unsigned long) globalCount,
+		       1e9 * seconds(start, end) / ACCESSES);
+
+		duckVM_quit(&duckVM);
+	}
+
+	return e;
+}
+
+#ifdef USE_DUCKLIB_MALLOC
+/* Measure the memory a list of conses really takes, collector bookkeeping included. Only DuckLib's allocator can say
+   how much memory is in use. */
+static dl_error_t measureConses(dl_memoryAllocation_t *memoryAllocation) {
+	dl_error_t e = dl_error_ok;
+	const dl_size_t length = MAX_OBJECTS / 2;
+	duckVM_t duckVM;
+	dl_size_t before = 0;
+	dl_size_t empty = 0;
+	dl_size_t full = 0;
+
+	/**/ dl_memory_usage(&before, *memoryAllocation);
+	e = duckVM_init(&duckVM, memoryAllocation, MAX_OBJECTS);
+	if (e) {
+		puts("duckVM_init failed.");
+		return e;
+	}
+	e = duckVM_pushNil(&duckVM);
+	if (e) goto cleanup;
+	/**/ dl_memory_usage(&empty, *memoryAllocation);
+	DL_DOTIMES(i, length) {
+		/* stack: list */
+		e = duckVM_pushCons(&duckVM);
+		if (e) break;
+		e = duckVM_push(&duckVM, 0);
+		if (e) break;
+		e = duckVM_setCdr(&duckVM, 1);
+		if (e) break;
+		e = duckVM_pop(&duckVM);
+		if (e) break;
+		e = duckVM_copyFromTop(&duckVM, 0);
+		if (e) break;
+		e = duckVM_pop(&duckVM);
+		if (e) break;
+	}
+	if (e) {
+		puts("Failed to build a list.");
+		goto cleanup;
+	}
+	/**/ dl_memory_usage(&full, *memoryAllocation);
+	printf("  measured: new VM %lu bytes, list of %lu conses %lu bytes (%.1f bytes/cons)\n",
+	       (unsigned long) (empty - before),
+	       (unsigned long) length,
+	       (unsigned long) (full - empty),
+	       (double) (full - empty) / length);
+
+ cleanup:
+	duckVM_quit(&duckVM);
+	return e;
+}
+#endif /* USE_DUCKLIB_MALLOC */
+
+/* Report the size of a VM object and time copying objects around the stack. */
+static dl_error_t bench_objects(dl_memoryAllocation_t *memoryAllocation) {
+	dl_error_t e = dl_error_ok;
+	const dl_size_t stackDepth = 1000;
+	duckVM_t duckVM;
+	clock_t start, end;
+
+	puts("objects:");
+	printf("  sizeof(duckVM_object_t): %lu bytes\n", (unsigned long) sizeof(duckVM_object_t));
+	printf("  heap of %lu objects:  %lu bytes\n",
+	       (unsigned long) MAX_OBJECTS,
+	       (unsigned long) (MAX_OBJECTS * sizeof(duckVM_object_t)));
+	printf("  stack of %lu objects:  %lu bytes\n",
+	       (unsigned long) stackDepth,
+	       (unsigned long) (stackDepth * sizeof(duckVM_object_t)));
+#ifdef USE_DUCKLIB_MALLOC
+	e = measureConses(memoryAllocation);
+	if (e) return e;
+#endif /* USE_DUCKLIB_MALLOC */
+
+	e = duckVM_init(&duckVM, memoryAllocation, MAX_OBJECTS);
+	if (e) {
+		puts("duckVM_init failed.");
+		return e;
+	}
+	DL_DOTIMES(i, stackDepth) {
+		e = duckVM_pushInteger(&duckVM);
+		if (e) break;
+	}
+	if (e) {
+		puts("Failed to fill the stack.");
+		goto cleanup;
+	}
+
+	start = clock();
+	DL_DOTIMES(i, ACCESSES) {
+		/* Copy an object from deep in the stack to the top, then drop it. */
+		e = duckVM_push(&duckVM, i % stackDepth);
+		if (e) break;
+		e = duckVM_pop(&duckVM);
+		if (e) break;
+	}
+	end = clock();
+	if (e) {
+		puts("Failed to copy objects.");
+		goto cleanup;
+	}
+	printf("  %6.2f ns/copy\n", 1e9 * seconds(start, end) / ACCESSES);
+
+ cleanup:
+	duckVM_quit(&duckVM);
+	return e;
+}
+
+static dl_error_t callback_nop(duckVM_t *duckVM) {
+	return duckVM_pushNil(duckVM);
+}
+
+/* `worstPause`, `stats`, and `bytecodeLength` may be null. `stats` is taken after the script runs. */
+static dl_error_t runScript(dl_memoryAllocation_t *memoryAllocation,
+                            const char *source,
+                            dl_size_t sliceBudget,
+                            double *time,
+                            dl_size_t *worstPause,
+                            duckVM_gcStats_t *stats,
+                            dl_size_t *bytecodeLength) {
+	dl_error_t e = dl_error_ok;
+	duckLisp_t duckLisp;
+	duckVM_t duckVM;
+	dl_uint8_t *bytecode = dl_null;
+	dl_size_t bytecode_length = 0;
+	dl_uint8_t name[16];
+	clock_t start, end;
+
+	e = duckLisp_init(&duckLisp,
+	                  memoryAllocation,
+	                  MAX_OBJECTS
+#ifdef USE_PARENTHESIS_INFERENCE
+	                  ,
+	                  0
+#endif /* USE_PARENTHESIS_INFERENCE */
+	                  );
+	if (e) {
+		puts("duckLisp_init failed.");
+		return e;
+	}
+	e = duckVM_init(&duckVM, memoryAllocation, MAX_OBJECTS);
+	if (e) {
+		puts("duckVM_init failed.");
+		(void) duckLisp_quit(&duckLisp);
+		return e;
+	}
+	e = duckVM_setIncrementalMarking(&duckVM, sliceBudget);
+	if (e) goto cleanup;
+
+	/* Plenty of callbacks so that the callback we care about isn't the only one. */
+	DL_DOTIMES(i, CALLBACKS) {
+		dl_size_t name_length = snprintf((char *) name, sizeof(name), "nop%li", (long) i);
+		e = duckLisp_linkCFunction(&duckLisp,
+		                           callback_nop,
+		                           name,
+		                           name_length
+#ifdef USE_PARENTHESIS_INFERENCE
+		                           ,
+		                           DL_STR("()")
+#endif /* USE_PARENTHESIS_INFERENCE */
+		                           );
+		if (e) break;
+		e = duckVM_linkCFunction(&duckVM, duckLisp_symbol_nameToValue(&duckLisp, name, name_length), callback_nop);
+		if (e) break;
+	}
+	if (e) {
+		puts("Failed to link callbacks.");
+		goto cleanup;
+	}
+
+	e = duckLisp_loadString(&duckLisp,
+#ifdef USE_PARENTHESIS_INFERENCE
+	                        dl_false,
+#endif /* USE_PARENTHESIS_INFERENCE */
+	                        &bytecode,
+	                        &bytecode_length,
+	                        (const dl_uint8_t *) source,
+	                        strlen(source),
+	                        DL_STR("<vm-bench>"));
+	if (e) {
+		puts("Compilation failed.");
+		goto cleanup;
+	}
+
+	start = clock();
+	e = duckVM_execute(&duckVM, bytecode, bytecode_length);
+	end = clock();
+	if (e) {
+		puts("Execution failed.");
+		goto cleanup;
+	}
+	*time = seconds(start, end);
+	if (worstPause != dl_null) *worstPause = duckVM_getWorstGcPause(&duckVM);
+	if (stats != dl_null) duckVM_getGcStats(&duckVM, stats);
+	if (bytecodeLength != dl_null) *bytecodeLength = bytecode_length;
+
+ cleanup:
+	if (bytecode != dl_null) (void) DL_FREE(memoryAllocation, &bytecode);
+	duckVM_quit(&duckVM);
+	(void) duckLisp_quit(&duckLisp);
+	return e;
+}
+
+/* Time a loop that calls a C callback against the same loop without the call. Both are timed a few times and the
+   fastest run is used, since the difference between them is small next to the noise. */
+static dl_error_t bench_ccall(dl_memoryAllocation_t *memoryAllocation) {
+	dl_error_t e = dl_error_ok;
+	const dl_size_t iterations = 1000000;
+	const dl_size_t runs = 5;
+	double emptyTime = 0.0;
+	double callTime = 0.0;
+
+	puts("ccall:");
+	DL_DOTIMES(i, runs) {
+		double time = 0.0;
+		e = runScript(memoryAllocation,
+		              "(() (__var i 0) (__while (__< i 1000000) (__setq i (__+ i 1))))",
+		              0,
+		              &time,
+		              dl_null,
+		              dl_null,
+		              dl_null);
+		if (e) return e;
+		if ((i == 0) || (time < emptyTime)) emptyTime = time;
+		e = runScript(memoryAllocation,
+		              "(() (__var i 0) (__while (__< i 1000000) (nop999) (__setq i (__+ i 1))))",
+		              0,
+		              &time,
+		              dl_null,
+		              dl_null,
+		              dl_null);
+		if (e) return e;
+		if ((i == 0) || (time < callTime)) callTime = time;
+	}
+	printf("  %6.2f ns/iteration without the call\n", 1e9 * emptyTime / iterations);
+	printf("  %6.2f ns/call\n", 1e9 * (callTime - emptyTime) / iterations);
+
+	return e;
+}
+
+/* Measure how much memory the decoded instructions take next to the bytecode they came from, and how fast a simple
+   loop runs from them. */
+static dl_error_t bench_decoded(dl_memoryAllocation_t *memoryAllocation) {
+	dl_error_t e = dl_error_ok;
+	const dl_size_t iterations = 1000000;
+	double time = 0.0;
+	duckVM_gcStats_t stats;
+	dl_size_t bytecodeLength = 0;
+
+	puts("decoded instructions:");
+	e = runScript(memoryAllocation,
+	              "(() (__var i 0) (__var j 0)"
+	              " (__while (__< i 1000000) (__if (__< j 3) (__setq j (__+ j 1)) (__setq j 0)) (__setq i (__+ i 1))))",
+	              0,
+	              &time,
+	              dl_null,
+	              &stats,
+	              &bytecodeLength);
+	if (e) return e;
+	printf("  %lu bytes of bytecode, %lu bytes decoded\n", (unsigned long) bytecodeLength, (unsigned long) stats.decodedBytes);
+	printf("  %6.2f ns/iteration\n", 1e9 * time / iterations);
+
+	return e;
+}
+
+/* Keep a big list alive while making garbage, and compare the longest collector pause with and without incremental
+   marking. */
+static dl_error_t bench_gcPause(dl_memoryAllocation_t *memoryAllocation) {
+	dl_error_t e = dl_error_ok;
+	const char *source = ("(() (__var kept ()) (__var i 0)"
+	                      " (__while (__< i 20000) (__setq kept (__cons i kept)) (__setq i (__+ i 1)))"
+	                      " (__var garbage ()) (__setq i 0)"
+	                      " (__while (__< i 1000000) (__setq garbage (__cons i (__cons i ()))) (__setq i (__+ i 1))))");
+	const dl_size_t sliceBudgets[] = {0, 1000, 100};
+
+	puts("gc pause:");
+	DL_DOTIMES(i, sizeof(sliceBudgets) / sizeof(*sliceBudgets)) {
+		double time = 0.0;
+		dl_size_t worstPause = 0;
+		e = runScript(memoryAllocation, source, sliceBudgets[i], &time, &worstPause, dl_null, dl_null);
+		if (e) return e;
+		printf("  slice budget %5lu: worst pause %6lu objects, %6.3f s\n",
+		       (unsigned long) sliceBudgets[i],
+		       (unsigned long) worstPause,
+		       time);
+	}
+
+	return e;
+}
+
+/* Time full collections with a lot of roots on the stack. Most of the time should be spent marking and sweeping, not
+   managing the mark stack. */
+static dl_error_t bench_gcRoots(dl_memoryAllocation_t *memoryAllocation) {
+	dl_error_t e = dl_error_ok;
+	const dl_size_t rootCount = 100000;
+	const dl_size_t collections = 100;
+	duckVM_t duckVM;
+	clock_t start, end;
+
+	puts("gc roots:");
+	e = duckVM_init(&duckVM, memoryAllocation, 4 * rootCount);
+	if (e) {
+		puts("duckVM_init failed.");
+		return e;
+	}
+	DL_DOTIMES(i, rootCount) {
+		e = duckVM_pushCons(&duckVM);
+		if (e) break;
+	}
+	if (e) {
+		puts("Failed to fill the stack.");
+		goto cleanup;
+	}
+
+	start = clock();
+	DL_DOTIMES(i, collections) {
+		e = duckVM_garbageCollect(&duckVM);
+		if (e) break;
+	}
+	end = clock();
+	if (e) {
+		puts("Garbage collection failed.");
+		goto cleanup;
+	}
+	printf("  %lu stack roots: %6.2f ms/collection\n",
+	       (unsigned long) rootCount,
+	       1e3 * seconds(start, end) / collections);
+
+ cleanup:
+	duckVM_quit(&duckVM);
+	return e;
+}
+
+/* Walk the list in global 0 from start to end `walks` times. */
+static dl_error_t walkList(duckVM_t *duckVM, dl_size_t walks, dl_size_t *length, double *time) {
+	dl_error_t e = dl_error_ok;
+	duckVM_object_t head;
+	clock_t start, end;
+
+	e = duckVM_pushGlobal(duckVM, 0);
+	if (e) return e;
+	e = duckVM_object_pop(duckVM, &head);
+	if (e) return e;
+
+	*length = 0;
+	start = clock();
+	DL_DOTIMES(i, walks) {
+		duckVM_object_t *cons = head.value.list;
+		while (cons != dl_null) {
+			duckVM_object_t *cdr = cons->value.cons.cdr;
+			(*length)++;
+			cons = ((cdr == dl_null) ? dl_null : cdr->value.list);
+		}
+	}
+	end = clock();
+	*time = seconds(start, end);
+	return e;
+}
+
+/* Time walking a list that was built in a scrambled order, then compact the heap and walk it again. */
+static dl_error_t bench_compact(dl_memoryAllocation_t *memoryAllocation) {
+	dl_error_t e = dl_error_ok;
+	const dl_size_t cellCount = 100000;
+	/* Shares no factors with `cellCount`, so stepping by it visits every cell once. */
+	const dl_size_t stride = 7919;
+	const dl_size_t walks = 100;
+	duckVM_t duckVM;
+	dl_size_t length = 0;
+	double time = 0.0;
+
+	puts("compaction:");
+	e = duckVM_init(&duckVM, memoryAllocation, 4 * cellCount);
+	if (e) {
+		puts("duckVM_init failed.");
+		return e;
+	}
+	DL_DOTIMES(i, cellCount) {
+		e = duckVM_pushCons(&duckVM);
+		if (e) break;
+	}
+	/* Link cell `i * stride` to cell `(i + 1) * stride` and make the first one a global. */
+	DL_DOTIMES(i, cellCount - 1) {
+		if (e) break;
+		e = duckVM_push(&duckVM, ((i + 1) * stride) % cellCount);
+		if (e) break;
+		e = duckVM_setCdr(&duckVM, (i * stride) % cellCount);
+		if (e) break;
+		e = duckVM_pop(&duckVM);
+	}
+	if (!e) e = duckVM_push(&duckVM, 0);
+	if (!e) e = duckVM_setGlobal(&duckVM, 0);
+	if (!e) e = duckVM_popAll(&duckVM);
+	if (e) {
+		puts("Failed to build the list.");
+		goto cleanup;
+	}
+
+	e = walkList(&duckVM, walks, &length, &time);
+	if (e) goto cleanup;
+	printf("  before: %6.2f ns/cell\n", 1e9 * time / length);
+
+	e = duckVM_compact(&duckVM);
+	if (e) {
+		puts("Compaction failed.");
+		goto cleanup;
+	}
+	e = walkList(&duckVM, walks, &length, &time);
+	if (e) goto cleanup;
+	printf("  after:  %6.2f ns/cell\n", 1e9 * time / length);
+	if (length != walks * cellCount) {
+		puts("Compaction broke the list.");
+		e = dl_error_shouldntHappen;
+	}
+
+ cleanup:
+	duckVM_quit(&duckVM);
+	return e;
+}
+
+#ifdef USE_PARALLEL_MARKING
+/* Time full collections of a big heap marked on different numbers of threads. The heap is a vector of long lists,
+   which is about the worst shape for one thread and the best for several. */
+static dl_error_t bench_parallelMark(dl_memoryAllocation_t *memoryAllocation) {
+	dl_error_t e = dl_error_ok;
+	const dl_size_t threadCounts[] = {1, 2, 4, 8};
+	const dl_size_t listCount = 256;
+	const dl_size_t listLength = 2000;
+	const dl_size_t collections = 20;
+	duckVM_t duckVM;
+
+	puts("parallel mark:");
+	e = duckVM_init(&duckVM, memoryAllocation, 4 * listCount * listLength);
+	if (e) {
+		puts("duckVM_init failed.");
+		return e;
+	}
+
+	/* stack: vector */
+	e = duckVM_pushVector(&duckVM, listCount);
+	DL_DOTIMES(i, listCount) {
+		if (e) break;
+		/* stack: vector list */
+		e = duckVM_pushNil(&duckVM);
+		DL_DOTIMES(j, listLength) {
+			if (e) break;
+			/* stack: vector list cons */
+			e = duckVM_pushCons(&duckVM);
+			if (e) break;
+			e = duckVM_push(&duckVM, 1);
+			if (e) break;
+			e = duckVM_setCdr(&duckVM, 2);
+			if (e) break;
+			e = duckVM_pop(&duckVM);
+			if (e) break;
+			e = duckVM_copyFromTop(&duckVM, 1);
+			if (e) break;
+			e = duckVM_pop(&duckVM);
+		}
+		if (e) break;
+		e = duckVM_setElement(&duckVM, i, 0);
+		if (e) break;
+		e = duckVM_pop(&duckVM);
+	}
+	if (e) {
+		puts("Failed to build the heap.");
+		goto cleanup;
+	}
+
+	DL_DOTIMES(i, sizeof(threadCounts) / sizeof(*threadCounts)) {
+		clock_t start, end;
+		struct timespec wallStart, wallEnd;
+		e = duckVM_setParallelMarking(&duckVM, threadCounts[i]);
+		if (e) goto cleanup;
+		start = clock();
+		(void) clock_gettime(CLOCK_MONOTONIC, &wallStart);
+		DL_DOTIMES(j, collections) {
+			e = duckVM_garbageCollect(&duckVM);
+			if (e) break;
+		}
+		(void) clock_gettime(CLOCK_MONOTONIC, &wallEnd);
+		end = clock();
+		if (e) {
+			puts("Garbage collection failed.");
+			goto cleanup;
+		}
+		/* `clock` adds up the time of every thread. */
+		printf("  %lu threads: %6.2f ms/collection, %6.2f ms of CPU time\n",
+		       (unsigned long) threadCounts[i],
+		       1e3 * ((double) (wallEnd.tv_sec - wallStart.tv_sec)
+		              + 1e-9 * (double) (wallEnd.tv_nsec - wallStart.tv_nsec)) / collections,
+		       1e3 * seconds(start, end) / collections);
+	}
+
+ cleanup:
+	duckVM_quit(&duckVM);
+	return e;
+}
+#endif /* USE_PARALLEL_MARKING */
+
+int main(void) {
+	dl_error_t e = dl_error_ok;
+	dl_memoryAllocation_t memoryAllocation;
+	void *memory = malloc(MEMORY_SIZE);
+
+	if (memory == NULL) {
+		puts("malloc failed.");
+		return 1;
+	}
+	e = dl_memory_init(&memoryAllocation, memory, MEMORY_SIZE, dl_memoryFit_best);
+	if (e) {
+		puts("dl_memory_init failed.");
+		goto cleanup;
+	}
+
+	e = bench_globals(&memoryAllocation);
+	if (e) goto cleanup;
+	e = bench_ccall(&memoryAllocation);
+	if (e) goto cleanup;
+	e = bench_decoded(&memoryAllocation);
+	if (e) goto cleanup;
+	e = bench_objects(&memoryAllocation);
+	if (e) goto cleanup;
+	e = bench_gcPause(&memoryAllocation);
+	if (e) goto cleanup;
+	e = bench_gcRoots(&memoryAllocation);
+	if (e) goto cleanup;
+	e = bench_compact(&memoryAllocation);
+	if (e) goto cleanup;
+#ifdef USE_PARALLEL_MARKING
+	e = bench_parallelMark(&memoryAllocation);
+	if (e) goto cleanup;
+#endif /* USE_PARALLEL_MARKING */
+
+ cleanup:
+	dl_memory_quit(&memoryAllocation);
+	free(memory);
+	return e;
+}